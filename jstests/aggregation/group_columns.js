@@ -0,0 +1,65 @@
+// Test that $group gives the same results whether it reads its input a batch of columns at a time
+// or as whole documents.
+(function() {
+    "use strict";
+
+    var t = db.agg_group_columns;
+    t.drop();
+
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 500; i++) {
+        var doc = {_id: i, k: i % 7, n: i, s: "s" + (i % 3)};
+        if (i % 5 == 0) {
+            delete doc.k;
+        }
+        if (i % 11 == 0) {
+            doc.n = i + 0.5;
+        }
+        if (i % 13 == 0) {
+            doc.n = NumberLong(i);
+        }
+        if (i % 17 == 0) {
+            doc.n = "not a number";
+        }
+        if (i % 19 == 0) {
+            doc.k = [1, 2];
+        }
+        bulk.insert(doc);
+    }
+    assert.writeOK(bulk.execute());
+
+    var pipelines = [
+        [{$group: {_id: "$k", total: {$sum: "$n"}, count: {$sum: 1}}}],
+        [{$group: {_id: null, total: {$sum: "$n"}, count: {$sum: 1}}}],
+        [{$group: {_id: {k: "$k", s: "$s"}, total: {$sum: "$n"}, top: {$max: "$n"}}}],
+        [{$group: {_id: "$missing", count: {$sum: 1}, first: {$first: "$s"}}}],
+        [{$group: {_id: "$s", ns: {$push: "$n"}, ks: {$addToSet: "$k"}, avg: {$avg: "$n"}}}],
+        [{$project: {s: 1, v: "$n"}}, {$group: {_id: "$s", total: {$sum: "$v"}}}],
+        [{$project: {_id: 0, k: 1}}, {$group: {_id: "$_id", count: {$sum: 1}, k: {$min: "$k"}}}],
+        [{$project: {x: "$k", y: "$k"}}, {$group: {_id: {x: "$x", y: "$y"}, count: {$sum: 1}}}],
+        [{$match: {k: {$gt: 2}}}, {$group: {_id: "$k", total: {$sum: "$n"}}}],
+        [{$limit: 100}, {$group: {_id: "$k", total: {$sum: "$n"}}}],
+        // Not read by columns.
+        [{$group: {_id: {$mod: ["$n", 3]}, total: {$sum: {$multiply: ["$n", 2]}}}}],
+        [{$project: {v: {$add: ["$n", 1]}}}, {$group: {_id: null, total: {$sum: "$v"}}}],
+    ];
+
+    function run(useColumns, pipeline) {
+        assert.commandWorked(db.adminCommand(
+            {setParameter: 1, internalDocumentSourceGroupUseColumns: useColumns}));
+        return t.aggregate(pipeline.concat([{$sort: {_id: 1}}])).toArray();
+    }
+
+    try {
+        pipelines.forEach(function(pipeline) {
+            var expected = run(false, pipeline);
+            var actual = run(true, pipeline);
+            assert.eq(expected, actual, tojson(pipeline));
+            // Make sure the types of the sums match as well.
+            assert.eq(tojson(expected), tojson(actual), tojson(pipeline));
+        });
+    } finally {
+        assert.commandWorked(
+            db.adminCommand({setParameter: 1, internalDocumentSourceGroupUseColumns: true}));
+    }
+})();
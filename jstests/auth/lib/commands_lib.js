@@ -308,6 +308,29 @@ var authCommandsLib = {
                 }
             ]
         },
+        {
+            testname: "analyze",
+            command: {analyze: "x"},
+            skipSharded: true,
+            setup: function (db) { db.x.save( {} ); },
+            teardown: function (db) { db.x.drop(); },
+            testcases: [
+                {
+                    runOnDb: firstDbName,
+                    roles: roles_dbAdmin,
+                    privileges: [
+                        { resource: {db: firstDbName, collection: "x"}, actions: ["planCacheWrite"] }
+                    ],
+                },
+                {
+                    runOnDb: secondDbName,
+                    roles: roles_dbAdminAny,
+                    privileges: [
+                        { resource: {db: secondDbName, collection: "x"}, actions: ["planCacheWrite"] }
+                    ],
+                },
+            ]
+        },
         {
             testname: "appendOplogNote",
             command: {appendOplogNote: 1, data: {a: 1}},
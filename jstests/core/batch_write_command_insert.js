@@ -199,6 +199,34 @@ assert.eq('string', typeof result.writeErrors[0].errmsg);
 
 assert.eq(coll.count(), 1);
 
+//
+// Duplicate key error in the middle of a batch large enough to be inserted in groups, ordered
+// false. Every other document must still be inserted and the error reported at its own index.
+coll.remove({});
+batch = [];
+for (var i = 0; i < 200; i++) {
+    batch.push({ a: i });
+}
+batch[150] = { a: 10 };
+request = { insert: coll.getName(), documents: batch, writeConcern: { w: 1 }, ordered: false };
+result = coll.runCommand(request);
+assert(result.ok, tojson(result));
+assert.eq(199, result.n);
+assert.eq(1, result.writeErrors.length);
+assert.eq(150, result.writeErrors[0].index);
+assert.eq(coll.count(), 199);
+
+//
+// Same as above, ordered true. Inserts stop at the duplicate.
+coll.remove({});
+request = { insert: coll.getName(), documents: batch, writeConcern: { w: 1 }, ordered: true };
+result = coll.runCommand(request);
+assert(result.ok, tojson(result));
+assert.eq(150, result.n);
+assert.eq(1, result.writeErrors.length);
+assert.eq(150, result.writeErrors[0].index);
+assert.eq(coll.count(), 150);
+
 //
 // Ensure _id is the first field in all documents
 coll.remove({});
@@ -0,0 +1,62 @@
+// Tests hashed indexes built with a non-default hashVersion.
+
+(function() {
+    'use strict';
+
+    // Include helpers for analyzing explain output.
+    load("jstests/libs/analyze_plan.js");
+
+    var t = db.hashindex_version;
+    t.drop();
+
+    // Unknown hash versions are rejected when the index is built.
+    assert.commandFailed(t.createIndex({a: "hashed"}, {hashVersion: 2}));
+    assert.eq(1, t.getIndexes().length);
+
+    var spec = {a: "hashed"};
+    assert.commandWorked(t.createIndex(spec, {hashVersion: 1}));
+    assert.eq(2, t.getIndexes().length);
+
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(t.insert({a: i}));
+    }
+    assert.writeOK(t.insert({a: 3.5}));
+    assert.writeOK(t.insert({a: "str"}));
+    assert.writeOK(t.insert({a: {b: 1}}));
+
+    assert.eq(103, t.find().hint(spec).itcount());
+    assert.eq(1, t.find({a: 3}).hint(spec).itcount());
+    assert.eq(1, t.find({a: NumberLong(3)}).hint(spec).itcount());
+    assert.eq(3.5, t.find({a: 3.5}).hint(spec).next().a);
+    assert.eq(1, t.find({a: "str"}).hint(spec).itcount());
+    assert.eq(1, t.find({a: {b: 1}}).hint(spec).itcount());
+    assert.eq(3, t.find({a: {$in: [1, 2, 50, 1000]}}).hint(spec).itcount());
+
+    // The planner must hash equality predicates with the index's version for the bounds to match.
+    var explain = t.find({a: 42}).explain(true);
+    assert(isIxscan(explain.queryPlanner.winningPlan));
+    assert.eq(1, explain.executionStats.nReturned);
+    assert.eq(1, explain.executionStats.totalKeysExamined);
+
+    // Updates and removes maintain the index.
+    assert.writeOK(t.update({a: 5}, {$set: {a: "five"}}));
+    assert.eq(0, t.find({a: 5}).hint(spec).itcount());
+    assert.eq(1, t.find({a: "five"}).hint(spec).itcount());
+    assert.writeOK(t.remove({a: "five"}));
+    assert.eq(0, t.find({a: "five"}).hint(spec).itcount());
+
+    var res = t.validate(true);
+    assert(res.valid, tojson(res));
+
+    // The test-only hash command reports the same hashes as each version of the index.
+    var hashCmd = db.runCommand({_hashBSONElement: 42});
+    if (hashCmd.ok) {
+        assert.eq(0, hashCmd.hashVersion);
+        var murmur = db.runCommand({_hashBSONElement: 42, hashVersion: 1});
+        assert.commandWorked(murmur);
+        assert.eq(1, murmur.hashVersion);
+        assert.neq(hashCmd.out, murmur.out);
+        assert.eq(murmur.out, db.runCommand({_hashBSONElement: 42.0, hashVersion: 1}).out);
+        assert.commandFailed(db.runCommand({_hashBSONElement: 42, hashVersion: 2}));
+    }
+})();
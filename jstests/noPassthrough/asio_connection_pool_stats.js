@@ -0,0 +1,43 @@
+// Checks that a replica set whose nodes use the ASIO network interface reuses pooled connections
+// for heartbeats, and reports them in connPoolStats.
+
+(function() {
+    'use strict';
+
+    var rst = new ReplSetTest({
+        name: 'asio_connection_pool_stats',
+        nodes: 2,
+        nodeOptions: {setParameter: 'outboundNetworkImpl=ASIO'}
+    });
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var secondary = rst.getSecondaries()[0];
+    assert.writeOK(primary.getDB('test').foo.insert({x: 1}, {writeConcern: {w: 2}}));
+
+    function pool(conn) {
+        var stats = assert.commandWorked(conn.adminCommand({connPoolStats: 1}));
+        assert(stats.asyncConnectionPools, tojson(stats));
+
+        var names = Object.keys(stats.asyncConnectionPools);
+        assert.eq(1, names.length, tojson(stats.asyncConnectionPools));
+        return stats.asyncConnectionPools[names[0]];
+    }
+
+    // Heartbeats to the other member go through the pool. Let a few of them run, then check
+    // that they are still sharing a single connection.
+    assert.soon(function() {
+        var stats = pool(primary);
+        var host = stats.hosts[secondary.host];
+        return host && host.created >= 1 && host.available >= 1;
+    }, 'primary never pooled a connection to the secondary');
+
+    var created = pool(primary).hosts[secondary.host].created;
+    sleep(5000);
+    var stats = pool(primary);
+    assert.eq(created, stats.hosts[secondary.host].created, tojson(stats));
+    assert.gte(stats.totalCreated, 1, tojson(stats));
+
+    rst.stopSet();
+})();
@@ -0,0 +1,64 @@
+// Checks that $group returns the same results when only some of its hash partitions are spilled
+// to disk as when everything fits in memory.
+
+(function() {
+    'use strict';
+
+    var mongo = MongoRunner.runMongod({});
+    assert.commandWorked(mongo.getDB('admin').runCommand({
+        setParameter: 1,
+        internalDocumentSourceGroupMaxMemoryBytes: 64 * 1024,
+        internalDocumentSourceGroupPartitions: 8
+    }));
+    var coll = mongo.getDB('test').group_partitioned_spill;
+
+    // A few hot groups that get many documents each, plus a long tail of groups with a single
+    // document, which push the $group over its memory limit.
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 20000; i++) {
+        var key = (i % 2 === 0) ? 'hot' + (i % 10) : 'cold' + i;
+        bulk.insert({key: key, x: i, s: 'v' + (i % 7)});
+    }
+    assert.writeOK(bulk.execute());
+
+    var pipeline = [
+        {$group: {
+            _id: '$key',
+            count: {$sum: 1},
+            total: {$sum: '$x'},
+            lo: {$min: '$x'},
+            hi: {$max: '$x'},
+            avg: {$avg: '$x'},
+            strings: {$addToSet: '$s'}
+        }},
+        {$sort: {_id: 1}}
+    ];
+
+    // Without allowDiskUse the memory limit is enforced.
+    var res = coll.runCommand('aggregate', {pipeline: pipeline});
+    assert.commandFailed(res);
+    assert.eq(16945, res.code);
+
+    var spilled = coll.aggregate(pipeline, {allowDiskUse: true}).toArray();
+
+    // Raise the limit so that nothing spills and compare.
+    assert.commandWorked(mongo.getDB('admin').runCommand(
+        {setParameter: 1, internalDocumentSourceGroupMaxMemoryBytes: 100 * 1024 * 1024}));
+    var inMemory = coll.aggregate(pipeline).toArray();
+
+    assert.eq(5 + 10000, inMemory.length);
+    assert.eq(inMemory.length, spilled.length);
+    for (var i = 0; i < inMemory.length; i++) {
+        inMemory[i].strings.sort();
+        spilled[i].strings.sort();
+        assert.docEq(inMemory[i], spilled[i]);
+    }
+
+    var hot = spilled.filter(function(doc) {
+        return doc._id === 'hot0';
+    });
+    assert.eq(1, hot.length);
+    assert.eq(2000, hot[0].count);
+
+    MongoRunner.stopMongod(mongo);
+})();
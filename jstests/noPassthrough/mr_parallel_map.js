@@ -0,0 +1,89 @@
+// Test that mapReduce gives the same results whether the map function runs on several threads or
+// on one, with reduce functions summed natively and in JavaScript.
+(function() {
+    "use strict";
+    var runner = MongoRunner.runMongod({setParameter: "internalMapReduceMapThreads=4"});
+    var db = runner.getDB("test");
+    var admin = runner.getDB("admin");
+    var t = db.mr_parallel_map;
+
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 2000; i++) {
+        var doc = {_id: i, k: i % 13, n: i, tags: ["t" + (i % 3), "t" + (i % 5)]};
+        if (i % 7 == 0) {
+            doc.n = NumberLong(i);
+        }
+        if (i % 11 == 0) {
+            doc.n = i + 0.5;
+        }
+        bulk.insert(doc);
+    }
+    assert.writeOK(bulk.execute());
+
+    var maps = [
+        function() {
+            emit(this.k, this.n);
+        },
+        function() {
+            this.tags.forEach(function(tag) {
+                emit(tag, 1);
+            });
+        },
+        function() {
+            emit({k: this.k, odd: this._id % 2 == 1}, this._id);
+        },
+    ];
+    var reduces = [
+        function(key, values) {
+            return Array.sum(values);
+        },
+        function(key, values) {
+            var total = 0;
+            values.forEach(function(v) {
+                total += v;
+            });
+            return total;
+        },
+        // Not summed natively.
+        function(key, values) {
+            return Math.max.apply(null, values);
+        },
+    ];
+
+    function run(numThreads, map, reduce, out) {
+        assert.commandWorked(
+            admin.runCommand({setParameter: 1, internalMapReduceMapThreads: numThreads}));
+        var res = db.runCommand({mapReduce: t.getName(), map: map, reduce: reduce, out: out});
+        assert.commandWorked(res);
+        if (out.inline) {
+            return res.results.sort(function(a, b) {
+                return bsonWoCompare({_id: a._id}, {_id: b._id});
+            });
+        }
+        return db[res.result].find().sort({_id: 1}).toArray();
+    }
+
+    maps.forEach(function(map) {
+        reduces.forEach(function(reduce) {
+            [{inline: 1}, {replace: "mr_parallel_map_out"}].forEach(function(out) {
+                var expected = run(1, map, reduce, out);
+                var actual = run(4, map, reduce, out);
+                assert.eq(expected, actual, tojson({map: map, reduce: reduce, out: out}));
+            });
+        });
+    });
+
+    // The map function runs without access to the database.
+    assert.commandWorked(admin.runCommand({setParameter: 1, internalMapReduceMapThreads: 4}));
+    var res = db.runCommand({
+        mapReduce: t.getName(),
+        map: function() {
+            emit(db.mr_parallel_map.findOne()._id, 1);
+        },
+        reduce: reduces[0],
+        out: {inline: 1}
+    });
+    assert.commandFailed(res);
+
+    MongoRunner.stopMongod(runner);
+})();
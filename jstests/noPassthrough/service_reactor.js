@@ -0,0 +1,45 @@
+// Checks that mongod serves clients correctly when connections are multiplexed over the reactor's
+// worker pool, and that the reactor's statistics are reported in serverStatus.
+
+(function() {
+    'use strict';
+
+    var mongo = MongoRunner.runMongod({setParameter: "serviceModel=reactor"});
+    var serverStatus = assert.commandWorked(mongo.getDB('admin').serverStatus());
+    if (!serverStatus.network.serviceReactor) {
+        // The reactor is not available on this platform or configuration (e.g. with SSL).
+        jsTest.log("Skipping test since the reactor service model is not in use");
+        MongoRunner.stopMongod(mongo);
+        return;
+    }
+
+    // Use more connections than there are I/O threads, and interleave their operations so that
+    // each connection is serviced by several different workers.
+    var conns = [];
+    for (var i = 0; i < 8; i++) {
+        conns.push(new Mongo(mongo.host));
+    }
+
+    for (var round = 0; round < 20; round++) {
+        conns.forEach(function(conn, i) {
+            var coll = conn.getDB('test').service_reactor;
+            assert.writeOK(coll.insert({conn: i, round: round}));
+            assert.eq(round + 1, coll.find({conn: i}).itcount());
+        });
+    }
+
+    // Errors, and state kept per connection such as getLastError, must stay with the connection.
+    var testDB = conns[0].getDB('test');
+    assert.commandFailed(testDB.runCommand({nonExistentCommand: 1}));
+    testDB.service_reactor.insert({_id: 1});
+    testDB.service_reactor.insert({_id: 1});
+    assert.eq(11000, testDB.getLastErrorObj().code);
+
+    serverStatus = assert.commandWorked(mongo.getDB('admin').serverStatus());
+    var reactorStats = serverStatus.network.serviceReactor;
+    assert.gte(reactorStats.connections, conns.length, tojson(reactorStats));
+    assert.gt(reactorStats.totalQueued, 8 * 20 * 2, tojson(reactorStats));
+    assert.gte(reactorStats.queueDepth, 0, tojson(reactorStats));
+
+    MongoRunner.stopMongod(mongo);
+})();
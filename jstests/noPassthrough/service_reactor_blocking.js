@@ -0,0 +1,44 @@
+// Checks that the reactor keeps serving connections while all of its worker threads are tied up in
+// long running operations, by growing its worker pool.
+
+(function() {
+    'use strict';
+
+    var baseName = "service_reactor_blocking";
+    var port = allocatePorts(1)[0];
+    var dbpath = MongoRunner.dataPath + baseName + "/";
+    resetDbpath(dbpath);
+
+    var mongo = startMongoProgram("mongod", "--port", port, "--dbpath", dbpath,
+                                  "--nohttpinterface", "--bind_ip", "127.0.0.1",
+                                  "--setParameter", "enableTestCommands=1",
+                                  "--setParameter", "serviceModel=reactor",
+                                  "--setParameter", "serviceReactorWorkerThreads=1");
+    var adminDB = mongo.getDB('admin');
+    var reactorStats = assert.commandWorked(adminDB.serverStatus()).network.serviceReactor;
+    if (!reactorStats) {
+        // The reactor is not available on this platform or configuration (e.g. with SSL).
+        jsTest.log("Skipping test since the reactor service model is not in use");
+        MongoRunner.stopMongod(port);
+        return;
+    }
+    assert.eq(1, reactorStats.minWorkerThreads, tojson(reactorStats));
+
+    // Keep the only worker thread which the pool starts with busy.
+    var awaitSleep = startParallelShell(
+        "assert.commandWorked(db.adminCommand({sleep: 1, secs: 20}));", port);
+
+    // Both waiting for the sleep to start and pinging need another worker thread.
+    assert.soon(function() {
+        return adminDB.currentOp().inprog.some(function(op) {
+            return op.query && op.query.sleep;
+        });
+    }, "sleep command never started");
+
+    var start = new Date();
+    assert.commandWorked(adminDB.runCommand({ping: 1}));
+    assert.lt(new Date() - start, 10 * 1000, "ping waited for the sleep command");
+
+    awaitSleep();
+    MongoRunner.stopMongod(port);
+})();
@@ -0,0 +1,72 @@
+// Test that the TTL monitor shares each pass between TTL indexes when a pass budget limits how
+// many documents it deletes, and reports how late expired documents are deleted.
+(function() {
+    "use strict";
+    // Launch mongod with shorter TTL monitor sleep interval.
+    var runner = MongoRunner.runMongod({setParameter: "ttlMonitorSleepSecs=1"});
+    var db = runner.getDB("test");
+    var admin = runner.getDB("admin");
+
+    assert.commandWorked(admin.runCommand({setParameter: 1, ttlMonitorEnabled: false}));
+
+    // Every document expired an hour ago.
+    var numDocs = 300;
+    var expired = new Date(new Date().getTime() - 60 * 60 * 1000);
+    var collNames = ["ttl_budget_a", "ttl_budget_b"];
+    collNames.forEach(function(collName) {
+        var coll = db[collName];
+        coll.drop();
+        assert.commandWorked(coll.ensureIndex({x: 1}, {expireAfterSeconds: 0}));
+
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < numDocs; i++) {
+            bulk.insert({x: expired});
+        }
+        assert.writeOK(bulk.execute());
+    });
+
+    // Visit each index ten documents at a time, and stop a pass after a hundred documents.
+    assert.commandWorked(admin.runCommand({setParameter: 1,
+                                           ttlMonitorSliceDocs: 10,
+                                           ttlMonitorPassMaxDocs: 100}));
+
+    var ttlStatus = db.serverStatus().metrics.ttl;
+    assert.commandWorked(admin.runCommand({setParameter: 1, ttlMonitorEnabled: true}));
+
+    // Wait for a whole pass.
+    assert.soon(function() {
+                    return db.serverStatus().metrics.ttl.passes >= ttlStatus.passes + 2;
+                },
+                "TTL monitor didn't run before timing out.");
+
+    // Both collections got their share of the pass, and the budget left expired documents.
+    var remaining = 0;
+    collNames.forEach(function(collName) {
+        var count = db[collName].count();
+        assert.lt(count, numDocs, collName + " was not visited by the TTL monitor");
+        remaining += count;
+    });
+    assert.gt(remaining, 0, "TTL pass did not respect its budget");
+
+    var newTTLStatus = db.serverStatus().metrics.ttl;
+    assert.gt(newTTLStatus.incompletePasses, ttlStatus.incompletePasses, tojson(newTTLStatus));
+
+    // The following passes delete the rest.
+    assert.soon(function() {
+                    return db.ttl_budget_a.count() == 0 && db.ttl_budget_b.count() == 0;
+                },
+                "TTL monitor didn't delete every expired document.");
+
+    newTTLStatus = db.serverStatus().metrics.ttl;
+    assert.eq(2 * numDocs,
+              newTTLStatus.deletedDocuments - ttlStatus.deletedDocuments,
+              tojson(newTTLStatus));
+    assert.eq(2 * numDocs,
+              newTTLStatus.deletionLag.num - ttlStatus.deletionLag.num,
+              tojson(newTTLStatus));
+    assert.gte(newTTLStatus.deletionLag.totalMillis - ttlStatus.deletionLag.totalMillis,
+               2 * numDocs * 60 * 60 * 1000,
+               tojson(newTTLStatus));
+
+    MongoRunner.stopMongod(runner);
+})();
@@ -0,0 +1,109 @@
+// Test that a text search sorted by score with a limit keeps only the top scoring documents and
+// stops reading the index early, and that a text search without a limit spills its scores to
+// disk, both giving the same results as a plain text search.
+(function() {
+    "use strict";
+
+    var t = db.fts_top_k;
+    t.drop();
+    assert.commandWorked(t.ensureIndex({text: "text"}));
+
+    // Short documents score higher than long ones with the same terms.
+    var filler = [];
+    for (var i = 0; i < 30; i++) {
+        filler.push("filler" + i);
+    }
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 2000; i++) {
+        var text = i % 100 == 0 ? "alpha beta" : "alpha " + filler.join(" ") + " beta";
+        if (i % 3 == 0) {
+            text += " gamma";
+        }
+        bulk.insert({_id: i, text: text, n: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    function findTextOr(stage) {
+        if (stage.stage == "TEXT_OR") {
+            return stage;
+        }
+        var children = stage.inputStages || (stage.inputStage ? [stage.inputStage] : []);
+        for (var i = 0; i < children.length; i++) {
+            var found = findTextOr(children[i]);
+            if (found) {
+                return found;
+            }
+        }
+        return null;
+    }
+
+    function setParameter(params) {
+        params.setParameter = 1;
+        assert.commandWorked(db.adminCommand(params));
+    }
+
+    function run(query, limit) {
+        var cursor = t.find(query, {score: {$meta: "textScore"}});
+        if (limit) {
+            cursor = cursor.sort({score: {$meta: "textScore"}}).limit(limit);
+        }
+        return cursor.toArray().sort(function(a, b) {
+            return b.score - a.score || a._id - b._id;
+        });
+    }
+
+    function explainTextOr(query, limit) {
+        var cursor = t.find(query, {score: {$meta: "textScore"}});
+        if (limit) {
+            cursor = cursor.sort({score: {$meta: "textScore"}}).limit(limit);
+        }
+        var explain = cursor.explain("executionStats");
+        var textOr = findTextOr(explain.executionStats.executionStages);
+        assert(textOr, tojson(explain));
+        return textOr;
+    }
+
+    var queries = [
+        {$text: {$search: "alpha beta"}},
+        {$text: {$search: "alpha gamma"}},
+        {$text: {$search: "beta gamma"}, n: {$gte: 500}},
+    ];
+
+    try {
+        // The top documents, ties aside, don't depend on how they are found.
+        queries.forEach(function(query) {
+            [5, 20, 3000].forEach(function(limit) {
+                setParameter({internalQueryExecTextOrTopK: false});
+                var expected = run(query, limit);
+                setParameter({internalQueryExecTextOrTopK: true});
+                var actual = run(query, limit);
+                assert.eq(expected.length, actual.length, tojson(query));
+                for (var i = 0; i < expected.length; i++) {
+                    assert.eq(expected[i].score, actual[i].score, tojson(query));
+                }
+            });
+        });
+
+        var textOr = explainTextOr({$text: {$search: "alpha beta"}}, 5);
+        assert.eq(5, textOr.limitAmount, tojson(textOr));
+        assert(textOr.stoppedEarly, tojson(textOr));
+
+        // A negated term leaves documents to the text matcher, so all of them are scored.
+        textOr = explainTextOr({$text: {$search: "alpha beta -gamma"}}, 5);
+        assert.eq(undefined, textOr.limitAmount, tojson(textOr));
+
+        // Without a limit, the scores spill to disk.
+        setParameter({internalQueryExecTextOrMaxMemoryBytes: 32 * 1024 * 1024});
+        var expected = queries.map(function(query) {
+            return run(query);
+        });
+        setParameter({internalQueryExecTextOrMaxMemoryBytes: 1024});
+        queries.forEach(function(query, i) {
+            assert.eq(expected[i], run(query), tojson(query));
+        });
+        assert(explainTextOr(queries[0]).spilled);
+    } finally {
+        setParameter({internalQueryExecTextOrTopK: true});
+        setParameter({internalQueryExecTextOrMaxMemoryBytes: 32 * 1024 * 1024});
+    }
+})();
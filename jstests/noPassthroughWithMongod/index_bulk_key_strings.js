@@ -0,0 +1,54 @@
+// Test that foreground index builds give the same indexes whether they sort their keys encoded as
+// KeyStrings or as BSON objects.
+(function() {
+    "use strict";
+
+    var t = db.index_bulk_key_strings;
+    t.drop();
+
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        var values = [i % 10, (i % 10) + 0.5, NumberLong(i % 7), "s" + (i % 13), null, [i % 3, 5]];
+        bulk.insert({_id: i, a: values[i % values.length], b: i % 4 == 0 ? i : -i, u: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    var specs = [{a: 1}, {a: -1, b: 1}, {b: 1, a: -1}];
+
+    function scanIndex(spec) {
+        return t.find({}, {_id: 1, a: 1, b: 1}).hint(spec).toArray();
+    }
+
+    function buildIndexes(sortKeyStrings) {
+        assert.commandWorked(
+            db.adminCommand({setParameter: 1, internalIndexBuildSortKeyStrings: sortKeyStrings}));
+        var results = specs.map(function(spec) {
+            assert.commandWorked(t.ensureIndex(spec));
+            var result = scanIndex(spec);
+            assert.commandWorked(t.dropIndex(spec));
+            return result;
+        });
+
+        // Unique indexes.
+        assert.commandWorked(t.ensureIndex({u: 1}, {unique: true}));
+        results.push(t.find({u: {$gte: 500}}, {_id: 1}).hint({u: 1}).toArray());
+        assert.commandWorked(t.dropIndex({u: 1}));
+        // Duplicate keys.
+        assert.commandFailedWithCode(t.ensureIndex({a: 1}, {unique: true}), 11000);
+
+        return results;
+    }
+
+    try {
+        var expected = buildIndexes(false);
+        var actual = buildIndexes(true);
+        for (var i = 0; i < expected.length; i++) {
+            assert.eq(expected[i], actual[i], "index " + i);
+            // Make sure the types of the keys match as well.
+            assert.eq(tojson(expected[i]), tojson(actual[i]), "index " + i);
+        }
+    } finally {
+        assert.commandWorked(
+            db.adminCommand({setParameter: 1, internalIndexBuildSortKeyStrings: true}));
+    }
+})();
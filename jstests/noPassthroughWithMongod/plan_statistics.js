@@ -0,0 +1,73 @@
+// Test that once a collection is analyzed, the planner skips the candidate plans its statistics
+// say are much more costly than the cheapest one, and that the statistics are dropped once the
+// collection changes enough.
+(function() {
+    "use strict";
+
+    var t = db.plan_statistics;
+    t.drop();
+
+    // 'a' is unique, 'b' takes two values.
+    var numDocs = 1000;
+    var bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({a: i, b: i % 2});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(t.ensureIndex({a: 1}));
+    assert.commandWorked(t.ensureIndex({b: 1}));
+
+    function numRejectedPlans(query) {
+        return t.find(query).explain().queryPlanner.rejectedPlans.length;
+    }
+
+    function statisticsMetrics() {
+        return db.serverStatus().metrics.query.statistics;
+    }
+
+    // Without statistics, both indexes are tried.
+    assert.gte(numRejectedPlans({a: 5, b: 1}), 1);
+
+    var res = db.runCommand({analyze: t.getName(), sampleSize: numDocs, buckets: 16});
+    assert.commandWorked(res);
+    assert.eq(numDocs, res.numRecords, tojson(res));
+    assert.eq(numDocs, res.sampled, tojson(res));
+    assert.eq(numDocs, res.indexes.a_1.numKeys, tojson(res));
+    assert.eq([numDocs], res.indexes.a_1.distinctPrefixes, tojson(res));
+    assert.eq([2], res.indexes.b_1.distinctPrefixes, tojson(res));
+    assert.lte(res.indexes.a_1.buckets.length, 16, tojson(res));
+
+    // The index on 'a' is so much more selective that the other plan is not tried.
+    var before = statisticsMetrics();
+    assert.eq(0, numRejectedPlans({a: 5, b: 1}));
+    assert.eq([{a: 5, b: 1}], t.find({a: 5, b: 1}, {_id: 0}).toArray());
+    var after = statisticsMetrics();
+    assert.gte(after.plansPruned - before.plansPruned, 2, tojson(after));
+    assert.gte(after.trialsSkipped - before.trialsSkipped, 2, tojson(after));
+
+    // Plans of similar costs are still tried.
+    assert.gte(numRejectedPlans({a: {$lt: 600}, b: 1}), 1);
+
+    // Sampling fewer documents.
+    res = db.runCommand({analyze: t.getName(), sampleSize: 100});
+    assert.commandWorked(res);
+    assert.eq(100, res.sampled, tojson(res));
+    assert.eq(0, numRejectedPlans({a: 5, b: 1}));
+
+    assert.commandFailed(db.runCommand({analyze: t.getName(), sampleSize: 0}));
+    assert.commandFailed(db.runCommand({analyze: "plan_statistics_missing"}));
+
+    // Enough writes make the statistics stale.
+    bulk = t.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs / 2; i++) {
+        bulk.insert({a: numDocs + i, b: i % 2});
+    }
+    assert.writeOK(bulk.execute());
+    assert.gte(numRejectedPlans({a: 5, b: 1}), 1);
+
+    // So does a new index.
+    assert.commandWorked(db.runCommand({analyze: t.getName()}));
+    assert.eq(0, numRejectedPlans({a: 5, b: 1}));
+    assert.commandWorked(t.ensureIndex({b: 1, a: 1}));
+    assert.gte(numRejectedPlans({a: 5, b: 1}), 2);
+})();
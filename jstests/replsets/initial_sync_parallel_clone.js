@@ -0,0 +1,46 @@
+/* test initial sync cloning several collections at once
+ *
+ * Make sure a member that clones collections in parallel, feeding indexes while it copies,
+ * ends up with the same documents and indexes as the primary.
+ */
+
+(function() {
+    "use strict";
+    var name = "initialSyncParallelClone";
+    var replTest = new ReplSetTest({name: name, nodes: 1});
+    replTest.startSet();
+    replTest.initiate();
+
+    var primary = replTest.getPrimary();
+    var db = primary.getDB("test");
+    for (var c = 0; c < 5; c++) {
+        var coll = db.getCollection("coll" + c);
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 1000; i++) {
+            bulk.insert({_id: i, a: i % 10, b: i});
+        }
+        assert.writeOK(bulk.execute());
+        assert.commandWorked(coll.ensureIndex({a: 1}));
+        assert.commandWorked(coll.ensureIndex({b: 1}, {unique: true}));
+    }
+
+    print("add a member that clones with three threads");
+    var secondary = replTest.add({setParameter: "initialSyncCloneThreads=3"});
+    replTest.reInitiate();
+    replTest.awaitSecondaryNodes();
+    replTest.awaitReplication();
+
+    secondary.setSlaveOk();
+    var secondaryDB = secondary.getDB("test");
+    for (var c = 0; c < 5; c++) {
+        var collName = "coll" + c;
+        assert.eq(1000, secondaryDB.getCollection(collName).count(), collName);
+        var indexes = secondaryDB.getCollection(collName).getIndexes().map(function(spec) {
+            return tojson(spec.key);
+        }).sort();
+        assert.eq(['{ "_id" : 1 }', '{ "a" : 1 }', '{ "b" : 1 }'], indexes, collName);
+        assert.eq(100, secondaryDB.getCollection(collName).find({a: 3}).hint({a: 1}).itcount());
+    }
+
+    replTest.stopSet();
+})();
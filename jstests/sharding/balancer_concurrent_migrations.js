@@ -0,0 +1,72 @@
+//
+// Tests that the balancer issues migrations of different collections between disjoint pairs of
+// shards concurrently, and records round-level migration statistics in the action log.
+//
+
+var st = new ShardingTest({shards: 4,
+                           mongos: 1,
+                           other: {chunksize: 1,
+                                   mongosOptions: {
+                                       setParameter: 'balancerMaxConcurrentMigrations=2'}}});
+
+st.stopBalancer();
+
+var mongos = st.s0;
+var admin = mongos.getDB('admin');
+var config = mongos.getDB('config');
+
+// The limit must be positive.
+assert.commandFailed(admin.runCommand({setParameter: 1, balancerMaxConcurrentMigrations: 0}));
+
+// Two collections whose chunks start out on different shards, so that their migrations can use
+// disjoint donors.
+function setupCollection(dbName, primaryShard) {
+    var coll = mongos.getCollection(dbName + '.foo');
+    assert.commandWorked(admin.runCommand({enableSharding: dbName}));
+    st.ensurePrimaryShard(dbName, primaryShard);
+    assert.commandWorked(admin.runCommand({shardCollection: coll + '', key: {_id: 1}}));
+
+    for (var i = 0; i < 8; i++) {
+        assert.commandWorked(admin.runCommand({split: coll + '', middle: {_id: i}}));
+    }
+}
+
+setupCollection('concurrentA', 'shard0000');
+setupCollection('concurrentB', 'shard0002');
+
+st.startBalancer();
+
+function isBalanced(dbName) {
+    var counts = st.chunkCounts('foo', dbName);
+    printjson(counts);
+    var values = Object.keys(counts).map(function(shard) { return counts[shard]; });
+    return Math.max.apply(null, values) - Math.min.apply(null, values) <= 2;
+}
+
+assert.soon(function() {
+    return isBalanced('concurrentA') && isBalanced('concurrentB');
+}, 'collections were not balanced', 5 * 60 * 1000);
+
+st.stopBalancer();
+
+// Every round which issued migrations records how they went.
+var rounds = config.actionlog.find({what: 'balancer.round',
+                                    'details.migrations': {$exists: true}}).toArray();
+printjson(rounds);
+assert.gt(rounds.length, 0);
+
+rounds.forEach(function(round) {
+    var migrations = round.details.migrations;
+    assert.eq(2, migrations.maxConcurrent, tojson(round));
+    assert.gte(migrations.attempted, 1, tojson(round));
+    assert.eq(migrations.attempted, migrations.succeeded + migrations.failed, tojson(round));
+    assert.gte(migrations.totalTimeMillis, migrations.maxTimeMillis, tojson(round));
+});
+
+// The donor step timings are rolled into the round.
+assert(rounds.some(function(round) {
+    return round.details.migrations.succeeded > 0 &&
+           Object.keys(round.details.migrations.donorStepTimeMillis).length == 6;
+}), tojson(rounds));
+
+st.stop();
@@ -0,0 +1,26 @@
+// Hashed shard keys only support the default (MD5) hash version.
+// @tags : [ hashed ]
+
+var st = new ShardingTest({ shards: 1 });
+st.stopBalancer();
+
+var admin = st.s0.getDB('admin');
+var coll = st.s0.getCollection('test.hashversion');
+
+assert.commandWorked(admin.runCommand({ enableSharding: coll.getDB() + "" }));
+
+// shardCollection refuses a hashed index which uses MurmurHash3.
+assert.commandWorked(coll.ensureIndex({ x: "hashed" }, { hashVersion: 1 }));
+assert.commandFailed(admin.runCommand({ shardCollection: coll + "", key: { x: "hashed" } }));
+assert.commandWorked(coll.dropIndex({ x: "hashed" }));
+
+// An index of another hash version which replaces the shard key index after sharding is not used
+// to split chunks, since chunk ranges are in MD5 hash space.
+assert.commandWorked(admin.runCommand({ shardCollection: coll + "", key: { x: "hashed" } }));
+assert.commandWorked(coll.dropIndex({ x: "hashed" }));
+assert.commandWorked(coll.ensureIndex({ x: "hashed" }, { hashVersion: 1 }));
+assert.commandFailed(st.shard0.getDB('admin').runCommand({ splitVector: coll + "",
+                                                           keyPattern: { x: "hashed" },
+                                                           maxChunkSizeBytes: 1024 * 1024 }));
+
+st.stop();
@@ -0,0 +1,85 @@
+//
+// Tests that a chunk migration stays correct when the donor clones the chunk in small batches
+// and spills the ids of the documents modified during the migration to a temporary collection.
+//
+
+var st = new ShardingTest({shards: 2, mongos: 1});
+st.stopBalancer();
+
+var mongos = st.s0;
+var admin = mongos.getDB('admin');
+var coll = mongos.getCollection('test.foo');
+var donor = st.shard0;
+var recipient = st.shard1;
+
+assert.commandWorked(admin.runCommand({enableSharding: 'test'}));
+st.ensurePrimaryShard('test', 'shard0000');
+assert.commandWorked(admin.runCommand({shardCollection: coll + '', key: {_id: 1}}));
+
+var numDocs = 5000;
+var bulk = coll.initializeUnorderedBulkOp();
+for (var i = 0; i < numDocs; i++) {
+    bulk.insert({_id: i, x: i});
+}
+assert.writeOK(bulk.execute());
+
+// Read the chunk a hundred record ids at a time, and spill every modification.
+assert.commandWorked(donor.adminCommand({setParameter: 1,
+                                         internalMigrationCloneBatchSize: 100,
+                                         internalMigrationModsMaxMemoryBytes: 1}));
+
+// Hold the recipient after the initial clone, so that the donor accumulates modifications.
+assert.commandWorked(recipient.adminCommand({configureFailPoint: 'migrateThreadHangAtStep3',
+                                             mode: 'alwaysOn'}));
+
+var awaitMigration = startParallelShell(
+    'assert.commandWorked(db.adminCommand({moveChunk: "test.foo", find: {_id: 0}, ' +
+    'to: "shard0001", _waitForDelete: true}));',
+    mongos.port);
+
+assert.soon(function() {
+    return recipient.getDB('test').foo.count() == numDocs;
+}, 'recipient did not clone the chunk');
+
+bulk = coll.initializeUnorderedBulkOp();
+for (var i = 0; i < 1000; i++) {
+    bulk.find({_id: i}).updateOne({$set: {x: -i}});
+}
+for (var i = 1000; i < 1500; i++) {
+    bulk.find({_id: i}).removeOne();
+}
+for (var i = numDocs; i < numDocs + 500; i++) {
+    bulk.insert({_id: i, x: i});
+}
+// Deleted and then inserted again while the migration is running.
+bulk.find({_id: 1499}).removeOne();
+bulk.insert({_id: 1499, x: 'again'});
+assert.writeOK(bulk.execute());
+
+assert.soon(function() {
+    return donor.getDB('local').migrationMods.count() > 0;
+}, 'donor did not spill the modified documents');
+
+assert.commandWorked(recipient.adminCommand({configureFailPoint: 'migrateThreadHangAtStep3',
+                                             mode: 'off'}));
+awaitMigration();
+
+// The whole collection is now on the recipient, with every modification applied.
+// 499 documents were deleted for good and 500 were inserted.
+assert.eq(0, donor.getDB('test').foo.count());
+assert.eq(numDocs + 1, recipient.getDB('test').foo.count());
+assert.eq(numDocs + 1, coll.find().itcount());
+
+for (var i = 0; i < 1000; i++) {
+    assert.eq(-i, coll.findOne({_id: i}).x);
+}
+assert.eq(0, coll.find({_id: {$gte: 1000, $lt: 1499}}).itcount());
+assert.eq('again', coll.findOne({_id: 1499}).x);
+assert.eq(500, coll.find({_id: {$gte: numDocs}}).itcount());
+
+// The spill collection goes away with the migration.
+assert.eq(0, donor.getDB('local').getCollectionNames().filter(function(name) {
+    return name == 'migrationMods';
+}).length);
+
+st.stop();
@@ -0,0 +1,61 @@
+//
+// Tests that the range deleter removes the ranges of different collections with several workers,
+// deletes in batches, backs off under pressure, and reports all of it in serverStatus.
+//
+
+var st = new ShardingTest({shards: 2,
+                           mongos: 1,
+                           other: {shardOptions: {setParameter: 'rangeDeleterWorkers=3'}}});
+st.stopBalancer();
+
+var mongos = st.s0;
+var admin = mongos.getDB('admin');
+var donor = st.shard0;
+
+assert.commandWorked(admin.runCommand({enableSharding: 'test'}));
+st.ensurePrimaryShard('test', 'shard0000');
+
+var numDocs = 100;
+var collNames = ['foo', 'bar'];
+collNames.forEach(function(collName) {
+    var coll = mongos.getCollection('test.' + collName);
+    assert.commandWorked(admin.runCommand({shardCollection: coll + '', key: {_id: 1}}));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i});
+    }
+    assert.writeOK(bulk.execute());
+});
+
+// Delete ten documents at a time, and consider the server always under pressure, since a cache
+// usage ratio is never negative.
+assert.commandWorked(donor.adminCommand({setParameter: 1,
+                                         internalRemoveRangeBatchSize: 10,
+                                         rangeDeleterMaxCacheUsageRatio: -1}));
+
+var status = donor.adminCommand({serverStatus: 1, rangeDeleter: 1}).rangeDeleter;
+assert.eq(3, status.workers, tojson(status));
+
+collNames.forEach(function(collName) {
+    assert.commandWorked(admin.runCommand({moveChunk: 'test.' + collName,
+                                           find: {_id: 0},
+                                           to: 'shard0001'}));
+});
+
+assert.soon(function() {
+    return donor.getDB('test').foo.count() == 0 && donor.getDB('test').bar.count() == 0;
+}, 'donor did not clean up the migrated ranges');
+
+collNames.forEach(function(collName) {
+    assert.eq(numDocs, mongos.getCollection('test.' + collName).find().itcount());
+});
+
+status = donor.adminCommand({serverStatus: 1, rangeDeleter: 1}).rangeDeleter;
+printjson(status);
+assert.eq(2 * numDocs, status.throttle.deletedDocs, tojson(status));
+assert.gte(status.throttle.batches, 2 * numDocs / 10, tojson(status));
+assert.gt(status.throttle.throttledBatches, 0, tojson(status));
+assert.gt(status.throttle.totalDelayMillis, 0, tojson(status));
+
+st.stop();
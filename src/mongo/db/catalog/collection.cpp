@@ -152,7 +152,7 @@ Collection::Collection(OperationContext* txn,
       _indexCatalog(this),
       _validatorDoc(_details->getCollectionOptions(txn).validator.getOwned()),
       _validator(uassertStatusOK(parseValidator(_validatorDoc))),
-      _cursorManager(fullNS),
+      _cursorManager(fullNS, CursorManager::numCollectionPartitions()),
       _cappedNotifier(_recordStore->isCapped() ? new CappedInsertNotifier() : nullptr),
       _mustTakeCappedLockOnInsert(isCapped() && !_ns.isSystemDotProfile() && !_ns.isOplog()) {
     _magic = 1357924;
@@ -325,6 +325,77 @@ StatusWith<RecordId> Collection::insertDocument(OperationContext* txn,
     return res;
 }
 
+Status Collection::insertDocuments(OperationContext* txn,
+                                   std::vector<BSONObj>::const_iterator begin,
+                                   std::vector<BSONObj>::const_iterator end,
+                                   bool enforceQuota,
+                                   bool fromMigrate) {
+    invariant(txn->lockState()->inAWriteUnitOfWork());
+
+    const bool hasIdIndex = _indexCatalog.findIdIndex(txn);
+    for (auto it = begin; it != end; it++) {
+        auto status = checkValidation(txn, *it);
+        if (!status.isOK())
+            return status;
+
+        if (hasIdIndex && (*it)["_id"].eoo()) {
+            return Status(ErrorCodes::InternalError,
+                          str::stream() << "Collection::insertDocuments got "
+                                           "document without _id for ns:" << _ns.ns());
+        }
+    }
+
+    const SnapshotId sid = txn->recoveryUnit()->getSnapshotId();
+
+    if (_mustTakeCappedLockOnInsert)
+        synchronizeOnCappedInFlightResource(txn->lockState());
+
+    if (isCapped()) {
+        // Capped deletes triggered by an insert must see every earlier document indexed, so
+        // capped collections insert and index one document at a time.
+        for (auto it = begin; it != end; it++) {
+            StatusWith<RecordId> res = _insertDocument(txn, *it, enforceQuota);
+            if (!res.isOK())
+                return res.getStatus();
+            invariant(sid == txn->recoveryUnit()->getSnapshotId());
+        }
+    } else {
+        std::vector<Record> records;
+        records.reserve(std::distance(begin, end));
+        for (auto it = begin; it != end; it++) {
+            records.push_back(Record{RecordId(), RecordData(it->objdata(), it->objsize())});
+        }
+
+        Status status = _recordStore->insertRecords(txn, &records, _enforceQuota(enforceQuota));
+        if (!status.isOK())
+            return status;
+        invariant(sid == txn->recoveryUnit()->getSnapshotId());
+
+        _infoCache.notifyOfWriteOp(records.size());
+
+        auto it = begin;
+        for (const auto& record : records) {
+            invariant(RecordId::min() < record.id);
+            invariant(record.id < RecordId::max());
+
+            status = _indexCatalog.indexRecord(txn, *it, record.id);
+            if (!status.isOK())
+                return status;
+            it++;
+        }
+    }
+
+    // Reserve the oplog entries of the whole batch at once.
+    getGlobalServiceContext()->getOpObserver()->onInserts(txn, ns(), begin, end, fromMigrate);
+
+    // Notify waiters once for the whole group rather than once per document.
+    if (_cappedNotifier && !_cappedNotifier.unique()) {
+        _cappedNotifier->notifyOfInsert();
+    }
+
+    return Status::OK();
+}
+
 StatusWith<RecordId> Collection::insertDocument(OperationContext* txn,
                                                 const BSONObj& doc,
                                                 MultiIndexBlock* indexBlock,
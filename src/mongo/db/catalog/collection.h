@@ -33,6 +33,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/base/status_with.h"
@@ -228,6 +229,20 @@ public:
                                         bool enforceQuota,
                                         bool fromMigrate = false);
 
+    /**
+     * Inserts all documents in the range [begin, end) as part of the caller's WriteUnitOfWork.
+     * Each document is validated, indexed and logged to the oplog as if inserted by
+     * insertDocument, but callers get to amortize the unit of work commit over the whole group.
+     *
+     * Returns the first error encountered. The caller is then responsible for rolling back the
+     * enclosing WriteUnitOfWork, since some of the documents may already have been written.
+     */
+    Status insertDocuments(OperationContext* txn,
+                           std::vector<BSONObj>::const_iterator begin,
+                           std::vector<BSONObj>::const_iterator end,
+                           bool enforceQuota,
+                           bool fromMigrate = false);
+
     /**
      * Callers must ensure no document validation is performed for this collection when calling
      * this method.
@@ -41,6 +41,7 @@
 #include "mongo/db/index_legacy.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/planner_ixselect.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
 
@@ -55,6 +56,7 @@ CollectionInfoCache::CollectionInfoCache(Collection* collection)
 void CollectionInfoCache::reset(OperationContext* txn) {
     LOG(1) << _collection->ns().ns() << ": clearing plan cache - collection info cache reset";
     clearQueryCache();
+    setStatistics(std::shared_ptr<const CollectionStatistics>());
     _keysComputed = false;
     computeIndexKeys(txn);
     updatePlanCacheIndexEntries(txn);
@@ -123,10 +125,11 @@ void CollectionInfoCache::computeIndexKeys(OperationContext* txn) {
     _keysComputed = true;
 }
 
-void CollectionInfoCache::notifyOfWriteOp() {
+void CollectionInfoCache::notifyOfWriteOp(size_t numDocs) {
     if (NULL != _planCache.get()) {
         _planCache->notifyOfWriteOp();
     }
+    _writesSinceAnalyze.fetchAndAdd(numDocs);
 }
 
 void CollectionInfoCache::clearQueryCache() {
@@ -143,6 +146,23 @@ QuerySettings* CollectionInfoCache::getQuerySettings() const {
     return _querySettings.get();
 }
 
+std::shared_ptr<const CollectionStatistics> CollectionInfoCache::getStatistics() {
+    stdx::lock_guard<stdx::mutex> lk(_statsMutex);
+    if (_stats && static_cast<double>(_writesSinceAnalyze.load()) >
+            internalQueryStatisticsStaleWriteRatio * _stats->numRecords()) {
+        LOG(1) << _collection->ns().ns() << ": dropping statistics, "
+               << _writesSinceAnalyze.load() << " writes since the collection was analyzed";
+        _stats.reset();
+    }
+    return _stats;
+}
+
+void CollectionInfoCache::setStatistics(std::shared_ptr<const CollectionStatistics> stats) {
+    stdx::lock_guard<stdx::mutex> lk(_statsMutex);
+    _stats = std::move(stats);
+    _writesSinceAnalyze.store(0);
+}
+
 void CollectionInfoCache::updatePlanCacheIndexEntries(OperationContext* txn) {
     std::vector<IndexEntry> indexEntries;
 
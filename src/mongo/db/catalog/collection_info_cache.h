@@ -30,10 +30,14 @@
 
 #pragma once
 
+#include <memory>
 
+#include "mongo/db/query/index_statistics.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/update_index_data.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
 
 namespace mongo {
 
@@ -66,6 +70,17 @@ public:
      */
     QuerySettings* getQuerySettings() const;
 
+    /**
+     * Get the statistics computed by the last analyze of this collection, or NULL if it was
+     * never analyzed, or if it changed too much since.
+     */
+    std::shared_ptr<const CollectionStatistics> getStatistics();
+
+    /**
+     * Replaces the statistics of this collection.
+     */
+    void setStatistics(std::shared_ptr<const CollectionStatistics> stats);
+
     // -------------------
 
     /* get set of index keys for this namespace.  handy to quickly check if a given
@@ -84,8 +99,9 @@ public:
 
     void clearQueryCache();
 
-    /* you must notify the cache if you are doing writes, as query plan utility will change */
-    void notifyOfWriteOp();
+    /* you must notify the cache if you are doing writes, as query plan utility will change.
+       'numDocs' is how many documents the write op changed. */
+    void notifyOfWriteOp(size_t numDocs = 1);
 
 private:
     Collection* _collection;  // not owned
@@ -101,6 +117,12 @@ private:
     // Includes index filters.
     std::unique_ptr<QuerySettings> _querySettings;
 
+    // Statistics used to estimate the cost of query plans. Dropped when the indexes change, or
+    // once enough documents were written since they were computed.
+    stdx::mutex _statsMutex;
+    std::shared_ptr<const CollectionStatistics> _stats;
+    AtomicUInt64 _writesSinceAnalyze;
+
     /**
      * Must be called under exclusive DB lock.
      */
@@ -114,12 +114,29 @@ public:
     int64_t nextSeed();
 
 private:
-    SimpleMutex _mutex;
+    static const size_t kNumPartitions = 16;
 
     typedef unordered_map<unsigned, string> Map;
-    Map _idToNS;
-    unsigned _nextId;
 
+    // The namespaces of the CursorManagers, partitioned by id so that killCursors and the
+    // creation of CursorManagers for different collections do not share a lock.
+    struct Partition {
+        SimpleMutex mutex;
+        Map idToNS;
+
+        // Threads using different partitions must not contend on a shared cache line.
+        char padding[64];
+    };
+
+    Partition& _partitionFor(unsigned id) {
+        return _partitions[id % kNumPartitions];
+    }
+
+    Partition _partitions[kNumPartitions];
+    AtomicUInt32 _nextId;
+    AtomicUInt32 _numIds;
+
+    SimpleMutex _randomMutex;
     std::unique_ptr<SecureRandom> _secureRandom;
 };
 
@@ -135,16 +152,16 @@ MONGO_INITIALIZER(GlobalCursorIdCache)(InitializerContext* context) {
 
 MONGO_INITIALIZER_WITH_PREREQUISITES(GlobalCursorManager, ("GlobalCursorIdCache"))
 (InitializerContext* context) {
-    globalCursorManager.reset(new CursorManager(""));
+    globalCursorManager.reset(new CursorManager("", CursorManager::kMaxPartitions));
     return Status::OK();
 }
 
-GlobalCursorIdCache::GlobalCursorIdCache() : _nextId(0), _secureRandom() {}
+GlobalCursorIdCache::GlobalCursorIdCache() : _secureRandom() {}
 
 GlobalCursorIdCache::~GlobalCursorIdCache() {}
 
 int64_t GlobalCursorIdCache::nextSeed() {
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
+    stdx::lock_guard<SimpleMutex> lk(_randomMutex);
     if (!_secureRandom)
         _secureRandom.reset(SecureRandom::create());
     return _secureRandom->nextInt64();
@@ -153,17 +170,17 @@ int64_t GlobalCursorIdCache::nextSeed() {
 unsigned GlobalCursorIdCache::created(const std::string& ns) {
     static const unsigned MAX_IDS = 1000 * 1000 * 1000;
 
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
-
-    fassert(17359, _idToNS.size() < MAX_IDS);
+    fassert(17359, _numIds.addAndFetch(1) <= MAX_IDS);
 
     for (unsigned i = 0; i <= MAX_IDS; i++) {
-        unsigned id = ++_nextId;
+        unsigned id = _nextId.addAndFetch(1);
         if (id == 0)
             continue;
-        if (_idToNS.count(id) > 0)
+        Partition& partition = _partitionFor(id);
+        stdx::lock_guard<SimpleMutex> lk(partition.mutex);
+        if (partition.idToNS.count(id) > 0)
             continue;
-        _idToNS[id] = ns;
+        partition.idToNS[id] = ns;
         return id;
     }
 
@@ -171,9 +188,11 @@ unsigned GlobalCursorIdCache::created(const std::string& ns) {
 }
 
 void GlobalCursorIdCache::destroyed(unsigned id, const std::string& ns) {
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
-    invariant(ns == _idToNS[id]);
-    _idToNS.erase(id);
+    Partition& partition = _partitionFor(id);
+    stdx::lock_guard<SimpleMutex> lk(partition.mutex);
+    invariant(ns == partition.idToNS[id]);
+    partition.idToNS.erase(id);
+    _numIds.subtractAndFetch(1);
 }
 
 bool GlobalCursorIdCache::eraseCursor(OperationContext* txn, CursorId id, bool checkAuth) {
@@ -188,10 +207,11 @@ bool GlobalCursorIdCache::eraseCursor(OperationContext* txn, CursorId id, bool c
         }
         ns = pin.c()->ns();
     } else {
-        stdx::lock_guard<SimpleMutex> lk(_mutex);
         unsigned nsid = idFromCursorId(id);
-        Map::const_iterator it = _idToNS.find(nsid);
-        if (it == _idToNS.end()) {
+        Partition& partition = _partitionFor(nsid);
+        stdx::lock_guard<SimpleMutex> lk(partition.mutex);
+        Map::const_iterator it = partition.idToNS.find(nsid);
+        if (it == partition.idToNS.end()) {
             // No namespace corresponding to this cursor id prefix.  TODO: Consider writing to
             // audit log here (even though we don't have a namespace).
             return false;
@@ -247,9 +267,11 @@ std::size_t GlobalCursorIdCache::timeoutCursors(OperationContext* txn, int milli
 
     // Compute the set of collection names that we have to time out cursors for.
     vector<string> todo;
-    {
-        stdx::lock_guard<SimpleMutex> lk(_mutex);
-        for (Map::const_iterator i = _idToNS.begin(); i != _idToNS.end(); ++i) {
+    for (size_t p = 0; p < kNumPartitions; p++) {
+        stdx::lock_guard<SimpleMutex> lk(_partitions[p].mutex);
+        for (Map::const_iterator i = _partitions[p].idToNS.begin();
+             i != _partitions[p].idToNS.end();
+             ++i) {
             if (globalCursorManager->ownsCursorId(cursorIdFromParts(i->first, 0))) {
                 // Skip the global cursor manager, since we handle it above (and it's not
                 // associated with a collection).
@@ -312,9 +334,22 @@ bool CursorManager::eraseCursorGlobal(OperationContext* txn, CursorId id) {
 // --------------------------
 
 
-CursorManager::CursorManager(StringData ns) : _nss(ns) {
+CursorManager::CursorManager(StringData ns, size_t numPartitions)
+    : _nss(ns), _numPartitions(numPartitions), _partitions(new Partition[numPartitions]) {
+    // Cursor ids carry their partition in their low bits, see _allocateCursorId_inlock.
+    invariant(_numPartitions > 0 && (_numPartitions & (_numPartitions - 1)) == 0);
+    invariant(_numPartitions <= kMaxPartitions);
+
     _collectionCacheRuntimeId = globalCursorIdCache->created(_nss.ns());
-    _random.reset(new PseudoRandom(globalCursorIdCache->nextSeed()));
+    PseudoRandom seeds(globalCursorIdCache->nextSeed());
+    for (size_t i = 0; i < _numPartitions; i++) {
+        _partitions[i].random.reset(new PseudoRandom(seeds.nextInt64()));
+    }
+}
+
+// static
+size_t CursorManager::numCollectionPartitions() {
+    return supportsDocLocking() ? kMaxPartitions : 1;
 }
 
 CursorManager::~CursorManager() {
@@ -322,67 +357,90 @@ CursorManager::~CursorManager() {
     globalCursorIdCache->destroyed(_collectionCacheRuntimeId, _nss.ns());
 }
 
-void CursorManager::invalidateAll(bool collectionGoingAway, const std::string& reason) {
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
-
-    for (ExecSet::iterator it = _nonCachedExecutors.begin(); it != _nonCachedExecutors.end();
-         ++it) {
-        // we kill the executor, but it deletes itself
-        PlanExecutor* exec = *it;
-        exec->kill(reason);
-        invariant(exec->collection() == NULL);
-    }
-    _nonCachedExecutors.clear();
-
-    if (collectionGoingAway) {
-        // we're going to wipe out the world
-        for (CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
-            ClientCursor* cc = i->second;
+CursorManager::Partition& CursorManager::_partitionForCursor(CursorId id) {
+    return _partitions[static_cast<uint32_t>(id) % _numPartitions];
+}
 
-            cc->kill();
+const CursorManager::Partition& CursorManager::_partitionForCursor(CursorId id) const {
+    return _partitions[static_cast<uint32_t>(id) % _numPartitions];
+}
 
-            invariant(cc->getExecutor() == NULL || cc->getExecutor()->collection() == NULL);
+CursorManager::Partition& CursorManager::_partitionForExecutor(PlanExecutor* exec) {
+    // Executors are heap allocated, so the low bits of their addresses carry no information.
+    const uint64_t address = reinterpret_cast<uintptr_t>(exec);
+    return _partitions[(address >> 6) % _numPartitions];
+}
 
-            // If the CC is pinned, somebody is actively using it and we do not delete it.
-            // Instead we notify the holder that we killed it.  The holder will then delete the
-            // CC.
-            //
-            // If the CC is not pinned, there is nobody actively holding it.  We can safely
-            // delete it.
-            if (!cc->isPinned()) {
-                delete cc;
-            }
+void CursorManager::invalidateAll(bool collectionGoingAway, const std::string& reason) {
+    for (size_t p = 0; p < _numPartitions; p++) {
+        Partition& partition = _partitions[p];
+        stdx::lock_guard<SimpleMutex> lk(partition.mutex);
+
+        for (ExecSet::iterator it = partition.nonCachedExecutors.begin();
+             it != partition.nonCachedExecutors.end();
+             ++it) {
+            // we kill the executor, but it deletes itself
+            PlanExecutor* exec = *it;
+            exec->kill(reason);
+            invariant(exec->collection() == NULL);
         }
-    } else {
-        CursorMap newMap;
-
-        // collection will still be around, just all PlanExecutors are invalid
-        for (CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
-            ClientCursor* cc = i->second;
+        partition.nonCachedExecutors.clear();
 
-            // Note that a valid ClientCursor state is "no cursor no executor."  This is because
-            // the set of active cursor IDs in ClientCursor is used as representation of query
-            // state.  See sharding_block.h.  TODO(greg,hk): Move this out.
-            if (NULL == cc->getExecutor()) {
-                newMap.insert(*i);
-                continue;
-            }
+        if (collectionGoingAway) {
+            // we're going to wipe out the world
+            for (CursorMap::const_iterator i = partition.cursors.begin();
+                 i != partition.cursors.end();
+                 ++i) {
+                ClientCursor* cc = i->second;
 
-            if (cc->isPinned() || cc->isAggCursor()) {
-                // Pinned cursors need to stay alive, so we leave them around.  Aggregation
-                // cursors also can stay alive (since they don't have their lifetime bound to
-                // the underlying collection).  However, if they have an associated executor, we
-                // need to kill it, because it's now invalid.
-                if (cc->getExecutor())
-                    cc->getExecutor()->kill(reason);
-                newMap.insert(*i);
-            } else {
                 cc->kill();
-                delete cc;
+
+                invariant(cc->getExecutor() == NULL || cc->getExecutor()->collection() == NULL);
+
+                // If the CC is pinned, somebody is actively using it and we do not delete it.
+                // Instead we notify the holder that we killed it.  The holder will then delete
+                // the CC.
+                //
+                // If the CC is not pinned, there is nobody actively holding it.  We can safely
+                // delete it.
+                if (!cc->isPinned()) {
+                    delete cc;
+                }
+            }
+        } else {
+            CursorMap newMap;
+
+            // collection will still be around, just all PlanExecutors are invalid
+            for (CursorMap::const_iterator i = partition.cursors.begin();
+                 i != partition.cursors.end();
+                 ++i) {
+                ClientCursor* cc = i->second;
+
+                // Note that a valid ClientCursor state is "no cursor no executor."  This is
+                // because the set of active cursor IDs in ClientCursor is used as
+                // representation of query state.  See sharding_block.h.  TODO(greg,hk): Move
+                // this out.
+                if (NULL == cc->getExecutor()) {
+                    newMap.insert(*i);
+                    continue;
+                }
+
+                if (cc->isPinned() || cc->isAggCursor()) {
+                    // Pinned cursors need to stay alive, so we leave them around.  Aggregation
+                    // cursors also can stay alive (since they don't have their lifetime bound to
+                    // the underlying collection).  However, if they have an associated executor,
+                    // we need to kill it, because it's now invalid.
+                    if (cc->getExecutor())
+                        cc->getExecutor()->kill(reason);
+                    newMap.insert(*i);
+                } else {
+                    cc->kill();
+                    delete cc;
+                }
             }
-        }
 
-        _cursors = newMap;
+            partition.cursors = newMap;
+        }
     }
 }
 
@@ -395,58 +453,77 @@ void CursorManager::invalidateDocument(OperationContext* txn,
         return;
     }
 
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
-
-    for (ExecSet::iterator it = _nonCachedExecutors.begin(); it != _nonCachedExecutors.end();
-         ++it) {
-        PlanExecutor* exec = *it;
-        exec->invalidate(txn, dl, type);
-    }
+    for (size_t p = 0; p < _numPartitions; p++) {
+        Partition& partition = _partitions[p];
+        stdx::lock_guard<SimpleMutex> lk(partition.mutex);
 
-    for (CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
-        PlanExecutor* exec = i->second->getExecutor();
-        if (exec) {
+        for (ExecSet::iterator it = partition.nonCachedExecutors.begin();
+             it != partition.nonCachedExecutors.end();
+             ++it) {
+            PlanExecutor* exec = *it;
             exec->invalidate(txn, dl, type);
         }
+
+        for (CursorMap::const_iterator i = partition.cursors.begin();
+             i != partition.cursors.end();
+             ++i) {
+            PlanExecutor* exec = i->second->getExecutor();
+            if (exec) {
+                exec->invalidate(txn, dl, type);
+            }
+        }
     }
 }
 
 std::size_t CursorManager::timeoutCursors(int millisSinceLastCall) {
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
+    size_t numTimedOut = 0;
 
-    vector<ClientCursor*> toDelete;
+    for (size_t p = 0; p < _numPartitions; p++) {
+        Partition& partition = _partitions[p];
+        stdx::lock_guard<SimpleMutex> lk(partition.mutex);
 
-    for (CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
-        ClientCursor* cc = i->second;
-        if (cc->shouldTimeout(millisSinceLastCall))
-            toDelete.push_back(cc);
-    }
+        vector<ClientCursor*> toDelete;
+
+        for (CursorMap::const_iterator i = partition.cursors.begin();
+             i != partition.cursors.end();
+             ++i) {
+            ClientCursor* cc = i->second;
+            if (cc->shouldTimeout(millisSinceLastCall))
+                toDelete.push_back(cc);
+        }
 
-    for (vector<ClientCursor*>::const_iterator i = toDelete.begin(); i != toDelete.end(); ++i) {
-        ClientCursor* cc = *i;
-        _deregisterCursor_inlock(cc);
-        cc->kill();
-        delete cc;
+        for (vector<ClientCursor*>::const_iterator i = toDelete.begin(); i != toDelete.end();
+             ++i) {
+            ClientCursor* cc = *i;
+            _deregisterCursor_inlock(&partition, cc);
+            cc->kill();
+            delete cc;
+        }
+
+        numTimedOut += toDelete.size();
     }
 
-    return toDelete.size();
+    return numTimedOut;
 }
 
 void CursorManager::registerExecutor(PlanExecutor* exec) {
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
-    const std::pair<ExecSet::iterator, bool> result = _nonCachedExecutors.insert(exec);
+    Partition& partition = _partitionForExecutor(exec);
+    stdx::lock_guard<SimpleMutex> lk(partition.mutex);
+    const std::pair<ExecSet::iterator, bool> result = partition.nonCachedExecutors.insert(exec);
     invariant(result.second);  // make sure this was inserted
 }
 
 void CursorManager::deregisterExecutor(PlanExecutor* exec) {
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
-    _nonCachedExecutors.erase(exec);
+    Partition& partition = _partitionForExecutor(exec);
+    stdx::lock_guard<SimpleMutex> lk(partition.mutex);
+    partition.nonCachedExecutors.erase(exec);
 }
 
 ClientCursor* CursorManager::find(CursorId id, bool pin) {
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
-    CursorMap::const_iterator it = _cursors.find(id);
-    if (it == _cursors.end())
+    Partition& partition = _partitionForCursor(id);
+    stdx::lock_guard<SimpleMutex> lk(partition.mutex);
+    CursorMap::const_iterator it = partition.cursors.find(id);
+    if (it == partition.cursors.end())
         return NULL;
 
     ClientCursor* cursor = it->second;
@@ -459,7 +536,8 @@ ClientCursor* CursorManager::find(CursorId id, bool pin) {
 }
 
 void CursorManager::unpin(ClientCursor* cursor) {
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
+    Partition& partition = _partitionForCursor(cursor->cursorid());
+    stdx::lock_guard<SimpleMutex> lk(partition.mutex);
 
     invariant(cursor->isPinned());
     cursor->unsetPinned();
@@ -470,24 +548,36 @@ bool CursorManager::ownsCursorId(CursorId cursorId) const {
 }
 
 void CursorManager::getCursorIds(std::set<CursorId>* openCursors) const {
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
+    for (size_t p = 0; p < _numPartitions; p++) {
+        const Partition& partition = _partitions[p];
+        stdx::lock_guard<SimpleMutex> lk(partition.mutex);
 
-    for (CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
-        ClientCursor* cc = i->second;
-        openCursors->insert(cc->cursorid());
+        for (CursorMap::const_iterator i = partition.cursors.begin();
+             i != partition.cursors.end();
+             ++i) {
+            ClientCursor* cc = i->second;
+            openCursors->insert(cc->cursorid());
+        }
     }
 }
 
 size_t CursorManager::numCursors() const {
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
-    return _cursors.size();
+    size_t numCursors = 0;
+    for (size_t p = 0; p < _numPartitions; p++) {
+        stdx::lock_guard<SimpleMutex> lk(_partitions[p].mutex);
+        numCursors += _partitions[p].cursors.size();
+    }
+    return numCursors;
 }
 
-CursorId CursorManager::_allocateCursorId_inlock() {
+CursorId CursorManager::_allocateCursorId_inlock(size_t partitionIndex) {
+    Partition& partition = _partitions[partitionIndex];
     for (int i = 0; i < 10000; i++) {
-        unsigned mypart = static_cast<unsigned>(_random->nextInt32());
+        // The low bits of the id name its partition.
+        unsigned mypart = static_cast<unsigned>(partition.random->nextInt32());
+        mypart = mypart - (mypart % _numPartitions) + partitionIndex;
         CursorId id = cursorIdFromParts(_collectionCacheRuntimeId, mypart);
-        if (_cursors.count(id) == 0)
+        if (partition.cursors.count(id) == 0)
             return id;
     }
     fassertFailed(17360);
@@ -495,22 +585,27 @@ CursorId CursorManager::_allocateCursorId_inlock() {
 
 CursorId CursorManager::registerCursor(ClientCursor* cc) {
     invariant(cc);
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
-    CursorId id = _allocateCursorId_inlock();
-    _cursors[id] = cc;
+    const size_t partitionIndex =
+        _numPartitions == 1 ? 0 : _nextCursorPartition.fetchAndAdd(1) % _numPartitions;
+    Partition& partition = _partitions[partitionIndex];
+    stdx::lock_guard<SimpleMutex> lk(partition.mutex);
+    CursorId id = _allocateCursorId_inlock(partitionIndex);
+    partition.cursors[id] = cc;
     return id;
 }
 
 void CursorManager::deregisterCursor(ClientCursor* cc) {
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
-    _deregisterCursor_inlock(cc);
+    Partition& partition = _partitionForCursor(cc->cursorid());
+    stdx::lock_guard<SimpleMutex> lk(partition.mutex);
+    _deregisterCursor_inlock(&partition, cc);
 }
 
 Status CursorManager::eraseCursor(OperationContext* txn, CursorId id, bool shouldAudit) {
-    stdx::lock_guard<SimpleMutex> lk(_mutex);
+    Partition& partition = _partitionForCursor(id);
+    stdx::lock_guard<SimpleMutex> lk(partition.mutex);
 
-    CursorMap::iterator it = _cursors.find(id);
-    if (it == _cursors.end()) {
+    CursorMap::iterator it = partition.cursors.find(id);
+    if (it == partition.cursors.end()) {
         if (shouldAudit) {
             audit::logKillCursorsAuthzCheck(txn->getClient(), _nss, id, ErrorCodes::CursorNotFound);
         }
@@ -532,14 +627,14 @@ Status CursorManager::eraseCursor(OperationContext* txn, CursorId id, bool shoul
     }
 
     cursor->kill();
-    _deregisterCursor_inlock(cursor);
+    _deregisterCursor_inlock(&partition, cursor);
     delete cursor;
     return Status::OK();
 }
 
-void CursorManager::_deregisterCursor_inlock(ClientCursor* cc) {
+void CursorManager::_deregisterCursor_inlock(Partition* partition, ClientCursor* cc) {
     invariant(cc);
     CursorId id = cc->cursorid();
-    _cursors.erase(id);
+    partition->cursors.erase(id);
 }
 }
@@ -35,6 +35,8 @@
 #include "mongo/db/invalidation_type.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/unordered_map.h"
 #include "mongo/platform/unordered_set.h"
 #include "mongo/util/concurrency/mutex.h"
 
@@ -44,9 +46,33 @@ class OperationContext;
 class PseudoRandom;
 class PlanExecutor;
 
+/**
+ * Registry of the cursors and yielding executors of one collection.
+ *
+ * The registry may be split into partitions, each with its own mutex. A cursor lives in the
+ * partition named by the low bits of its id and an executor in the partition its address hashes
+ * to, so lookups by getMore and registrations by concurrent queries rarely share a lock.
+ * Operations over every cursor, such as document invalidations, visit the partitions one at a
+ * time.
+ */
 class CursorManager {
 public:
-    CursorManager(StringData ns);
+    // Number of partitions of the global cursor manager, which serves every collection, and of
+    // the managers of collections on storage engines with document-level locking.
+    static const size_t kMaxPartitions = 16;
+
+    /**
+     * 'numPartitions' must be a power of two no larger than kMaxPartitions.
+     */
+    CursorManager(StringData ns, size_t numPartitions = 1);
+
+    /**
+     * Number of partitions for the manager of a collection. Storage engines with document-level
+     * locking run many operations on one collection at once and never invalidate documents, so
+     * their collections get kMaxPartitions. On MMAPv1 every update and delete invalidates the
+     * collection's executors partition by partition, so its collections keep a single one.
+     */
+    static size_t numCollectionPartitions();
 
     /**
      * will kill() all PlanExecutor instances it has
@@ -143,19 +169,33 @@ public:
     static std::size_t timeoutCursorsGlobal(OperationContext* txn, int millisSinceLastCall);
 
 private:
-    CursorId _allocateCursorId_inlock();
-    void _deregisterCursor_inlock(ClientCursor* cc);
+    typedef unordered_set<PlanExecutor*> ExecSet;
+    typedef unordered_map<CursorId, ClientCursor*> CursorMap;
+
+    struct Partition {
+        mutable SimpleMutex mutex;
+        ExecSet nonCachedExecutors;
+        CursorMap cursors;
+        std::unique_ptr<PseudoRandom> random;  // generates the ids of this partition's cursors
+
+        // Threads using different partitions must not contend on a shared cache line.
+        char padding[64];
+    };
+
+    Partition& _partitionForCursor(CursorId id);
+    const Partition& _partitionForCursor(CursorId id) const;
+    Partition& _partitionForExecutor(PlanExecutor* exec);
+
+    CursorId _allocateCursorId_inlock(size_t partitionIndex);
+    void _deregisterCursor_inlock(Partition* partition, ClientCursor* cc);
 
     NamespaceString _nss;
     unsigned _collectionCacheRuntimeId;
-    std::unique_ptr<PseudoRandom> _random;
-
-    mutable SimpleMutex _mutex;
 
-    typedef unordered_set<PlanExecutor*> ExecSet;
-    ExecSet _nonCachedExecutors;
+    // Spreads newly registered cursors over the partitions.
+    AtomicUInt32 _nextCursorPartition;
 
-    typedef std::map<CursorId, ClientCursor*> CursorMap;
-    CursorMap _cursors;
+    const size_t _numPartitions;
+    std::unique_ptr<Partition[]> _partitions;
 };
 }
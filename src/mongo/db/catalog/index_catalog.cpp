@@ -47,6 +47,7 @@
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/field_ref.h"
+#include "mongo/db/hasher.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
@@ -994,6 +995,13 @@ IndexDescriptor* IndexCatalog::findShardKeyPrefixedIndex(OperationContext* txn,
         if (!shardKey.isPrefixOf(desc->keyPattern()))
             continue;
 
+        // Chunk ranges of hashed shard keys are in MD5 hash space. An index hashing with another
+        // function orders the documents differently, so it cannot serve splits, migrations or
+        // range deletions, even if it replaced the original shard key index.
+        if (desc->getAccessMethodName() == IndexNames::HASHED &&
+            desc->infoObj()["hashVersion"].numberInt() != BSONElementHasher::MD5_HASH_VERSION)
+            continue;
+
         if (!desc->isMultikey(txn))
             return desc;
 
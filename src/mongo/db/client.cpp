@@ -89,6 +89,23 @@ void Client::initThread(const char* desc, ServiceContext* service, AbstractMessa
     *currentClient.get() = service->makeClient(fullDesc, mp);
 }
 
+ServiceContext::UniqueClient Client::releaseCurrent() {
+    invariant(haveClient());
+    return std::move(*currentClient.getMake());
+}
+
+void Client::setCurrent(ServiceContext::UniqueClient client) {
+    invariant(!haveClient());
+    invariant(client);
+
+    {
+        stdx::lock_guard<Client> lk(*client);
+        client->_threadId = stdx::this_thread::get_id();
+    }
+    setThreadName(client->desc().c_str());
+    *currentClient.getMake() = std::move(client);
+}
+
 namespace {
 int64_t generateSeed(const std::string& desc) {
     size_t seed = 0;
@@ -75,6 +75,19 @@ public:
      */
     static void initThreadIfNotAlready();
 
+    /**
+     * Moves the Client of the current thread out of thread-local storage and returns it, leaving
+     * the thread without a Client. Used by network servers which multiplex many connections over
+     * a pool of threads, between two messages of the same connection.
+     */
+    static ServiceContext::UniqueClient releaseCurrent();
+
+    /**
+     * Makes "client" the Client of the current thread, which must not already have one. This is
+     * the reverse of releaseCurrent().
+     */
+    static void setCurrent(ServiceContext::UniqueClient client);
+
     std::string clientAddress(bool includePort = false) const;
     const std::string& desc() const {
         return _desc;
@@ -150,8 +163,9 @@ private:
     // Description for the client (e.g. conn8)
     const std::string _desc;
 
-    // OS id of the thread, which owns this client
-    const stdx::thread::id _threadId;
+    // OS id of the thread, which owns this client. Only changes under _lock, when the client is
+    // moved to another thread with setCurrent().
+    stdx::thread::id _threadId;
 
     // > 0 for things "conn", 0 otherwise
     const ConnectionId _connectionId;
@@ -44,7 +44,9 @@
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/copydb.h"
 #include "mongo/db/commands/rename_collection.h"
@@ -52,14 +54,19 @@
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index_builder.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/op_observer.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/ops/insert.h"
 #include "mongo/db/repl/isself.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -111,6 +118,26 @@ BSONObj fixindex(const string& newDbName, BSONObj o) {
     return res;
 }
 
+namespace {
+/**
+ * Opens a connection to 'cs' and authenticates it as the internal user if auth is enabled.
+ */
+Status connectToSource(const ConnectionString& cs, unique_ptr<DBClientBase>* connOut) {
+    std::string errmsg;
+    unique_ptr<DBClientBase> con(cs.connect(errmsg));
+    if (!con.get()) {
+        return Status(ErrorCodes::HostUnreachable, errmsg);
+    }
+
+    if (getGlobalAuthorizationManager()->isAuthEnabled() && !authenticateInternalUser(con.get())) {
+        return Status(ErrorCodes::AuthenticationFailed, "Unable to authenticate as internal user");
+    }
+
+    *connOut = std::move(con);
+    return Status::OK();
+}
+}  // namespace
+
 Cloner::Cloner() {}
 
 struct Cloner::Fun {
@@ -119,9 +146,30 @@ struct Cloner::Fun {
     void operator()(DBClientCursorBatchIterator& i) {
         invariant(from_collection.coll() != "system.indexes");
 
-        // XXX: can probably take dblock instead
-        unique_ptr<ScopedTransaction> scopedXact(new ScopedTransaction(txn, MODE_X));
-        unique_ptr<Lock::GlobalWrite> globalWriteLock(new Lock::GlobalWrite(txn->lockState()));
+        // Validate the whole batch before taking any lock, so that parallel clones overlap the
+        // validation along with the fetching. The documents point into the current batch of the
+        // cursor, which stays valid until this function returns.
+        vector<BSONObj> batch;
+        while (i.moreInCurrentBatch()) {
+            BSONObj tmp = i.nextSafe();
+
+            /* assure object is valid.  note this will slow us down a little. */
+            const Status status = validateBSON(tmp.objdata(), tmp.objsize());
+            if (!status.isOK()) {
+                str::stream ss;
+                ss << "Cloner: found corrupt document in " << from_collection.toString() << ": "
+                   << status.reason();
+                if (skipCorruptDocumentsWhenCloning) {
+                    warning() << ss.ss.str() << "; skipping";
+                    continue;
+                }
+                msgasserted(28531, ss);
+            }
+            batch.push_back(tmp);
+        }
+
+        unique_ptr<ScopedTransaction> scopedXact(new ScopedTransaction(txn, MODE_IX));
+        unique_ptr<Lock::DBLock> dbWriteLock(new Lock::DBLock(txn->lockState(), _dbName, MODE_X));
         uassert(ErrorCodes::NotMaster,
                 str::stream() << "Not primary while cloning collection " << from_collection.ns()
                               << " to " << to_collection.ns(),
@@ -149,8 +197,15 @@ struct Cloner::Fun {
             MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "createCollection", to_collection.ns());
         }
 
-        while (i.moreInCurrentBatch()) {
+        // Documents are inserted in groups of up to internalInsertMaxBatchSize, and every group
+        // is flushed before returning.
+        vector<BSONObj> pending;
+        const size_t maxGroupSize = std::max(internalInsertMaxBatchSize, 1);
+
+        for (const BSONObj& doc : batch) {
             if (numSeen % 128 == 127) {
+                _insertPending(collection, &pending);
+
                 time_t now = time(0);
                 if (now - lastLog >= 60) {
                     // report progress
@@ -164,13 +219,13 @@ struct Cloner::Fun {
                 }
 
                 if (_mayYield) {
+                    dbWriteLock.reset();
                     scopedXact.reset();
-                    globalWriteLock.reset();
 
                     CurOp::get(txn)->yielded();
 
-                    scopedXact.reset(new ScopedTransaction(txn, MODE_X));
-                    globalWriteLock.reset(new Lock::GlobalWrite(txn->lockState()));
+                    scopedXact.reset(new ScopedTransaction(txn, MODE_IX));
+                    dbWriteLock.reset(new Lock::DBLock(txn->lockState(), _dbName, MODE_X));
 
                     // Check if everything is still all right.
                     if (txn->writesAreReplicated()) {
@@ -195,26 +250,69 @@ struct Cloner::Fun {
                 }
             }
 
-            BSONObj tmp = i.nextSafe();
+            ++numSeen;
+            pending.push_back(doc);
+            if (pending.size() >= maxGroupSize) {
+                _insertPending(collection, &pending);
+            }
+            RARELY if (time(0) - saveLast > 60) {
+                log() << numSeen << " objects cloned so far from collection " << from_collection;
+                saveLast = time(0);
+            }
+        }
 
-            /* assure object is valid.  note this will slow us down a little. */
-            const Status status = validateBSON(tmp.objdata(), tmp.objsize());
-            if (!status.isOK()) {
-                str::stream ss;
-                ss << "Cloner: found corrupt document in " << from_collection.toString() << ": "
-                   << status.reason();
-                if (skipCorruptDocumentsWhenCloning) {
-                    warning() << ss.ss.str() << "; skipping";
-                    continue;
+        _insertPending(collection, &pending);
+    }
+
+    /**
+     * Inserts all documents in 'pending' in a single WriteUnitOfWork and clears it. If the group
+     * fails it is retried one document at a time, so the offending document gets reported.
+     */
+    void _insertPending(Collection* collection, vector<BSONObj>* pending) {
+        if (pending->empty())
+            return;
+
+        vector<BSONObj> docs;
+        docs.swap(*pending);
+
+        if (indexer) {
+            // The index builders belong to the collection as it was when the copy started, and
+            // must not be fed documents of one that was recreated while the lock was released.
+            uassert(28738,
+                    str::stream() << "collection " << to_collection.ns()
+                                  << " dropped during clone",
+                    collection == indexedCollection);
+
+            // Keys added to the bulk builders cannot be rolled back, so a write conflict fails
+            // the clone instead of being retried.
+            WriteUnitOfWork wunit(txn);
+            for (const auto& doc : docs) {
+                StatusWith<RecordId> loc = collection->insertDocument(txn, doc, indexer, true);
+                if (!loc.isOK()) {
+                    error() << "error: exception cloning object in " << from_collection << ' '
+                            << loc.getStatus() << " obj:" << doc;
                 }
-                msgasserted(28531, ss);
+                uassertStatusOK(loc.getStatus());
             }
+            wunit.commit();
+            return;
+        }
 
-            ++numSeen;
+        Status status = Status::OK();
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+            WriteUnitOfWork wunit(txn);
+            status = collection->insertDocuments(txn, docs.begin(), docs.end(), true);
+            if (status.isOK())
+                wunit.commit();
+        }
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "cloner insert", to_collection.ns());
+        if (status.isOK())
+            return;
+
+        for (const auto& doc : docs) {
             MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
                 WriteUnitOfWork wunit(txn);
 
-                BSONObj doc = tmp;
                 StatusWith<RecordId> loc = collection->insertDocument(txn, doc, true);
                 if (!loc.isOK()) {
                     error() << "error: exception cloning object in " << from_collection << ' '
@@ -224,10 +322,6 @@ struct Cloner::Fun {
                 wunit.commit();
             }
             MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "cloner insert", to_collection.ns());
-            RARELY if (time(0) - saveLast > 60) {
-                log() << numSeen << " objects cloned so far from collection " << from_collection;
-                saveLast = time(0);
-            }
         }
     }
 
@@ -242,6 +336,8 @@ struct Cloner::Fun {
     time_t saveLast;
     bool _mayYield;
     bool _mayBeInterrupted;
+    MultiIndexBlock* indexer;       // not owned, may be NULL
+    Collection* indexedCollection;  // the collection 'indexer' builds indexes for
 };
 
 /* copy the specified collection
@@ -255,7 +351,8 @@ void Cloner::copy(OperationContext* txn,
                   bool slaveOk,
                   bool mayYield,
                   bool mayBeInterrupted,
-                  Query query) {
+                  Query query,
+                  MultiIndexBlock* indexer) {
     LOG(2) << "\t\tcloning collection " << from_collection << " to " << to_collection << " on "
            << _conn->getServerAddress() << " with filter " << query.toString() << endl;
 
@@ -267,6 +364,12 @@ void Cloner::copy(OperationContext* txn,
     f.saveLast = time(0);
     f._mayYield = mayYield;
     f._mayBeInterrupted = mayBeInterrupted;
+    f.indexer = indexer;
+    f.indexedCollection = NULL;
+    if (indexer) {
+        Database* db = dbHolder().get(txn, toDBName);
+        f.indexedCollection = db ? db->getCollection(to_collection) : NULL;
+    }
 
     int options = QueryOption_NoCursorTimeout | (slaveOk ? QueryOption_SlaveOk : 0);
     {
@@ -340,7 +443,9 @@ void Cloner::copyIndexes(OperationContext* txn,
     // indexes after the fact. This depends on holding a lock on the collection the whole time
     // from creation to completion without yielding to ensure the index and the collection
     // matches. It also wouldn't work on non-empty collections so we would need both
-    // implementations anyway as long as that is supported.
+    // implementations anyway as long as that is supported. copyCollectionData only does this
+    // when CloneOptions::buildIndexesDuringClone says that nothing else writes to the target,
+    // and aborts the build if the collection was replaced while the lock was released.
     MultiIndexBlock indexer(txn, collection);
     if (mayBeInterrupted)
         indexer.allowInterruption();
@@ -419,7 +524,8 @@ bool Cloner::copyCollection(OperationContext* txn,
          true,
          mayYield,
          mayBeInterrupted,
-         Query(query).snapshot());
+         Query(query).snapshot(),
+         nullptr);
 
     /* TODO : copyIndexes bool does not seem to be implemented! */
     if (!shouldCopyIndexes) {
@@ -440,6 +546,235 @@ bool Cloner::copyCollection(OperationContext* txn,
     return true;
 }
 
+Status Cloner::copyCollectionData(OperationContext* txn,
+                                  const string& toDBName,
+                                  const BSONObj& collection,
+                                  const CloneOptions& opts,
+                                  bool masterSameProcess) {
+    LOG(2) << "  really will clone: " << collection << endl;
+    const char* collectionName = collection["name"].valuestr();
+    BSONObj options = collection.getObjectField("options");
+
+    const NamespaceString from_name(opts.fromDB, collectionName);
+    const NamespaceString to_name(toDBName, collectionName);
+
+    // Capped collections are not fed while copying: a capped delete unindexes the document from
+    // the real index, but its keys would already be in the bulk builder.
+    vector<BSONObj> indexesToBuild;
+    if (opts.buildIndexesDuringClone && !options["capped"].trueValue()) {
+        Lock::TempRelease tempRelease(txn->lockState());
+        list<BSONObj> sourceIndexes =
+            _conn->getIndexSpecs(from_name.ns(), opts.slaveOk ? QueryOption_SlaveOk : 0);
+        for (const auto& spec : sourceIndexes) {
+            // Unique secondary indexes wait for syncIndexes, see CloneOptions.
+            if (spec["unique"].trueValue() && !IndexDescriptor::isIdIndexPattern(spec["key"].Obj()))
+                continue;
+            indexesToBuild.push_back(fixindex(toDBName, spec));
+        }
+    }
+
+    Database* db = dbHolder().openDb(txn, toDBName);
+
+    {
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+            WriteUnitOfWork wunit(txn);
+
+            // we defer building id index for performance - building it in batch is much
+            // faster
+            Status createStatus = userCreateNS(txn, db, to_name.ns(), options, false);
+            if (!createStatus.isOK()) {
+                return createStatus;
+            }
+
+            wunit.commit();
+        }
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "createCollection", to_name.ns());
+    }
+
+    Collection* c = db->getCollection(to_name);
+    unique_ptr<MultiIndexBlock> indexer;
+    if (!indexesToBuild.empty()) {
+        indexer.reset(new MultiIndexBlock(txn, c));
+        if (opts.mayBeInterrupted)
+            indexer->allowInterruption();
+        indexer->removeExistingIndexes(&indexesToBuild);
+        uassertStatusOK(indexer->init(indexesToBuild));
+    }
+
+    LOG(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
+    Query q;
+    if (opts.snapshot)
+        q.snapshot();
+
+    try {
+        copy(txn,
+             toDBName,
+             from_name,
+             options,
+             to_name,
+             masterSameProcess,
+             opts.slaveOk,
+             opts.mayYield,
+             opts.mayBeInterrupted,
+             q,
+             indexer.get());
+    } catch (...) {
+        // The indexer must not clean up after a collection that is gone.
+        db = dbHolder().get(txn, toDBName);
+        if (indexer && (!db || db->getCollection(to_name) != c))
+            indexer->abortWithoutCleanup();
+        throw;
+    }
+
+    // Copy releases the lock, so we need to re-load the database. This should
+    // probably throw if the database has changed in between, but for now preserve
+    // the existing behaviour.
+    db = dbHolder().get(txn, toDBName);
+    if (!db && indexer)
+        indexer->abortWithoutCleanup();
+    uassert(18645, str::stream() << "database " << toDBName << " dropped during clone", db);
+
+    if (indexer) {
+        if (db->getCollection(to_name) != c) {
+            indexer->abortWithoutCleanup();
+            msgasserted(28737,
+                        str::stream() << "collection " << to_name.ns()
+                                      << " dropped during clone");
+        }
+
+        // Documents with duplicate _ids come from the clone not being a true snapshot, and are
+        // dropped for the same reason as below.
+        set<RecordId> dups;
+        uassertStatusOK(indexer->doneInserting(&dups));
+        for (set<RecordId>::const_iterator it = dups.begin(); it != dups.end(); ++it) {
+            WriteUnitOfWork wunit(txn);
+            BSONObj id;
+
+            c->deleteDocument(txn, *it, true, true, txn->writesAreReplicated() ? &id : nullptr);
+            wunit.commit();
+        }
+
+        if (!dups.empty()) {
+            log() << "index build dropped: " << dups.size() << " dups";
+        }
+
+        WriteUnitOfWork wunit(txn);
+        indexer->commit();
+        if (txn->writesAreReplicated()) {
+            const string systemIndexes = to_name.getSystemIndexesCollection();
+            for (const auto& spec : indexesToBuild) {
+                getGlobalServiceContext()->getOpObserver()->onCreateIndex(
+                    txn, systemIndexes.c_str(), spec);
+            }
+        }
+        wunit.commit();
+    }
+
+    c = db->getCollection(to_name);
+    if (c && !c->getIndexCatalog()->haveIdIndex(txn)) {
+        // We need to drop objects with duplicate _ids because we didn't do a true
+        // snapshot and this is before applying oplog operations that occur during the
+        // initial sync.
+        set<RecordId> dups;
+
+        MultiIndexBlock indexer(txn, c);
+        if (opts.mayBeInterrupted)
+            indexer.allowInterruption();
+
+        uassertStatusOK(indexer.init(c->getIndexCatalog()->getDefaultIdIndexSpec()));
+        uassertStatusOK(indexer.insertAllDocumentsInCollection(&dups));
+
+        // This must be done before we commit the indexer. See the comment about
+        // dupsAllowed in IndexCatalog::_unindexRecord and SERVER-17487.
+        for (set<RecordId>::const_iterator it = dups.begin(); it != dups.end(); ++it) {
+            WriteUnitOfWork wunit(txn);
+            BSONObj id;
+
+            c->deleteDocument(txn, *it, true, true, txn->writesAreReplicated() ? &id : nullptr);
+            wunit.commit();
+        }
+
+        if (!dups.empty()) {
+            log() << "index build dropped: " << dups.size() << " dups";
+        }
+
+        WriteUnitOfWork wunit(txn);
+        indexer.commit();
+        if (txn->writesAreReplicated()) {
+            getGlobalServiceContext()->getOpObserver()->onCreateIndex(
+                txn,
+                c->ns().getSystemIndexesCollection().c_str(),
+                c->getIndexCatalog()->getDefaultIdIndexSpec());
+        }
+        wunit.commit();
+    }
+
+    return Status::OK();
+}
+
+Status Cloner::copyCollectionsInParallel(OperationContext* txn,
+                                         const string& toDBName,
+                                         const ConnectionString& source,
+                                         const list<BSONObj>& toClone,
+                                         const CloneOptions& opts) {
+    const bool writesAreReplicated = txn->writesAreReplicated();
+    const bool validationDisabled = documentValidationDisabled(txn);
+
+    stdx::mutex mutex;
+    list<BSONObj>::const_iterator next = toClone.begin();
+    Status firstError = Status::OK();
+
+    // Each worker has its own client, operation context and connection, and takes the database
+    // lock for itself. Inserts and index feeding serialize on the exclusive database lock, but
+    // fetching from the source and validating documents overlap between collections.
+    auto worker = [&]() {
+        Client::initThread("clonerWorker");
+        OperationContextImpl workerTxn;
+        workerTxn.setReplicatedWrites(writesAreReplicated);
+        documentValidationDisabled(&workerTxn) = validationDisabled;
+
+        Cloner cloner;
+        Status status = connectToSource(source, &cloner._conn);
+        while (status.isOK()) {
+            BSONObj collection;
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                if (!firstError.isOK() || next == toClone.end())
+                    return;
+                collection = *next++;
+            }
+
+            try {
+                ScopedTransaction transaction(&workerTxn, MODE_IX);
+                Lock::DBLock dbWrite(workerTxn.lockState(), toDBName, MODE_X);
+                status = cloner.copyCollectionData(&workerTxn, toDBName, collection, opts, false);
+            } catch (const DBException& ex) {
+                status = ex.toStatus();
+            }
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        if (firstError.isOK())
+            firstError = status;
+    };
+
+    const size_t numWorkers =
+        std::min(toClone.size(), static_cast<size_t>(opts.parallelCollections));
+    log() << "cloning " << toClone.size() << " collections of " << toDBName << " using "
+          << numWorkers << " threads";
+
+    Lock::TempRelease tempRelease(txn->lockState());
+    vector<stdx::thread> workers;
+    for (size_t i = 0; i < numWorkers; i++) {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+
+    return firstError;
+}
+
 Status Cloner::copyDb(OperationContext* txn,
                       const std::string& toDBName,
                       const string& masterHost,
@@ -479,19 +814,10 @@ Status Cloner::copyDb(OperationContext* txn,
         if (_conn.get()) {
             // nothing to do
         } else if (!masterSameProcess) {
-            std::string errmsg;
-            unique_ptr<DBClientBase> con(cs.connect(errmsg));
-            if (!con.get()) {
-                return Status(ErrorCodes::HostUnreachable, errmsg);
-            }
-
-            if (getGlobalAuthorizationManager()->isAuthEnabled() &&
-                !authenticateInternalUser(con.get())) {
-                return Status(ErrorCodes::AuthenticationFailed,
-                              "Unable to authenticate as internal user");
+            Status status = connectToSource(cs, &_conn);
+            if (!status.isOK()) {
+                return status;
             }
-
-            _conn = std::move(con);
         } else {
             _conn.reset(new DBDirectClient(txn));
         }
@@ -567,93 +893,22 @@ Status Cloner::copyDb(OperationContext* txn,
                 repl::getGlobalReplicationCoordinator()->canAcceptWritesForDatabase(toDBName));
 
     if (opts.syncData) {
-        for (list<BSONObj>::iterator i = toClone.begin(); i != toClone.end(); i++) {
-            BSONObj collection = *i;
-            LOG(2) << "  really will clone: " << collection << endl;
-            const char* collectionName = collection["name"].valuestr();
-            BSONObj options = collection.getObjectField("options");
-
-            const NamespaceString from_name(opts.fromDB, collectionName);
-            const NamespaceString to_name(toDBName, collectionName);
-
-            Database* db = dbHolder().openDb(txn, toDBName);
-
-            {
-                MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
-                    WriteUnitOfWork wunit(txn);
-
-                    // we defer building id index for performance - building it in batch is much
-                    // faster
-                    Status createStatus = userCreateNS(txn, db, to_name.ns(), options, false);
-                    if (!createStatus.isOK()) {
-                        return createStatus;
-                    }
-
-                    wunit.commit();
-                }
-                MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "createCollection", to_name.ns());
+        if (opts.parallelCollections > 1 && !masterSameProcess && toClone.size() > 1) {
+            Status status = copyCollectionsInParallel(txn, toDBName, cs, toClone, opts);
+            if (!status.isOK()) {
+                return status;
             }
 
-            LOG(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
-            Query q;
-            if (opts.snapshot)
-                q.snapshot();
-
-            copy(txn,
-                 toDBName,
-                 from_name,
-                 options,
-                 to_name,
-                 masterSameProcess,
-                 opts.slaveOk,
-                 opts.mayYield,
-                 opts.mayBeInterrupted,
-                 q);
-
-            // Copy releases the lock, so we need to re-load the database. This should
-            // probably throw if the database has changed in between, but for now preserve
-            // the existing behaviour.
-            db = dbHolder().get(txn, toDBName);
-            uassert(18645, str::stream() << "database " << toDBName << " dropped during clone", db);
-
-            Collection* c = db->getCollection(to_name);
-            if (c && !c->getIndexCatalog()->haveIdIndex(txn)) {
-                // We need to drop objects with duplicate _ids because we didn't do a true
-                // snapshot and this is before applying oplog operations that occur during the
-                // initial sync.
-                set<RecordId> dups;
-
-                MultiIndexBlock indexer(txn, c);
-                if (opts.mayBeInterrupted)
-                    indexer.allowInterruption();
-
-                uassertStatusOK(indexer.init(c->getIndexCatalog()->getDefaultIdIndexSpec()));
-                uassertStatusOK(indexer.insertAllDocumentsInCollection(&dups));
-
-                // This must be done before we commit the indexer. See the comment about
-                // dupsAllowed in IndexCatalog::_unindexRecord and SERVER-17487.
-                for (set<RecordId>::const_iterator it = dups.begin(); it != dups.end(); ++it) {
-                    WriteUnitOfWork wunit(txn);
-                    BSONObj id;
-
-                    c->deleteDocument(
-                        txn, *it, true, true, txn->writesAreReplicated() ? &id : nullptr);
-                    wunit.commit();
-                }
-
-                if (!dups.empty()) {
-                    log() << "index build dropped: " << dups.size() << " dups";
-                }
-
-                WriteUnitOfWork wunit(txn);
-                indexer.commit();
-                if (txn->writesAreReplicated()) {
-                    getGlobalServiceContext()->getOpObserver()->onCreateIndex(
-                        txn,
-                        c->ns().getSystemIndexesCollection().c_str(),
-                        c->getIndexCatalog()->getDefaultIdIndexSpec());
+            // The workers ran without our lock, so make sure the database is still there.
+            uassert(28736,
+                    str::stream() << "database " << toDBName << " dropped during clone",
+                    dbHolder().get(txn, toDBName));
+        } else {
+            for (list<BSONObj>::iterator i = toClone.begin(); i != toClone.end(); i++) {
+                Status status = copyCollectionData(txn, toDBName, *i, opts, masterSameProcess);
+                if (!status.isOK()) {
+                    return status;
                 }
-                wunit.commit();
             }
         }
     }
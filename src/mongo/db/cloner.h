@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <list>
+
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/base/disallow_copying.h"
 
@@ -37,6 +39,7 @@ namespace mongo {
 
 struct CloneOptions;
 class DBClientBase;
+class MultiIndexBlock;
 class NamespaceString;
 class OperationContext;
 
@@ -78,7 +81,30 @@ private:
               bool slaveOk,
               bool mayYield,
               bool mayBeInterrupted,
-              Query q);
+              Query q,
+              MultiIndexBlock* indexer);
+
+    /**
+     * Creates the collection described by the listCollections entry 'collection', copies its
+     * documents and builds its _id index, along with any index that opts.buildIndexesDuringClone
+     * allows to be fed while copying. Requires an exclusive lock on 'toDBName'.
+     */
+    Status copyCollectionData(OperationContext* txn,
+                              const std::string& toDBName,
+                              const BSONObj& collection,
+                              const CloneOptions& opts,
+                              bool masterSameProcess);
+
+    /**
+     * Runs copyCollectionData for every entry of 'toClone' on up to opts.parallelCollections
+     * threads, each with its own connection to 'source'. Releases the caller's locks while the
+     * threads run and returns the first error any of them hit.
+     */
+    Status copyCollectionsInParallel(OperationContext* txn,
+                                     const std::string& toDBName,
+                                     const ConnectionString& source,
+                                     const std::list<BSONObj>& toClone,
+                                     const CloneOptions& opts);
 
     void copyIndexes(OperationContext* txn,
                      const std::string& toDBName,
@@ -111,6 +137,9 @@ struct CloneOptions {
 
         syncData = true;
         syncIndexes = true;
+
+        parallelCollections = 1;
+        buildIndexesDuringClone = false;
     }
 
     std::string fromDB;
@@ -124,6 +153,17 @@ struct CloneOptions {
 
     bool syncData;
     bool syncIndexes;
+
+    // Number of collections to copy at once. Ignored when cloning from this same process.
+    int parallelCollections;
+
+    // Feed the _id index and all non-unique indexes of each collection while its documents are
+    // copied, rather than building them from a collection scan afterwards. Unique secondary
+    // indexes are left to syncIndexes, since a copy that is not a snapshot may hold transient
+    // duplicates until the oplog is applied. Capped collections are never fed, since capped
+    // deletes cannot take keys back out of a bulk builder. The index builders live across lock
+    // releases, so this is only safe when nothing else writes to the target.
+    bool buildIndexesDuringClone;
 };
 
 }  // namespace mongo
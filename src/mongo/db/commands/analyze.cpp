@@ -0,0 +1,207 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kCommand
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/query/index_statistics.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+using std::string;
+using std::stringstream;
+using std::vector;
+
+/**
+ * Computes the statistics the query planner uses to estimate the cost of candidate plans on a
+ * collection, from the keys its indexes generate for a sample of its documents.
+ *
+ * { analyze: <collection> [, sampleSize: <number of documents>] [, buckets: <number>] }
+ */
+class AnalyzeCmd : public Command {
+public:
+    AnalyzeCmd() : Command("analyze") {}
+
+    virtual bool slaveOk() const {
+        return true;
+    }
+
+    virtual bool isWriteCommandForConfigServer() const {
+        return false;
+    }
+
+    virtual void help(stringstream& h) const {
+        h << "Sample a collection to compute the histograms and distinct key counts of its "
+             "indexes, which the query planner uses to skip costly candidate plans.\n"
+             "{ analyze: <collection>, sampleSize: <documents>, buckets: <per index> }";
+    }
+
+    virtual void addRequiredPrivileges(const std::string& dbname,
+                                       const BSONObj& cmdObj,
+                                       std::vector<Privilege>* out) {
+        ActionSet actions;
+        actions.addAction(ActionType::planCacheWrite);
+        out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+    }
+
+    bool run(OperationContext* txn,
+             const string& dbname,
+             BSONObj& cmdObj,
+             int,
+             string& errmsg,
+             BSONObjBuilder& result) {
+        const NamespaceString nss(parseNs(dbname, cmdObj));
+
+        long long sampleSize = internalQueryStatisticsSampleSize;
+        if (cmdObj.hasField("sampleSize")) {
+            sampleSize = cmdObj["sampleSize"].numberLong();
+        }
+        if (sampleSize <= 0) {
+            return appendCommandStatus(
+                result, Status(ErrorCodes::BadValue, "sampleSize must be positive"));
+        }
+
+        long long numBuckets = IndexStatistics::kDefaultNumBuckets;
+        if (cmdObj.hasField("buckets")) {
+            numBuckets = cmdObj["buckets"].numberLong();
+        }
+        if (numBuckets <= 0) {
+            return appendCommandStatus(result,
+                                       Status(ErrorCodes::BadValue, "buckets must be positive"));
+        }
+
+        AutoGetCollectionForRead ctx(txn, nss);
+        Collection* collection = ctx.getCollection();
+        if (!collection) {
+            errmsg = "ns not found";
+            return false;
+        }
+
+        struct SampledIndex {
+            const IndexDescriptor* desc;
+            const IndexAccessMethod* iam;
+            const MatchExpression* filter;
+            vector<BSONObj> keys;
+        };
+        vector<SampledIndex> indexes;
+        IndexCatalog::IndexIterator ii =
+            collection->getIndexCatalog()->getIndexIterator(txn, false);
+        while (ii.more()) {
+            const IndexDescriptor* desc = ii.next();
+            SampledIndex index = {desc,
+                                  ii.accessMethod(desc),
+                                  ii.catalogEntry(desc)->getFilterExpression(),
+                                  vector<BSONObj>()};
+            indexes.push_back(index);
+        }
+
+        // Without a way to read random documents, sample the collection by taking every
+        // 'stride'th document of a scan.
+        const long long numRecords = collection->numRecords(txn);
+        const long long stride = std::max(1LL, numRecords / sampleSize);
+
+        // The scan yields, so that a large collection does not hold the lock or a single snapshot
+        // for its whole length. Dropping the collection or any of its indexes kills the scan,
+        // which keeps the index pointers gathered above valid.
+        std::unique_ptr<PlanExecutor> exec =
+            InternalPlanner::collectionScan(txn, nss.ns(), collection);
+        exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
+
+        long long numSampled = 0;
+        long long position = 0;
+        BSONObj doc;
+        PlanExecutor::ExecState state = PlanExecutor::IS_EOF;
+        while (numSampled < sampleSize &&
+               PlanExecutor::ADVANCED == (state = exec->getNext(&doc, NULL))) {
+            txn->checkForInterrupt();
+            if (0 != position++ % stride) {
+                continue;
+            }
+
+            for (SampledIndex& index : indexes) {
+                if (index.filter && !index.filter->matchesBSON(doc)) {
+                    continue;
+                }
+                BSONObjSet keys;
+                index.iam->getKeys(doc, &keys);
+                for (const BSONObj& key : keys) {
+                    index.keys.push_back(key.getOwned());
+                }
+            }
+            numSampled++;
+        }
+
+        if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
+            return appendCommandStatus(
+                result,
+                Status(ErrorCodes::OperationFailed,
+                       str::stream() << "Executor error during analyze: "
+                                     << WorkingSetCommon::toStatusString(doc)));
+        }
+
+        auto stats = std::make_shared<CollectionStatistics>(numRecords, numSampled);
+        for (SampledIndex& index : indexes) {
+            stats->addIndex(IndexStatistics::build(index.desc->indexName(),
+                                                   index.desc->keyPattern(),
+                                                   std::move(index.keys),
+                                                   numSampled,
+                                                   numBuckets));
+        }
+
+        LOG(1) << "analyzed " << nss.ns() << ", sampled " << numSampled << " of " << numRecords
+               << " documents";
+
+        result.append("ns", nss.ns());
+        result.appendElements(stats->toBSON());
+        collection->infoCache()->setStatistics(std::move(stats));
+        // Cached plans were chosen without the statistics, and would keep them from being used.
+        collection->infoCache()->clearQueryCache();
+        return true;
+    }
+
+} analyzeCmd;
+
+}  // namespace mongo
@@ -32,6 +32,8 @@
 
 #include "mongo/db/commands/mr.h"
 
+#include <pcrecpp.h>
+
 #include "mongo/client/connpool.h"
 #include "mongo/client/parallel.h"
 #include "mongo/db/auth/authorization_session.h"
@@ -39,6 +41,7 @@
 #include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/document_validation.h"
+#include "mongo/db/client.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/db.h"
@@ -58,6 +61,7 @@
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/sharded_connection_info.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/chunk_manager.h"
 #include "mongo/s/config.h"
@@ -66,6 +70,8 @@
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/s/stale_exception.h"
 #include "mongo/scripting/engine.h"
+#include "mongo/stdx/chrono.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
@@ -82,6 +88,40 @@ using std::vector;
 
 namespace mr {
 
+// Number of threads running the map function of a mapReduce that isn't in jsMode. With more than
+// one, the map function runs in scopes that can't access the database.
+MONGO_EXPORT_SERVER_PARAMETER(internalMapReduceMapThreads, int, 1);
+
+// Whether to sum natively the values of reduce functions recognized as only summing them.
+MONGO_EXPORT_SERVER_PARAMETER(internalMapReduceNativeReduce, bool, true);
+
+namespace {
+
+// Number of documents handed to a map thread at a time.
+const size_t kMapBatchDocs = 100;
+
+/**
+ * Checks the arguments of a call to emit(key, value) and returns them as a tuple.
+ */
+BSONObj emitArgsToTuple(const BSONObj& args) {
+    uassert(10077, "fast_emit takes 2 args", args.nFields() == 2);
+    uassert(13069,
+            "an emit can't be more than half max bson size",
+            args.objsize() < (BSONObjMaxUserSize / 2));
+
+    if (args.firstElement().type() == Undefined) {
+        BSONObjBuilder b(args.objsize());
+        b.appendNull("");
+        BSONObjIterator i(args);
+        i.next();
+        b.append(i.next());
+        return b.obj();
+    }
+    return args;
+}
+
+}  // namespace
+
 AtomicUInt32 Config::JOB_NUMBER;
 
 JSFunction::JSFunction(const std::string& type, const BSONElement& e) {
@@ -259,6 +299,130 @@ void JSReducer::_reduce(const BSONList& tuples, BSONObj& key, int& endSizeEstima
     _reduce(x, key, endSizeEstimate);
 }
 
+NativeSumReducer::NativeSumReducer(const BSONElement& code, bool startFromZero)
+    : _startFromZero(startFromZero), _jsReducer(code) {}
+
+std::unique_ptr<NativeSumReducer> NativeSumReducer::parse(const BSONElement& code,
+                                                          const BSONObj& scopeSetup) {
+    // A scope of its own, or one redefining Array, could change what the function does.
+    if ((code.type() != Code && code.type() != String) || scopeSetup.hasField("Array"))
+        return nullptr;
+
+    // Recognized forms, with any name for the variables and any spacing:
+    //   function(key, values) { return Array.sum(values); }
+    //   function(key, values) { var total = 0; values.forEach(function(v) { total += v; });
+    //                           return total; }
+    //   function(key, values) { var total = 0; for (var i = 0; i < values.length; i++)
+    //                           total += values[i]; return total; }
+    static const char kHeader[] =
+        "\\s*function\\s*\\(\\s*([A-Za-z_$][\\w$]*)\\s*,\\s*([A-Za-z_$][\\w$]*)\\s*\\)\\s*\\{\\s*";
+    static const char kStartFromZero[] = "var\\s+([A-Za-z_$][\\w$]*)\\s*=\\s*0\\s*;\\s*";
+    static const char kReturnTotal[] = "return\\s+\\3\\s*;?\\s*\\}\\s*";
+    static const pcrecpp::RE arraySum(std::string(kHeader) +
+                                      "return\\s+Array\\s*\\.\\s*sum\\s*\\(\\s*\\2\\s*\\)\\s*;?"
+                                      "\\s*\\}\\s*");
+    static const pcrecpp::RE forEachSum(std::string(kHeader) + kStartFromZero +
+                                        "\\2\\s*\\.\\s*forEach\\s*\\(\\s*function\\s*\\(\\s*"
+                                        "([A-Za-z_$][\\w$]*)\\s*\\)\\s*\\{\\s*\\3\\s*\\+=\\s*\\4"
+                                        "\\s*;?\\s*\\}\\s*\\)\\s*;\\s*" +
+                                        kReturnTotal);
+    static const pcrecpp::RE forLoopSum(std::string(kHeader) + kStartFromZero +
+                                        "for\\s*\\(\\s*var\\s+([A-Za-z_$][\\w$]*)\\s*=\\s*0\\s*;"
+                                        "\\s*\\4\\s*<\\s*\\2\\s*\\.\\s*length\\s*;\\s*"
+                                        "(?:\\4\\s*\\+\\+|\\+\\+\\s*\\4)\\s*\\)\\s*"
+                                        "(?:\\{\\s*\\3\\s*\\+=\\s*\\2\\s*\\[\\s*\\4\\s*\\]\\s*;?"
+                                        "\\s*\\}|\\3\\s*\\+=\\s*\\2\\s*\\[\\s*\\4\\s*\\]\\s*;)\\s*" +
+                                        kReturnTotal);
+
+    const std::string text = code._asCode();
+    std::string key;
+    std::string values;
+    std::string total;
+    std::string var;
+    if (arraySum.FullMatch(text, &key, &values)) {
+        if (key == values)
+            return nullptr;
+        return std::unique_ptr<NativeSumReducer>(new NativeSumReducer(code, false));
+    }
+    if (forEachSum.FullMatch(text, &key, &values, &total, &var) ||
+        forLoopSum.FullMatch(text, &key, &values, &total, &var)) {
+        // Reusing a name would shadow one of the variables.
+        std::set<std::string> names{key, values, total, var};
+        if (names.size() != 4)
+            return nullptr;
+        return std::unique_ptr<NativeSumReducer>(new NativeSumReducer(code, true));
+    }
+    return nullptr;
+}
+
+void NativeSumReducer::init(State* state) {
+    // The JavaScript function reduces what can't be summed natively, and in jsMode.
+    _jsReducer.init(state);
+}
+
+bool NativeSumReducer::reduceNumbers(const BSONList& tuples, BSONObj* out) const {
+    invariant(tuples.size() > 1);
+
+    double total = 0;
+    for (size_t i = 0; i < tuples.size(); i++) {
+        BSONObjIterator it(tuples[i]);
+        it.next();  // key
+        const BSONElement value = it.next();
+        if (value.type() != NumberDouble && value.type() != NumberInt)
+            return false;
+
+        // Array.sum() starts from the first value rather than from 0, which differs for -0.
+        if (i == 0 && !_startFromZero)
+            total = value.number();
+        else
+            total += value.number();
+    }
+
+    BSONObjBuilder b;
+    b.appendAs(tuples[0].firstElement(), "0");
+    b.append("1", total);
+    *out = b.obj();
+    return true;
+}
+
+BSONObj NativeSumReducer::reduce(const BSONList& tuples) {
+    if (tuples.size() <= 1)
+        return tuples[0];
+
+    BSONObj res;
+    if (reduceNumbers(tuples, &res)) {
+        ++numReduces;
+    } else {
+        res = _jsReducer.reduce(tuples);
+        numReduces += _jsReducer.numReduces;
+        _jsReducer.numReduces = 0;
+    }
+    return res;
+}
+
+BSONObj NativeSumReducer::finalReduce(const BSONList& tuples, Finalizer* finalizer) {
+    BSONObj reduced;
+    if (tuples.size() <= 1 || !reduceNumbers(tuples, &reduced)) {
+        BSONObj res = _jsReducer.finalReduce(tuples, finalizer);
+        numReduces += _jsReducer.numReduces;
+        _jsReducer.numReduces = 0;
+        return res;
+    }
+    ++numReduces;
+
+    BSONObjIterator it(reduced);
+    BSONObjBuilder b(reduced.objsize());
+    b.appendAs(it.next(), "_id");
+    b.appendAs(it.next(), "value");
+    BSONObj res = b.obj();
+
+    if (finalizer) {
+        res = finalizer->finalize(res);
+    }
+
+    return res;
+}
+
 Config::Config(const string& _dbname, const BSONObj& cmdObj) {
     dbname = _dbname;
     ns = dbname + "." + cmdObj.firstElement().valuestrsafe();
@@ -301,7 +465,10 @@ Config::Config(const string& _dbname, const BSONObj& cmdObj) {
             scopeSetup = cmdObj["scope"].embeddedObjectUserCheck();
 
         mapper.reset(new JSMapper(cmdObj["map"]));
-        reducer.reset(new JSReducer(cmdObj["reduce"]));
+        if (internalMapReduceNativeReduce)
+            reducer = NativeSumReducer::parse(cmdObj["reduce"], scopeSetup);
+        if (!reducer)
+            reducer.reset(new JSReducer(cmdObj["reduce"]));
         if (cmdObj["finalize"].type() && cmdObj["finalize"].trueValue())
             finalizer.reset(new JSFinalizer(cmdObj["finalize"]));
 
@@ -1130,6 +1297,14 @@ void State::emit(const BSONObj& a) {
     _size += _add(_temp.get(), a);
 }
 
+void State::emitMapped(const BSONList& tuples, long long numEmits, long long numReduces) {
+    for (const BSONObj& tuple : tuples) {
+        _size += _add(_temp.get(), tuple);
+    }
+    _numEmits += numEmits;
+    _config.reducer->numReduces += numReduces;
+}
+
 int State::_add(InMemory* im, const BSONObj& a) {
     BSONList& all = (*im)[a];
     all.push_back(a);
@@ -1188,22 +1363,8 @@ void State::reduceAndSpillInMemoryStateIfNeeded() {
  * emit that will be called by js function
  */
 BSONObj fast_emit(const BSONObj& args, void* data) {
-    uassert(10077, "fast_emit takes 2 args", args.nFields() == 2);
-    uassert(13069,
-            "an emit can't be more than half max bson size",
-            args.objsize() < (BSONObjMaxUserSize / 2));
-
     State* state = (State*)data;
-    if (args.firstElement().type() == Undefined) {
-        BSONObjBuilder b(args.objsize());
-        b.appendNull("");
-        BSONObjIterator i(args);
-        i.next();
-        b.append(i.next());
-        state->emit(b.obj());
-    } else {
-        state->emit(args);
-    }
+    state->emit(emitArgsToTuple(args));
     return BSONObj();
 }
 
@@ -1221,6 +1382,251 @@ BSONObj _bailFromJS(const BSONObj& args, void* data) {
     return BSONObj();
 }
 
+/**
+ * A map thread of a ParallelMapper, with its own scope.
+ */
+class ParallelMapper::Worker {
+    MONGO_DISALLOW_COPYING(Worker);
+
+public:
+    explicit Worker(ParallelMapper* mapper) : _mapper(mapper) {}
+
+    /**
+     * Sets up the scope and compiles the map function. Runs on the worker's thread.
+     */
+    void init() {
+        const Config& config = _mapper->_config;
+
+        std::unique_ptr<Scope> scope(globalScriptEngine->newScope());
+        if (!config.scopeSetup.isEmpty())
+            scope->init(&config.scopeSetup);
+        scope->init(&_mapper->_mapScope);
+
+        _func = scope->createFunction(_mapper->_mapCode.c_str());
+        uassert(28734, "couldn't compile code for: _map", _func);
+        scope->injectNative("emit", emit, this);
+
+        stdx::lock_guard<stdx::mutex> lk(_mapper->_mutex);
+        _scope = std::move(scope);
+        if (_mapper->_shutdown)
+            _scope->kill();
+    }
+
+    /**
+     * Maps the documents of 'batch' and, with a NativeSumReducer, reduces what they emit.
+     */
+    void map(Batch* batch) {
+        Timer t;
+        _batch = batch;
+        try {
+            for (const BSONObj& doc : batch->docs) {
+                if (_scope->invoke(_func, &_mapper->_config.mapParams, &doc, 0, true)) {
+                    batch->error = _scope->getError();
+                    break;
+                }
+            }
+        } catch (const DBException& e) {
+            batch->error = e.toString();
+        }
+        _batch = NULL;
+        batch->docs.clear();
+        batch->mapMicros = t.micros();
+
+        if (!batch->error.empty() || !_mapper->_sumReducer)
+            return;
+
+        InMemory byKey;
+        for (const BSONObj& tuple : batch->emits) {
+            byKey[tuple].push_back(tuple);
+        }
+
+        BSONList reduced;
+        for (InMemory::iterator i = byKey.begin(); i != byKey.end(); ++i) {
+            BSONList& all = i->second;
+            BSONObj res;
+            if (all.size() > 1 && _mapper->_sumReducer->reduceNumbers(all, &res)) {
+                reduced.push_back(res);
+                batch->numReduces++;
+            } else {
+                reduced.insert(reduced.end(), all.begin(), all.end());
+            }
+        }
+        batch->emits.swap(reduced);
+    }
+
+    /**
+     * Terminates the map function. The mapper's mutex must be held.
+     */
+    void kill_inlock() {
+        if (_scope)
+            _scope->kill();
+    }
+
+    /**
+     * Destroys the scope. Runs on the worker's thread, with the mapper's mutex held.
+     */
+    void resetScope_inlock() {
+        _scope.reset();
+    }
+
+private:
+    static BSONObj emit(const BSONObj& args, void* data) {
+        Worker* worker = static_cast<Worker*>(data);
+        invariant(worker->_batch);
+        worker->_batch->emits.push_back(emitArgsToTuple(args).getOwned());
+        worker->_batch->numEmits++;
+        return BSONObj();
+    }
+
+    ParallelMapper* const _mapper;
+    std::unique_ptr<Scope> _scope;  // set with the mapper's mutex held
+    ScriptingFunction _func = 0;
+    Batch* _batch = NULL;  // being mapped
+};
+
+ParallelMapper::ParallelMapper(OperationContext* txn,
+                               const Config& config,
+                               const BSONElement& mapCode,
+                               size_t numThreads)
+    : _txn(txn),
+      _config(config),
+      _mapCode(mapCode._asCode()),
+      _mapScope(mapCode.type() == CodeWScope ? mapCode.codeWScopeObject().getOwned() : BSONObj()),
+      _sumReducer(dynamic_cast<const NativeSumReducer*>(config.reducer.get())),
+      _maxInFlight(2 * numThreads) {
+    try {
+        for (size_t i = 0; i < numThreads; i++) {
+            _workers.emplace_back(new Worker(this));
+            _threads.emplace_back(
+                stdx::bind(&ParallelMapper::workerMain, this, _workers.back().get()));
+        }
+    } catch (...) {
+        shutdown();
+        throw;
+    }
+}
+
+ParallelMapper::~ParallelMapper() {
+    shutdown();
+}
+
+void ParallelMapper::shutdown() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _shutdown = true;
+        _toMap.clear();
+        for (auto& worker : _workers) {
+            worker->kill_inlock();
+        }
+        _workAvailable.notify_all();
+    }
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+    _threads.clear();
+}
+
+void ParallelMapper::workerMain(Worker* worker) {
+    Client::initThread("MapReduceWorker");
+
+    std::string initError;
+    try {
+        worker->init();
+    } catch (const DBException& e) {
+        initError = e.toString();
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (true) {
+        while (!_shutdown && _toMap.empty()) {
+            _workAvailable.wait(lk);
+        }
+        if (_shutdown)
+            break;
+
+        std::shared_ptr<Batch> batch = _toMap.front();
+        _toMap.pop_front();
+        lk.unlock();
+
+        if (initError.empty())
+            worker->map(batch.get());
+        else
+            batch->error = initError;
+
+        lk.lock();
+        batch->done = true;
+        _batchDone.notify_all();
+    }
+    worker->resetScope_inlock();
+}
+
+void ParallelMapper::add(const BSONObj& doc, State* state) {
+    if (!_currentBatch)
+        _currentBatch.reset(new Batch());
+    _currentBatch->docs.push_back(doc);
+    if (_currentBatch->docs.size() < kMapBatchDocs)
+        return;
+
+    submitCurrentBatch();
+
+    size_t numInFlight;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        numInFlight = _inFlight.size();
+    }
+    takeMapped(state, numInFlight > _maxInFlight ? numInFlight - _maxInFlight : 0);
+}
+
+void ParallelMapper::finish(State* state) {
+    submitCurrentBatch();
+
+    size_t numInFlight;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        numInFlight = _inFlight.size();
+    }
+    takeMapped(state, numInFlight);
+}
+
+void ParallelMapper::submitCurrentBatch() {
+    if (!_currentBatch || _currentBatch->docs.empty())
+        return;
+
+    std::shared_ptr<Batch> batch(_currentBatch.release());
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _inFlight.push_back(batch);
+    _toMap.push_back(batch);
+    _workAvailable.notify_one();
+}
+
+void ParallelMapper::takeMapped(State* state, size_t minToTake) {
+    size_t taken = 0;
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (!_inFlight.empty()) {
+        std::shared_ptr<Batch> batch = _inFlight.front();
+        if (!batch->done) {
+            if (taken >= minToTake)
+                break;
+
+            _batchDone.wait_for(lk, stdx::chrono::milliseconds(100));
+            lk.unlock();
+            _txn->checkForInterrupt();
+            lk.lock();
+            continue;
+        }
+        _inFlight.pop_front();
+        lk.unlock();
+
+        uassert(28735, str::stream() << "map invoke failed: " << batch->error, batch->error.empty());
+        state->emitMapped(batch->emits, batch->numEmits, batch->numReduces);
+        _mapMicros += batch->mapMicros;
+        taken++;
+
+        lk.lock();
+    }
+}
+
 /**
  * This class represents a map/reduce command executed on a single server
  */
@@ -1352,6 +1758,13 @@ public:
             long long reduceTime = 0;
             long long numInputs = 0;
 
+            // The map function of a jsMode job emits into the shared scope, so it runs here.
+            std::unique_ptr<ParallelMapper> parallelMapper;
+            if (internalMapReduceMapThreads > 1 && !state.jsMode()) {
+                parallelMapper.reset(new ParallelMapper(
+                    txn, config, cmd["map"], static_cast<size_t>(internalMapReduceMapThreads)));
+            }
+
             {
                 // We've got a cursor preventing migrations off, now re-establish our
                 // useful cursor.
@@ -1400,11 +1813,15 @@ public:
                     }
 
                     // do map
-                    if (config.verbose)
-                        mt.reset();
-                    config.mapper->map(o);
-                    if (config.verbose)
-                        mapTime += mt.micros();
+                    if (parallelMapper) {
+                        parallelMapper->add(o.getOwned(), &state);
+                    } else {
+                        if (config.verbose)
+                            mt.reset();
+                        config.mapper->map(o);
+                        if (config.verbose)
+                            mapTime += mt.micros();
+                    }
 
                     // Check if the state accumulated so far needs to be written to a
                     // collection. This may yield the DB lock temporarily and then
@@ -1451,6 +1868,13 @@ public:
                         break;
                 }
             }
+
+            if (parallelMapper) {
+                // The documents left don't need the collection, only the map threads.
+                parallelMapper->finish(&state);
+                mapTime = parallelMapper->getMapMicros();
+                parallelMapper.reset();
+            }
             pm.finished();
 
             txn->checkForInterrupt();
@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <deque>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -39,6 +41,9 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/scripting/engine.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 
 namespace mongo {
 
@@ -162,6 +167,43 @@ private:
     JSFunction _func;
 };
 
+/**
+ * Runs reduce functions that only add up their values, such as
+ * function(key, values) { return Array.sum(values); }, without calling into JavaScript.
+ *
+ * JavaScript adds numbers as doubles, so values that are all doubles or ints are summed natively
+ * in the same order, to a double. Any other value, such as a NumberLong or a string, which "+"
+ * treats in its own way, sends the whole reduce to the JavaScript function.
+ */
+class NativeSumReducer : public Reducer {
+public:
+    /**
+     * Returns a reducer for the reduce function 'code' if it is one of the summing functions
+     * recognized, or nullptr. 'scopeSetup' is the scope the functions will run in.
+     */
+    static std::unique_ptr<NativeSumReducer> parse(const BSONElement& code,
+                                                   const BSONObj& scopeSetup);
+
+    virtual void init(State* state);
+
+    virtual BSONObj reduce(const BSONList& tuples);
+    virtual BSONObj finalReduce(const BSONList& tuples, Finalizer* finalizer);
+
+    /**
+     * Reduces 'tuples', of which there must be more than one, into a single tuple
+     * {"0": key, "1": value} stored in '*out'. Returns false, leaving '*out' alone, if a value
+     * can't be summed natively. Thread safe.
+     */
+    bool reduceNumbers(const BSONList& tuples, BSONObj* out) const;
+
+private:
+    NativeSumReducer(const BSONElement& code, bool startFromZero);
+
+    // Functions that start from "var total = 0" rather than from the first value.
+    const bool _startFromZero;
+    JSReducer _jsReducer;
+};
+
 class JSFinalizer : public Finalizer {
 public:
     JSFinalizer(const BSONElement& code) : _func("_finalize", code) {}
@@ -277,6 +319,12 @@ public:
      */
     void emit(const BSONObj& a);
 
+    /**
+     * Stages the 'tuples' emitted, and possibly reduced already, by a ParallelMapper, for
+     * 'numEmits' calls to emit() and 'numReduces' reduces.
+     */
+    void emitMapped(const BSONList& tuples, long long numEmits, long long numReduces);
+
     /**
     * Checks the size of the transient in-memory results accumulated so far and potentially
     * runs reduce in order to compact them. If the data is still too large, it will be
@@ -404,6 +452,95 @@ protected:
     ScriptingFunction _reduceAndFinalizeAndInsert;
 };
 
+/**
+ * Runs the map function on several threads, each with its own JavaScript scope, over batches of
+ * documents handed to it by the thread reading the input. The tuples emitted by a batch go back
+ * to the State in the order the batches were added. With a NativeSumReducer, the tuples of a
+ * batch are reduced by key before going back.
+ *
+ * The map function runs in a plain scope: it can't use the database or stored functions.
+ */
+class ParallelMapper {
+    MONGO_DISALLOW_COPYING(ParallelMapper);
+
+public:
+    /**
+     * Starts 'numThreads' threads running the map function 'mapCode' for the operation 'txn'.
+     */
+    ParallelMapper(OperationContext* txn,
+                   const Config& config,
+                   const BSONElement& mapCode,
+                   size_t numThreads);
+
+    /**
+     * Stops the threads, killing the map functions still running.
+     */
+    ~ParallelMapper();
+
+    /**
+     * Queues the owned document 'doc' for mapping. Hands the batches already mapped to 'state',
+     * waiting for the oldest one if too many are in flight.
+     */
+    void add(const BSONObj& doc, State* state);
+
+    /**
+     * Maps all documents added so far and hands them to 'state'.
+     */
+    void finish(State* state);
+
+    /**
+     * Time the map function took over all threads.
+     */
+    long long getMapMicros() const {
+        return _mapMicros;
+    }
+
+private:
+    struct Batch {
+        std::vector<BSONObj> docs;
+        BSONList emits;
+        long long numEmits = 0;
+        long long numReduces = 0;
+        long long mapMicros = 0;
+        std::string error;
+        bool done = false;
+    };
+
+    class Worker;
+
+    void workerMain(Worker* worker);
+
+    /**
+     * Hands the batches at the front of _inFlight which are done to 'state'. If 'minToTake' is
+     * more than what is done, waits for that many.
+     */
+    void takeMapped(State* state, size_t minToTake);
+
+    void submitCurrentBatch();
+
+    /// Kills the map functions still running and joins the threads.
+    void shutdown();
+
+    OperationContext* const _txn;
+    const Config& _config;
+    const std::string _mapCode;
+    const BSONObj _mapScope;
+    const NativeSumReducer* const _sumReducer;
+    const size_t _maxInFlight;
+
+    std::unique_ptr<Batch> _currentBatch;  // being filled by add()
+    long long _mapMicros = 0;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _workAvailable;
+    stdx::condition_variable _batchDone;
+    bool _shutdown = false;
+    std::deque<std::shared_ptr<Batch>> _inFlight;  // in the order added
+    std::deque<std::shared_ptr<Batch>> _toMap;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<stdx::thread> _threads;
+};
+
 BSONObj fast_emit(const BSONObj& args, void* data);
 BSONObj _bailFromJS(const BSONObj& args, void* data);
 
@@ -208,4 +208,103 @@ TEST(ConfigOutputOptionsTest, parseOutputOptions) {
                                   mr::Config::INMEMORY);
 }
 
+/**
+ * Tests for mr::NativeSumReducer
+ */
+
+/**
+ * Returns whether NativeSumReducer recognizes the reduce function 'code'.
+ */
+bool _isNativeSum(const std::string& code, const BSONObj& scopeSetup = BSONObj()) {
+    BSONObj cmdObj = BSON("reduce" << BSONCode(code));
+    return mr::NativeSumReducer::parse(cmdObj["reduce"], scopeSetup) != nullptr;
+}
+
+TEST(NativeSumReducerTest, RecognizesSums) {
+    ASSERT_TRUE(_isNativeSum("function(key, values) { return Array.sum(values); }"));
+    ASSERT_TRUE(_isNativeSum("function (k,v){return Array.sum(v)}"));
+    ASSERT_TRUE(_isNativeSum(
+        "function(key, values) {\n"
+        "    var total = 0;\n"
+        "    values.forEach(function(v) { total += v; });\n"
+        "    return total;\n"
+        "}"));
+    ASSERT_TRUE(_isNativeSum(
+        "function(k, vals) { var s = 0; for (var i = 0; i < vals.length; i++) s += vals[i]; "
+        "return s; }"));
+    ASSERT_TRUE(_isNativeSum(
+        "function(k, vals) { var s = 0; for (var i = 0; i < vals.length; ++i) { s += vals[i]; } "
+        "return s; }"));
+}
+
+TEST(NativeSumReducerTest, DoesNotRecognizeOtherFunctions) {
+    ASSERT_FALSE(_isNativeSum("function(key, values) { return Array.sum(values) + 1; }"));
+    ASSERT_FALSE(_isNativeSum("function(key, values) { return Array.avg(values); }"));
+    ASSERT_FALSE(_isNativeSum("function(key, values) { return Array.sum(key); }"));
+    ASSERT_FALSE(_isNativeSum(
+        "function(key, values) { var total = 1; values.forEach(function(v) { total += v; }); "
+        "return total; }"));
+    // The variable of the inner function shadows the total.
+    ASSERT_FALSE(_isNativeSum(
+        "function(key, values) { var v = 0; values.forEach(function(v) { v += v; }); "
+        "return v; }"));
+    // Array may be redefined by the scope.
+    ASSERT_FALSE(_isNativeSum("function(key, values) { return Array.sum(values); }",
+                              BSON("Array" << 1)));
+
+    BSONObj cmdObj =
+        BSON("reduce" << BSONCodeWScope("function(key, values) { return Array.sum(values); }",
+                                        BSONObj()));
+    ASSERT_FALSE(mr::NativeSumReducer::parse(cmdObj["reduce"], BSONObj()));
+}
+
+TEST(NativeSumReducerTest, ReduceNumbers) {
+    BSONObj cmdObj = BSON("reduce" << BSONCode("function(k, v) { return Array.sum(v); }"));
+    std::unique_ptr<mr::NativeSumReducer> reducer =
+        mr::NativeSumReducer::parse(cmdObj["reduce"], BSONObj());
+    ASSERT(reducer);
+
+    mr::BSONList tuples;
+    tuples.push_back(BSON("0"
+                          << "a"
+                          << "1" << 1));
+    tuples.push_back(BSON("0"
+                          << "a"
+                          << "1" << 2.5));
+    tuples.push_back(BSON("0"
+                          << "a"
+                          << "1" << 3));
+    BSONObj out;
+    ASSERT_TRUE(reducer->reduceNumbers(tuples, &out));
+    ASSERT_EQUALS(BSON("0"
+                       << "a"
+                       << "1" << 6.5),
+                  out);
+    ASSERT_EQUALS(NumberDouble, out["1"].type());
+
+    // JavaScript adds ints as doubles too.
+    tuples.pop_back();
+    tuples.pop_back();
+    tuples.push_back(BSON("0"
+                          << "a"
+                          << "1" << 2));
+    ASSERT_TRUE(reducer->reduceNumbers(tuples, &out));
+    ASSERT_EQUALS(NumberDouble, out["1"].type());
+    ASSERT_EQUALS(3.0, out["1"].Double());
+
+    // Other values are left to the JavaScript function.
+    BSONObj before = out;
+    tuples.push_back(BSON("0"
+                          << "a"
+                          << "1" << 4LL));
+    ASSERT_FALSE(reducer->reduceNumbers(tuples, &out));
+    ASSERT_EQUALS(before, out);
+    tuples.pop_back();
+    tuples.push_back(BSON("0"
+                          << "a"
+                          << "1"
+                          << "4"));
+    ASSERT_FALSE(reducer->reduceNumbers(tuples, &out));
+}
+
 }  // namespace
@@ -275,6 +275,7 @@ public:
     BSONObj generateSection(OperationContext* txn, const BSONElement& configElement) const {
         BSONObjBuilder b;
         networkCounter.append(b);
+        serviceReactorCounter.append(b);
         return b.obj();
     }
 
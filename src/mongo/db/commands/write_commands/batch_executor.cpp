@@ -123,6 +123,12 @@ private:
 // TODO: Determine queueing behavior we want here
 MONGO_EXPORT_SERVER_PARAMETER(queueForMigrationCommit, bool, true);
 
+namespace {
+// Grouped inserts also stop at this many bytes of documents, so that large documents do not
+// produce overly large storage engine transactions.
+const size_t kInsertGroupMaxBytes = 256 * 1024;
+}  // namespace
+
 using mongoutils::str::stream;
 
 WriteBatchExecutor::WriteBatchExecutor(OperationContext* txn, OpCounters* opCounters, LastError* le)
@@ -648,7 +654,7 @@ public:
     /**
      * Returns true if this executor has the lock on the target database.
      */
-    bool hasLock() {
+    bool hasLock() const {
         return _dbLock.get();
     }
 
@@ -656,7 +662,7 @@ public:
      * Gets the target collection for the batch operation.  Value is undefined
      * unless hasLock() is true.
      */
-    Collection* getCollection() {
+    Collection* getCollection() const {
         return _collection;
     }
 
@@ -763,6 +769,36 @@ static void normalizeInserts(const BatchedCommandRequest& request,
     }
 }
 
+// Returns the exclusive end of the run of inserts starting at state.currIndex which may be
+// committed together. The run stops before the first document which failed normalization, and is
+// bounded by both internalInsertMaxBatchSize and kInsertGroupMaxBytes. Capped collections are
+// never grouped, see execInsertGroup().
+static size_t getInsertGroupEnd(const WriteBatchExecutor::ExecInsertsState& state) {
+    if (state.request->isInsertIndexRequest())
+        return state.currIndex;
+    if (state.hasLock() && state.getCollection() && state.getCollection()->isCapped())
+        return state.currIndex;
+
+    const size_t maxDocs = std::max(internalInsertMaxBatchSize, 1);
+    size_t bytes = 0;
+    size_t end = state.currIndex;
+    while (end < state.normalizedInserts.size() && end - state.currIndex < maxDocs) {
+        const StatusWith<BSONObj>& normalizedInsert = state.normalizedInserts[end];
+        if (!normalizedInsert.isOK())
+            break;
+
+        const BSONObj& doc = normalizedInsert.getValue().isEmpty()
+            ? state.request->getInsertRequest()->getDocumentsAt(end)
+            : normalizedInsert.getValue();
+        bytes += doc.objsize();
+        if (bytes > kInsertGroupMaxBytes && end > state.currIndex)
+            break;
+
+        ++end;
+    }
+    return end;
+}
+
 void WriteBatchExecutor::execInserts(const BatchedCommandRequest& request,
                                      std::vector<WriteErrorDetail*>* errors) {
     // Theory of operation:
@@ -770,8 +806,11 @@ void WriteBatchExecutor::execInserts(const BatchedCommandRequest& request,
     // Instantiates an ExecInsertsState, which represents all of the state involved in the batch
     // insert execution algorithm.  Most importantly, encapsulates the lock state.
     //
-    // Every iteration of the loop in execInserts() processes one document insertion, by calling
-    // insertOne() exactly once for a given value of state.currIndex.
+    // Every iteration of the loop in execInserts() first tries to insert a group of consecutive
+    // documents with execInsertGroup(), which commits them in one WriteUnitOfWork. If any document
+    // of the group fails, the group is rolled back and its documents are instead processed one
+    // insertion per iteration, by calling insertOne() exactly once for a given value of
+    // state.currIndex. This preserves both ordered semantics and per-document error reporting.
     //
     // If the ExecInsertsState indicates that the requisite write locks are not held, insertOne
     // acquires them and performs lock-acquisition-time checks.  However, on non-error
@@ -799,11 +838,12 @@ void WriteBatchExecutor::execInserts(const BatchedCommandRequest& request,
     // Yield frequency is based on the same constants used by PlanYieldPolicy.
     ElapsedTracker elapsedTracker(internalQueryExecYieldIterations, internalQueryExecYieldPeriodMS);
 
-    for (state.currIndex = 0; state.currIndex < state.request->sizeWriteOps(); ++state.currIndex) {
-        if (state.currIndex + 1 == state.request->sizeWriteOps()) {
-            setupSynchronousCommit(_txn);
-        }
+    // Documents before this index are known to fail as part of a group, and are inserted one at a
+    // time so that each error is reported against the document which caused it.
+    size_t singleInsertsUntil = 0;
 
+    state.currIndex = 0;
+    while (state.currIndex < state.request->sizeWriteOps()) {
         if (elapsedTracker.intervalHasElapsed()) {
             // Yield between inserts.
             if (state.hasLock()) {
@@ -821,6 +861,26 @@ void WriteBatchExecutor::execInserts(const BatchedCommandRequest& request,
             elapsedTracker.resetLastTime();
         }
 
+        if (state.currIndex >= singleInsertsUntil) {
+            const size_t groupEnd = getInsertGroupEnd(state);
+            if (groupEnd > state.currIndex + 1) {
+                if (groupEnd == state.request->sizeWriteOps()) {
+                    setupSynchronousCommit(_txn);
+                }
+
+                if (execInsertGroup(&state, groupEnd)) {
+                    state.currIndex = groupEnd;
+                    continue;
+                }
+
+                singleInsertsUntil = groupEnd;
+            }
+        }
+
+        if (state.currIndex + 1 == state.request->sizeWriteOps()) {
+            setupSynchronousCommit(_txn);
+        }
+
         WriteErrorDetail* error = NULL;
         execOneInsert(&state, &error);
         if (error) {
@@ -829,6 +889,8 @@ void WriteBatchExecutor::execInserts(const BatchedCommandRequest& request,
             if (request.getOrdered())
                 return;
         }
+
+        ++state.currIndex;
     }
 }
 
@@ -1066,6 +1128,81 @@ void WriteBatchExecutor::execOneInsert(ExecInsertsState* state, WriteErrorDetail
     }
 }
 
+bool WriteBatchExecutor::execInsertGroup(ExecInsertsState* state, size_t groupEnd) {
+    invariant(!_txn->lockState()->inAWriteUnitOfWork());
+    invariant(groupEnd <= state->normalizedInserts.size());
+
+    std::vector<BSONObj> docs;
+    docs.reserve(groupEnd - state->currIndex);
+    for (size_t i = state->currIndex; i < groupEnd; ++i) {
+        const BSONObj& normalizedInsert = state->normalizedInserts[i].getValue();
+        docs.push_back(normalizedInsert.isEmpty()
+                           ? state->request->getInsertRequest()->getDocumentsAt(i)
+                           : normalizedInsert);
+    }
+
+    // Capped collections may have to delete documents inserted earlier in the same group, so they
+    // are always written one document at a time. Find that out before setting up the operation.
+    // The lock is kept for the single-document path, so while it is held getInsertGroupEnd() does
+    // not offer further groups for a capped collection.
+    try {
+        WriteOpResult lockResult;
+        if (!state->lockAndCheck(&lockResult))
+            return false;
+    } catch (const DBException& ex) {
+        if (ErrorCodes::isInterruption(ex.getCode()))
+            throw;
+        state->unlock();
+        return false;
+    }
+    if (state->getCollection()->isCapped())
+        return false;
+
+    BatchItemRef firstInsertItem(state->request, state->currIndex);
+    CurOp currentOp(_txn);
+    beginCurrentOp(_txn, firstInsertItem);
+
+    bool committed = false;
+    try {
+        WriteOpResult lockResult;
+        if (state->lockAndCheck(&lockResult)) {
+            WriteUnitOfWork wunit(_txn);
+            Status status =
+                state->getCollection()->insertDocuments(_txn, docs.begin(), docs.end(), true);
+            if (status.isOK()) {
+                wunit.commit();
+                committed = true;
+            }
+        }
+    } catch (const DBException& ex) {
+        Status status = ex.toStatus();
+        if (ErrorCodes::isInterruption(status.code()))
+            throw;
+        if (status.code() == ErrorCodes::WriteConflict)
+            CurOp::get(_txn)->debug().writeConflicts++;
+
+        // Same policy as insertOne(): errors release the write lock.
+        _txn->recoveryUnit()->abandonSnapshot();
+        state->unlock();
+    }
+
+    if (!committed) {
+        LOG(3) << "grouped insert of " << docs.size() << " documents into "
+               << state->request->getNS() << " failed, retrying one at a time";
+        return false;
+    }
+
+    for (size_t i = state->currIndex; i < groupEnd; ++i) {
+        incOpStats(BatchItemRef(state->request, i));
+    }
+
+    WriteOpStats stats;
+    stats.n = docs.size();
+    incWriteStats(firstInsertItem, stats, NULL, &currentOp);
+    finishCurrentOp(_txn, NULL);
+    return true;
+}
+
 /**
  * Perform a single insert into a collection.  Requires the insert be preprocessed and the
  * collection already has been created.
@@ -97,6 +97,15 @@ private:
      */
     void execOneInsert(ExecInsertsState* state, WriteErrorDetail** error);
 
+    /**
+     * Executes the inserts in [state->currIndex, groupEnd) inside a single WriteUnitOfWork.
+     *
+     * Returns true if the whole group was committed. Returns false, without having inserted or
+     * reported anything, if any document in the group failed; the caller must then re-execute
+     * the group one document at a time so that errors are attributed to individual documents.
+     */
+    bool execInsertGroup(ExecInsertsState* state, size_t groupEnd);
+
     /**
      * Executes an update item (which may update many documents or upsert), and returns the
      * upserted _id on upsert or error on failure.
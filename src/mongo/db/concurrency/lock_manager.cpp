@@ -30,6 +30,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "mongo/db/concurrency/lock_manager.h"
@@ -38,6 +39,7 @@
 #include "mongo/db/concurrency/locker.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/stringutils.h"
 #include "mongo/util/timer.h"
 
@@ -127,6 +129,75 @@ static_assert((sizeof(LockRequestStatusNames) / sizeof(LockRequestStatusNames[0]
 }  // namespace
 
 
+/**
+ * Grants MODE_IS and MODE_IX requests on a global or database resource by counting them in a
+ * single atomic word, without taking any mutex, for as long as the resource's LockHead holds no
+ * other modes.
+ *
+ * A request in a conflicting mode closes the counter under the LockHead's bucket mutex. Closing
+ * sets the closed bit and takes the counts in one atomic step, and the LockHead adds them to its
+ * granted counts, so the conflicting request waits for them to drain like for any other granted
+ * request. While the counter is closed, new intent requests go through the LockHead and requests
+ * which were counted before it closed are released through the LockHead. The LockHead reopens
+ * the counter once it only has intent modes granted and none of the counted requests remain.
+ *
+ * Counters are claimed for a resource the first time it is used and are never given back.
+ */
+struct IntentCounter {
+    IntentCounter() : lockHead(NULL) {}
+
+    // Set while the resource's LockHead holds the counts
+    static const uint64_t kClosed = 1ULL << 63;
+
+    // MODE_IS requests are counted in the low 32 bits and MODE_IX in the next 31
+    static const uint64_t kCountMask = 0x7FFFFFFF;
+
+    static uint64_t unit(LockMode mode) {
+        return mode == MODE_NONE ? 0 : (mode == MODE_IS ? 1 : (1ULL << 32));
+    }
+
+    static uint32_t count(uint64_t value, LockMode mode) {
+        return (value / unit(mode)) & kCountMask;
+    }
+
+    /**
+     * Moves one request from the count of 'oldMode' to the count of 'newMode', unless the
+     * counter is closed. Either mode may be MODE_NONE, to count a new request or to uncount a
+     * released one. Once the counter is closed, requests which it had granted must be changed
+     * through the LockHead which closed it.
+     */
+    bool tryChange(LockMode oldMode, LockMode newMode) {
+        uint64_t value = state.load();
+        while (!(value & kClosed)) {
+            invariant(oldMode == MODE_NONE || count(value, oldMode) > 0);
+            invariant(newMode == MODE_NONE || count(value, newMode) < kCountMask);
+
+            const uint64_t newValue = value - unit(oldMode) + unit(newMode);
+            const uint64_t actual = state.compareAndSwap(value, newValue);
+            if (actual == value) {
+                return true;
+            }
+            value = actual;
+        }
+        return false;
+    }
+
+    // The resource which owns this counter, or zero if it is unused
+    AtomicUInt64 resourceId;
+
+    // The closed bit and the counts of granted requests
+    AtomicUInt64 state;
+
+    // The LockHead which closed this counter. Written under that LockHead's bucket mutex before
+    // the counter is closed, so a request which finds the counter closed can always locate it.
+    LockHead* lockHead;
+
+    // Counters are allocated as an array and each one is updated by every intent request on its
+    // resource, so keep them off each other's cache lines.
+    char padding[64];
+};
+
+
 /**
  * There is one of these objects for each resource that has a lock request. Empty objects
  * (i.e. LockHead with no requests) are allowed to exist on the lock manager's hash table.
@@ -154,6 +225,9 @@ struct LockHead {
 
         conversionsCount = 0;
         compatibleFirstCount = 0;
+
+        memset(intentCounterGrants, 0, sizeof(intentCounterGrants));
+        intentCounter = NULL;
     }
 
     /**
@@ -238,6 +312,64 @@ struct LockHead {
      */
     void migratePartitionedLockHeads();
 
+    /**
+     * Closes the resource's intent counter, if it has one and it is not closed already, and
+     * takes over the requests which it had granted.
+     */
+    void closeIntentCounter(IntentCounter* counter) {
+        if (!counter || intentCounter) {
+            return;
+        }
+
+        counter->lockHead = this;
+        const uint64_t counts = counter->state.swap(IntentCounter::kClosed);
+        invariant(!(counts & IntentCounter::kClosed));
+        intentCounter = counter;
+
+        const LockMode modes[] = {MODE_IS, MODE_IX};
+        for (LockMode mode : modes) {
+            const uint32_t numGranted = IntentCounter::count(counts, mode);
+            if (numGranted == 0) {
+                continue;
+            }
+
+            if (grantedCounts[mode] == 0) {
+                grantedModes |= modeMask(mode);
+            }
+            grantedCounts[mode] += numGranted;
+            intentCounterGrants[mode] += numGranted;
+        }
+    }
+
+    /**
+     * Reopens the intent counter closed by this LockHead, once nothing but intent modes are
+     * granted or requested and all the requests which the counter had granted are released.
+     */
+    void reopenIntentCounterIfPossible() {
+        if (!intentCounter || (grantedModes & ~intentModes) || conflictModes ||
+            intentCounterGrants[MODE_IS] || intentCounterGrants[MODE_IX]) {
+            return;
+        }
+
+        invariant(intentCounter->state.swap(0) == IntentCounter::kClosed);
+        intentCounter->lockHead = NULL;
+        intentCounter = NULL;
+    }
+
+    /**
+     * Puts a request granted by the intent counter, which this LockHead must have closed, on the
+     * granted queue.
+     */
+    void adoptIntentCounterRequest(LockRequest* request) {
+        invariant(intentCounter == request->intentCounter);
+        invariant(intentCounterGrants[request->mode] > 0);
+
+        intentCounterGrants[request->mode]--;
+        request->intentCounter = NULL;
+        request->lock = this;
+        grantedList.push_back(request);
+    }
+
     // Methods to maintain the granted queue
     void incGrantedModeCount(LockMode mode) {
         invariant(grantedCounts[mode] >= 0);
@@ -331,6 +463,18 @@ struct LockHead {
     // be switched to compatible-first. As long as this value is > 0, the policy will stay
     // compatible-first.
     uint32_t compatibleFirstCount;
+
+    //
+    // Intent counter
+    //
+
+    // Counts the requests for each of the intent modes, which the resource's intent counter
+    // granted before this LockHead closed it. These are included in grantedCounts, but are not
+    // on the granted list.
+    uint32_t intentCounterGrants[LockModesCount];
+
+    // The resource's intent counter while this LockHead keeps it closed, or NULL.
+    IntentCounter* intentCounter;
 };
 
 /**
@@ -413,16 +557,51 @@ void LockHead::migratePartitionedLockHeads() {
 // LockManager
 //
 
+namespace {
+
+unsigned numCores() {
+    return std::max(ProcessInfo().getNumCores(), 1U);
+}
+
+unsigned nextPowerOfTwo(unsigned n) {
+    unsigned result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
 // Have more buckets than CPUs to reduce contention on lock and caches
-const unsigned LockManager::_numLockBuckets(128);
+unsigned defaultNumLockBuckets() {
+    return std::max(128U, nextPowerOfTwo(4 * numCores()));
+}
 
-// Balance scalability of intent locks against potential added cost of conflicting locks.
-// The exact value doesn't appear very important, but should be power of two
-const unsigned LockManager::_numPartitions = 32;
+// Balance scalability of intent locks against potential added cost of conflicting locks, which
+// have to visit every partition. Intent locks on the global and database resources are normally
+// granted by their IntentCounter, so partitions mostly serve collections. Lockers are assigned to
+// partitions by their sequential ids and share a partition mutex once more lockers are active
+// than there are partitions, or when their ids are congruent modulo the count.
+unsigned defaultNumPartitions() {
+    return std::max(32U, nextPowerOfTwo(2 * numCores()));
+}
+
+// Intent counters are shared by the global resource and every database. A database whose name
+// hashes to kMaxIntentCounterProbes claimed counters in a row goes without one.
+const unsigned kNumIntentCounters = 256;
+const unsigned kMaxIntentCounterProbes = 8;
+
+}  // namespace
+
+LockManager::LockManager() : LockManager(defaultNumLockBuckets(), defaultNumPartitions()) {}
+
+LockManager::LockManager(unsigned numLockBuckets, unsigned numPartitions)
+    : _numLockBuckets(numLockBuckets), _numPartitions(numPartitions) {
+    invariant(_numLockBuckets > 0);
+    invariant(_numPartitions > 0);
 
-LockManager::LockManager() {
     _lockBuckets = new LockBucket[_numLockBuckets];
     _partitions = new Partition[_numPartitions];
+    _intentCounters = new IntentCounter[kNumIntentCounters];
 }
 
 LockManager::~LockManager() {
@@ -435,12 +614,28 @@ LockManager::~LockManager() {
 
     delete[] _lockBuckets;
     delete[] _partitions;
+    delete[] _intentCounters;
 }
 
 LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mode) {
     // Sanity check that requests are not being reused without proper cleanup
     invariant(request->status == LockRequest::STATUS_NEW);
 
+    // Fast path for intent locks on the global and database resources
+    if (request->useIntentCounter && (mode == MODE_IX || mode == MODE_IS)) {
+        IntentCounter* counter = _getIntentCounter(resId);
+        if (counter && counter->tryChange(MODE_NONE, mode)) {
+            request->mode = mode;
+            request->lock = NULL;
+            request->partitionedLock = NULL;
+            request->intentCounter = counter;
+            request->partitioned = false;
+            request->recursiveCount = 1;
+            request->status = LockRequest::STATUS_GRANTED;
+            return LOCK_OK;
+        }
+    }
+
     request->partitioned = (mode == MODE_IX || mode == MODE_IS);
 
     // For intent modes, try the PartitionedLockHead
@@ -478,9 +673,11 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
     }
 
     // For the first lock with a non-intent mode, migrate requests from partitioned lock heads
+    // and from the intent counter
     if (lock->partitioned()) {
         lock->migratePartitionedLockHeads();
     }
+    lock->closeIntentCounter(_getIntentCounter(resId));
 
     request->partitioned = false;
     return lock->newRequest(request, mode);
@@ -512,14 +709,25 @@ LockResult LockManager::convert(ResourceId resId, LockRequest* request, LockMode
     LockBucket* bucket = _getBucket(resId);
     stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
 
-    LockBucket::Map::iterator it = bucket->data.find(resId);
-    invariant(it != bucket->data.end());
-
-    LockHead* const lock = it->second;
+    LockHead* lock;
+    if (request->intentCounter) {
+        // A request granted by the intent counter has no LockHead yet, so close the counter to
+        // move the request to one.
+        lock = bucket->findOrInsert(resId);
+        lock->closeIntentCounter(request->intentCounter);
+        lock->adoptIntentCounterRequest(request);
+    } else {
+        LockBucket::Map::iterator it = bucket->data.find(resId);
+        invariant(it != bucket->data.end());
+        lock = it->second;
+    }
 
     if (lock->partitioned()) {
         lock->migratePartitionedLockHeads();
     }
+    if (!(modeMask(newMode) & intentModes)) {
+        lock->closeIntentCounter(_getIntentCounter(resId));
+    }
 
     // Construct granted mask without our current mode, so that it is not counted as
     // conflicting
@@ -557,6 +765,7 @@ LockResult LockManager::convert(ResourceId resId, LockRequest* request, LockMode
         lock->decGrantedModeCount(request->mode);
         request->mode = newMode;
 
+        lock->reopenIntentCounterIfPossible();
         return LOCK_OK;
     }
 }
@@ -588,6 +797,33 @@ bool LockManager::unlock(LockRequest* request) {
 
         // not partitioned anymore, fall through to regular case
     }
+
+    if (request->intentCounter) {
+        invariant(request->status == LockRequest::STATUS_GRANTED);
+        IntentCounter* const counter = request->intentCounter;
+
+        // Fast path: the counter is still open
+        if (counter->tryChange(request->mode, MODE_NONE)) {
+            request->intentCounter = NULL;
+            return true;
+        }
+
+        // The counter was closed, which moved this grant to the resource's LockHead
+        LockHead* lock = counter->lockHead;
+        LockBucket* bucket = _getBucket(lock->resourceId);
+        stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+
+        invariant(lock->intentCounter == counter);
+        invariant(lock->intentCounterGrants[request->mode] > 0);
+
+        lock->intentCounterGrants[request->mode]--;
+        lock->decGrantedModeCount(request->mode);
+        request->intentCounter = NULL;
+
+        _onLockModeChanged(lock, lock->grantedCounts[request->mode] == 0);
+        return true;
+    }
+
     invariant(request->lock);
 
     LockHead* lock = request->lock;
@@ -614,6 +850,8 @@ bool LockManager::unlock(LockRequest* request) {
 
         lock->conflictList.remove(request);
         lock->decConflictModeCount(request->mode);
+
+        lock->reopenIntentCounterIfPossible();
     } else if (request->status == LockRequest::STATUS_CONVERTING) {
         // This cancels a pending convert request
         invariant(request->recursiveCount > 0);
@@ -637,7 +875,6 @@ bool LockManager::unlock(LockRequest* request) {
 }
 
 void LockManager::downgrade(LockRequest* request, LockMode newMode) {
-    invariant(request->lock);
     invariant(request->status == LockRequest::STATUS_GRANTED);
     invariant(request->recursiveCount > 0);
 
@@ -646,6 +883,35 @@ void LockManager::downgrade(LockRequest* request, LockMode newMode) {
     invariant((LockConflictsTable[request->mode] | LockConflictsTable[newMode]) ==
               LockConflictsTable[request->mode]);
 
+    if (request->intentCounter) {
+        IntentCounter* const counter = request->intentCounter;
+
+        // Fast path: the counter is still open
+        if (counter->tryChange(request->mode, newMode)) {
+            request->mode = newMode;
+            return;
+        }
+
+        // The counter was closed, which moved this grant to the resource's LockHead
+        LockHead* lock = counter->lockHead;
+        LockBucket* bucket = _getBucket(lock->resourceId);
+        stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+
+        invariant(lock->intentCounter == counter);
+        invariant(lock->intentCounterGrants[request->mode] > 0);
+
+        lock->intentCounterGrants[request->mode]--;
+        lock->intentCounterGrants[newMode]++;
+        lock->incGrantedModeCount(newMode);
+        lock->decGrantedModeCount(request->mode);
+        request->mode = newMode;
+
+        _onLockModeChanged(lock, true);
+        return;
+    }
+
+    invariant(request->lock);
+
     LockHead* lock = request->lock;
 
     LockBucket* bucket = _getBucket(lock->resourceId);
@@ -679,6 +945,7 @@ void LockManager::cleanupUnusedLocks() {
                 invariant(lock->conflictList._back == NULL);
                 invariant(lock->conversionsCount == 0);
                 invariant(lock->compatibleFirstCount == 0);
+                invariant(lock->intentCounter == NULL);
 
                 bucket->data.erase(it++);
                 deletedLockHeads++;
@@ -779,9 +1046,15 @@ void LockManager::_onLockModeChanged(LockHead* lock, bool checkConflictQueue) {
         }
     }
 
+    lock->reopenIntentCounterIfPossible();
+
     // This is a convenient place to check that the state of the two request queues is in sync
-    // with the bitmask on the modes.
-    invariant((lock->grantedModes == 0) ^ (lock->grantedList._front != NULL));
+    // with the bitmask on the modes. Requests granted by the intent counter are counted without
+    // being on the granted queue.
+    const bool hasIntentCounterGrants =
+        lock->intentCounterGrants[MODE_IS] || lock->intentCounterGrants[MODE_IX];
+    invariant((lock->grantedModes == 0) ^
+              (lock->grantedList._front != NULL || hasIntentCounterGrants));
     invariant((lock->conflictModes == 0) ^ (lock->conflictList._front != NULL));
 }
 
@@ -793,6 +1066,32 @@ LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
     return &_partitions[request->locker->getId() % _numPartitions];
 }
 
+IntentCounter* LockManager::_getIntentCounter(ResourceId resId) {
+    const ResourceType resType = resId.getType();
+    if (resType != RESOURCE_GLOBAL && resType != RESOURCE_DATABASE) {
+        return NULL;
+    }
+
+    const uint64_t key = resId;
+    for (unsigned i = 0; i < kMaxIntentCounterProbes; i++) {
+        IntentCounter* counter = &_intentCounters[(key + i) % kNumIntentCounters];
+
+        uint64_t owner = counter->resourceId.load();
+        if (owner == 0) {
+            owner = counter->resourceId.compareAndSwap(0, key);
+            if (owner == 0) {
+                return counter;
+            }
+        }
+
+        if (owner == key) {
+            return counter;
+        }
+    }
+
+    return NULL;
+}
+
 void LockManager::dump() const {
     log() << "Dumping LockManager @ " << static_cast<const void*>(this) << '\n';
 
@@ -811,7 +1110,7 @@ void LockManager::_dumpBucket(const LockBucket* bucket) const {
          it++) {
         const LockHead* lock = it->second;
 
-        if (lock->grantedList.empty()) {
+        if (lock->grantedModes == 0) {
             // If there are no granted requests, this lock is empty, so no need to print it
             continue;
         }
@@ -828,6 +1127,12 @@ void LockManager::_dumpBucket(const LockBucket* bucket) const {
                << "CompatibleFirst = " << iter->compatibleFirst << "; " << '\n';
         }
 
+        if (lock->intentCounter) {
+            sb << '\t' << "Granted by intent counter: "
+               << "IS = " << lock->intentCounterGrants[MODE_IS] << "; "
+               << "IX = " << lock->intentCounterGrants[MODE_IX] << "; " << '\n';
+        }
+
         sb << '\n';
 
         sb << "PENDING:\n";
@@ -1072,9 +1377,12 @@ void LockRequest::initNew(Locker* locker, LockGrantNotification* notify) {
 
     enqueueAtFront = false;
     compatibleFirst = false;
+    useIntentCounter = false;
     recursiveCount = 0;
 
     lock = NULL;
+    partitionedLock = NULL;
+    intentCounter = NULL;
     prev = NULL;
     next = NULL;
     status = STATUS_NEW;
@@ -51,7 +51,16 @@ class LockManager {
     MONGO_DISALLOW_COPYING(LockManager);
 
 public:
+    /**
+     * Sizes the lock buckets and intent lock partitions from the number of cores on the machine.
+     */
     LockManager();
+
+    /**
+     * Uses the given number of lock buckets and intent lock partitions. Both must be non-zero.
+     */
+    LockManager(unsigned numLockBuckets, unsigned numPartitions);
+
     ~LockManager();
 
     /**
@@ -125,7 +134,7 @@ private:
     // The deadlock detector needs to access the buckets and locks directly
     friend class DeadlockDetector;
 
-    // The lockheads need access to the partitions
+    // The lockheads need access to the partitions and intent counters
     friend struct LockHead;
 
     // These types describe the locks hash table
@@ -135,6 +144,10 @@ private:
         typedef unordered_map<ResourceId, LockHead*> Map;
         Map data;
         LockHead* findOrInsert(ResourceId resId);
+
+        // Buckets are allocated as an array, so keep each one's mutex and map off the cache
+        // lines of its neighbours.
+        char padding[64];
     };
 
     // Each locker maps to a partition that is used for resources acquired in intent modes
@@ -146,6 +159,9 @@ private:
         typedef unordered_map<ResourceId, PartitionedLockHead*> Map;
         SimpleMutex mutex;
         Map data;
+
+        // Lockers on different partitions must not contend on a shared cache line.
+        char padding[64];
     };
 
     /**
@@ -154,6 +170,13 @@ private:
      */
     LockBucket* _getBucket(ResourceId resId) const;
 
+    /**
+     * Retrieves the IntentCounter for a global or database resource, claiming a free one if the
+     * resource has none yet. Returns NULL for other resource types, or if no counter could be
+     * claimed, in which case the resource never gets one. There is no need to hold a lock when
+     * calling this function.
+     */
+    IntentCounter* _getIntentCounter(ResourceId resId);
 
     /**
      * Retrieves the Partition that a particular LockRequest should use for intent locking.
@@ -178,11 +201,13 @@ private:
      */
     void _onLockModeChanged(LockHead* lock, bool checkConflictQueue);
 
-    static const unsigned _numLockBuckets;
+    const unsigned _numLockBuckets;
     LockBucket* _lockBuckets;
 
-    static const unsigned _numPartitions;
+    const unsigned _numPartitions;
     Partition* _partitions;
+
+    IntentCounter* _intentCounters;
 };
 
 
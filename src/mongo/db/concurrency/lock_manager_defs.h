@@ -40,6 +40,7 @@ namespace mongo {
 
 class Locker;
 
+struct IntentCounter;
 struct LockHead;
 struct PartitionedLockHead;
 
@@ -356,6 +357,11 @@ struct LockRequest {
     // granted immediately. This effectively turns off fairness.
     bool compatibleFirst;
 
+    // When set, MODE_IS and MODE_IX requests on the global and database resources may be granted
+    // by counting them in the resource's IntentCounter, without taking any mutex. Such grants are
+    // invisible to the deadlock detector, so only lockers which never need it set this flag.
+    bool useIntentCounter;
+
     // When set, an attempt is made to execute this request using partitioned lockheads.
     // This speeds up the common case where all requested locking modes are compatible with
     // each other, at the cost of extra overhead for conflicting modes.
@@ -381,6 +387,10 @@ struct LockRequest {
     // only transition from 'partitionedLock' to 'lock', never the other way around.
     PartitionedLockHead* partitionedLock;
 
+    // Pointer to the intent counter which granted this request, or null if it was not granted
+    // through one. 'lock' and 'partitionedLock' are both NULL while this is set.
+    IntentCounter* intentCounter;
+
     // The reason intrusive linked list is used instead of the std::list class is to allow
     // for entries to be removed from the middle of the list in O(1) time, if they are known
     // instead of having to search for them and we cannot persist iterators, because the list
@@ -315,6 +315,143 @@ TEST(LockManager, Conflict) {
     ASSERT(request2.numNotifies == 1);
 }
 
+TEST(LockManager, IntentLocksMigrateAcrossPartitionCounts) {
+    // The intent lock partitions must behave the same however many there are, including when
+    // every locker shares a single one.
+    const unsigned partitionCounts[] = {1, 3, 32};
+    for (unsigned numPartitions : partitionCounts) {
+        LockManager lockMgr(1, numPartitions);
+        const ResourceId resId(RESOURCE_DATABASE, std::string("TestDB"));
+
+        MMAPV1LockerImpl lockerIS;
+        MMAPV1LockerImpl lockerIX;
+        MMAPV1LockerImpl lockerX;
+
+        LockRequestCombo requestIS(&lockerIS);
+        LockRequestCombo requestIX(&lockerIX);
+        LockRequestCombo requestX(&lockerX);
+
+        ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIS, MODE_IS));
+        ASSERT(LOCK_OK == lockMgr.lock(resId, &requestIX, MODE_IX));
+
+        // The exclusive request moves the intent requests off their partitions and waits for them
+        ASSERT(LOCK_WAITING == lockMgr.lock(resId, &requestX, MODE_X));
+
+        ASSERT(lockMgr.unlock(&requestIS));
+        ASSERT(requestX.numNotifies == 0);
+        ASSERT(lockMgr.unlock(&requestIX));
+        ASSERT(requestX.numNotifies == 1);
+        ASSERT(requestX.lastResult == LOCK_OK);
+
+        ASSERT(lockMgr.unlock(&requestX));
+    }
+}
+
+TEST(LockManager, IntentCounterGrantsUncontendedIntentLocks) {
+    LockManager lockMgr;
+    const ResourceId resIdDb(RESOURCE_DATABASE, std::string("TestDB"));
+    const ResourceId resIdColl(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+    DefaultLockerImpl locker1;
+    DefaultLockerImpl locker2;
+    DefaultLockerImpl locker3;
+
+    LockRequestCombo requestIS(&locker1);
+    LockRequestCombo requestIX(&locker2);
+    LockRequestCombo requestX(&locker3);
+    requestIS.useIntentCounter = true;
+    requestIX.useIntentCounter = true;
+
+    // Intent requests on a database are counted without going through a LockHead
+    ASSERT(LOCK_OK == lockMgr.lock(resIdDb, &requestIS, MODE_IS));
+    ASSERT(LOCK_OK == lockMgr.lock(resIdDb, &requestIX, MODE_IX));
+    ASSERT(requestIS.intentCounter != NULL);
+    ASSERT(requestIS.lock == NULL);
+    ASSERT(requestIX.intentCounter == requestIS.intentCounter);
+
+    // Collections have no intent counter
+    LockRequestCombo requestColl(&locker1);
+    requestColl.useIntentCounter = true;
+    ASSERT(LOCK_OK == lockMgr.lock(resIdColl, &requestColl, MODE_IX));
+    ASSERT(requestColl.intentCounter == NULL);
+    ASSERT(lockMgr.unlock(&requestColl));
+
+    // The exclusive request waits for the counted requests to drain
+    ASSERT(LOCK_WAITING == lockMgr.lock(resIdDb, &requestX, MODE_X));
+
+    ASSERT(lockMgr.unlock(&requestIS));
+    ASSERT(requestX.numNotifies == 0);
+    ASSERT(lockMgr.unlock(&requestIX));
+    ASSERT(requestX.numNotifies == 1);
+    ASSERT(requestX.lastResult == LOCK_OK);
+
+    // While the exclusive request is granted, intent requests queue on the LockHead
+    LockRequestCombo requestWaiting(&locker1);
+    requestWaiting.useIntentCounter = true;
+    ASSERT(LOCK_WAITING == lockMgr.lock(resIdDb, &requestWaiting, MODE_IS));
+    ASSERT(requestWaiting.intentCounter == NULL);
+
+    ASSERT(lockMgr.unlock(&requestX));
+    ASSERT(requestWaiting.numNotifies == 1);
+    ASSERT(requestWaiting.lastResult == LOCK_OK);
+    ASSERT(lockMgr.unlock(&requestWaiting));
+
+    // Once only intent modes are left, the counter grants again
+    LockRequestCombo requestAgain(&locker2);
+    requestAgain.useIntentCounter = true;
+    ASSERT(LOCK_OK == lockMgr.lock(resIdDb, &requestAgain, MODE_IX));
+    ASSERT(requestAgain.intentCounter != NULL);
+    ASSERT(lockMgr.unlock(&requestAgain));
+}
+
+TEST(LockManager, IntentCounterConvertAndDowngrade) {
+    LockManager lockMgr;
+    const ResourceId resId(RESOURCE_GLOBAL, 1);
+
+    DefaultLockerImpl locker1;
+    DefaultLockerImpl locker2;
+
+    LockRequestCombo request1(&locker1);
+    LockRequestCombo request2(&locker2);
+    request1.useIntentCounter = true;
+    request2.useIntentCounter = true;
+
+    // A counted request moves to the LockHead when it is converted to a conflicting mode
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request1, MODE_IS));
+    ASSERT(LOCK_OK == lockMgr.convert(resId, &request1, MODE_S));
+    ASSERT(request1.intentCounter == NULL);
+    ASSERT(request1.lock != NULL);
+    ASSERT(request1.mode == MODE_S);
+
+    // Counting stays closed while the shared request is granted
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &request2, MODE_IX));
+    ASSERT(request2.intentCounter == NULL);
+
+    ASSERT(!lockMgr.unlock(&request1));
+    ASSERT(lockMgr.unlock(&request1));
+    ASSERT(request2.numNotifies == 1);
+    ASSERT(request2.lastResult == LOCK_OK);
+    ASSERT(lockMgr.unlock(&request2));
+
+    // Downgrading a counted request keeps it counted
+    request1.initNew(&locker1, &request1);
+    request1.useIntentCounter = true;
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request1, MODE_IX));
+    ASSERT(request1.intentCounter != NULL);
+    lockMgr.downgrade(&request1, MODE_IS);
+    ASSERT(request1.mode == MODE_IS);
+    ASSERT(request1.intentCounter != NULL);
+
+    // An exclusive request waits for the downgraded request
+    request2.initNew(&locker2, &request2);
+    request2.numNotifies = 0;
+    ASSERT(LOCK_WAITING == lockMgr.lock(resId, &request2, MODE_X));
+    ASSERT(lockMgr.unlock(&request1));
+    ASSERT(request2.numNotifies == 1);
+    ASSERT(request2.lastResult == LOCK_OK);
+    ASSERT(lockMgr.unlock(&request2));
+}
+
 TEST(LockManager, MultipleConflict) {
     LockManager lockMgr;
     const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
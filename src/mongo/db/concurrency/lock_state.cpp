@@ -608,6 +608,10 @@ LockResult LockerImpl<IsForMMAPV1>::lockBegin(ResourceId resId, LockMode mode) {
         LockRequestsMap::Iterator itNew = _requests.insert(resId);
         itNew->initNew(this, &_notify);
 
+        // The deadlock detector, which only the MMAP V1 flush lock uses, cannot see requests
+        // granted by an intent counter
+        itNew->useIntentCounter = !IsForMMAPV1;
+
         request = itNew.objAddr();
     } else {
         request = it.objAddr();
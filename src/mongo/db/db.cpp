@@ -40,6 +40,7 @@
 #include <signal.h>
 #include <string>
 
+#include "mongo/base/checked_cast.h"
 #include "mongo/base/init.h"
 #include "mongo/base/initializer.h"
 #include "mongo/base/status.h"
@@ -154,6 +155,19 @@ public:
         Client::initThread("conn", p);
     }
 
+    virtual bool supportsDetachedConnections() const {
+        return true;
+    }
+
+    virtual std::unique_ptr<ConnectionState> detachConnection(AbstractMessagingPort* p) {
+        return stdx::make_unique<ClientState>(Client::releaseCurrent());
+    }
+
+    virtual void attachConnection(AbstractMessagingPort* p,
+                                  std::unique_ptr<ConnectionState> state) {
+        Client::setCurrent(std::move(checked_cast<ClientState*>(state.get())->client));
+    }
+
     virtual void process(Message& m, AbstractMessagingPort* port) {
         while (true) {
             if (inShutdown()) {
@@ -198,6 +212,14 @@ public:
             break;
         }
     }
+
+private:
+    // The Client of a connection which is not currently being serviced by any thread.
+    struct ClientState : public ConnectionState {
+        explicit ClientState(ServiceContext::UniqueClient client) : client(std::move(client)) {}
+
+        ServiceContext::UniqueClient client;
+    };
 };
 
 static void logStartup() {
@@ -556,7 +578,7 @@ static void _initAndListen(int listenPort) {
             exitCleanly(EXIT_NEED_UPGRADE);
         }
 
-        getDeleter()->startWorkers();
+        getDeleter()->startWorkers(rangeDeleterWorkers);
 
         restartInProgressIndexesFromLastShutdown(&txn);
 
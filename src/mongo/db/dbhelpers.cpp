@@ -56,6 +56,7 @@
 #include "mongo/db/range_arithmetic.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
@@ -77,6 +78,9 @@ using std::stringstream;
 
 using logger::LogComponent;
 
+// Number of documents removeRange deletes under one acquisition of the write lock.
+MONGO_EXPORT_SERVER_PARAMETER(internalRemoveRangeBatchSize, int, 128);
+
 void Helpers::ensureIndex(OperationContext* txn,
                           Collection* collection,
                           BSONObj keyPattern,
@@ -302,7 +306,8 @@ long long Helpers::removeRange(OperationContext* txn,
                                const WriteConcernOptions& writeConcern,
                                RemoveSaver* callback,
                                bool fromMigrate,
-                               bool onlyRemoveOrphanedDocs) {
+                               bool onlyRemoveOrphanedDocs,
+                               RemoveRangePacer* pacer) {
     Timer rangeRemoveTimer;
     const string& ns = range.ns;
 
@@ -335,7 +340,12 @@ long long Helpers::removeRange(OperationContext* txn,
 
     Milliseconds millisWaitingForReplication{0};
 
-    while (1) {
+    const size_t batchSize = std::max(1, internalRemoveRangeBatchSize);
+
+    bool done = false;
+    while (!done) {
+        long long numDeletedInBatch = 0;
+
         // Scoping for write lock.
         {
             OldClientWriteContext ctx(txn, ns);
@@ -346,6 +356,8 @@ long long Helpers::removeRange(OperationContext* txn,
             IndexDescriptor* desc =
                 collection->getIndexCatalog()->findIndexByKeyPattern(txn, indexKeyPattern.toBSON());
 
+            // The scan does not yield, so the whole batch is read and deleted without
+            // releasing the lock.
             unique_ptr<PlanExecutor> exec(
                 InternalPlanner::indexScan(txn,
                                            collection,
@@ -355,62 +367,71 @@ long long Helpers::removeRange(OperationContext* txn,
                                            maxInclusive,
                                            InternalPlanner::FORWARD,
                                            InternalPlanner::IXSCAN_FETCH));
-            exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
 
-            RecordId rloc;
-            BSONObj obj;
-            PlanExecutor::ExecState state;
-            // This may yield so we cannot touch nsd after this.
-            state = exec->getNext(&obj, &rloc);
-            exec.reset();
-            if (PlanExecutor::IS_EOF == state) {
-                break;
-            }
+            std::vector<std::pair<RecordId, BSONObj>> batch;
+            batch.reserve(batchSize);
 
-            if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
-                const std::unique_ptr<PlanStageStats> stats(exec->getStats());
-                warning(LogComponent::kSharding)
-                    << PlanExecutor::statestr(state) << " - cursor error while trying to delete "
-                    << min << " to " << max << " in " << ns << ": "
-                    << WorkingSetCommon::toStatusString(obj)
-                    << ", stats: " << Explain::statsToBSON(*stats) << endl;
-                break;
-            }
-
-            verify(PlanExecutor::ADVANCED == state);
-
-            WriteUnitOfWork wuow(txn);
-
-            if (onlyRemoveOrphanedDocs) {
-                // Do a final check in the write lock to make absolutely sure that our
-                // collection hasn't been modified in a way that invalidates our migration
-                // cleanup.
-
-                // We should never be able to turn off the sharding state once enabled, but
-                // in the future we might want to.
-                verify(shardingState.enabled());
-
-                bool docIsOrphan;
-
-                // In write lock, so will be the most up-to-date version
-                std::shared_ptr<CollectionMetadata> metadataNow =
-                    shardingState.getCollectionMetadata(ns);
-                if (metadataNow) {
-                    ShardKeyPattern kp(metadataNow->getKeyPattern());
-                    BSONObj key = kp.extractShardKeyFromDoc(obj);
-                    docIsOrphan =
-                        !metadataNow->keyBelongsToMe(key) && !metadataNow->keyIsPending(key);
-                } else {
-                    docIsOrphan = false;
+            while (batch.size() < batchSize) {
+                RecordId rloc;
+                BSONObj obj;
+                PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
+                if (PlanExecutor::IS_EOF == state) {
+                    done = true;
+                    break;
                 }
 
-                if (!docIsOrphan) {
+                if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
+                    const std::unique_ptr<PlanStageStats> stats(exec->getStats());
                     warning(LogComponent::kSharding)
-                        << "aborting migration cleanup for chunk " << min << " to " << max
-                        << (metadataNow ? (string) " at document " + obj.toString() : "")
-                        << ", collection " << ns << " has changed " << endl;
+                        << PlanExecutor::statestr(state)
+                        << " - cursor error while trying to delete " << min << " to " << max
+                        << " in " << ns << ": " << WorkingSetCommon::toStatusString(obj)
+                        << ", stats: " << Explain::statsToBSON(*stats) << endl;
+                    done = true;
                     break;
                 }
+
+                verify(PlanExecutor::ADVANCED == state);
+
+                if (onlyRemoveOrphanedDocs) {
+                    // Do a final check in the write lock to make absolutely sure that our
+                    // collection hasn't been modified in a way that invalidates our migration
+                    // cleanup.
+
+                    // We should never be able to turn off the sharding state once enabled, but
+                    // in the future we might want to.
+                    verify(shardingState.enabled());
+
+                    bool docIsOrphan;
+
+                    // In write lock, so will be the most up-to-date version
+                    std::shared_ptr<CollectionMetadata> metadataNow =
+                        shardingState.getCollectionMetadata(ns);
+                    if (metadataNow) {
+                        ShardKeyPattern kp(metadataNow->getKeyPattern());
+                        BSONObj key = kp.extractShardKeyFromDoc(obj);
+                        docIsOrphan =
+                            !metadataNow->keyBelongsToMe(key) && !metadataNow->keyIsPending(key);
+                    } else {
+                        docIsOrphan = false;
+                    }
+
+                    if (!docIsOrphan) {
+                        warning(LogComponent::kSharding)
+                            << "aborting migration cleanup for chunk " << min << " to " << max
+                            << (metadataNow ? (string) " at document " + obj.toString() : "")
+                            << ", collection " << ns << " has changed " << endl;
+                        done = true;
+                        break;
+                    }
+                }
+
+                batch.push_back(std::make_pair(rloc, obj.getOwned()));
+            }
+            exec.reset();
+
+            if (batch.empty()) {
+                break;
             }
 
             NamespaceString nss(ns);
@@ -421,19 +442,21 @@ long long Helpers::removeRange(OperationContext* txn,
                 return numDeleted;
             }
 
-            if (callback)
-                callback->goingToDelete(obj);
+            WriteUnitOfWork wuow(txn);
+            for (size_t i = 0; i < batch.size(); i++) {
+                if (callback)
+                    callback->goingToDelete(batch[i].second);
 
-            BSONObj deletedId;
-            collection->deleteDocument(txn, rloc, false, false, &deletedId);
+                BSONObj deletedId;
+                collection->deleteDocument(txn, batch[i].first, false, false, &deletedId);
+            }
             wuow.commit();
-            numDeleted++;
-        }
 
-        // TODO remove once the yielding below that references this timer has been removed
-        Timer secondaryThrottleTime;
+            numDeletedInBatch = batch.size();
+            numDeleted += numDeletedInBatch;
+        }
 
-        if (writeConcern.shouldWaitForOtherNodes() && numDeleted > 0) {
+        if (writeConcern.shouldWaitForOtherNodes()) {
             repl::ReplicationCoordinator::StatusAndDuration replStatus =
                 repl::getGlobalReplicationCoordinator()->awaitReplication(
                     txn,
@@ -447,6 +470,10 @@ long long Helpers::removeRange(OperationContext* txn,
             }
             millisWaitingForReplication += replStatus.duration;
         }
+
+        if (pacer) {
+            pacer->afterBatch(txn, numDeletedInBatch);
+        }
     }
 
     if (writeConcern.shouldWaitForOtherNodes())
@@ -49,6 +49,7 @@ struct WriteConcernOptions;
  */
 struct Helpers {
     class RemoveSaver;
+    class RemoveRangePacer;
 
     /* ensure the specified index exists.
 
@@ -163,6 +164,11 @@ struct Helpers {
      *
      * Returns -1 when no usable index exists
      *
+     * Documents are removed in batches of internalRemoveRangeBatchSize, each one under a
+     * single acquisition of the write lock and a single storage transaction. The
+     * secondaryThrottle write concern is waited for and the pacer, if any, is called after
+     * every batch, with no locks held.
+     *
      * Does oplog the individual document deletions.
      * // TODO: Refactor this mechanism, it is growing too large
      */
@@ -172,7 +178,8 @@ struct Helpers {
                                  const WriteConcernOptions& secondaryThrottle,
                                  RemoveSaver* callback = NULL,
                                  bool fromMigrate = false,
-                                 bool onlyRemoveOrphanedDocs = false);
+                                 bool onlyRemoveOrphanedDocs = false,
+                                 RemoveRangePacer* pacer = NULL);
 
 
     // TODO: This will supersede Chunk::MaxObjectsPerChunk
@@ -225,6 +232,20 @@ struct Helpers {
         boost::filesystem::path _file;
         std::ofstream* _out;
     };
+
+    /**
+     * Lets the caller of removeRange control the pace of the deletes.
+     */
+    class RemoveRangePacer {
+    public:
+        virtual ~RemoveRangePacer() = default;
+
+        /**
+         * Called after every batch of removed documents, with no locks held. May sleep to
+         * slow down the deletes, or throw to interrupt them.
+         */
+        virtual void afterBatch(OperationContext* txn, long long numDeleted) = 0;
+    };
 };
 
 }  // namespace mongo
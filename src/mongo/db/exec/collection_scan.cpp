@@ -38,6 +38,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -67,6 +68,10 @@ CollectionScan::CollectionScan(OperationContext* txn,
       _commonStats(kStageType) {
     // Explain reports the direction of the collection scan.
     _specificStats.direction = params.direction;
+
+    if (internalQueryExecCompileFilters) {
+        _compiledFilter = CompiledMatcher::compile(_filter);
+    }
 }
 
 PlanStage::StageState CollectionScan::work(WorkingSetID* out) {
@@ -176,7 +181,7 @@ PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID* out) {
     ++_specificStats.docsTested;
 
-    if (Filter::passes(member, _filter)) {
+    if (Filter::passes(member, _filter, _compiledFilter.get())) {
         *out = memberID;
         ++_commonStats.advanced;
         return PlanStage::ADVANCED;
@@ -32,6 +32,7 @@
 
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/matcher/compiled_matcher.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
 
@@ -91,6 +92,9 @@ private:
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
+    // Single-pass form of _filter, or NULL if it has none.
+    std::unique_ptr<CompiledMatcher> _compiledFilter;
+
     std::unique_ptr<RecordCursor> _cursor;
 
     CollectionScanParams _params;
@@ -35,6 +35,7 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -60,7 +61,11 @@ FetchStage::FetchStage(OperationContext* txn,
       _child(child),
       _filter(filter),
       _idRetrying(WorkingSet::INVALID_ID),
-      _commonStats(kStageType) {}
+      _commonStats(kStageType) {
+    if (internalQueryExecCompileFilters) {
+        _compiledFilter = CompiledMatcher::compile(_filter);
+    }
+}
 
 FetchStage::~FetchStage() {}
 
@@ -210,7 +215,7 @@ PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
     // predicate.
     ++_specificStats.docsExamined;
 
-    if (Filter::passes(member, _filter)) {
+    if (Filter::passes(member, _filter, _compiledFilter.get())) {
         *out = memberID;
 
         ++_commonStats.advanced;
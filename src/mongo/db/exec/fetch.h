@@ -32,6 +32,7 @@
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/compiled_matcher.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
 
@@ -100,6 +101,9 @@ private:
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
+    // Single-pass form of _filter, or NULL if it has none.
+    std::unique_ptr<CompiledMatcher> _compiledFilter;
+
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "mongo/db/exec/working_set.h"
+#include "mongo/db/matcher/compiled_matcher.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/matchable.h"
 
@@ -158,6 +159,19 @@ public:
         return filter->matches(&doc, NULL);
     }
 
+    /**
+     * Same as above, but uses 'compiledFilter', the compiled form of 'filter', when 'wsm' has
+     * its document. 'compiledFilter' may be NULL.
+     */
+    static bool passes(WorkingSetMember* wsm,
+                       const MatchExpression* filter,
+                       const CompiledMatcher* compiledFilter) {
+        if (compiledFilter && wsm->hasObj()) {
+            return compiledFilter->matchesBSON(wsm->obj.value());
+        }
+        return passes(wsm, filter);
+    }
+
     static bool passes(const BSONObj& keyData,
                        const BSONObj& keyPattern,
                        const MatchExpression* filter) {
@@ -655,7 +655,13 @@ struct TextMatchStats : public SpecificStats {
 };
 
 struct TextOrStats : public SpecificStats {
-    TextOrStats() : fetches(0) {}
+    TextOrStats()
+        : fetches(0),
+          limit(0),
+          docsPruned(0),
+          maxDocsBuffered(0),
+          stoppedEarly(false),
+          spilled(false) {}
 
     virtual SpecificStats* clone() const {
         TextOrStats* specific = new TextOrStats(*this);
@@ -663,6 +669,21 @@ struct TextOrStats : public SpecificStats {
     }
 
     size_t fetches;
+
+    // How many of the highest scoring documents are returned, or 0 for all of them.
+    size_t limit;
+
+    // Documents dropped since they couldn't score high enough to be returned.
+    size_t docsPruned;
+
+    // Most documents whose scores were held in memory at once.
+    size_t maxDocsBuffered;
+
+    // Did we stop reading the index before the end of the terms?
+    bool stoppedEarly;
+
+    // Were the scores spilled to disk?
+    bool spilled;
 };
 
 }  // namespace mongo
@@ -144,7 +144,15 @@ const SpecificStats* TextStage::getSpecificStats() const {
 unique_ptr<PlanStage> TextStage::buildTextTree(OperationContext* txn,
                                                WorkingSet* ws,
                                                const MatchExpression* filter) const {
-    auto textScorer = make_unique<TextOrStage>(txn, _params.spec, ws, filter, _params.index);
+    // The text matcher above the TEXT_OR stage can drop documents for negations, phrases or
+    // case, so the TEXT_OR stage can't keep only the highest scoring ones in that case.
+    const FTSQuery& query = _params.query;
+    const bool matcherFilters = query.getCaseSensitive() || !query.getNegatedTerms().empty() ||
+        !query.getPositivePhr().empty() || !query.getNegatedPhr().empty();
+    const size_t limit = matcherFilters ? 0 : _params.limit;
+
+    auto textScorer =
+        make_unique<TextOrStage>(txn, _params.spec, ws, filter, _params.index, limit);
 
     // Get all the index scans for each term in our query.
     for (const auto& term : _params.query.getTermsForBounds()) {
@@ -159,7 +167,7 @@ unique_ptr<PlanStage> TextStage::buildTextTree(OperationContext* txn,
         ixparams.descriptor = _params.index;
         ixparams.direction = -1;
 
-        textScorer->addChild(make_unique<IndexScan>(txn, ixparams, ws, nullptr));
+        textScorer->addChild(make_unique<IndexScan>(txn, ixparams, ws, nullptr), term);
     }
 
     auto fetcher = make_unique<FetchStage>(
@@ -62,6 +62,10 @@ struct TextStageParams {
 
     // The text query.
     FTSQuery query;
+
+    // If not 0, the results are sorted by text score and only this many of the highest scoring
+    // ones are needed.
+    size_t limit = 0;
 };
 
 /**
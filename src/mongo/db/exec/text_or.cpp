@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/text_or.h"
 
+#include <algorithm>
+#include <limits>
 #include <map>
 #include <vector>
 
@@ -40,7 +42,9 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/matchable.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/storage_options.h"
 #include "mongo/stdx/memory.h"
 
 namespace mongo {
@@ -54,13 +58,32 @@ using fts::FTSSpec;
 
 const char* TextOrStage::kStageType = "TEXT_OR";
 
+namespace {
+
+// Fewest index keys read between two checks of whether the top scoring documents are known.
+const size_t kMinKeysBetweenChecks = 128;
+
+/**
+ * Orders spilled scores by RecordId, so that the scores of a document come out together.
+ */
+struct SpilledScoreComparator {
+    template <typename Data>
+    int operator()(const Data& lhs, const Data& rhs) const {
+        return lhs.first.compare(rhs.first);
+    }
+};
+
+}  // namespace
+
 TextOrStage::TextOrStage(OperationContext* txn,
                          const FTSSpec& ftsSpec,
                          WorkingSet* ws,
                          const MatchExpression* filter,
-                         IndexDescriptor* index)
+                         IndexDescriptor* index,
+                         size_t limit)
     : _ftsSpec(ftsSpec),
       _ws(ws),
+      _limit(limit),
       _scoreIterator(_scores.end()),
       _commonStats(kStageType),
       _filter(filter),
@@ -70,8 +93,9 @@ TextOrStage::TextOrStage(OperationContext* txn,
 
 TextOrStage::~TextOrStage() {}
 
-void TextOrStage::addChild(unique_ptr<PlanStage> child) {
+void TextOrStage::addChild(unique_ptr<PlanStage> child, const std::string& term) {
     _children.push_back(std::move(child));
+    _terms.push_back(term);
 }
 
 bool TextOrStage::isEOF() {
@@ -113,6 +137,11 @@ void TextOrStage::invalidate(OperationContext* txn, const RecordId& dl, Invalida
         child->invalidate(txn, dl, type);
     }
 
+    if (_spilledScores) {
+        // The spilled scores can't be removed. Skip them when returning the results.
+        _invalidatedSpilled.insert(dl);
+    }
+
     // Remove the RecordID from the ScoreMap.
     ScoreMap::iterator scoreIt = _scores.find(dl);
     if (scoreIt != _scores.end()) {
@@ -206,6 +235,17 @@ PlanStage::StageState TextOrStage::work(WorkingSetID* out) {
 
 PlanStage::StageState TextOrStage::initStage(WorkingSetID* out) {
     *out = WorkingSet::INVALID_ID;
+
+    if (_limit && _children.size() > 64) {
+        // TextRecordData::childrenRead has a bit per child.
+        _limit = 0;
+    }
+    if (_limit) {
+        _maxTermScores.assign(_children.size(), std::numeric_limits<double>::infinity());
+        _childEOF.assign(_children.size(), false);
+    }
+    _specificStats.limit = _limit;
+
     try {
         _recordCursor = _index->getCollection()->getCursor(_txn);
         _internalState = State::kReadingTerms;
@@ -237,18 +277,62 @@ PlanStage::StageState TextOrStage::readFromChildren(WorkingSetID* out) {
     }
 
     if (PlanStage::ADVANCED == childState) {
-        return addTerm(id, out);
+        StageState stageState = addTerm(id, out);
+        if (PlanStage::NEED_YIELD == stageState) {
+            // We'll retry the same key.
+            return stageState;
+        }
+
+        if (_limit) {
+            // Read the next key from the next child, so that the bounds on the scores of the
+            // documents not read yet go down for all terms.
+            do {
+                _currentChild = (_currentChild + 1) % _children.size();
+            } while (_childEOF[_currentChild]);
+
+            if (_keysBeforeCheck > 0) {
+                --_keysBeforeCheck;
+            } else if (selectTopDocuments()) {
+                _specificStats.stoppedEarly = true;
+                _scoreIterator = _scores.begin();
+                _internalState = State::kReturningResults;
+            }
+        } else if (!_spilledScores &&
+                   _memUsage > static_cast<size_t>(internalQueryExecTextOrMaxMemoryBytes)) {
+            spillScores();
+        }
+        return stageState;
     } else if (PlanStage::IS_EOF == childState) {
         // Done with this child.
-        ++_currentChild;
+        if (_limit) {
+            _childEOF[_currentChild] = true;
+            _maxTermScores[_currentChild] = 0;
+            ++_numChildrenEOF;
+
+            if (_numChildrenEOF < _children.size()) {
+                do {
+                    _currentChild = (_currentChild + 1) % _children.size();
+                } while (_childEOF[_currentChild]);
+                return PlanStage::NEED_TIME;
+            }
 
-        if (_currentChild < _children.size()) {
-            // We have another child to read from.
-            return PlanStage::NEED_TIME;
+            // All scores are known.
+            invariant(selectTopDocuments());
+        } else {
+            ++_currentChild;
+
+            if (_currentChild < _children.size()) {
+                // We have another child to read from.
+                return PlanStage::NEED_TIME;
+            }
         }
 
         // If we're here we are done reading results.  Move to the next state.
-        _scoreIterator = _scores.begin();
+        if (_spilledScores) {
+            _spilledScoreIterator.reset(_spilledScores->done());
+        } else {
+            _scoreIterator = _scores.begin();
+        }
         _internalState = State::kReturningResults;
 
         return PlanStage::NEED_TIME;
@@ -273,29 +357,208 @@ PlanStage::StageState TextOrStage::readFromChildren(WorkingSetID* out) {
 }
 
 PlanStage::StageState TextOrStage::returnResults(WorkingSetID* out) {
+    if (_spilledScores) {
+        return returnSpilledResults(out);
+    }
+
     if (_scoreIterator == _scores.end()) {
         _internalState = State::kDone;
         return PlanStage::IS_EOF;
     }
 
     // Retrieve the record that contains the text score.
-    TextRecordData textRecordData = _scoreIterator->second;
-    ++_scoreIterator;
+    TextRecordData* textRecordData = &_scoreIterator->second;
 
     // Ignore non-matched documents.
-    if (textRecordData.score < 0) {
-        invariant(textRecordData.wsid == WorkingSet::INVALID_ID);
+    if (textRecordData->score < 0) {
+        invariant(textRecordData->wsid == WorkingSet::INVALID_ID);
+        ++_scoreIterator;
         return PlanStage::NEED_TIME;
     }
 
-    WorkingSetMember* wsm = _ws->get(textRecordData.wsid);
+    if (_limit) {
+        StageState stageState = completeScore(textRecordData, out);
+        if (PlanStage::IS_EOF != stageState) {
+            if (PlanStage::NEED_TIME == stageState) {
+                // The document was deleted.
+                ++_scoreIterator;
+            }
+            return stageState;
+        }
+    }
+    ++_scoreIterator;
+
+    WorkingSetMember* wsm = _ws->get(textRecordData->wsid);
 
     // Populate the working set member with the text score and return it.
-    wsm->addComputed(new TextScoreComputedData(textRecordData.score));
-    *out = textRecordData.wsid;
+    wsm->addComputed(new TextScoreComputedData(textRecordData->score));
+    *out = textRecordData->wsid;
     return PlanStage::ADVANCED;
 }
 
+double TextOrStage::getTermScore(const BSONObj& keyData) const {
+    // Locate score within possibly compound key: {prefix,term,score,suffix}.
+    BSONObjIterator keyIt(keyData);
+    for (unsigned i = 0; i < _ftsSpec.numExtraBefore(); i++) {
+        keyIt.next();
+    }
+
+    keyIt.next();  // Skip past 'term'.
+
+    BSONElement scoreElement = keyIt.next();
+    return scoreElement.number();
+}
+
+double TextOrStage::getMaxScore(const TextRecordData& data) const {
+    double maxScore = data.score;
+    for (size_t i = 0; i < _children.size(); i++) {
+        if (!(data.childrenRead & (1ULL << i))) {
+            maxScore += _maxTermScores[i];
+        }
+    }
+    return maxScore;
+}
+
+bool TextOrStage::selectTopDocuments() {
+    // No document not read yet can score more than this.
+    double maxUnreadScore = 0;
+    for (double maxTermScore : _maxTermScores) {
+        maxUnreadScore += maxTermScore;
+    }
+
+    vector<ScoreMap::iterator> candidates;
+    candidates.reserve(_scores.size());
+    for (ScoreMap::iterator it = _scores.begin(); it != _scores.end(); ++it) {
+        if (it->second.score >= 0) {
+            candidates.push_back(it);
+        }
+    }
+
+    // Checking takes time linear in the number of candidates.
+    _keysBeforeCheck = std::max(kMinKeysBetweenChecks, candidates.size() / 2);
+
+    if (candidates.size() <= _limit) {
+        // Any document may still be among the top ones, until all are read.
+        return _numChildrenEOF == _children.size();
+    }
+
+    // The documents with the highest scores so far come first. Since scores only go up, any
+    // document which can't beat the lowest of them never will.
+    auto last = candidates.begin() + (_limit - 1);
+    std::nth_element(candidates.begin(),
+                     last,
+                     candidates.end(),
+                     [](ScoreMap::iterator lhs, ScoreMap::iterator rhs) {
+                         return lhs->second.score > rhs->second.score;
+                     });
+    const double minTopScore = (*last)->second.score;
+
+    // Dropped documents are forgotten, so that memory only holds the documents which may still
+    // make the top ones. One read again for another term comes back with a partial score, whose
+    // bound may be too low. That is harmless: its actual score is already below the lowest top
+    // score, which never goes down.
+    bool known = maxUnreadScore <= minTopScore;
+    for (auto it = last + 1; it != candidates.end(); ++it) {
+        TextRecordData& data = (*it)->second;
+        const double maxScore = getMaxScore(data);
+        if (maxScore < minTopScore) {
+            _ws->free(data.wsid);
+            _scores.erase(*it);
+            *it = _scores.end();
+            ++_specificStats.docsPruned;
+        } else if (maxScore > minTopScore) {
+            known = false;
+        }
+    }
+
+    if (!known) {
+        return false;
+    }
+
+    // Only the top documents are returned. The others score as much as the lowest of them, at
+    // best.
+    for (auto it = last + 1; it != candidates.end(); ++it) {
+        if (_scores.end() != *it) {
+            _ws->free((*it)->second.wsid);
+            ++_specificStats.docsPruned;
+        }
+    }
+
+    ScoreMap topScores;
+    for (auto it = candidates.begin(); it != last + 1; ++it) {
+        topScores.insert(**it);
+    }
+    _scores.swap(topScores);
+    return true;
+}
+
+PlanStage::StageState TextOrStage::completeScore(TextRecordData* textRecordData,
+                                                 WorkingSetID* out) {
+    bool complete = true;
+    for (size_t i = 0; i < _children.size(); i++) {
+        if (!_childEOF[i] && !(textRecordData->childrenRead & (1ULL << i))) {
+            complete = false;
+            break;
+        }
+    }
+    if (complete) {
+        return PlanStage::IS_EOF;
+    }
+
+    // Score the document for the terms it wasn't read for.
+    try {
+        if (!WorkingSetCommon::fetchIfUnfetched(
+                _txn, _ws, textRecordData->wsid, _recordCursor)) {
+            _ws->free(textRecordData->wsid);
+            textRecordData->wsid = WorkingSet::INVALID_ID;
+            textRecordData->score = -1;
+            return PlanStage::NEED_TIME;
+        }
+    } catch (const WriteConflictException& wce) {
+        *out = WorkingSet::INVALID_ID;
+        return PlanStage::NEED_YIELD;
+    }
+    ++_specificStats.fetches;
+
+    WorkingSetMember* member = _ws->get(textRecordData->wsid);
+    member->obj.setValue(member->obj.value().getOwned());
+
+    fts::TermFrequencyMap termFrequencies;
+    _ftsSpec.scoreDocument(member->obj.value(), &termFrequencies);
+
+    double score = 0;
+    for (const auto& term : _terms) {
+        fts::TermFrequencyMap::const_iterator it = termFrequencies.find(term);
+        if (it != termFrequencies.end()) {
+            score += it->second;
+        }
+    }
+    textRecordData->score = score;
+    textRecordData->childrenRead = ~0ULL;
+    return PlanStage::IS_EOF;
+}
+
+void TextOrStage::spillScores() {
+    _spilledScores.reset(ScoreSorter::make(
+        SortOptions()
+            .ExtSortAllowed()
+            .TempDir(storageGlobalParams.dbpath + "/_tmp")
+            .MaxMemoryUsageBytes(static_cast<size_t>(internalQueryExecTextOrMaxMemoryBytes)),
+        SpilledScoreComparator()));
+
+    for (const auto& entry : _scores) {
+        if (WorkingSet::INVALID_ID != entry.second.wsid) {
+            _ws->free(entry.second.wsid);
+        }
+        _spilledScores->add(entry.first, SpilledScore(entry.second.score));
+    }
+
+    _scores.clear();
+    _scoreIterator = _scores.end();
+    _memUsage = 0;
+    _specificStats.spilled = true;
+}
+
 /**
  * Provides support for covered matching on non-text fields of a compound text index.
  */
@@ -376,9 +639,29 @@ PlanStage::StageState TextOrStage::addTerm(WorkingSetID wsid, WorkingSetID* out)
     invariant(wsm->getState() == WorkingSetMember::LOC_AND_IDX);
     invariant(1 == wsm->keyData.size());
     const IndexKeyDatum newKeyData = wsm->keyData.back();  // copy to keep it around.
+    const double documentTermScore = getTermScore(newKeyData.keyData);
+
+    if (_limit) {
+        // Our children read their keys in decreasing order of score.
+        _maxTermScores[_currentChild] = documentTermScore;
+    }
+
+    if (_spilledScores) {
+        // The scores are summed, and the filter applied, when returning the results.
+        _spilledScores->add(wsm->loc, SpilledScore(documentTermScore));
+        _ws->free(wsid);
+        return NEED_TIME;
+    }
 
     TextRecordData* textRecordData = &_scores[wsm->loc];
     double* documentAggregateScore = &textRecordData->score;
+    _specificStats.maxDocsBuffered = std::max(_specificStats.maxDocsBuffered, _scores.size());
+
+    if (*documentAggregateScore < 0) {
+        // We have already rejected this document for not matching the filter.
+        _ws->free(wsid);
+        return NEED_TIME;
+    }
 
     if (WorkingSet::INVALID_ID == textRecordData->wsid) {
         // We haven't seen this RecordId before. Keep the working set member around (it may be
@@ -394,6 +677,8 @@ PlanStage::StageState TextOrStage::addTerm(WorkingSetID wsid, WorkingSetID* out)
                     _txn, newKeyData.indexKeyPattern, newKeyData.keyData, _ws, wsid, _recordCursor);
                 shouldKeep = _filter->matches(&tdoc);
             } catch (const WriteConflictException& wce) {
+                // We'll see this RecordId as new again when retrying.
+                textRecordData->wsid = WorkingSet::INVALID_ID;
                 _idRetrying = wsid;
                 *out = WorkingSet::INVALID_ID;
                 return NEED_YIELD;
@@ -416,6 +701,9 @@ PlanStage::StageState TextOrStage::addTerm(WorkingSetID wsid, WorkingSetID* out)
             }
         }
 
+        if (!_limit) {
+            _memUsage += sizeof(ScoreMap::value_type) + wsm->getMemUsage();
+        }
     } else {
         // We already have a working set member for this RecordId. Free the new WSM and retrieve the
         // old one. Note that since we don't keep all index keys, we could get a score that doesn't
@@ -426,25 +714,88 @@ PlanStage::StageState TextOrStage::addTerm(WorkingSetID wsid, WorkingSetID* out)
         wsm = _ws->get(textRecordData->wsid);
     }
 
-    if (*documentAggregateScore < 0) {
-        // We have already rejected this document for not matching the filter.
-        return NEED_TIME;
+    if (_limit) {
+        textRecordData->childrenRead |= 1ULL << _currentChild;
     }
 
-    // Locate score within possibly compound key: {prefix,term,score,suffix}.
-    BSONObjIterator keyIt(newKeyData.keyData);
-    for (unsigned i = 0; i < _ftsSpec.numExtraBefore(); i++) {
-        keyIt.next();
+    // Aggregate relevance score, term keys.
+    *documentAggregateScore += documentTermScore;
+    return NEED_TIME;
+}
+
+PlanStage::StageState TextOrStage::returnSpilledResults(WorkingSetID* out) {
+    WorkingSetID wsid = _idRetrying;
+    double score = _retryingScore;
+
+    if (WorkingSet::INVALID_ID == wsid) {
+        if (!_nextSpilledScore) {
+            if (!_spilledScoreIterator->more()) {
+                _internalState = State::kDone;
+                return PlanStage::IS_EOF;
+            }
+            _nextSpilledScore.reset(new ScoreSorter::Data(_spilledScoreIterator->next()));
+        }
+
+        // Sum the scores of the next RecordId, which the sorter returns together.
+        const RecordId loc = _nextSpilledScore->first;
+        score = _nextSpilledScore->second.score;
+        bool rejected = score < 0;
+        _nextSpilledScore.reset();
+        while (_spilledScoreIterator->more()) {
+            ScoreSorter::Data next = _spilledScoreIterator->next();
+            if (next.first != loc) {
+                _nextSpilledScore.reset(new ScoreSorter::Data(next));
+                break;
+            }
+            rejected = rejected || next.second.score < 0;
+            score += next.second.score;
+        }
+
+        if (rejected || _invalidatedSpilled.count(loc)) {
+            return PlanStage::NEED_TIME;
+        }
+
+        wsid = _ws->allocate();
+        WorkingSetMember* wsm = _ws->get(wsid);
+        wsm->loc = loc;
+        _ws->transitionToLocAndIdx(wsid);
+    } else {
+        _idRetrying = WorkingSet::INVALID_ID;
+        if (_invalidatedSpilled.count(_ws->get(wsid)->loc)) {
+            _ws->free(wsid);
+            return PlanStage::NEED_TIME;
+        }
     }
 
-    keyIt.next();  // Skip past 'term'.
+    if (_filter) {
+        // Without index key data, the filter is applied to the fetched document.
+        bool shouldKeep;
+        try {
+            TextMatchableDocument tdoc(_txn, BSONObj(), BSONObj(), _ws, wsid, _recordCursor);
+            shouldKeep = _filter->matches(&tdoc);
+        } catch (const WriteConflictException& wce) {
+            _idRetrying = wsid;
+            _retryingScore = score;
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        } catch (const TextMatchableDocument::DocumentDeletedException&) {
+            shouldKeep = false;
+        }
 
-    BSONElement scoreElement = keyIt.next();
-    double documentTermScore = scoreElement.number();
+        if (!shouldKeep) {
+            ++_specificStats.fetches;
+            _ws->free(wsid);
+            return PlanStage::NEED_TIME;
+        }
+    }
 
-    // Aggregate relevance score, term keys.
-    *documentAggregateScore += documentTermScore;
-    return NEED_TIME;
+    WorkingSetMember* wsm = _ws->get(wsid);
+    wsm->addComputed(new TextScoreComputedData(score));
+    *out = wsid;
+    return PlanStage::ADVANCED;
 }
 
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
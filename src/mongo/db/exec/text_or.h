@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "mongo/db/catalog/collection.h"
@@ -37,6 +38,8 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
+#include "mongo/platform/unordered_set.h"
 
 namespace mongo {
 
@@ -53,6 +56,14 @@ class OperationContext;
  *
  * The WorkingSetMembers returned are in the LOC_AND_IDX state. If a filter is passed in, some
  * WorkingSetMembers may be returned in the LOC_AND_OBJ state.
+ *
+ * With a limit, only that many of the highest scoring documents are returned. The children are
+ * then read a key at a time in turn: as each reads its term's keys in decreasing order of score,
+ * the last score it read bounds what the documents not read yet can score on that term. Reading
+ * stops once no document can beat the top ones, and documents that can't are dropped as it goes.
+ *
+ * Without a limit, the scores are spilled to disk, and summed when returning the results, once
+ * they take more than internalQueryExecTextOrMaxMemoryBytes.
  */
 class TextOrStage final : public PlanStage {
 public:
@@ -73,14 +84,22 @@ public:
         kDone,
     };
 
+    /**
+     * If 'limit' is not 0, only that many of the highest scoring documents are returned. Every
+     * document returned must then reach the results, sorted by score.
+     */
     TextOrStage(OperationContext* txn,
                 const FTSSpec& ftsSpec,
                 WorkingSet* ws,
                 const MatchExpression* filter,
-                IndexDescriptor* index);
+                IndexDescriptor* index,
+                size_t limit);
     ~TextOrStage() final;
 
-    void addChild(unique_ptr<PlanStage> child);
+    /**
+     * Adds a child reading the index keys of 'term' in decreasing order of score.
+     */
+    void addChild(unique_ptr<PlanStage> child, const std::string& term);
 
     bool isEOF() final;
 
@@ -128,6 +147,42 @@ private:
      */
     StageState returnResults(WorkingSetID* out);
 
+    /**
+     * Worker for kReturningResults once the scores were spilled. Sums the scores of the next
+     * RecordId and applies the filter to it.
+     */
+    StageState returnSpilledResults(WorkingSetID* out);
+
+    /**
+     * Returns the score of the term in the text index key 'keyData'.
+     */
+    double getTermScore(const BSONObj& keyData) const;
+
+    struct TextRecordData;
+
+    /**
+     * Returns the most the document with 'data' can score, given the terms it was read for.
+     */
+    double getMaxScore(const TextRecordData& data) const;
+
+    /**
+     * Drops the documents which can't be among the 'limit' highest scoring ones. Returns true if
+     * those are known, in which case only they are kept.
+     */
+    bool selectTopDocuments();
+
+    /**
+     * Computes the score of a top scoring document not read for all terms, which needs fetching
+     * it. Returns NEED_YIELD if the fetch must be retried, NEED_TIME if the document was deleted
+     * and IS_EOF once the score is complete.
+     */
+    StageState completeScore(TextRecordData* textRecordData, WorkingSetID* out);
+
+    /**
+     * Moves the scores read so far to a Sorter, and frees their working set members.
+     */
+    void spillScores();
+
     // The index spec used to determine where to find the score.
     FTSSpec _ftsSpec;
 
@@ -140,23 +195,86 @@ private:
     // Children owned by us.
     vector<unique_ptr<PlanStage>> _children;
 
+    // The term each of _children reads.
+    vector<std::string> _terms;
+
     // Which of _children are we calling work(...) on now?
     size_t _currentChild = 0;
 
+    // How many of the highest scoring documents to return, or 0 for all of them. Cleared if
+    // there are too many children to keep track of which terms each document was read for.
+    size_t _limit;
+
+    // With a limit, the score of the last key read by each child, which no document not read by
+    // that child yet can beat on its term. 0 once the child is EOF.
+    vector<double> _maxTermScores;
+    vector<bool> _childEOF;
+    size_t _numChildrenEOF = 0;
+
+    // Index keys to read before checking again whether the top scoring documents are known.
+    size_t _keysBeforeCheck = 0;
+
     /**
      *  Temporary score data filled out by children.
      *  Maps from RecordID -> (aggregate score for doc, wsid).
      *  Map each buffered record id to this data.
      */
     struct TextRecordData {
-        TextRecordData() : wsid(WorkingSet::INVALID_ID), score(0.0) {}
+        TextRecordData() : wsid(WorkingSet::INVALID_ID), score(0.0), childrenRead(0) {}
         WorkingSetID wsid;
         double score;
+
+        // With a limit, bit i is set once _children[i] read this document.
+        uint64_t childrenRead;
     };
 
     typedef unordered_map<RecordId, TextRecordData, RecordId::Hasher> ScoreMap;
     ScoreMap _scores;
-    ScoreMap::const_iterator _scoreIterator;
+    ScoreMap::iterator _scoreIterator;
+
+    // Approximate memory used by _scores and their working set members.
+    size_t _memUsage = 0;
+
+    /**
+     * A score spilled to disk. Negative for a document rejected by the filter.
+     */
+    struct SpilledScore {
+        struct SorterDeserializeSettings {};
+
+        SpilledScore() : score(0) {}
+        explicit SpilledScore(double s) : score(s) {}
+
+        void serializeForSorter(BufBuilder& buf) const {
+            buf.appendNum(score);
+        }
+        static SpilledScore deserializeForSorter(BufReader& buf,
+                                                 const SorterDeserializeSettings&) {
+            return SpilledScore(buf.read<double>());
+        }
+        int memUsageForSorter() const {
+            return sizeof(SpilledScore);
+        }
+        SpilledScore getOwned() const {
+            return *this;
+        }
+
+        double score;
+    };
+
+    typedef Sorter<RecordId, SpilledScore> ScoreSorter;
+
+    // Set once the scores are spilled. The scores read after are added to it directly.
+    std::unique_ptr<ScoreSorter> _spilledScores;
+    std::unique_ptr<ScoreSorter::Iterator> _spilledScoreIterator;
+
+    // The first score of the next RecordId, read past the scores of the previous one.
+    std::unique_ptr<ScoreSorter::Data> _nextSpilledScore;
+
+    // Score of the spilled document in _idRetrying.
+    double _retryingScore = 0;
+
+    // RecordIds invalidated after their scores were spilled.
+    unordered_set<RecordId, RecordId::Hasher> _invalidatedSpilled;
 
     // Stats
     CommonStats _commonStats;
@@ -42,4 +42,10 @@ Timestamp getLastSetTimestamp();
  * Generates a new and unique Timestamp.
  */
 Timestamp getNextGlobalTimestamp();
+
+/**
+ * Reserves 'count' consecutive Timestamps in a single step and returns the first of them. The
+ * others follow it by incrementing the inc field, all within the same second.
+ */
+Timestamp getNextGlobalTimestamps(unsigned count);
 }
@@ -34,35 +34,75 @@
 
 #include "mongo/db/hasher.h"
 
+#include <third_party/murmurhash3/MurmurHash3.h>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/util/startup_test.h"
 
 namespace mongo {
 
-using std::unique_ptr;
 
-Hasher::Hasher(HashSeed seed) : _seed(seed) {
+MD5Hasher::MD5Hasher(HashSeed seed) : _seed(seed) {
     md5_init(&_md5State);
     md5_append(&_md5State, reinterpret_cast<const md5_byte_t*>(&_seed), sizeof(_seed));
 }
 
-void Hasher::addData(const void* keyData, size_t numBytes) {
+void MD5Hasher::addData(const void* keyData, size_t numBytes) {
     md5_append(&_md5State, static_cast<const md5_byte_t*>(keyData), numBytes);
 }
 
-void Hasher::finish(HashDigest out) {
+void MD5Hasher::finish(HashDigest out) {
     md5_finish(&_md5State, out);
 }
 
-long long int BSONElementHasher::hash64(const BSONElement& e, HashSeed seed) {
-    unique_ptr<Hasher> h(HasherFactory::createHasher(seed));
-    recursiveHash(h.get(), e, false);
-    HashDigest d;
-    h->finish(d);
+Murmur3Hasher::Murmur3Hasher(HashSeed seed) : _seed(seed) {}
+
+void Murmur3Hasher::addData(const void* keyData, size_t numBytes) {
+    _data.appendBuf(keyData, numBytes);
+}
+
+void Murmur3Hasher::finish(HashDigest out) {
+    MurmurHash3_x64_128(_data.buf(), _data.len(), static_cast<uint32_t>(_seed), out);
+}
+
+Hasher* HasherFactory::createHasher(HashSeed seed, int hashVersion) {
+    switch (hashVersion) {
+        case BSONElementHasher::MD5_HASH_VERSION:
+            return new MD5Hasher(seed);
+        case BSONElementHasher::MURMUR3_HASH_VERSION:
+            return new Murmur3Hasher(seed);
+    }
+    invariant(false);
+    return NULL;
+}
+
+namespace {
+long long int digestTo64(const HashDigest d) {
     // HashDigest is actually 16 bytes, but we just get 8 via truncation
     // NOTE: assumes little-endian
-    return *reinterpret_cast<long long int*>(d);
+    return *reinterpret_cast<const long long int*>(d);
+}
+}  // namespace
+
+long long int BSONElementHasher::hash64(const BSONElement& e, HashSeed seed) {
+    return hash64(e, seed, MD5_HASH_VERSION);
+}
+
+long long int BSONElementHasher::hash64(const BSONElement& e, HashSeed seed, int hashVersion) {
+    // Hashers live on the stack here, as this is called for every key of a hashed index and
+    // for every targeting of a hashed shard key.
+    HashDigest d;
+    if (hashVersion == MURMUR3_HASH_VERSION) {
+        Murmur3Hasher h(seed);
+        recursiveHash(&h, e, false);
+        h.finish(d);
+    } else {
+        invariant(hashVersion == MD5_HASH_VERSION);
+        MD5Hasher h(seed);
+        recursiveHash(&h, e, false);
+        h.finish(d);
+    }
+    return digestTo64(d);
 }
 
 void BSONElementHasher::recursiveHash(Hasher* h, const BSONElement& e, bool includeFieldName) {
@@ -107,6 +147,11 @@ struct HasherUnitTest : public StartupTest {
         // Hard-coded check to ensure the hash function is consistent across platforms
         BSONObj o = BSON("check" << 42);
         verify(BSONElementHasher::hash64(o.firstElement(), 0) == -944302157085130861LL);
+        verify(BSONElementHasher::hash64(o.firstElement(), 0, BSONElementHasher::MD5_HASH_VERSION) ==
+               -944302157085130861LL);
+        verify(BSONElementHasher::hash64(
+                   o.firstElement(), 0, BSONElementHasher::MURMUR3_HASH_VERSION) ==
+               8715208212397937794LL);
     }
 } hasherUnitTest;
 }
@@ -37,6 +37,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/bson/bsonelement.h"
+#include "mongo/bson/util/builder.h"
 #include "mongo/util/md5.hpp"
 
 namespace mongo {
@@ -48,31 +49,59 @@ class Hasher {
     MONGO_DISALLOW_COPYING(Hasher);
 
 public:
-    explicit Hasher(HashSeed seed);
-    ~Hasher(){};
+    virtual ~Hasher() {}
 
     // pointer to next part of input key, length in bytes to read
-    void addData(const void* keyData, size_t numBytes);
+    virtual void addData(const void* keyData, size_t numBytes) = 0;
 
     // finish computing the hash, put the result in the digest
     // only call this once per Hasher
-    void finish(HashDigest out);
+    virtual void finish(HashDigest out) = 0;
+
+protected:
+    Hasher() = default;
+};
+
+/**
+ * Hash version 0: MD5 over the seed followed by the data.
+ */
+class MD5Hasher final : public Hasher {
+public:
+    explicit MD5Hasher(HashSeed seed);
+
+    void addData(const void* keyData, size_t numBytes) final;
+    void finish(HashDigest out) final;
 
 private:
     md5_state_t _md5State;
     HashSeed _seed;
 };
 
+/**
+ * Hash version 1: 128-bit x64 MurmurHash3 of the data, seeded with the seed. MurmurHash3 isn't
+ * incremental, so the data is gathered up until finish().
+ */
+class Murmur3Hasher final : public Hasher {
+public:
+    explicit Murmur3Hasher(HashSeed seed);
+
+    void addData(const void* keyData, size_t numBytes) final;
+    void finish(HashDigest out) final;
+
+private:
+    StackBufBuilder _data;
+    HashSeed _seed;
+};
+
 class HasherFactory {
     MONGO_DISALLOW_COPYING(HasherFactory);
 
 public:
-    /* Eventually this may be a more sophisticated factory
-     * for creating other hashers, but for now use MD5.
+    /**
+     * Creates a hasher for the given hash version, which must be supported (see
+     * BSONElementHasher::isSupportedHashVersion).
      */
-    static Hasher* createHasher(HashSeed seed) {
-        return new Hasher(seed);
-    }
+    static Hasher* createHasher(HashSeed seed, int hashVersion = 0);
 
 private:
     HasherFactory();
@@ -91,6 +120,24 @@ public:
      */
     static const int DEFAULT_HASH_SEED = 0;
 
+    /* Versions of the hash function, as stored in the "hashVersion" field of hashed index
+     * specs. Indexes without a "hashVersion" use MD5_HASH_VERSION.
+     *
+     * WARNING: never change what an existing version computes. Hashed indexes and hashed
+     * shard keys on disk depend on it.
+     *
+     * Hashed shard keys always use MD5_HASH_VERSION. The sharded collection metadata does not
+     * record a hash version, so every mongos and shard, including ones of older versions, hashes
+     * shard key values with MD5 when targeting, filtering and splitting. shardCollection refuses
+     * other versions, and IndexCatalog::findShardKeyPrefixedIndex never returns such an index.
+     */
+    static const int MD5_HASH_VERSION = 0;
+    static const int MURMUR3_HASH_VERSION = 1;
+
+    static bool isSupportedHashVersion(int hashVersion) {
+        return hashVersion == MD5_HASH_VERSION || hashVersion == MURMUR3_HASH_VERSION;
+    }
+
     /* This computes a 64-bit hash of the value part of BSONElement "e",
      * preceded by the seed "seed".  Squashes element (and any sub-elements)
      * of the same canonical type, so hash({a:{b:4}}) will be the same
@@ -105,6 +152,10 @@ public:
      */
     static long long int hash64(const BSONElement& e, HashSeed seed);
 
+    /* Same as above, using the hash function of the given, supported, hash version.
+     */
+    static long long int hash64(const BSONElement& e, HashSeed seed, int hashVersion);
+
     /* This incrementally computes the hash of BSONElement "e"
      * using hash function "h".  If "includeFieldName" is true,
      * then the name of the field is hashed in between the type of
@@ -356,5 +356,59 @@ TEST(BSONElementHasher, HashCodeWScope) {
     ASSERT_EQUALS(hashIt(o), 501342939894575968LL);
 }
 
+long long murmurHashIt(const BSONObj& object, int seed = 0) {
+    return BSONElementHasher::hash64(
+        object.firstElement(), seed, BSONElementHasher::MURMUR3_HASH_VERSION);
+}
+
+TEST(BSONElementHasher, SupportedHashVersions) {
+    ASSERT(BSONElementHasher::isSupportedHashVersion(BSONElementHasher::MD5_HASH_VERSION));
+    ASSERT(BSONElementHasher::isSupportedHashVersion(BSONElementHasher::MURMUR3_HASH_VERSION));
+    ASSERT(!BSONElementHasher::isSupportedHashVersion(-1));
+    ASSERT(!BSONElementHasher::isSupportedHashVersion(2));
+}
+
+TEST(BSONElementHasher, DefaultHashVersionIsMD5) {
+    BSONObj o = BSON("check" << 42);
+    ASSERT_EQUALS(hashIt(o),
+                  BSONElementHasher::hash64(
+                      o.firstElement(), 0, BSONElementHasher::MD5_HASH_VERSION));
+    ASSERT_NOT_EQUALS(hashIt(o), murmurHashIt(o));
+}
+
+TEST(BSONElementHasher, Murmur3HashIsStable) {
+    // Hashed indexes of version 1 store these values on disk, so they must never change.
+    ASSERT_EQUALS(murmurHashIt(BSON("check" << 42)), 8715208212397937794LL);
+    ASSERT_EQUALS(murmurHashIt(BSON("check" << 42), 1), -9087602108468514688LL);
+    ASSERT_EQUALS(murmurHashIt(BSON("check"
+                                    << "abc")),
+                  1087612813366940559LL);
+    ASSERT_EQUALS(murmurHashIt(BSON("check" << OID("010203040506070809101112"))),
+                  678198950576308690LL);
+}
+
+TEST(BSONElementHasher, Murmur3SquashesNumericTypes) {
+    const long long intHash = murmurHashIt(BSON("a" << 3));
+    ASSERT_EQUALS(intHash, murmurHashIt(BSON("a" << 3LL)));
+    ASSERT_EQUALS(intHash, murmurHashIt(BSON("a" << 3.1)));
+    ASSERT_NOT_EQUALS(intHash, murmurHashIt(BSON("a" << 4)));
+    ASSERT_NOT_EQUALS(intHash, murmurHashIt(BSON("a" << 3), 1));
+
+    // Same for numbers nested in sub-documents.
+    ASSERT_EQUALS(murmurHashIt(BSON("a" << BSON("b" << 4))),
+                  murmurHashIt(BSON("a" << BSON("b" << 4.1))));
+}
+
+TEST(BSONElementHasher, Murmur3HashesLargeDocuments) {
+    // Larger than the hasher's stack buffer.
+    BSONObjBuilder builder;
+    for (int i = 0; i < 1000; i++) {
+        builder.append(BSONObjBuilder::numStr(i), i);
+    }
+    BSONObj big = BSON("check" << builder.obj());
+    ASSERT_EQUALS(murmurHashIt(big), murmurHashIt(big.copy()));
+    ASSERT_NOT_EQUALS(murmurHashIt(big), murmurHashIt(BSON("check" << BSONObj())));
+}
+
 }  // namespace
 }  // namespace mongo
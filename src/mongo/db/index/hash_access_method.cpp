@@ -47,6 +47,13 @@ HashAccessMethod::HashAccessMethod(IndexCatalogEntry* btreeState, SortedDataInte
             !descriptor->unique());
 
     ExpressionParams::parseHashParams(descriptor->infoObj(), &_seed, &_hashVersion, &_hashedField);
+
+    uassert(28730,
+            str::stream() << "Unsupported hashVersion " << _hashVersion << " for hashed index. "
+                          << "Supported versions are " << BSONElementHasher::MD5_HASH_VERSION
+                          << " (MD5, the default) and " << BSONElementHasher::MURMUR3_HASH_VERSION
+                          << " (MurmurHash3).",
+            BSONElementHasher::isSupportedHashVersion(_hashVersion));
 }
 
 void HashAccessMethod::getKeys(const BSONObj& obj, BSONObjSet* keys) const {
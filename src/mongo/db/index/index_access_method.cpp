@@ -55,6 +55,14 @@ using std::vector;
 
 MONGO_EXPORT_SERVER_PARAMETER(failIndexKeyTooLong, bool, true);
 
+// Number of threads that sort and spill the keys of a foreground index build. 1 sorts on the
+// thread building the index.
+MONGO_EXPORT_SERVER_PARAMETER(internalIndexBuildSortThreads, int, 1);
+
+// Do bulk builds encode keys as KeyStrings before sorting them, when the storage engine accepts
+// them?
+MONGO_EXPORT_SERVER_PARAMETER(internalIndexBuildSortKeyStrings, bool, true);
+
 //
 // Comparison for external sorter interface
 //
@@ -86,6 +94,18 @@ private:
     const int _version;
 };
 
+/**
+ * Orders encoded keys, which already end with their RecordId.
+ */
+class KeyStringSortComparison {
+public:
+    typedef std::pair<SortableKeyString, RecordId> Data;
+
+    int operator()(const Data& l, const Data& r) const {
+        return l.first.compare(r.first);
+    }
+};
+
 IndexAccessMethod::IndexAccessMethod(IndexCatalogEntry* btreeState, SortedDataInterface* btree)
     : _btreeState(btreeState), _descriptor(btreeState->descriptor()), _newInterface(btree) {
     verify(0 == _descriptor->version() || 1 == _descriptor->version());
@@ -319,18 +339,28 @@ Status IndexAccessMethod::update(OperationContext* txn,
 }
 
 std::unique_ptr<IndexAccessMethod::BulkBuilder> IndexAccessMethod::initiateBulk() {
-    return std::unique_ptr<BulkBuilder>(new BulkBuilder(this, _descriptor));
+    const bool sortKeyStrings =
+        internalIndexBuildSortKeyStrings && _newInterface->bulkBuilderAcceptsKeyStrings();
+    return std::unique_ptr<BulkBuilder>(new BulkBuilder(this, _descriptor, sortKeyStrings));
 }
 
 IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
-                                            const IndexDescriptor* descriptor)
-    : _sorter(Sorter::make(
-          SortOptions()
-              .TempDir(storageGlobalParams.dbpath + "/_tmp")
-              .ExtSortAllowed()
-              .MaxMemoryUsageBytes(100 * 1024 * 1024),
-          BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
-      _real(index) {}
+                                            const IndexDescriptor* descriptor,
+                                            bool sortKeyStrings)
+    : _ordering(Ordering::make(descriptor->keyPattern())), _real(index) {
+    const SortOptions options = SortOptions()
+                                    .TempDir(storageGlobalParams.dbpath + "/_tmp")
+                                    .ExtSortAllowed()
+                                    .MaxMemoryUsageBytes(100 * 1024 * 1024)
+                                    .NumThreads(std::max(internalIndexBuildSortThreads, 1));
+    if (sortKeyStrings) {
+        _keyStringSorter.reset(KeyStringSorter::make(options, KeyStringSortComparison()));
+    } else {
+        _sorter.reset(Sorter::make(
+            options,
+            BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version())));
+    }
+}
 
 Status IndexAccessMethod::BulkBuilder::insert(OperationContext* txn,
                                               const BSONObj& obj,
@@ -343,7 +373,14 @@ Status IndexAccessMethod::BulkBuilder::insert(OperationContext* txn,
     _isMultiKey = _isMultiKey || (keys.size() > 1);
 
     for (BSONObjSet::iterator it = keys.begin(); it != keys.end(); ++it) {
-        _sorter->add(*it, loc);
+        if (_keyStringSorter) {
+            // Encode the key once, here: the sort compares the encoded bytes, and the storage
+            // engine stores them as they are.
+            _keyStringSorter->add(SortableKeyString(KeyString(*it, _ordering, loc), it->objsize()),
+                                  loc);
+        } else {
+            _sorter->add(*it, loc);
+        }
         _keysInserted++;
     }
 
@@ -362,7 +399,13 @@ Status IndexAccessMethod::commitBulk(OperationContext* txn,
                                      set<RecordId>* dupsToDrop) {
     Timer timer;
 
-    std::unique_ptr<BulkBuilder::Sorter::Iterator> i(bulk->_sorter->done());
+    std::unique_ptr<BulkBuilder::Sorter::Iterator> i;
+    std::unique_ptr<BulkBuilder::KeyStringSorter::Iterator> keyStringIt;
+    if (bulk->_keyStringSorter) {
+        keyStringIt.reset(bulk->_keyStringSorter->done());
+    } else {
+        i.reset(bulk->_sorter->done());
+    }
 
     stdx::unique_lock<Client> lk(*txn->getClient());
     ProgressMeterHolder pm(*txn->setMessage_inlock("Index Bulk Build: (2/3) btree bottom up",
@@ -385,21 +428,38 @@ Status IndexAccessMethod::commitBulk(OperationContext* txn,
     }
     MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "setting index multikey flag", "");
 
-    while (i->more()) {
+    // A bulk loading builder writes outside of our transaction, so there is nothing for a
+    // per-key WriteUnitOfWork to do.
+    const bool useUnitOfWorkPerKey = !builder->isBulkLoading();
+
+    while (keyStringIt ? keyStringIt->more() : i->more()) {
         if (mayInterrupt) {
             txn->checkForInterrupt();
         }
 
-        WriteUnitOfWork wunit(txn);
-        // Improve performance in the btree-building phase by disabling rollback tracking.
-        // This avoids copying all the written bytes to a buffer that is only used to roll back.
-        // Note that this is safe to do, as this entire index-build-in-progress will be cleaned
-        // up by the index system.
-        txn->recoveryUnit()->setRollbackWritesDisabled();
+        std::unique_ptr<WriteUnitOfWork> wunit;
+        if (useUnitOfWorkPerKey) {
+            wunit.reset(new WriteUnitOfWork(txn));
+            // Improve performance in the btree-building phase by disabling rollback tracking.
+            // This avoids copying all the written bytes to a buffer that is only used to roll
+            // back. Note that this is safe to do, as this entire index-build-in-progress will be
+            // cleaned up by the index system.
+            txn->recoveryUnit()->setRollbackWritesDisabled();
+        }
 
         // Get the next datum and add it to the builder.
-        BulkBuilder::Sorter::Data d = i->next();
-        Status status = builder->addKey(d.first, d.second);
+        RecordId loc;
+        Status status = Status::OK();
+        if (keyStringIt) {
+            BulkBuilder::KeyStringSorter::Data d = keyStringIt->next();
+            loc = d.second;
+            status = builder->addKeyString(
+                d.first.getKey(), d.first.getTypeBits(), d.second, d.first.getBsonSize());
+        } else {
+            BulkBuilder::Sorter::Data d = i->next();
+            loc = d.second;
+            status = builder->addKey(d.first, d.second);
+        }
 
         if (!status.isOK()) {
             // Overlong key that's OK to skip?
@@ -412,7 +472,7 @@ Status IndexAccessMethod::commitBulk(OperationContext* txn,
                 invariant(!dupsAllowed);  // shouldn't be getting DupKey errors if dupsAllowed.
 
                 if (dupsToDrop) {
-                    dupsToDrop->insert(d.second);
+                    dupsToDrop->insert(loc);
                     continue;
                 }
             }
@@ -423,7 +483,9 @@ Status IndexAccessMethod::commitBulk(OperationContext* txn,
         // If we're here either it's a dup and we're cool with it or the addKey went just
         // fine.
         pm.hit();
-        wunit.commit();
+        if (wunit) {
+            wunit->commit();
+        }
     }
 
     pm.finished();
@@ -444,3 +506,4 @@ Status IndexAccessMethod::commitBulk(OperationContext* txn,
 
 #include "mongo/db/sorter/sorter.cpp"
 MONGO_CREATE_SORTER(mongo::BSONObj, mongo::RecordId, mongo::BtreeExternalSortComparison);
+MONGO_CREATE_SORTER(mongo::SortableKeyString, mongo::RecordId, mongo::KeyStringSortComparison);
@@ -32,6 +32,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index/sortable_key_string.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/record_id.h"
@@ -197,10 +198,17 @@ public:
         friend class IndexAccessMethod;
 
         using Sorter = mongo::Sorter<BSONObj, RecordId>;
+        using KeyStringSorter = mongo::Sorter<SortableKeyString, RecordId>;
 
-        BulkBuilder(const IndexAccessMethod* index, const IndexDescriptor* descriptor);
+        BulkBuilder(const IndexAccessMethod* index,
+                    const IndexDescriptor* descriptor,
+                    bool sortKeyStrings);
 
+        // Exactly one of the sorters is set. Keys are encoded and sorted as KeyStrings when the
+        // index's bulk builder accepts them.
         std::unique_ptr<Sorter> _sorter;
+        std::unique_ptr<KeyStringSorter> _keyStringSorter;
+        const Ordering _ordering;
         const IndexAccessMethod* _real;
         int64_t _keysInserted = 0;
         bool _isMultiKey = false;
@@ -0,0 +1,126 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/util/builder.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/util/bufreader.h"
+
+namespace mongo {
+
+/**
+ * An index key as the Sorter sees it during a bulk index build when the index accepts encoded
+ * keys: the KeyString of the key followed by its RecordId, and the TypeBits of the key.
+ *
+ * Since KeyStrings order like the keys they encode, these compare with memcmp, in index order
+ * and then RecordId order, and are handed as they are to the storage engine's bulk builder.
+ */
+class SortableKeyString {
+public:
+    SortableKeyString() : _keySize(0), _bsonSize(0) {}
+
+    /**
+     * 'key' must end with a RecordId. 'bsonSize' is the size of the key as a BSONObj.
+     */
+    SortableKeyString(const KeyString& key, int bsonSize)
+        : _data(key.getBuffer(), key.getSize()), _keySize(key.getSize()), _bsonSize(bsonSize) {
+        const KeyString::TypeBits& typeBits = key.getTypeBits();
+        if (!typeBits.isAllZeros()) {
+            _data.append(reinterpret_cast<const char*>(typeBits.getBuffer()), typeBits.getSize());
+        }
+    }
+
+    /**
+     * The encoded key, followed by its RecordId.
+     */
+    StringData getKey() const {
+        return StringData(_data.data(), _keySize);
+    }
+
+    KeyString::TypeBits getTypeBits() const {
+        BufReader reader(_data.data() + _keySize, _data.size() - _keySize);
+        return KeyString::TypeBits::fromBuffer(&reader);
+    }
+
+    int getBsonSize() const {
+        return _bsonSize;
+    }
+
+    int compare(const SortableKeyString& other) const {
+        const int cmp =
+            memcmp(_data.data(), other._data.data(), std::min(_keySize, other._keySize));
+        if (cmp) {
+            return cmp;
+        }
+        return static_cast<int>(_keySize) - static_cast<int>(other._keySize);
+    }
+
+    //
+    // Sorter support
+    //
+
+    struct SorterDeserializeSettings {};
+
+    void serializeForSorter(BufBuilder& buf) const {
+        buf.appendNum(static_cast<int>(_data.size()));
+        buf.appendNum(static_cast<int>(_keySize));
+        buf.appendNum(_bsonSize);
+        buf.appendBuf(_data.data(), _data.size());
+    }
+
+    static SortableKeyString deserializeForSorter(BufReader& buf,
+                                                  const SorterDeserializeSettings&) {
+        SortableKeyString out;
+        const int dataSize = buf.read<int>();
+        out._keySize = buf.read<int>();
+        out._bsonSize = buf.read<int>();
+        out._data.assign(static_cast<const char*>(buf.skip(dataSize)), dataSize);
+        return out;
+    }
+
+    int memUsageForSorter() const {
+        return sizeof(SortableKeyString) + _data.size();
+    }
+
+    SortableKeyString getOwned() const {
+        return *this;
+    }
+
+private:
+    std::string _data;  // The key, its RecordId and its TypeBits unless they are all zeros.
+    size_t _keySize;    // Size of the key and RecordId in '_data'.
+    int _bsonSize;
+};
+
+}  // namespace mongo
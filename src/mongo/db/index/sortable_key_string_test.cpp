@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/sortable_key_string.h"
+
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+using std::vector;
+
+const BSONObj kKeyPattern = BSON("a" << 1 << "b" << -1);
+
+BSONObj decode(const SortableKeyString& key) {
+    const StringData bytes = key.getKey();
+    const size_t keySize = KeyString::sizeWithoutRecordIdAtEnd(bytes.rawData(), bytes.size());
+    return KeyString::toBson(
+        bytes.rawData(), keySize, Ordering::make(kKeyPattern), key.getTypeBits());
+}
+
+TEST(SortableKeyStringTest, OrdersLikeIndex) {
+    const Ordering ordering = Ordering::make(kKeyPattern);
+    vector<BSONObj> keys = {BSON("" << 1 << "" << 2),
+                            BSON("" << 1.5 << "" << 2),
+                            BSON("" << 1 << "" << "x"),
+                            BSON("" << 1 << "" << 3),
+                            BSON("" << -4 << "" << BSONNULL),
+                            BSON("" << "abc" << "" << 2),
+                            BSON("" << 2LL << "" << 2)};
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        for (size_t j = 0; j < keys.size(); ++j) {
+            for (long long li = 1; li <= 2; ++li) {
+                for (long long lj = 1; lj <= 2; ++lj) {
+                    const SortableKeyString left(KeyString(keys[i], ordering, RecordId(li)), 0);
+                    const SortableKeyString right(KeyString(keys[j], ordering, RecordId(lj)), 0);
+
+                    int expected = keys[i].woCompare(keys[j], ordering, false);
+                    if (0 == expected) {
+                        expected = RecordId(li).compare(RecordId(lj));
+                    }
+
+                    const int actual = left.compare(right);
+                    ASSERT_EQUALS(expected < 0, actual < 0);
+                    ASSERT_EQUALS(expected == 0, actual == 0);
+                }
+            }
+        }
+    }
+}
+
+TEST(SortableKeyStringTest, KeepsTypes) {
+    const Ordering ordering = Ordering::make(kKeyPattern);
+    const BSONObj key = BSON("" << 1.0 << "" << 5LL);
+    const SortableKeyString sortable(KeyString(key, ordering, RecordId(3)), key.objsize());
+
+    ASSERT_FALSE(sortable.getTypeBits().isAllZeros());
+    ASSERT_EQUALS(key.objsize(), sortable.getBsonSize());
+    BSONObjIterator decoded(decode(sortable));
+    ASSERT_EQUALS(NumberDouble, decoded.next().type());
+    ASSERT_EQUALS(NumberLong, decoded.next().type());
+}
+
+TEST(SortableKeyStringTest, SerializesForSorter) {
+    const Ordering ordering = Ordering::make(kKeyPattern);
+    const BSONObj key = BSON("" << 7 << "" << 2.5);
+    const SortableKeyString sortable(KeyString(key, ordering, RecordId(42)), key.objsize());
+
+    BufBuilder buf;
+    sortable.serializeForSorter(buf);
+    BufReader reader(buf.buf(), buf.len());
+    const SortableKeyString roundTripped = SortableKeyString::deserializeForSorter(
+        reader, SortableKeyString::SorterDeserializeSettings());
+
+    ASSERT(reader.atEof());
+    ASSERT_EQUALS(0, sortable.compare(roundTripped));
+    ASSERT_EQUALS(key.objsize(), roundTripped.getBsonSize());
+    ASSERT_EQUALS(RecordId(42),
+                  KeyString::decodeRecordIdAtEnd(roundTripped.getKey().rawData(),
+                                                 roundTripped.getKey().size()));
+    ASSERT_EQUALS(key, decode(roundTripped));
+}
+
+}  // namespace
@@ -30,6 +30,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <fstream>
 #include <memory>
 
@@ -957,23 +958,77 @@ void checkAndInsert(OperationContext* txn,
     }
 }
 
+/**
+ * Inserts objs[begin, end) in a single WriteUnitOfWork. Returns false without having inserted
+ * anything if the group could not be committed as a whole, in which case the caller inserts the
+ * documents one at a time so that errors are reported against the right document.
+ */
+static bool insertMultiGroup(OperationContext* txn,
+                             OldClientContext& ctx,
+                             const char* ns,
+                             vector<BSONObj>& objs,
+                             size_t begin,
+                             size_t end) {
+    Collection* collection = ctx.db()->getCollection(ns);
+    if (!collection || collection->isCapped())
+        return false;
+
+    vector<BSONObj> fixedObjs;
+    fixedObjs.reserve(end - begin);
+    for (size_t i = begin; i < end; i++) {
+        StatusWith<BSONObj> fixed = fixDocumentForInsert(objs[i]);
+        if (!fixed.isOK())
+            return false;
+        fixedObjs.push_back(fixed.getValue().isEmpty() ? objs[i] : fixed.getValue());
+    }
+
+    try {
+        WriteUnitOfWork wunit(txn);
+        Status status =
+            collection->insertDocuments(txn, fixedObjs.begin(), fixedObjs.end(), true);
+        if (!status.isOK())
+            return false;
+        wunit.commit();
+    } catch (const WriteConflictException&) {
+        CurOp::get(txn)->debug().writeConflicts++;
+        txn->recoveryUnit()->abandonSnapshot();
+        return false;
+    } catch (const DBException& ex) {
+        if (ErrorCodes::isInterruption(ErrorCodes::fromInt(ex.getCode())))
+            throw;
+        return false;
+    }
+
+    std::copy(fixedObjs.begin(), fixedObjs.end(), objs.begin() + begin);
+    return true;
+}
+
 NOINLINE_DECL void insertMulti(OperationContext* txn,
                                OldClientContext& ctx,
                                bool keepGoing,
                                const char* ns,
                                vector<BSONObj>& objs,
                                CurOp& op) {
-    size_t i;
-    for (i = 0; i < objs.size(); i++) {
-        try {
-            checkAndInsert(txn, ctx, ns, objs[i]);
-        } catch (const UserException& ex) {
-            if (!keepGoing || i == objs.size() - 1) {
-                globalOpCounters.incInsertInWriteLock(i);
-                throw;
+    const size_t maxGroupSize = std::max(internalInsertMaxBatchSize, 1);
+    size_t i = 0;
+    while (i < objs.size()) {
+        const size_t groupEnd = std::min(objs.size(), i + maxGroupSize);
+        if (groupEnd - i > 1 && insertMultiGroup(txn, ctx, ns, objs, i, groupEnd)) {
+            i = groupEnd;
+            continue;
+        }
+
+        for (; i < groupEnd; i++) {
+            try {
+                checkAndInsert(txn, ctx, ns, objs[i]);
+            } catch (const UserException& ex) {
+                if (!keepGoing || i == objs.size() - 1) {
+                    globalOpCounters.incInsertInWriteLock(i);
+                    throw;
+                }
+                LastError::get(txn->getClient()).setLastError(ex.getCode(), ex.getInfo().msg);
+                // otherwise ignore and keep going
             }
-            LastError::get(txn->getClient()).setLastError(ex.getCode(), ex.getInfo().msg);
-            // otherwise ignore and keep going
         }
     }
 
@@ -0,0 +1,169 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/compiled_matcher.h"
+
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/matcher/matchable.h"
+
+namespace mongo {
+
+// static
+bool CompiledMatcher::isSingleFieldLeaf(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LTE:
+        case MatchExpression::LT:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::REGEX:
+        case MatchExpression::MOD:
+        case MatchExpression::EXISTS:
+        case MatchExpression::MATCH_IN: {
+            const StringData path = expr->path();
+            return !path.empty() && path.find('.') == std::string::npos;
+        }
+        default:
+            return false;
+    }
+}
+
+// static
+std::unique_ptr<CompiledMatcher> CompiledMatcher::compile(const MatchExpression* expr) {
+    if (!expr || expr->matchType() != MatchExpression::AND) {
+        return nullptr;
+    }
+
+    std::unique_ptr<CompiledMatcher> compiled(new CompiledMatcher());
+    size_t numLeaves = 0;
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        const MatchExpression* child = expr->getChild(i);
+        if (!isSingleFieldLeaf(child)) {
+            compiled->_residual.push_back(child);
+            continue;
+        }
+
+        const StringData fieldName = child->path();
+        size_t position;
+        StringMap<size_t>::const_iterator it = compiled->_fieldPositions.find(fieldName);
+        if (it != compiled->_fieldPositions.end()) {
+            position = it->second;
+        } else {
+            if (compiled->_fields.size() == kMaxFields) {
+                compiled->_residual.push_back(child);
+                continue;
+            }
+            position = compiled->_fields.size();
+            compiled->_fieldPositions[fieldName] = position;
+            compiled->_fields.push_back(FieldPredicates{{}, true});
+        }
+
+        const LeafMatchExpression* leaf = static_cast<const LeafMatchExpression*>(child);
+        FieldPredicates& predicates = compiled->_fields[position];
+        predicates.leaves.push_back(leaf);
+
+        // A path missing from the document produces a single EOO element.
+        if (predicates.matchesMissing && !leaf->matchesSingleElement(BSONElement())) {
+            predicates.matchesMissing = false;
+            compiled->_requiredFields |= uint64_t(1) << position;
+        }
+        ++numLeaves;
+    }
+
+    if (numLeaves < 2) {
+        // A single predicate scans the document once either way.
+        return nullptr;
+    }
+
+    return compiled;
+}
+
+// static
+bool CompiledMatcher::leafMatchesField(const LeafMatchExpression* leaf, const BSONElement& field) {
+    // Same elements as a BSONElementIterator over a single-component path: the field, or the
+    // elements of an array followed by the array itself.
+    if (field.type() == Array) {
+        BSONObjIterator it(field.embeddedObject());
+        while (it.more()) {
+            if (leaf->matchesSingleElement(it.next())) {
+                return true;
+            }
+        }
+    }
+
+    return leaf->matchesSingleElement(field);
+}
+
+bool CompiledMatcher::matchesBSON(const BSONObj& doc) const {
+    uint64_t seenFields = 0;
+    size_t numSeen = 0;
+
+    BSONObjIterator it(doc);
+    while (numSeen < _fields.size() && it.more()) {
+        const BSONElement field = it.next();
+        StringMap<size_t>::const_iterator position =
+            _fieldPositions.find(field.fieldNameStringData());
+        if (position == _fieldPositions.end()) {
+            continue;
+        }
+
+        // Like BSONObj::getField, only the first occurrence of a field name counts.
+        const uint64_t fieldBit = uint64_t(1) << position->second;
+        if (seenFields & fieldBit) {
+            continue;
+        }
+        seenFields |= fieldBit;
+        ++numSeen;
+
+        for (const LeafMatchExpression* leaf : _fields[position->second].leaves) {
+            if (!leafMatchesField(leaf, field)) {
+                return false;
+            }
+        }
+    }
+
+    if (_requiredFields & ~seenFields) {
+        return false;
+    }
+
+    if (!_residual.empty()) {
+        BSONMatchableDocument matchable(doc);
+        for (const MatchExpression* expr : _residual) {
+            if (!expr->matches(&matchable)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+}  // namespace mongo
@@ -0,0 +1,110 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+class LeafMatchExpression;
+class MatchExpression;
+
+/**
+ * Evaluates a conjunction of predicates over a BSON document in a single pass over its
+ * top-level fields.
+ *
+ * MatchExpression::matches walks the expression tree and each leaf looks its path up in the
+ * document again, so a $and of n predicates scans the document n times. The compiled form
+ * groups the leaves of the top-level $and that have a single-component path by field name.
+ * Each field of the document is then looked up once, and dispatched to every predicate on
+ * that field. Predicates on fields missing from the document are answered from a result
+ * computed at compile time. The children of the $and that do not qualify are evaluated with
+ * MatchExpression::matches once the single pass has succeeded.
+ *
+ * A compiled matcher points into the expression it was compiled from, which must outlive it.
+ */
+class CompiledMatcher {
+    MONGO_DISALLOW_COPYING(CompiledMatcher);
+
+public:
+    /**
+     * Returns the compiled form of 'expr', or nullptr if 'expr' would not benefit from it,
+     * i.e. it is not a $and with at least two single-field leaf predicates.
+     */
+    static std::unique_ptr<CompiledMatcher> compile(const MatchExpression* expr);
+
+    /**
+     * Returns true if 'doc' matches the expression this was compiled from.
+     */
+    bool matchesBSON(const BSONObj& doc) const;
+
+    /**
+     * Number of distinct top-level fields handled in the single pass. For testing.
+     */
+    size_t numFields() const {
+        return _fields.size();
+    }
+
+private:
+    CompiledMatcher() = default;
+
+    // All the predicates of the single pass on one top-level field.
+    struct FieldPredicates {
+        std::vector<const LeafMatchExpression*> leaves;
+
+        // Whether the predicates all match a document which does not have the field.
+        bool matchesMissing;
+    };
+
+    // At most one bit per field in a 64-bit mask of the fields seen during the pass.
+    static const size_t kMaxFields = 64;
+
+    static bool isSingleFieldLeaf(const MatchExpression* expr);
+
+    static bool leafMatchesField(const LeafMatchExpression* leaf, const BSONElement& field);
+
+    std::vector<FieldPredicates> _fields;
+
+    // Maps a top-level field name to its position in _fields.
+    StringMap<size_t> _fieldPositions;
+
+    // Bits of the fields whose predicates do not all match when the field is missing.
+    uint64_t _requiredFields = 0;
+
+    // Children of the $and that are evaluated after the single pass.
+    std::vector<const MatchExpression*> _residual;
+};
+
+}  // namespace mongo
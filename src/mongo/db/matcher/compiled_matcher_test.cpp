@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/compiled_matcher.h"
+
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Parses a query and compiles it. The BSONObj must outlive the MatchExpression, which must
+ * outlive the CompiledMatcher.
+ */
+class CompiledQuery {
+public:
+    CompiledQuery(const std::string& str) : _obj(fromjson(str)) {
+        StatusWithMatchExpression result = MatchExpressionParser::parse(_obj);
+        ASSERT_OK(result.getStatus());
+        _expr = std::move(result.getValue());
+        _compiled = CompiledMatcher::compile(_expr.get());
+    }
+
+    const CompiledMatcher* compiled() const {
+        return _compiled.get();
+    }
+
+    /**
+     * Asserts that the compiled matcher and the expression agree on every test document.
+     */
+    void assertSameMatches() const {
+        ASSERT(_compiled);
+
+        const char* docs[] = {"{}",
+                              "{a: 1}",
+                              "{a: 5, b: 'x'}",
+                              "{a: 5, b: 'xyz', c: 3}",
+                              "{b: 'xyz', a: 5, c: 3}",
+                              "{a: null, b: null}",
+                              "{a: [], b: []}",
+                              "{a: [1, 5, 10], b: ['x', 'y']}",
+                              "{a: [[5]], b: 'x'}",
+                              "{a: {x: 1}, b: 'x'}",
+                              "{a: 5, a: 100, b: 'x'}",
+                              "{a: 100, a: 5, b: 'x'}",
+                              "{a: 5, b: 'x', c: {d: 1}}",
+                              "{a: 5, b: 'x', c: {d: 2}}",
+                              "{a: 5, b: 'x', c: [{d: 1}]}",
+                              "{a: 7, b: 'abc', d: 4}"};
+
+        for (const char* docStr : docs) {
+            BSONObj doc = fromjson(docStr);
+            ASSERT_EQUALS(_expr->matchesBSON(doc), _compiled->matchesBSON(doc))
+                << "query: " << _obj << ", document: " << doc;
+        }
+    }
+
+private:
+    const BSONObj _obj;
+    std::unique_ptr<MatchExpression> _expr;
+    std::unique_ptr<CompiledMatcher> _compiled;
+};
+
+TEST(CompiledMatcher, NotCompiledWithoutSeveralLeaves) {
+    ASSERT_FALSE(CompiledQuery("{}").compiled());
+    ASSERT_FALSE(CompiledQuery("{a: 1}").compiled());
+    ASSERT_FALSE(CompiledQuery("{a: 1, 'b.c': 1}").compiled());
+    ASSERT_FALSE(CompiledQuery("{$or: [{a: 1}, {b: 1}]}").compiled());
+    ASSERT_FALSE(CompiledQuery("{a: {$elemMatch: {$gt: 1}}, b: {$size: 1}}").compiled());
+}
+
+TEST(CompiledMatcher, GroupsPredicatesByField) {
+    CompiledQuery query("{a: {$gt: 1, $lt: 10}, b: 'x', c: {$exists: true}}");
+    ASSERT(query.compiled());
+    ASSERT_EQUALS(3U, query.compiled()->numFields());
+}
+
+TEST(CompiledMatcher, Comparisons) {
+    CompiledQuery("{a: 5, b: 'x'}").assertSameMatches();
+    CompiledQuery("{a: {$gt: 1, $lt: 10}, b: {$gte: 'x'}}").assertSameMatches();
+    CompiledQuery("{a: {$lte: 5}, b: {$ne: 'x'}, c: {$gte: 3}}").assertSameMatches();
+    CompiledQuery("{a: [5], b: 'x'}").assertSameMatches();
+    CompiledQuery("{a: [1, 5, 10], b: ['x', 'y']}").assertSameMatches();
+}
+
+TEST(CompiledMatcher, MissingFields) {
+    CompiledQuery("{a: null, b: null}").assertSameMatches();
+    CompiledQuery("{a: 5, d: null}").assertSameMatches();
+    CompiledQuery("{a: {$exists: true}, b: {$exists: true}, d: {$exists: false}}")
+        .assertSameMatches();
+    CompiledQuery("{a: {$exists: false}, b: {$exists: true}, c: {$lt: 5}}").assertSameMatches();
+}
+
+TEST(CompiledMatcher, OtherLeaves) {
+    CompiledQuery("{a: {$in: [1, 5]}, b: {$in: [/^x/, null]}}").assertSameMatches();
+    CompiledQuery("{a: {$nin: [5]}, b: /y/, c: 3}").assertSameMatches();
+    CompiledQuery("{a: {$mod: [5, 0]}, b: {$regex: '^X', $options: 'i'}}").assertSameMatches();
+}
+
+TEST(CompiledMatcher, ResidualPredicates) {
+    CompiledQuery("{a: 5, b: 'x', 'c.d': 1}").assertSameMatches();
+    CompiledQuery("{a: 5, b: 'x', $or: [{c: 3}, {'c.d': 2}]}").assertSameMatches();
+    CompiledQuery("{a: {$gte: 5, $lt: 8}, b: {$type: 2}, c: {$elemMatch: {d: 1}}}")
+        .assertSameMatches();
+}
+
+}  // namespace
+}  // namespace mongo
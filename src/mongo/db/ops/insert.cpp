@@ -30,6 +30,7 @@
 
 #include "mongo/db/ops/insert.h"
 #include "mongo/db/global_timestamp.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -38,6 +39,8 @@ using std::string;
 
 using namespace mongoutils;
 
+MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize, int, 64);
+
 StatusWith<BSONObj> fixDocumentForInsert(const BSONObj& doc) {
     if (doc.objsize() > BSONObjMaxUserSize)
         return StatusWith<BSONObj>(ErrorCodes::BadValue,
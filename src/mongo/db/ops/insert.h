@@ -33,6 +33,12 @@
 
 namespace mongo {
 
+/**
+ * Maximum number of documents of an insert batch which are committed in a single
+ * WriteUnitOfWork. Setting this to 1 disables grouped inserts.
+ */
+extern int internalInsertMaxBatchSize;
+
 /**
  * if doc is ok, then return is BSONObj()
  * otherwise, BSONObj is what should be inserted instead
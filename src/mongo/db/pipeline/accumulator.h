@@ -49,6 +49,15 @@ public:
         processInternal(input, merging);
     }
 
+    /**
+     * Like process(), but takes an input straight out of a BSON document, with EOO standing for a
+     * missing value. Never merging. Accumulators that only care about a few types override this
+     * to avoid building a Value for every input.
+     */
+    virtual void processElement(const BSONElement& input) {
+        processInternal(Value(input), false);
+    }
+
     /** Marks the end of the evaluate() phase and return accumulated result.
      *  toBeMerged should be true when the outputs will be merged by process().
      */
@@ -65,6 +74,18 @@ public:
     /// Reset this accumulator to a fresh state ready to receive input.
     virtual void reset() = 0;
 
+    /// Number of bytes needed to hold an accumulator of this kind. See createInPlace().
+    virtual size_t allocSize() const = 0;
+
+    /**
+     * Constructs a fresh accumulator of the same kind as this one in the memory at 'where', which
+     * must be at least allocSize() bytes and aligned for any type. This lets callers that need many
+     * accumulators, such as $group, place them in memory they manage themselves. The returned
+     * object must be destroyed by calling its destructor directly and never be handed to an
+     * intrusive_ptr.
+     */
+    virtual Accumulator* createInPlace(void* where) const = 0;
+
 protected:
     /// Update subclass's internal state based on input
     virtual void processInternal(const Value& input, bool merging) = 0;
@@ -82,6 +103,8 @@ public:
     Value getValue(bool toBeMerged) const final;
     const char* getOpName() const final;
     void reset() final;
+    size_t allocSize() const final;
+    Accumulator* createInPlace(void* where) const final;
 
     static boost::intrusive_ptr<Accumulator> create();
 
@@ -99,6 +122,8 @@ public:
     Value getValue(bool toBeMerged) const final;
     const char* getOpName() const final;
     void reset() final;
+    size_t allocSize() const final;
+    Accumulator* createInPlace(void* where) const final;
 
     static boost::intrusive_ptr<Accumulator> create();
 
@@ -116,6 +141,8 @@ public:
     Value getValue(bool toBeMerged) const final;
     const char* getOpName() const final;
     void reset() final;
+    size_t allocSize() const final;
+    Accumulator* createInPlace(void* where) const final;
 
     static boost::intrusive_ptr<Accumulator> create();
 
@@ -129,9 +156,12 @@ public:
     AccumulatorSum();
 
     void processInternal(const Value& input, bool merging) final;
+    void processElement(const BSONElement& input) final;
     Value getValue(bool toBeMerged) const final;
     const char* getOpName() const final;
     void reset() final;
+    size_t allocSize() const final;
+    Accumulator* createInPlace(void* where) const final;
 
     static boost::intrusive_ptr<Accumulator> create();
 
@@ -155,6 +185,8 @@ public:
     Value getValue(bool toBeMerged) const final;
     const char* getOpName() const final;
     void reset() final;
+    size_t allocSize() const final;
+    Accumulator* createInPlace(void* where) const final;
 
     static boost::intrusive_ptr<Accumulator> createMin();
     static boost::intrusive_ptr<Accumulator> createMax();
@@ -173,6 +205,8 @@ public:
     Value getValue(bool toBeMerged) const final;
     const char* getOpName() const final;
     void reset() final;
+    size_t allocSize() const final;
+    Accumulator* createInPlace(void* where) const final;
 
     static boost::intrusive_ptr<Accumulator> create();
 
@@ -189,6 +223,8 @@ public:
     Value getValue(bool toBeMerged) const final;
     const char* getOpName() const final;
     void reset() final;
+    size_t allocSize() const final;
+    Accumulator* createInPlace(void* where) const final;
 
     static boost::intrusive_ptr<Accumulator> create();
 
@@ -206,6 +242,8 @@ public:
     Value getValue(bool toBeMerged) const final;
     const char* getOpName() const final;
     void reset() final;
+    size_t allocSize() const final;
+    Accumulator* createInPlace(void* where) const final;
 
     static boost::intrusive_ptr<Accumulator> createSamp();
     static boost::intrusive_ptr<Accumulator> createPop();
@@ -79,6 +79,14 @@ intrusive_ptr<Accumulator> AccumulatorAddToSet::create() {
     return new AccumulatorAddToSet();
 }
 
+size_t AccumulatorAddToSet::allocSize() const {
+    return sizeof(AccumulatorAddToSet);
+}
+
+Accumulator* AccumulatorAddToSet::createInPlace(void* where) const {
+    return new (where) AccumulatorAddToSet();
+}
+
 const char* AccumulatorAddToSet::getOpName() const {
     return "$addToSet";
 }
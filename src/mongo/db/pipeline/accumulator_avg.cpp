@@ -63,6 +63,14 @@ intrusive_ptr<Accumulator> AccumulatorAvg::create() {
     return new AccumulatorAvg();
 }
 
+size_t AccumulatorAvg::allocSize() const {
+    return sizeof(AccumulatorAvg);
+}
+
+Accumulator* AccumulatorAvg::createInPlace(void* where) const {
+    return new (where) AccumulatorAvg();
+}
+
 Value AccumulatorAvg::getValue(bool toBeMerged) const {
     if (!toBeMerged) {
         if (_count == 0)
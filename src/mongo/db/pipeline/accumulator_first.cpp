@@ -64,6 +64,14 @@ intrusive_ptr<Accumulator> AccumulatorFirst::create() {
     return new AccumulatorFirst();
 }
 
+size_t AccumulatorFirst::allocSize() const {
+    return sizeof(AccumulatorFirst);
+}
+
+Accumulator* AccumulatorFirst::createInPlace(void* where) const {
+    return new (where) AccumulatorFirst();
+}
+
 const char* AccumulatorFirst::getOpName() const {
     return "$first";
 }
@@ -58,6 +58,14 @@ intrusive_ptr<Accumulator> AccumulatorLast::create() {
     return new AccumulatorLast();
 }
 
+size_t AccumulatorLast::allocSize() const {
+    return sizeof(AccumulatorLast);
+}
+
+Accumulator* AccumulatorLast::createInPlace(void* where) const {
+    return new (where) AccumulatorLast();
+}
+
 const char* AccumulatorLast::getOpName() const {
     return "$last";
 }
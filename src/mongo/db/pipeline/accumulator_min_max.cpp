@@ -68,6 +68,14 @@ intrusive_ptr<Accumulator> AccumulatorMinMax::createMax() {
     return new AccumulatorMinMax(Sense::MAX);
 }
 
+size_t AccumulatorMinMax::allocSize() const {
+    return sizeof(AccumulatorMinMax);
+}
+
+Accumulator* AccumulatorMinMax::createInPlace(void* where) const {
+    return new (where) AccumulatorMinMax(_sense);
+}
+
 const char* AccumulatorMinMax::getOpName() const {
     if (_sense == 1)
         return "$min";
@@ -76,6 +76,14 @@ intrusive_ptr<Accumulator> AccumulatorPush::create() {
     return new AccumulatorPush();
 }
 
+size_t AccumulatorPush::allocSize() const {
+    return sizeof(AccumulatorPush);
+}
+
+Accumulator* AccumulatorPush::createInPlace(void* where) const {
+    return new (where) AccumulatorPush();
+}
+
 const char* AccumulatorPush::getOpName() const {
     return "$push";
 }
@@ -91,6 +91,14 @@ intrusive_ptr<Accumulator> AccumulatorStdDev::createPop() {
     return new AccumulatorStdDev(false);
 }
 
+size_t AccumulatorStdDev::allocSize() const {
+    return sizeof(AccumulatorStdDev);
+}
+
+Accumulator* AccumulatorStdDev::createInPlace(void* where) const {
+    return new (where) AccumulatorStdDev(_isSamp);
+}
+
 AccumulatorStdDev::AccumulatorStdDev(bool isSamp) : _isSamp(isSamp), _count(0), _mean(0), _m2(0) {
     // This is a fixed size Accumulator so we never need to update this
     _memUsageBytes = sizeof(*this);
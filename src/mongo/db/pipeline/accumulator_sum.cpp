@@ -56,10 +56,35 @@ void AccumulatorSum::processInternal(const Value& input, bool merging) {
     }
 }
 
+void AccumulatorSum::processElement(const BSONElement& input) {
+    // Same as processInternal(), without going through a Value.
+    const BSONType type = input.type();
+    if (type != NumberInt && type != NumberLong && type != NumberDouble)
+        return;
+
+    totalType = Value::getWidestNumeric(totalType, type);
+
+    if (totalType == NumberDouble) {
+        doubleTotal += input.numberDouble();
+    } else {
+        long long v = type == NumberInt ? input._numberInt() : input._numberLong();
+        longTotal += v;
+        doubleTotal += v;
+    }
+}
+
 intrusive_ptr<Accumulator> AccumulatorSum::create() {
     return new AccumulatorSum();
 }
 
+size_t AccumulatorSum::allocSize() const {
+    return sizeof(AccumulatorSum);
+}
+
+Accumulator* AccumulatorSum::createInPlace(void* where) const {
+    return new (where) AccumulatorSum();
+}
+
 Value AccumulatorSum::getValue(bool toBeMerged) const {
     if (totalType == NumberLong) {
         return Value(longTotal);
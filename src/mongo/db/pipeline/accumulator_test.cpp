@@ -1003,8 +1003,81 @@ private:
     }
 };
 
+/** Summing BSONElements gives the same result, and type, as summing the equivalent Values. */
+class Elements : public Base {
+public:
+    void run() {
+        const BSONObj inputs[] = {
+            BSON_ARRAY(1 << 2 << 3),
+            BSON_ARRAY(numeric_limits<int>::max() << 1),
+            BSON_ARRAY(1 << 2LL << 3),
+            BSON_ARRAY(1 << 2.5 << 3LL),
+            BSON_ARRAY(numeric_limits<long long>::max() << numeric_limits<long long>::max()
+                                                        << 1.0),
+            BSON_ARRAY("foo" << BSONNULL << 4 << BSON("a" << 1) << BSON_ARRAY(5)),
+            BSONArray(),
+        };
+
+        for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+            intrusive_ptr<Accumulator> fromValues = AccumulatorSum::create();
+            intrusive_ptr<Accumulator> fromElements = AccumulatorSum::create();
+            BSONForEach(elem, inputs[i]) {
+                fromValues->process(Value(elem), false);
+                fromElements->processElement(elem);
+            }
+            // A missing value.
+            fromElements->processElement(BSONElement());
+
+            assertBinaryEqual(fromValue(fromValues->getValue(false)),
+                              fromValue(fromElements->getValue(false)));
+        }
+    }
+};
+
 }  // namespace Sum
 
+namespace InPlace {
+
+/** An accumulator constructed in place starts out fresh and of the prototype's kind. */
+class FreshOfSameKind : public Base {
+public:
+    void run() {
+        intrusive_ptr<Accumulator> prototype = AccumulatorMinMax::createMax();
+        prototype->process(Value(10), false);
+
+        std::unique_ptr<char[]> memory(new char[prototype->allocSize()]);
+        Accumulator* accumulator = prototype->createInPlace(memory.get());
+        ASSERT_EQUALS(string("$max"), accumulator->getOpName());
+        ASSERT(accumulator->getValue(false).missing());
+
+        accumulator->process(Value(3), false);
+        accumulator->process(Value(5), false);
+        assertBinaryEqual(BSON("" << 5), fromValue(accumulator->getValue(false)));
+
+        // The prototype is unaffected.
+        assertBinaryEqual(BSON("" << 10), fromValue(prototype->getValue(false)));
+
+        accumulator->~Accumulator();
+    }
+};
+
+/** Accumulators holding heap memory release it when destroyed in place. */
+class ReleasesState : public Base {
+public:
+    void run() {
+        intrusive_ptr<Accumulator> prototype = AccumulatorPush::create();
+        std::unique_ptr<char[]> memory(new char[prototype->allocSize()]);
+        Accumulator* accumulator = prototype->createInPlace(memory.get());
+        for (int i = 0; i < 100; i++) {
+            accumulator->process(Value(string(100, 'x')), false);
+        }
+        ASSERT_EQUALS(100U, accumulator->getValue(false).getArray().size());
+        accumulator->~Accumulator();
+    }
+};
+
+}  // namespace InPlace
+
 class All : public Suite {
 public:
     All() : Suite("accumulator") {}
@@ -1080,6 +1153,10 @@ public:
         add<Sum::IntNull>();
         add<Sum::IntUndefined>();
         add<Sum::NoOverflowBeforeDouble>();
+        add<Sum::Elements>();
+
+        add<InPlace::FreshOfSameKind>();
+        add<InPlace::ReleasesState>();
     }
 };
 
@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/column_batch.h"
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+ColumnBatch::ColumnBatch(std::vector<std::string> fieldNames)
+    : _fieldNames(std::move(fieldNames)), _columns(_fieldNames.size()) {
+    for (size_t i = 0; i < _fieldNames.size(); i++) {
+        invariant(_fieldPositions.find(_fieldNames[i]) == _fieldPositions.end());
+        _fieldPositions[_fieldNames[i]] = i;
+    }
+}
+
+void ColumnBatch::clear() {
+    for (size_t i = 0; i < _columns.size(); i++) {
+        _columns[i].clear();
+    }
+    _numRows = 0;
+    _documents.clear();
+    _documentBytes = 0;
+}
+
+void ColumnBatch::appendDocument(const BSONObj& doc) {
+    dassert(doc.isOwned());
+
+    for (size_t i = 0; i < _columns.size(); i++) {
+        _columns[i].push_back(BSONElement());
+    }
+
+    size_t fieldsLeft = _columns.size();
+    BSONObjIterator it(doc);
+    while (fieldsLeft > 0 && it.more()) {
+        const BSONElement elem = it.next();
+        StringMap<size_t>::const_iterator pos = _fieldPositions.find(elem.fieldNameStringData());
+        if (pos == _fieldPositions.end())
+            continue;
+
+        // Only the first occurrence of a field counts, as when building a Document.
+        BSONElement& slot = _columns[pos->second].back();
+        if (slot.eoo()) {
+            slot = elem;
+            fieldsLeft--;
+        }
+    }
+
+    _numRows++;
+    _documents.push_back(doc);
+    _documentBytes += doc.objsize();
+}
+
+void ColumnBatch::takeRowsFrom(ColumnBatch* input, const std::vector<int>& inputColumns) {
+    invariant(inputColumns.size() == _columns.size());
+
+    clear();
+    for (size_t i = 0; i < _columns.size(); i++) {
+        if (inputColumns[i] == kMissingColumn) {
+            _columns[i].resize(input->_numRows);
+        } else {
+            // Copied rather than swapped, since several fields may come from the same column.
+            _columns[i] = input->_columns[inputColumns[i]];
+        }
+    }
+    _numRows = input->_numRows;
+    _documents.swap(input->_documents);
+    _documentBytes = input->_documentBytes;
+
+    input->clear();
+}
+
+}  // namespace mongo
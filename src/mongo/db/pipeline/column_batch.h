@@ -0,0 +1,115 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+/**
+ * A batch of documents laid out by column: for each of a fixed list of top-level field names,
+ * the value of that field in every document of the batch.
+ *
+ * Pipeline stages that only need a few top-level fields of their input can pass these between
+ * them instead of Documents, so that nothing is built per field and per document beyond a
+ * BSONElement pointing into the original BSON. See DocumentSource::prepareColumns().
+ */
+class ColumnBatch {
+    MONGO_DISALLOW_COPYING(ColumnBatch);
+
+public:
+    /**
+     * Column index used by takeRowsFrom() for a field that is missing from every row.
+     */
+    static const int kMissingColumn = -1;
+
+    /**
+     * A batch of the fields 'fieldNames', which must be distinct.
+     */
+    explicit ColumnBatch(std::vector<std::string> fieldNames);
+
+    const std::vector<std::string>& getFieldNames() const {
+        return _fieldNames;
+    }
+
+    size_t numRows() const {
+        return _numRows;
+    }
+
+    /**
+     * Returns the value of the field at 'fieldIndex' in getFieldNames() in every row of the
+     * batch. The element is EOO in the rows where the field is missing.
+     */
+    const std::vector<BSONElement>& getColumn(size_t fieldIndex) const {
+        return _columns[fieldIndex];
+    }
+
+    /**
+     * Approximate number of bytes of BSON held by this batch.
+     */
+    size_t getApproximateSize() const {
+        return _documentBytes;
+    }
+
+    /**
+     * Removes all rows.
+     */
+    void clear();
+
+    /**
+     * Adds 'doc' as the last row, picking out the first occurrence of each field. 'doc' must be
+     * owned and is kept alive by the batch until it is cleared.
+     */
+    void appendDocument(const BSONObj& doc);
+
+    /**
+     * Replaces the rows of this batch with the rows of 'input', taking the field at index i of
+     * getFieldNames() from the column at index 'inputColumns[i]' of 'input', or leaving it
+     * missing if that is kMissingColumn. 'input' is left empty.
+     */
+    void takeRowsFrom(ColumnBatch* input, const std::vector<int>& inputColumns);
+
+private:
+    const std::vector<std::string> _fieldNames;
+    StringMap<size_t> _fieldPositions;
+
+    std::vector<std::vector<BSONElement>> _columns;
+    size_t _numRows = 0;
+
+    // Hold the BSON the columns point into.
+    std::vector<BSONObj> _documents;
+    size_t _documentBytes = 0;
+};
+
+}  // namespace mongo
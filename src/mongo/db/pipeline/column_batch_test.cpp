@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/pipeline/column_batch.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using std::string;
+using std::vector;
+
+vector<string> fields(const string& a, const string& b) {
+    vector<string> names;
+    names.push_back(a);
+    names.push_back(b);
+    return names;
+}
+
+TEST(ColumnBatchTest, PicksOutFields) {
+    ColumnBatch batch(fields("a", "b"));
+    ASSERT_EQUALS(0U, batch.numRows());
+
+    batch.appendDocument(BSON("x" << 1 << "b" << 2 << "a"
+                                  << "foo"));
+    batch.appendDocument(BSON("a" << BSON_ARRAY(1 << 2)));
+    batch.appendDocument(BSONObj());
+    ASSERT_EQUALS(3U, batch.numRows());
+
+    const vector<BSONElement>& a = batch.getColumn(0);
+    ASSERT_EQUALS(3U, a.size());
+    ASSERT_EQUALS("foo", a[0].str());
+    ASSERT_EQUALS(Array, a[1].type());
+    ASSERT(a[2].eoo());
+
+    const vector<BSONElement>& b = batch.getColumn(1);
+    ASSERT_EQUALS(3U, b.size());
+    ASSERT_EQUALS(2, b[0].numberInt());
+    ASSERT(b[1].eoo());
+    ASSERT(b[2].eoo());
+}
+
+TEST(ColumnBatchTest, FirstOccurrenceOfFieldCounts) {
+    ColumnBatch batch(fields("a", "b"));
+    batch.appendDocument(BSON("a" << 1 << "a" << 2 << "b" << 3));
+    ASSERT_EQUALS(1, batch.getColumn(0)[0].numberInt());
+    ASSERT_EQUALS(3, batch.getColumn(1)[0].numberInt());
+}
+
+TEST(ColumnBatchTest, NoFields) {
+    ColumnBatch batch((vector<string>()));
+    batch.appendDocument(BSON("a" << 1));
+    batch.appendDocument(BSON("b" << 1));
+    ASSERT_EQUALS(2U, batch.numRows());
+}
+
+TEST(ColumnBatchTest, Clear) {
+    ColumnBatch batch(fields("a", "b"));
+    const BSONObj doc = BSON("a" << 1 << "b" << 2);
+    batch.appendDocument(doc);
+    ASSERT_EQUALS(size_t(doc.objsize()), batch.getApproximateSize());
+
+    batch.clear();
+    ASSERT_EQUALS(0U, batch.numRows());
+    ASSERT_EQUALS(0U, batch.getApproximateSize());
+    ASSERT(batch.getColumn(0).empty());
+    ASSERT(batch.getColumn(1).empty());
+}
+
+TEST(ColumnBatchTest, TakeRowsFrom) {
+    ColumnBatch input(fields("a", "b"));
+    input.appendDocument(BSON("a" << 1 << "b" << 2));
+    input.appendDocument(BSON("a" << 3));
+
+    // Output fields: x from "b", y missing, z and w both from "a".
+    vector<string> outputFields;
+    outputFields.push_back("x");
+    outputFields.push_back("y");
+    outputFields.push_back("z");
+    outputFields.push_back("w");
+    vector<int> inputColumns;
+    inputColumns.push_back(1);
+    inputColumns.push_back(ColumnBatch::kMissingColumn);
+    inputColumns.push_back(0);
+    inputColumns.push_back(0);
+
+    ColumnBatch output(outputFields);
+    output.appendDocument(BSON("x" << 10));
+    output.takeRowsFrom(&input, inputColumns);
+
+    ASSERT_EQUALS(0U, input.numRows());
+    ASSERT_EQUALS(2U, output.numRows());
+
+    ASSERT_EQUALS(2, output.getColumn(0)[0].numberInt());
+    ASSERT(output.getColumn(0)[1].eoo());
+    ASSERT(output.getColumn(1)[0].eoo());
+    ASSERT(output.getColumn(1)[1].eoo());
+    for (size_t i = 2; i < 4; i++) {
+        ASSERT_EQUALS(1, output.getColumn(i)[0].numberInt());
+        ASSERT_EQUALS(3, output.getColumn(i)[1].numberInt());
+    }
+
+    // The input can be filled again.
+    input.appendDocument(BSON("b" << 4));
+    ASSERT_EQUALS(1U, input.numRows());
+    ASSERT_EQUALS(4, input.getColumn(1)[0].numberInt());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -44,6 +44,7 @@
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/matcher.h"
+#include "mongo/db/pipeline/column_batch.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/dependencies.h"
 #include "mongo/db/pipeline/expression_context.h"
@@ -166,6 +167,28 @@ public:
         return NOT_SUPPORTED;
     }
 
+    /**
+     * Asks this source to return its output from now on as ColumnBatches of the top-level fields
+     * 'fieldNames', through getNextColumns(), rather than as Documents. This is for stages that
+     * only need a few fields of their input. Returns false, changing nothing, if this source
+     * can't. Once this returned true, getNext() must not be called anymore.
+     *
+     * The default implementation returns false.
+     */
+    virtual bool prepareColumns(const std::vector<std::string>& fieldNames) {
+        return false;
+    }
+
+    /**
+     * Replaces the contents of 'batch', whose fields are those given to prepareColumns(), with
+     * the next Documents of this source. Returns false at EOF.
+     * Subclasses must call pExpCtx->checkForInterupt().
+     */
+    virtual bool getNextColumns(ColumnBatch* batch) {
+        verify(false);
+        return false;
+    }
+
     /**
      * In the default case, serializes the DocumentSource and adds it to the std::vector<Value>.
      *
@@ -389,6 +412,8 @@ public:
     // virtuals from DocumentSource
     ~DocumentSourceCursor() final;
     boost::optional<Document> getNext() final;
+    bool prepareColumns(const std::vector<std::string>& fieldNames) final;
+    bool getNextColumns(ColumnBatch* batch) final;
     const char* getSourceName() const final;
     Value serialize(bool explain = false) const final;
     void setSource(DocumentSource* pSource) final;
@@ -525,11 +550,81 @@ public:
     boost::intrusive_ptr<DocumentSource> getShardSource() final;
     boost::intrusive_ptr<DocumentSource> getMergeSource() final;
 
+    ~DocumentSourceGroup() final;
+
 private:
     explicit DocumentSourceGroup(const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
 
-    /// Spill groups map to disk and returns an iterator to the file.
-    std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
+    /**
+     * A group's accumulators are stored in a single block of memory: an array holding one
+     * Accumulator* per field, followed by the accumulators themselves, constructed in place from
+     * _accumulatorPrototypes. This avoids a separate heap allocation per group per field.
+     */
+    typedef Accumulator** GroupState;
+    typedef std::unordered_map<Value, GroupState, Value::Hash> GroupsMap;
+
+    /**
+     * Groups are hash partitioned on their _id. When the memory limit is exceeded only the
+     * largest partitions are spilled to disk, so partitions holding few, frequently hit groups
+     * keep aggregating in memory. A spilled partition is re-aggregated on its own, by merging its
+     * sorted runs, when it is reached during output.
+     */
+    struct Partition {
+        GroupsMap groups;
+        std::vector<std::unique_ptr<char[]>> blocks;  // hold the GroupStates of 'groups'
+        size_t bytesLeftInBlock = 0;
+        long long memoryUsageBytes = 0;
+        std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> spilledRuns;
+    };
+
+    /// Computes _groupStateOffsets and _groupStateBytes from _accumulatorPrototypes.
+    void layoutGroupState();
+
+    /// Constructs fresh accumulators for every field in the _groupStateBytes at 'where'.
+    GroupState constructGroupState(char* where);
+    void destroyGroupState(GroupState state);
+
+    /// Allocates a new GroupState out of the blocks owned by 'partition'.
+    GroupState newGroupState(Partition* partition);
+
+    /// Destroys all groups of 'partition' and releases the memory holding them.
+    void clearGroups(Partition* partition);
+
+    Partition& partitionFor(const Value& id);
+
+    /**
+     * Returns the accumulators of the group for 'id', creating the group if it is new, after
+     * spilling if the groups use more memory than allowed. Must be followed by a call to
+     * endGroupUpdate() once the accumulators have processed their input, which accounts for the
+     * memory the group now uses.
+     */
+    GroupState beginGroupUpdate(const Value& id);
+    void endGroupUpdate(GroupState group);
+
+    /**
+     * Computes _idColumns and _accumulatorColumns, adding the top-level fields they read to
+     * 'fieldNames'. Returns false, leaving both empty, if an _id or accumulator expression reads
+     * anything else than a top-level field or a constant.
+     */
+    bool mapExpressionsToColumns(std::vector<std::string>* fieldNames);
+
+    /// Groups the rows of 'batch', whose columns are those from mapExpressionsToColumns().
+    void processColumns(const ColumnBatch& batch);
+
+    /// Spills the groups of 'partition' to disk as a sorted run and clears them.
+    void spill(Partition* partition);
+
+    /**
+     * Prepares output of the partition at _outputPartition, merging its spilled runs if it has
+     * any.
+     */
+    void startPartitionOutput();
+
+    /// Merges all spilled entries for the next _id out of _sorterIterator.
+    Document nextSpilledGroup();
+
+    /// Releases all groups and spill files. Does not touch pSource.
+    void freeGroups();
 
     // Only used by spill. Would be function-local if that were legal in C++03.
     class SpillSTLComparator;
@@ -559,10 +654,20 @@ private:
      */
     Value expandId(const Value& val);
 
+    std::vector<Partition> _partitions;
+
+    // Memory used by the groups of all partitions, and number of spills, while populating.
+    long long _memoryUsageBytes;
+    size_t _numSpills;
 
-    typedef std::vector<boost::intrusive_ptr<Accumulator>> Accumulators;
-    typedef std::unordered_map<Value, Accumulators, Value::Hash> GroupsMap;
-    GroupsMap groups;
+    // The group between beginGroupUpdate() and endGroupUpdate().
+    Partition* _updatedPartition;
+    bool _updatedGroupInserted;
+    long long _updatedGroupMemoryBytes;
+
+    // The ColumnBatch column each _id expression and accumulator reads, when grouping columns.
+    std::vector<int> _idColumns;
+    std::vector<int> _accumulatorColumns;
 
     /*
       The field names for the result documents and the accumulator
@@ -580,25 +685,30 @@ private:
     std::vector<boost::intrusive_ptr<Accumulator>(*)()> vpAccumulatorFactory;
     std::vector<boost::intrusive_ptr<Expression>> vpExpression;
 
+    // One accumulator per field, used to construct the accumulators of each group.
+    std::vector<boost::intrusive_ptr<Accumulator>> _accumulatorPrototypes;
+    std::vector<size_t> _groupStateOffsets;
+    size_t _groupStateBytes;
 
-    Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
+    Document makeDocument(const Value& id, GroupState accums, bool mergeableOutput);
 
     bool _doingMerge;
-    bool _spilled;
     const bool _extSortAllowed;
     const int _maxMemoryUsageBytes;
     std::unique_ptr<Variables> _variables;
     std::vector<std::string> _idFieldNames;  // used when id is a document
     std::vector<boost::intrusive_ptr<Expression>> _idExpressions;
 
-    // only used when !_spilled
+    // The partition currently being output and, if it was never spilled, the next group in it.
+    size_t _outputPartition;
     GroupsMap::iterator groupsIterator;
 
-    // only used when _spilled
+    // only used while outputting a spilled partition
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
     std::pair<Value, Value> _firstPartOfNextGroup;
     Value _currentId;
-    Accumulators _currentAccumulators;
+    std::unique_ptr<char[]> _currentGroupStateMemory;
+    GroupState _currentAccumulators;
 };
 
 
@@ -766,6 +876,8 @@ public:
     const char* getSourceName() const final;
     boost::intrusive_ptr<DocumentSource> optimize() final;
     Value serialize(bool explain = false) const final;
+    bool prepareColumns(const std::vector<std::string>& fieldNames) final;
+    bool getNextColumns(ColumnBatch* batch) final;
 
     virtual GetDepsReturn getDependencies(DepsTracker* deps) const;
 
@@ -795,6 +907,11 @@ private:
     std::unique_ptr<Variables> _variables;
     boost::intrusive_ptr<ExpressionObject> pEO;
     BSONObj _raw;
+
+    // Only used when producing columns: the batch read from pSource, and for each field of the
+    // output batch the column of '_inputBatch' it comes from.
+    std::unique_ptr<ColumnBatch> _inputBatch;
+    std::vector<int> _inputColumns;
 };
 
 class DocumentSourceRedact final : public DocumentSource {
@@ -135,6 +135,63 @@ void DocumentSourceCursor::loadBatch() {
             state == PlanExecutor::IS_EOF || state == PlanExecutor::ADVANCED);
 }
 
+bool DocumentSourceCursor::prepareColumns(const std::vector<string>& fieldNames) {
+    // Documents already loaded by getNext() would be lost.
+    return _currentBatch.empty();
+}
+
+bool DocumentSourceCursor::getNextColumns(ColumnBatch* batch) {
+    pExpCtx->checkForInterrupt();
+
+    batch->clear();
+    if (!_exec)
+        return false;
+
+    // Same as loadBatch(), filling 'batch' instead of _currentBatch.
+    const NamespaceString nss(_ns);
+    AutoGetCollectionForRead autoColl(pExpCtx->opCtx, nss);
+
+    _exec->restoreState(pExpCtx->opCtx);
+
+    BSONObj obj;
+    PlanExecutor::ExecState state;
+    while ((state = _exec->getNext(&obj, NULL)) == PlanExecutor::ADVANCED) {
+        batch->appendDocument(obj.getOwned());
+
+        if (_limit) {
+            if (++_docsAddedToBatches == _limit->getLimit()) {
+                break;
+            }
+            verify(_docsAddedToBatches < _limit->getLimit());
+        }
+
+        if (batch->getApproximateSize() > size_t(MaxBytesToReturnToClientAtOnce)) {
+            // End this batch and prepare PlanExecutor for yielding.
+            _exec->saveState();
+            return true;
+        }
+    }
+
+    // If we got here, there won't be any more documents.
+    _exec.reset();
+
+    uassert(28731,
+            str::stream() << "collection or index disappeared when cursor yielded: "
+                          << WorkingSetCommon::toStatusString(obj),
+            state != PlanExecutor::DEAD);
+
+    uassert(28732,
+            str::stream() << "cursor encountered an error: "
+                          << WorkingSetCommon::toStatusString(obj),
+            state != PlanExecutor::FAILURE);
+
+    massert(28733,
+            str::stream() << "Unexpected return from PlanExecutor::getNext: " << state,
+            state == PlanExecutor::IS_EOF || state == PlanExecutor::ADVANCED);
+
+    return batch->numRows() > 0;
+}
+
 void DocumentSourceCursor::setSource(DocumentSource* pSource) {
     /* this doesn't take a source */
     verify(false);
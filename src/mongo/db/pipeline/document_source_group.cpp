@@ -28,14 +28,18 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+#include <cstddef>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/column_batch.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
 
@@ -44,6 +48,25 @@ using std::shared_ptr;
 using std::pair;
 using std::vector;
 
+// Memory a $group may use for its groups before it errors out or, with allowDiskUse, spills.
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupMaxMemoryBytes, int, 100 * 1024 * 1024);
+
+// Number of hash partitions $group splits its groups into. Spilling writes out whole partitions,
+// largest first.
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupPartitions, int, 16);
+
+// Whether $group reads its input a ColumnBatch at a time when its source supports it.
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupUseColumns, bool, true);
+
+namespace {
+// Size of the blocks the GroupStates of a partition are allocated from.
+const size_t kGroupStateBlockBytes = 64 * 1024;
+
+// Markers used instead of a column index for expressions that don't read a ColumnBatch column.
+const int kConstantColumn = -1;
+const int kUnsupportedColumn = -2;
+}
+
 REGISTER_DOCUMENT_SOURCE(group, DocumentSourceGroup::createFromBson);
 
 const char* DocumentSourceGroup::getSourceName() const {
@@ -56,74 +79,98 @@ boost::optional<Document> DocumentSourceGroup::getNext() {
     if (!populated)
         populate();
 
-    if (_spilled) {
-        if (!_sorterIterator)
-            return boost::none;
+    while (_outputPartition < _partitions.size()) {
+        if (_sorterIterator)
+            return nextSpilledGroup();
 
-        const size_t numAccumulators = vpAccumulatorFactory.size();
-        for (size_t i = 0; i < numAccumulators; i++) {
-            _currentAccumulators[i]->reset();  // prep accumulators for a new group
+        Partition& partition = _partitions[_outputPartition];
+        if (groupsIterator != partition.groups.end()) {
+            Document out =
+                makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->inShard);
+            ++groupsIterator;
+            return out;
         }
 
-        _currentId = _firstPartOfNextGroup.first;
-        while (_currentId == _firstPartOfNextGroup.first) {
-            // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
-            // At loop exit, it is the first value to be processed in the next group.
+        // This partition is done, so free it before moving on to the next one.
+        clearGroups(&partition);
+        partition.spilledRuns.clear();
+        ++_outputPartition;
+        startPartitionOutput();
+    }
 
-            switch (numAccumulators) {  // mirrors switch in spill()
-                case 0:                 // no Accumulators so no Values
-                    break;
+    dispose();
+    return boost::none;
+}
+
+Document DocumentSourceGroup::nextSpilledGroup() {
+    const size_t numAccumulators = _accumulatorPrototypes.size();
+    for (size_t i = 0; i < numAccumulators; i++) {
+        _currentAccumulators[i]->reset();  // prep accumulators for a new group
+    }
+
+    _currentId = _firstPartOfNextGroup.first;
+    while (_currentId == _firstPartOfNextGroup.first) {
+        // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
+        // At loop exit, it is the first value to be processed in the next group.
+
+        switch (numAccumulators) {  // mirrors switch in spill()
+            case 0:                 // no Accumulators so no Values
+                break;
+
+            case 1:  // single accumulators serialize as a single Value
+                _currentAccumulators[0]->process(_firstPartOfNextGroup.second,
+                                                 /*merging=*/true);
+                break;
 
-                case 1:  // single accumulators serialize as a single Value
-                    _currentAccumulators[0]->process(_firstPartOfNextGroup.second,
+            default: {  // multiple accumulators serialize as an array
+                const vector<Value>& accumulatorStates = _firstPartOfNextGroup.second.getArray();
+                for (size_t i = 0; i < numAccumulators; i++) {
+                    _currentAccumulators[i]->process(accumulatorStates[i],
                                                      /*merging=*/true);
-                    break;
-
-                default: {  // multiple accumulators serialize as an array
-                    const vector<Value>& accumulatorStates =
-                        _firstPartOfNextGroup.second.getArray();
-                    for (size_t i = 0; i < numAccumulators; i++) {
-                        _currentAccumulators[i]->process(accumulatorStates[i],
-                                                         /*merging=*/true);
-                    }
-                    break;
                 }
-            }
-
-            if (!_sorterIterator->more()) {
-                dispose();
                 break;
             }
-
-            _firstPartOfNextGroup = _sorterIterator->next();
         }
 
-        return makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
-
-    } else {
-        if (groups.empty())
-            return boost::none;
-
-        Document out =
-            makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->inShard);
-
-        if (++groupsIterator == groups.end())
-            dispose();
+        if (!_sorterIterator->more()) {
+            // Done with this partition. getNext() moves on to the next one.
+            _sorterIterator.reset();
+            break;
+        }
 
-        return out;
+        _firstPartOfNextGroup = _sorterIterator->next();
     }
+
+    return makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
 }
 
 void DocumentSourceGroup::dispose() {
     // free our resources
-    GroupsMap().swap(groups);
+    freeGroups();
+
+    // free our source's resources
+    pSource->dispose();
+}
+
+void DocumentSourceGroup::freeGroups() {
     _sorterIterator.reset();
+    for (size_t i = 0; i < _partitions.size(); i++) {
+        clearGroups(&_partitions[i]);
+    }
+    vector<Partition>().swap(_partitions);
+
+    if (_currentAccumulators) {
+        destroyGroupState(_currentAccumulators);
+        _currentAccumulators = nullptr;
+        _currentGroupStateMemory.reset();
+    }
 
     // make us look done
-    groupsIterator = groups.end();
+    _outputPartition = 0;
+}
 
-    // free our source's resources
-    pSource->dispose();
+DocumentSourceGroup::~DocumentSourceGroup() {
+    freeGroups();
 }
 
 intrusive_ptr<DocumentSource> DocumentSourceGroup::optimize() {
@@ -161,9 +208,8 @@ Value DocumentSourceGroup::serialize(bool explain) const {
     // add the remaining fields
     const size_t n = vFieldName.size();
     for (size_t i = 0; i < n; ++i) {
-        intrusive_ptr<Accumulator> accum = vpAccumulatorFactory[i]();
-        insides[vFieldName[i]] =
-            Value(DOC(accum->getOpName() << vpExpression[i]->serialize(explain)));
+        insides[vFieldName[i]] = Value(DOC(_accumulatorPrototypes[i]->getOpName()
+                                           << vpExpression[i]->serialize(explain)));
     }
 
     if (_doingMerge) {
@@ -200,10 +246,17 @@ intrusive_ptr<DocumentSourceGroup> DocumentSourceGroup::create(
 DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>& pExpCtx)
     : DocumentSource(pExpCtx),
       populated(false),
+      _memoryUsageBytes(0),
+      _numSpills(0),
+      _updatedPartition(nullptr),
+      _updatedGroupInserted(false),
+      _updatedGroupMemoryBytes(0),
+      _groupStateBytes(0),
       _doingMerge(false),
-      _spilled(false),
       _extSortAllowed(pExpCtx->extSortAllowed && !pExpCtx->inRouter),
-      _maxMemoryUsageBytes(100 * 1024 * 1024) {}
+      _maxMemoryUsageBytes(internalDocumentSourceGroupMaxMemoryBytes),
+      _outputPartition(0),
+      _currentAccumulators(nullptr) {}
 
 void DocumentSourceGroup::addAccumulator(const std::string& fieldName,
                                          intrusive_ptr<Accumulator>(*pAccumulatorFactory)(),
@@ -211,6 +264,7 @@ void DocumentSourceGroup::addAccumulator(const std::string& fieldName,
     vFieldName.push_back(fieldName);
     vpAccumulatorFactory.push_back(pAccumulatorFactory);
     vpExpression.push_back(pExpression);
+    _accumulatorPrototypes.push_back(pAccumulatorFactory());
 }
 
 
@@ -341,111 +395,353 @@ public:
 };
 }
 
-void DocumentSourceGroup::populate() {
-    const size_t numAccumulators = vpAccumulatorFactory.size();
-    dassert(numAccumulators == vpExpression.size());
+void DocumentSourceGroup::layoutGroupState() {
+    // Every accumulator starts on a boundary suitable for any type, as does the GroupState itself
+    // since GroupStates are packed back to back in a partition's blocks.
+    const size_t alignment = alignof(std::max_align_t);
+    const auto alignUp = [alignment](size_t bytes) {
+        return (bytes + alignment - 1) / alignment * alignment;
+    };
+
+    const size_t numAccumulators = _accumulatorPrototypes.size();
+    size_t bytes = alignUp(numAccumulators * sizeof(Accumulator*));
+    _groupStateOffsets.clear();
+    for (size_t i = 0; i < numAccumulators; i++) {
+        _groupStateOffsets.push_back(bytes);
+        bytes += alignUp(_accumulatorPrototypes[i]->allocSize());
+    }
+    _groupStateBytes = std::max(bytes, alignment);
+}
 
-    // pushed to on spill()
-    vector<shared_ptr<Sorter<Value, Value>::Iterator>> sortedFiles;
-    int memoryUsageBytes = 0;
-
-    // This loop consumes all input from pSource and buckets it based on pIdExpression.
-    while (boost::optional<Document> input = pSource->getNext()) {
-        if (memoryUsageBytes > _maxMemoryUsageBytes) {
-            uassert(16945,
-                    "Exceeded memory limit for $group, but didn't allow external sort."
-                    " Pass allowDiskUse:true to opt in.",
-                    _extSortAllowed);
-            sortedFiles.push_back(spill());
-            memoryUsageBytes = 0;
+DocumentSourceGroup::GroupState DocumentSourceGroup::constructGroupState(char* where) {
+    GroupState state = reinterpret_cast<GroupState>(where);
+    const size_t numAccumulators = _accumulatorPrototypes.size();
+    size_t i = 0;
+    try {
+        for (; i < numAccumulators; i++) {
+            state[i] = _accumulatorPrototypes[i]->createInPlace(where + _groupStateOffsets[i]);
         }
+    } catch (...) {
+        while (i > 0) {
+            state[--i]->~Accumulator();
+        }
+        throw;
+    }
+    return state;
+}
 
-        _variables->setRoot(*input);
+void DocumentSourceGroup::destroyGroupState(GroupState state) {
+    for (size_t i = 0; i < _accumulatorPrototypes.size(); i++) {
+        state[i]->~Accumulator();
+    }
+}
 
-        /* get the _id value */
-        Value id = computeId(_variables.get());
+DocumentSourceGroup::GroupState DocumentSourceGroup::newGroupState(Partition* partition) {
+    const size_t blockBytes = std::max(kGroupStateBlockBytes, _groupStateBytes);
+    if (partition->bytesLeftInBlock < _groupStateBytes) {
+        partition->blocks.emplace_back(new char[blockBytes]);
+        partition->bytesLeftInBlock = blockBytes;
+    }
 
-        /* treat missing values the same as NULL SERVER-4674 */
-        if (id.missing())
-            id = Value(BSONNULL);
+    // GroupStates are handed out from the front of the newest block.
+    char* where = partition->blocks.back().get() + (blockBytes - partition->bytesLeftInBlock);
+    GroupState state = constructGroupState(where);
+    partition->bytesLeftInBlock -= _groupStateBytes;
+    return state;
+}
 
-        /*
-          Look for the _id value in the map; if it's not there, add a
-          new entry with a blank accumulator.
-        */
-        const size_t oldSize = groups.size();
-        vector<intrusive_ptr<Accumulator>>& group = groups[id];
-        const bool inserted = groups.size() != oldSize;
+void DocumentSourceGroup::clearGroups(Partition* partition) {
+    for (GroupsMap::const_iterator it = partition->groups.begin(), end = partition->groups.end();
+         it != end;
+         ++it) {
+        destroyGroupState(it->second);
+    }
 
-        if (inserted) {
-            memoryUsageBytes += id.getApproximateSize();
+    GroupsMap().swap(partition->groups);
+    vector<std::unique_ptr<char[]>>().swap(partition->blocks);
+    partition->bytesLeftInBlock = 0;
+    partition->memoryUsageBytes = 0;
+    groupsIterator = partition->groups.end();
+}
 
-            // Add the accumulators
-            group.reserve(numAccumulators);
-            for (size_t i = 0; i < numAccumulators; i++) {
-                group.push_back(vpAccumulatorFactory[i]());
-            }
-        } else {
-            for (size_t i = 0; i < numAccumulators; i++) {
-                // subtract old mem usage. New usage added back after processing.
-                memoryUsageBytes -= group[i]->memUsageForSorter();
+DocumentSourceGroup::Partition& DocumentSourceGroup::partitionFor(const Value& id) {
+    // GroupsMap buckets on the same hash, so mix it before picking a partition to keep the groups
+    // of a partition spread across all of its buckets.
+    unsigned long long hash = Value::Hash()(id);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return _partitions[hash % _partitions.size()];
+}
+
+DocumentSourceGroup::GroupState DocumentSourceGroup::beginGroupUpdate(const Value& id) {
+    if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+        uassert(16945,
+                "Exceeded memory limit for $group, but didn't allow external sort."
+                " Pass allowDiskUse:true to opt in.",
+                _extSortAllowed);
+
+        // Spill the largest partitions until we are down to half of the limit, so that we
+        // don't spill again as soon as the next new group comes in.
+        while (_memoryUsageBytes > _maxMemoryUsageBytes / 2) {
+            Partition* largest = &_partitions[0];
+            for (size_t i = 1; i < _partitions.size(); i++) {
+                if (_partitions[i].memoryUsageBytes > largest->memoryUsageBytes)
+                    largest = &_partitions[i];
             }
+            _memoryUsageBytes -= largest->memoryUsageBytes;
+            spill(largest);
+            _numSpills++;
         }
+    }
 
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
-        for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
-            memoryUsageBytes += group[i]->memUsageForSorter();
+    /*
+      Look for the _id value in its partition's map; if it's not there,
+      add a new entry with blank accumulators.
+    */
+    Partition& partition = partitionFor(id);
+    _updatedPartition = &partition;
+    _updatedGroupMemoryBytes = 0;
+    GroupsMap::iterator it = partition.groups.find(id);
+    _updatedGroupInserted = it == partition.groups.end();
+
+    if (_updatedGroupInserted) {
+        GroupState state = newGroupState(&partition);
+        try {
+            it = partition.groups.insert(std::make_pair(id, state)).first;
+        } catch (...) {
+            destroyGroupState(state);
+            throw;
         }
+        _updatedGroupMemoryBytes += id.getApproximateSize();
+    } else {
+        for (size_t i = 0; i < _accumulatorPrototypes.size(); i++) {
+            // subtract old mem usage. New usage added back in endGroupUpdate().
+            _updatedGroupMemoryBytes -= it->second[i]->memUsageForSorter();
+        }
+    }
 
-        // We are done with the ROOT document so release it.
-        _variables->clearRoot();
-
-        DEV {
-            // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted  // is a dup
-                &&
-                !pExpCtx->inRouter  // can't spill to disk in router
-                &&
-                !_extSortAllowed  // don't change behavior when testing external sort
-                &&
-                sortedFiles.size() < 20  // don't open too many FDs
-                ) {
-                sortedFiles.push_back(spill());
-            }
+    return it->second;
+}
+
+void DocumentSourceGroup::endGroupUpdate(GroupState group) {
+    for (size_t i = 0; i < _accumulatorPrototypes.size(); i++) {
+        _updatedGroupMemoryBytes += group[i]->memUsageForSorter();
+    }
+
+    Partition& partition = *_updatedPartition;
+    partition.memoryUsageBytes += _updatedGroupMemoryBytes;
+    _memoryUsageBytes += _updatedGroupMemoryBytes;
+
+    DEV {
+        // In debug mode, spill every time we have a duplicate id to stress merge logic.
+        if (!_updatedGroupInserted  // is a dup
+            &&
+            !pExpCtx->inRouter  // can't spill to disk in router
+            &&
+            !_extSortAllowed  // don't change behavior when testing external sort
+            &&
+            _numSpills < 20  // don't open too many FDs
+            ) {
+            _memoryUsageBytes -= partition.memoryUsageBytes;
+            spill(&partition);
+            _numSpills++;
         }
     }
+}
+
+namespace {
+/**
+ * If 'expr' reads a top-level field of the input document, returns the index of that field in
+ * 'fieldNames', adding it if needed. Returns kConstantColumn if 'expr' is a constant, and
+ * kUnsupportedColumn otherwise.
+ */
+int columnFor(Expression* expr, vector<std::string>* fieldNames) {
+    if (dynamic_cast<ExpressionConstant*>(expr))
+        return kConstantColumn;
+
+    ExpressionFieldPath* fieldPath = dynamic_cast<ExpressionFieldPath*>(expr);
+    if (!fieldPath || !fieldPath->isTopLevelRootField())
+        return kUnsupportedColumn;
+
+    const std::string& fieldName = fieldPath->getFieldPath().getFieldName(1);
+    const vector<std::string>::iterator it =
+        std::find(fieldNames->begin(), fieldNames->end(), fieldName);
+    if (it != fieldNames->end())
+        return it - fieldNames->begin();
+
+    fieldNames->push_back(fieldName);
+    return fieldNames->size() - 1;
+}
+}  // namespace
+
+bool DocumentSourceGroup::mapExpressionsToColumns(vector<std::string>* fieldNames) {
+    _idColumns.clear();
+    _accumulatorColumns.clear();
+
+    for (size_t i = 0; i < _idExpressions.size(); i++) {
+        _idColumns.push_back(columnFor(_idExpressions[i].get(), fieldNames));
+    }
+    for (size_t i = 0; i < vpExpression.size(); i++) {
+        _accumulatorColumns.push_back(columnFor(vpExpression[i].get(), fieldNames));
+    }
 
-    // These blocks do any final steps necessary to prepare to output results.
-    if (!sortedFiles.empty()) {
-        _spilled = true;
-        if (!groups.empty()) {
-            sortedFiles.push_back(spill());
+    if (std::count(_idColumns.begin(), _idColumns.end(), kUnsupportedColumn) ||
+        std::count(_accumulatorColumns.begin(), _accumulatorColumns.end(), kUnsupportedColumn)) {
+        _idColumns.clear();
+        _accumulatorColumns.clear();
+        return false;
+    }
+    return true;
+}
+
+void DocumentSourceGroup::processColumns(const ColumnBatch& batch) {
+    const size_t numRows = batch.numRows();
+    const size_t numAccumulators = _accumulatorPrototypes.size();
+
+    // Constant inputs are evaluated once per batch.
+    vector<Value> constants(numAccumulators);
+    for (size_t i = 0; i < numAccumulators; i++) {
+        if (_accumulatorColumns[i] == kConstantColumn)
+            constants[i] = vpExpression[i]->evaluate(_variables.get());
+    }
+
+    bool constantId = true;
+    for (size_t i = 0; i < _idColumns.size(); i++) {
+        constantId = constantId && _idColumns[i] == kConstantColumn;
+    }
+    if (constantId) {
+        // Every row goes to the same group, so each accumulator takes a whole column at once.
+        Value id = computeId(_variables.get());
+        if (id.missing())
+            id = Value(BSONNULL);
+
+        GroupState group = beginGroupUpdate(id);
+        for (size_t i = 0; i < numAccumulators; i++) {
+            Accumulator* accumulator = group[i];
+            if (_accumulatorColumns[i] == kConstantColumn) {
+                for (size_t row = 0; row < numRows; row++) {
+                    accumulator->process(constants[i], false);
+                }
+            } else {
+                const vector<BSONElement>& column = batch.getColumn(_accumulatorColumns[i]);
+                for (size_t row = 0; row < numRows; row++) {
+                    accumulator->processElement(column[row]);
+                }
+            }
         }
+        endGroupUpdate(group);
+        return;
+    }
 
-        // We won't be using groups again so free its memory.
-        GroupsMap().swap(groups);
+    vector<Value> idValues(_idColumns.size());
+    for (size_t i = 0; i < _idColumns.size(); i++) {
+        if (_idColumns[i] == kConstantColumn)
+            idValues[i] = _idExpressions[i]->evaluate(_variables.get());
+    }
 
-        _sorterIterator.reset(
-            Sorter<Value, Value>::Iterator::merge(sortedFiles, SortOptions(), SorterComparator()));
+    for (size_t row = 0; row < numRows; row++) {
+        // Same as computeId(), reading the inputs out of the batch.
+        for (size_t i = 0; i < _idColumns.size(); i++) {
+            if (_idColumns[i] != kConstantColumn)
+                idValues[i] = Value(batch.getColumn(_idColumns[i])[row]);
+        }
+        Value id = idValues.size() == 1 ? idValues[0] : Value(idValues);
 
-        // prepare current to accumulate data
-        _currentAccumulators.reserve(numAccumulators);
+        /* treat missing values the same as NULL SERVER-4674 */
+        if (id.missing())
+            id = Value(BSONNULL);
+
+        GroupState group = beginGroupUpdate(id);
         for (size_t i = 0; i < numAccumulators; i++) {
-            _currentAccumulators.push_back(vpAccumulatorFactory[i]());
+            if (_accumulatorColumns[i] == kConstantColumn) {
+                group[i]->process(constants[i], false);
+            } else {
+                group[i]->processElement(batch.getColumn(_accumulatorColumns[i])[row]);
+            }
         }
+        endGroupUpdate(group);
+    }
+}
 
-        verify(_sorterIterator->more());  // we put data in, we should get something out.
-        _firstPartOfNextGroup = _sorterIterator->next();
+void DocumentSourceGroup::populate() {
+    const size_t numAccumulators = _accumulatorPrototypes.size();
+    dassert(numAccumulators == vpExpression.size());
+
+    layoutGroupState();
+    _partitions.resize(std::max(internalDocumentSourceGroupPartitions, 1));
+    _memoryUsageBytes = 0;
+    _numSpills = 0;
+
+    // When the _id and the accumulators only read top-level fields, ask the source for those
+    // fields a batch at a time rather than for whole Documents.
+    vector<std::string> fieldNames;
+    if (internalDocumentSourceGroupUseColumns && !_doingMerge &&
+        mapExpressionsToColumns(&fieldNames) && pSource->prepareColumns(fieldNames)) {
+        ColumnBatch batch(std::move(fieldNames));
+        while (pSource->getNextColumns(&batch)) {
+            processColumns(batch);
+        }
     } else {
-        // start the group iterator
-        groupsIterator = groups.begin();
+        // This loop consumes all input from pSource and buckets it based on pIdExpression.
+        while (boost::optional<Document> input = pSource->getNext()) {
+            _variables->setRoot(*input);
+
+            /* get the _id value */
+            Value id = computeId(_variables.get());
+
+            /* treat missing values the same as NULL SERVER-4674 */
+            if (id.missing())
+                id = Value(BSONNULL);
+
+            /* tickle all the accumulators for the group we found */
+            GroupState group = beginGroupUpdate(id);
+            for (size_t i = 0; i < numAccumulators; i++) {
+                group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
+            }
+            endGroupUpdate(group);
+
+            // We are done with the ROOT document so release it.
+            _variables->clearRoot();
+        }
     }
 
+    // start outputting the first partition
+    _outputPartition = 0;
+    startPartitionOutput();
+
     populated = true;
 }
 
+void DocumentSourceGroup::startPartitionOutput() {
+    if (_outputPartition >= _partitions.size())
+        return;
+
+    Partition& partition = _partitions[_outputPartition];
+    if (partition.spilledRuns.empty()) {
+        groupsIterator = partition.groups.begin();
+        return;
+    }
+
+    // Some of this partition's groups are on disk, so the rest must go there too to be merged
+    // with them.
+    if (!partition.groups.empty()) {
+        spill(&partition);
+    }
+
+    _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
+        partition.spilledRuns, SortOptions(), SorterComparator()));
+
+    // prepare current to accumulate data
+    if (!_currentAccumulators) {
+        _currentGroupStateMemory.reset(new char[_groupStateBytes]);
+        _currentAccumulators = constructGroupState(_currentGroupStateMemory.get());
+    }
+
+    verify(_sorterIterator->more());  // we put data in, we should get something out.
+    _firstPartOfNextGroup = _sorterIterator->next();
+}
+
 class DocumentSourceGroup::SpillSTLComparator {
 public:
     bool operator()(const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) const {
@@ -453,7 +749,11 @@ public:
     }
 };
 
-shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
+void DocumentSourceGroup::spill(Partition* partition) {
+    if (partition->groups.empty())
+        return;  // nothing to write, and the Sorter doesn't accept empty files
+
+    const GroupsMap& groups = partition->groups;
     vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
     ptrs.reserve(groups.size());
     for (GroupsMap::const_iterator it = groups.begin(), end = groups.end(); it != end; ++it) {
@@ -462,9 +762,10 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
 
     stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator());
 
+    const size_t numAccumulators = _accumulatorPrototypes.size();
     SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-    switch (vpAccumulatorFactory.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                             // no values, essentially a distinct
+    switch (numAccumulators) {
+        case 0:  // no values, essentially a distinct
             for (size_t i = 0; i < ptrs.size(); i++) {
                 writer.addAlreadySorted(ptrs[i]->first, Value());
             }
@@ -480,7 +781,8 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
         default:  // multiple values, serialize as array-typed Value
             for (size_t i = 0; i < ptrs.size(); i++) {
                 vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
+                accums.reserve(numAccumulators);
+                for (size_t j = 0; j < numAccumulators; j++) {
                     accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
                 }
                 writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
@@ -488,9 +790,9 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
             break;
     }
 
-    groups.clear();
+    clearGroups(partition);
 
-    return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+    partition->spilledRuns.push_back(shared_ptr<Sorter<Value, Value>::Iterator>(writer.done()));
 }
 
 void DocumentSourceGroup::parseIdExpression(BSONElement groupField,
@@ -559,7 +861,7 @@ Value DocumentSourceGroup::expandId(const Value& val) {
 }
 
 Document DocumentSourceGroup::makeDocument(const Value& id,
-                                           const Accumulators& accums,
+                                           GroupState accums,
                                            bool mergeableOutput) {
     const size_t n = vFieldName.size();
     MutableDocument out(1 + n);
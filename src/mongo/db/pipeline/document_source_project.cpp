@@ -28,6 +28,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <boost/smart_ptr/intrusive_ptr.hpp>
 
 #include "mongo/db/jsobj.h"
@@ -77,6 +78,49 @@ boost::optional<Document> DocumentSourceProject::getNext() {
     return out.freeze();
 }
 
+bool DocumentSourceProject::prepareColumns(const vector<string>& fieldNames) {
+    // Each requested field must be copied from a top-level input field or not be output at all.
+    vector<string> inputFieldNames;
+    vector<int> inputColumns;
+    for (size_t i = 0; i < fieldNames.size(); i++) {
+        boost::optional<string> inputFieldName;
+        if (!pEO->getTopLevelInputField(fieldNames[i], &inputFieldName))
+            return false;
+
+        if (!inputFieldName) {
+            inputColumns.push_back(ColumnBatch::kMissingColumn);
+            continue;
+        }
+
+        vector<string>::const_iterator it =
+            std::find(inputFieldNames.begin(), inputFieldNames.end(), *inputFieldName);
+        if (it == inputFieldNames.end()) {
+            inputFieldNames.push_back(*inputFieldName);
+            it = inputFieldNames.end() - 1;
+        }
+        inputColumns.push_back(it - inputFieldNames.begin());
+    }
+
+    if (!pSource->prepareColumns(inputFieldNames))
+        return false;
+
+    _inputBatch.reset(new ColumnBatch(std::move(inputFieldNames)));
+    _inputColumns = std::move(inputColumns);
+    return true;
+}
+
+bool DocumentSourceProject::getNextColumns(ColumnBatch* batch) {
+    pExpCtx->checkForInterrupt();
+
+    if (!pSource->getNextColumns(_inputBatch.get())) {
+        batch->clear();
+        return false;
+    }
+
+    batch->takeRowsFrom(_inputBatch.get(), _inputColumns);
+    return true;
+}
+
 intrusive_ptr<DocumentSource> DocumentSourceProject::optimize() {
     intrusive_ptr<Expression> pE(pEO->optimize());
     pEO = boost::dynamic_pointer_cast<ExpressionObject>(pE);
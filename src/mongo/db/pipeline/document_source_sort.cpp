@@ -36,6 +36,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
 
@@ -45,6 +46,10 @@ using std::make_pair;
 using std::string;
 using std::vector;
 
+// Number of threads that sort and spill the data of a $sort which exceeds its memory limit. 1
+// sorts on the thread running the aggregation.
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceSortThreads, int, 1);
+
 REGISTER_DOCUMENT_SOURCE(sort, DocumentSourceSort::createFromBson);
 
 const char* DocumentSourceSort::getSourceName() const {
@@ -209,6 +214,7 @@ SortOptions DocumentSourceSort::makeSortOptions() const {
     if (pExpCtx->extSortAllowed && !pExpCtx->inRouter) {
         opts.extSortAllowed = true;
         opts.tempDir = pExpCtx->tempDir;
+        opts.numThreads = std::max(internalDocumentSourceSortThreads, 1);
     }
 
     return opts;
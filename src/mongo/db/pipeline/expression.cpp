@@ -1396,6 +1396,34 @@ void ExpressionObject::addField(const FieldPath& fieldPath,
     subObj->addField(fieldPath.tail(), pExpression);
 }
 
+bool ExpressionObject::getTopLevelInputField(const string& fieldName,
+                                             boost::optional<string>* inputFieldName) const {
+    invariant(_atRoot);
+    *inputFieldName = boost::none;
+
+    FieldMap::const_iterator it = _expressions.find(fieldName);
+    if (it == _expressions.end()) {
+        // _id from the root doc is always included, see addToDocument().
+        if (!_excludeId && fieldName == "_id")
+            *inputFieldName = fieldName;
+        return true;
+    }
+
+    if (!it->second) {
+        // An inclusion.
+        *inputFieldName = fieldName;
+        return true;
+    }
+
+    const ExpressionFieldPath* fieldPath = dynamic_cast<ExpressionFieldPath*>(it->second.get());
+    if (fieldPath && fieldPath->isTopLevelRootField()) {
+        *inputFieldName = fieldPath->getFieldPath().getFieldName(1);
+        return true;
+    }
+
+    return false;
+}
+
 void ExpressionObject::includePath(const string& theFieldPath) {
     addField(theFieldPath, NULL);
 }
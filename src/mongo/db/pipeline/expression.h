@@ -616,6 +616,14 @@ public:
         return _fieldPath;
     }
 
+    /**
+     * Returns true if this is the path of a top-level field of the root document, like "$a". The
+     * name of that field is then getFieldPath().getFieldName(1).
+     */
+    bool isTopLevelRootField() const {
+        return _variable == Variables::ROOT_ID && _fieldPath.getPathLength() == 2;
+    }
+
 private:
     ExpressionFieldPath(const std::string& fieldPath, Variables::Id variable);
 
@@ -890,6 +898,15 @@ public:
         _excludeId = b;
     }
 
+    /**
+     * For the root object of a $project. Returns true if the top-level field 'fieldName' of the
+     * output is either never output, in which case '*inputFieldName' is left unset, or copied
+     * unchanged from a top-level field of the input, whose name is stored in '*inputFieldName'.
+     * Returns false if the field is computed in any other way.
+     */
+    bool getTopLevelInputField(const std::string& fieldName,
+                               boost::optional<std::string>* inputFieldName) const;
+
 private:
     explicit ExpressionObject(bool atRoot);
 
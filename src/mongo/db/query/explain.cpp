@@ -396,8 +396,18 @@ void Explain::statsToBSON(const PlanStageStats& stats,
     } else if (STAGE_TEXT_OR == stats.stageType) {
         TextOrStats* spec = static_cast<TextOrStats*>(stats.specific.get());
 
+        if (spec->limit) {
+            bob->appendNumber("limitAmount", spec->limit);
+        }
+
         if (verbosity >= ExplainCommon::EXEC_STATS) {
             bob->appendNumber("docsExamined", spec->fetches);
+            if (spec->limit) {
+                bob->appendNumber("docsPruned", spec->docsPruned);
+                bob->appendNumber("maxDocsBuffered", spec->maxDocsBuffered);
+                bob->appendBool("stoppedEarly", spec->stoppedEarly);
+            }
+            bob->appendBool("spilled", spec->spilled);
         }
     } else if (STAGE_UPDATE == stats.stageType) {
         UpdateStats* spec = static_cast<UpdateStats*>(stats.specific.get());
@@ -36,14 +36,19 @@
 #include "mongo/db/geo/hash.h"
 #include "mongo/db/geo/r2_region_coverer.h"
 #include "mongo/db/hasher.h"
+#include "mongo/db/index/expression_params.h"
 
 namespace mongo {
 
 using std::set;
 
-BSONObj ExpressionMapping::hash(const BSONElement& value) {
+BSONObj ExpressionMapping::hash(const BSONElement& value, const BSONObj& indexInfoObj) {
+    HashSeed seed;
+    int hashVersion;
+    ExpressionParams::parseHashSeedAndVersion(indexInfoObj, &seed, &hashVersion);
+
     BSONObjBuilder bob;
-    bob.append("", BSONElementHasher::hash64(value, BSONElementHasher::DEFAULT_HASH_SEED));
+    bob.append("", BSONElementHasher::hash64(value, seed, hashVersion));
     return bob.obj();
 }
 
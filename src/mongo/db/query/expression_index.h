@@ -43,7 +43,11 @@ namespace mongo {
  */
 class ExpressionMapping {
 public:
-    static BSONObj hash(const BSONElement& value);
+    /**
+     * Hashes 'value' the same way the hashed index described by 'indexInfoObj' does, honoring
+     * its "seed" and "hashVersion".
+     */
+    static BSONObj hash(const BSONElement& value, const BSONObj& indexInfoObj);
 
     static void cover2d(const R2Region& region,
                         const BSONObj& indexInfoObj,
@@ -32,12 +32,15 @@
 
 #include "mongo/db/query/get_executor.h"
 
+#include <algorithm>
 #include <limits>
 #include <memory>
 
+#include "mongo/base/counter.h"
 #include "mongo/base/error_codes.h"
 #include "mongo/base/parse_number.h"
 #include "mongo/client/dbclientinterface.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/exec/cached_plan.h"
 #include "mongo/db/exec/count.h"
 #include "mongo/db/exec/delete.h"
@@ -58,6 +61,7 @@
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_cost_estimator.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
@@ -200,6 +204,67 @@ void fillOutPlannerParams(OperationContext* txn,
 
 namespace {
 
+Counter64 statisticsPlansPruned;
+ServerStatusMetricField<Counter64> displayStatisticsPlansPruned("query.statistics.plansPruned",
+                                                                &statisticsPlansPruned);
+Counter64 statisticsTrialsSkipped;
+ServerStatusMetricField<Counter64> displayStatisticsTrialsSkipped(
+    "query.statistics.trialsSkipped", &statisticsTrialsSkipped);
+
+/**
+ * If 'collection' was analyzed, estimates the cost of each of the candidate 'solutions' and
+ * deletes those which cost internalQueryPlanStatisticsPruneRatio times more than the cheapest
+ * one, so that the MultiPlanStage does not run them. A ratio alone means little between small
+ * estimates, so a pruned plan must also cost internalQueryPlanStatisticsPruneMinCostDifference
+ * more than the cheapest one.
+ */
+void pruneSolutionsByCost(OperationContext* opCtx,
+                          Collection* collection,
+                          const CanonicalQuery& canonicalQuery,
+                          vector<QuerySolution*>* solutions) {
+    if (!internalQueryPlanUseStatistics || solutions->size() < 2) {
+        return;
+    }
+
+    std::shared_ptr<const CollectionStatistics> stats = collection->infoCache()->getStatistics();
+    if (!stats) {
+        return;
+    }
+
+    PlanCostEstimator estimator(*stats, collection->numRecords(opCtx));
+    vector<double> costs(solutions->size());
+    for (size_t i = 0; i < solutions->size(); ++i) {
+        if (!estimator.estimate(*(*solutions)[i], &costs[i])) {
+            // Without an estimate for every candidate, the trial period has to decide.
+            return;
+        }
+    }
+
+    const double bestCost = *std::min_element(costs.begin(), costs.end());
+    const double maxCost =
+        std::max(bestCost * internalQueryPlanStatisticsPruneRatio,
+                 bestCost + internalQueryPlanStatisticsPruneMinCostDifference);
+
+    vector<QuerySolution*> kept;
+    for (size_t i = 0; i < solutions->size(); ++i) {
+        if (costs[i] > maxCost) {
+            LOG(2) << "Pruning plan with estimated cost " << costs[i] << ", cheapest is "
+                   << bestCost << ": " << (*solutions)[i]->toString();
+            delete (*solutions)[i];
+            statisticsPlansPruned.increment();
+        } else {
+            kept.push_back((*solutions)[i]);
+        }
+    }
+
+    if (1 == kept.size()) {
+        LOG(2) << "Plan is the cheapest by far according to the collection statistics, "
+               << "skipping the trial period: " << canonicalQuery.toStringShort();
+        statisticsTrialsSkipped.increment();
+    }
+    solutions->swap(kept);
+}
+
 /**
  * Build an execution tree for the query described in 'canonicalQuery'.  Does not take
  * ownership of arguments.
@@ -367,6 +432,8 @@ Status prepareExecution(OperationContext* opCtx,
         }
     }
 
+    pruneSolutionsByCost(opCtx, collection, *canonicalQuery, &solutions);
+
     if (1 == solutions.size()) {
         // Only one possible plan.  Run it.  Build the stages from the solution.
         verify(StageBuilder::build(opCtx, collection, *solutions[0], ws, rootOut));
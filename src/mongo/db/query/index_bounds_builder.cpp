@@ -334,7 +334,7 @@ void IndexBoundsBuilder::translate(const MatchExpression* expr,
         }
     } else if (MatchExpression::EQ == expr->matchType()) {
         const EqualityMatchExpression* node = static_cast<const EqualityMatchExpression*>(expr);
-        translateEquality(node->getData(), isHashed, oilOut, tightnessOut);
+        translateEquality(node->getData(), index, isHashed, oilOut, tightnessOut);
     } else if (MatchExpression::LTE == expr->matchType()) {
         const LTEMatchExpression* node = static_cast<const LTEMatchExpression*>(expr);
         BSONElement dataElt = node->getData();
@@ -516,7 +516,7 @@ void IndexBoundsBuilder::translate(const MatchExpression* expr,
         IndexBoundsBuilder::BoundsTightness tightness;
         for (BSONElementSet::iterator it = afr.equalities().begin(); it != afr.equalities().end();
              ++it) {
-            translateEquality(*it, isHashed, oilOut, &tightness);
+            translateEquality(*it, index, isHashed, oilOut, &tightness);
             if (tightness != IndexBoundsBuilder::EXACT) {
                 *tightnessOut = tightness;
             }
@@ -769,6 +769,7 @@ void IndexBoundsBuilder::translateRegex(const RegexMatchExpression* rme,
 
 // static
 void IndexBoundsBuilder::translateEquality(const BSONElement& data,
+                                           const IndexEntry& index,
                                            bool isHashed,
                                            OrderedIntervalList* oil,
                                            BoundsTightness* tightnessOut) {
@@ -777,7 +778,7 @@ void IndexBoundsBuilder::translateEquality(const BSONElement& data,
     if (Array != data.type()) {
         BSONObj dataObj;
         if (isHashed) {
-            dataObj = ExpressionMapping::hash(data);
+            dataObj = ExpressionMapping::hash(data, index.infoObj);
         } else {
             dataObj = objFromElement(data);
         }
@@ -158,6 +158,7 @@ public:
                                BoundsTightness* tightnessOut);
 
     static void translateEquality(const BSONElement& data,
+                                  const IndexEntry& index,
                                   bool isHashed,
                                   OrderedIntervalList* oil,
                                   BoundsTightness* tightnessOut);
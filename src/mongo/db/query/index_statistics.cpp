@@ -0,0 +1,316 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/index_statistics.h"
+
+#include <algorithm>
+
+namespace mongo {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+BSONObj wrapElement(const BSONElement& elt) {
+    BSONObjBuilder bob;
+    bob.appendAs(elt, "");
+    return bob.obj();
+}
+
+/**
+ * Returns the position of the first field whose value differs between 'lhs' and 'rhs', or
+ * 'numFields' if they hold the same values.
+ */
+size_t firstDifference(const BSONObj& lhs, const BSONObj& rhs, size_t numFields) {
+    BSONObjIterator lit(lhs);
+    BSONObjIterator rit(rhs);
+    for (size_t i = 0; i < numFields; ++i) {
+        if (!lit.more() || !rit.more()) {
+            return i;
+        }
+        if (lit.next().woCompare(rit.next(), false) != 0) {
+            return i;
+        }
+    }
+    return numFields;
+}
+
+/**
+ * Guesses which fraction of the keys of a bucket holding values from 'lower' to 'upper' are
+ * between 'start' and 'end', when the interval only partially overlaps the bucket. Numbers are
+ * assumed to be uniformly distributed within the bucket.
+ */
+double overlapFraction(const BSONElement& lower,
+                       const BSONElement& upper,
+                       const BSONElement& start,
+                       const BSONElement& end) {
+    if (!lower.isNumber() || !upper.isNumber() || !start.isNumber() || !end.isNumber()) {
+        return 0.5;
+    }
+
+    const double width = upper.numberDouble() - lower.numberDouble();
+    if (!(width > 0)) {
+        return 0.5;
+    }
+
+    const double lo = std::max(start.numberDouble(), lower.numberDouble());
+    const double hi = std::min(end.numberDouble(), upper.numberDouble());
+    return std::max(0.0, std::min(1.0, (hi - lo) / width));
+}
+
+}  // namespace
+
+// static
+IndexStatistics IndexStatistics::build(const string& name,
+                                       const BSONObj& keyPattern,
+                                       vector<BSONObj> keys,
+                                       long long numDocs,
+                                       size_t numBuckets) {
+    invariant(numBuckets > 0);
+
+    IndexStatistics stats;
+    stats._name = name;
+    stats._keyPattern = keyPattern.getOwned();
+    stats._numKeys = keys.size();
+    stats._numDocs = numDocs;
+
+    const size_t numFields = keyPattern.nFields();
+    stats._distinctPrefixes.resize(numFields, 0);
+    if (keys.empty()) {
+        return stats;
+    }
+
+    // Sort by value, whatever the direction of the index: the histogram describes the values.
+    std::sort(keys.begin(), keys.end(), [](const BSONObj& lhs, const BSONObj& rhs) {
+        return lhs.woCompare(rhs, BSONObj(), false) < 0;
+    });
+
+    stats._lowest = wrapElement(keys[0].firstElement());
+
+    const size_t depth = (keys.size() + numBuckets - 1) / numBuckets;
+    Bucket current = {BSONObj(), 0, 0};
+    for (size_t i = 0; i < keys.size(); ++i) {
+        const size_t diff = (0 == i) ? 0 : firstDifference(keys[i - 1], keys[i], numFields);
+        for (size_t j = diff; j < numFields; ++j) {
+            stats._distinctPrefixes[j]++;
+        }
+
+        if (0 == diff) {
+            // A new leading value. Close the current bucket if it is deep enough, so that equal
+            // leading values are never split between buckets.
+            if (current.count >= static_cast<long long>(depth)) {
+                current.upper = wrapElement(keys[i - 1].firstElement());
+                stats._buckets.push_back(current);
+                current.count = 0;
+                current.distinct = 0;
+            }
+            current.distinct++;
+        }
+        current.count++;
+    }
+    current.upper = wrapElement(keys.back().firstElement());
+    stats._buckets.push_back(current);
+
+    return stats;
+}
+
+double IndexStatistics::keysPerDocument() const {
+    if (0 == _numDocs) {
+        return 1.0;
+    }
+    return static_cast<double>(_numKeys) / _numDocs;
+}
+
+long long IndexStatistics::distinctPrefixes(size_t prefixLen) const {
+    invariant(prefixLen > 0 && prefixLen <= _distinctPrefixes.size());
+    return _distinctPrefixes[prefixLen - 1];
+}
+
+double IndexStatistics::estimateSelectivity(const IndexBounds& bounds) const {
+    if (0 == _numKeys) {
+        return 0.0;
+    }
+
+    if (bounds.isSimpleRange) {
+        BSONElement start = bounds.startKey.firstElement();
+        BSONElement end = bounds.endKey.firstElement();
+        if (start.eoo() || end.eoo()) {
+            return 1.0;
+        }
+        if (start.woCompare(end, false) > 0) {
+            std::swap(start, end);
+        }
+        return rangeSelectivity(start, true, end, true);
+    }
+
+    if (bounds.fields.empty()) {
+        return 1.0;
+    }
+
+    double selectivity = 0.0;
+    for (const Interval& interval : bounds.fields[0].intervals) {
+        selectivity += estimateSelectivity(interval);
+    }
+
+    // The histogram only describes the leading field. When the bounds hold points on the first
+    // fields of a compound index, the distinct counts of these prefixes tell more.
+    double numPoints = 1.0;
+    const size_t numFields = std::min(bounds.fields.size(), _distinctPrefixes.size());
+    for (size_t i = 0; i < numFields; ++i) {
+        const OrderedIntervalList& oil = bounds.fields[i];
+        bool allPoints = true;
+        for (const Interval& interval : oil.intervals) {
+            allPoints = allPoints && interval.isPoint();
+        }
+        if (!allPoints) {
+            break;
+        }
+
+        numPoints *= oil.intervals.size();
+        if (i > 0 && _distinctPrefixes[i] > 0) {
+            selectivity = std::min(selectivity, numPoints / _distinctPrefixes[i]);
+        }
+    }
+
+    return std::max(0.0, std::min(1.0, selectivity));
+}
+
+double IndexStatistics::estimateSelectivity(const Interval& interval) const {
+    if (0 == _numKeys) {
+        return 0.0;
+    }
+
+    // Intervals of descending fields go from high to low values.
+    if (interval.start.woCompare(interval.end, false) > 0) {
+        return rangeSelectivity(
+            interval.end, interval.endInclusive, interval.start, interval.startInclusive);
+    }
+    return rangeSelectivity(
+        interval.start, interval.startInclusive, interval.end, interval.endInclusive);
+}
+
+double IndexStatistics::rangeSelectivity(const BSONElement& start,
+                                         bool startInclusive,
+                                         const BSONElement& end,
+                                         bool endInclusive) const {
+    const bool isPoint = startInclusive && endInclusive && 0 == start.woCompare(end, false);
+
+    double keys = 0.0;
+    BSONElement lower = _lowest.firstElement();
+    bool lowerInclusive = true;
+    for (const Bucket& bucket : _buckets) {
+        BSONElement upper = bucket.upper.firstElement();
+
+        const int endLowerCmp = end.woCompare(lower, false);
+        const int startUpperCmp = start.woCompare(upper, false);
+        const bool missesBucket = endLowerCmp < 0 ||
+            (0 == endLowerCmp && !(endInclusive && lowerInclusive)) || startUpperCmp > 0 ||
+            (0 == startUpperCmp && !startInclusive);
+
+        if (!missesBucket) {
+            const int startLowerCmp = start.woCompare(lower, false);
+            const int endUpperCmp = end.woCompare(upper, false);
+            const bool coversLower =
+                startLowerCmp < 0 || (0 == startLowerCmp && (startInclusive || !lowerInclusive));
+            const bool coversUpper = endUpperCmp > 0 || (0 == endUpperCmp && endInclusive);
+
+            if (coversLower && coversUpper) {
+                keys += bucket.count;
+            } else if (isPoint) {
+                keys += static_cast<double>(bucket.count) / bucket.distinct;
+            } else {
+                // At least one of the bucket's values is within the interval.
+                const double perValue = static_cast<double>(bucket.count) / bucket.distinct;
+                keys += std::max(perValue,
+                                 bucket.count * overlapFraction(lower, upper, start, end));
+            }
+        }
+
+        lower = upper;
+        lowerInclusive = false;
+    }
+
+    // Each sampled key stands for numRecords / numSampled documents, so an interval which no
+    // sampled key falls in may still hold that many. Never estimate less than one sampled key.
+    return std::min(1.0, std::max(1.0, keys) / _numKeys);
+}
+
+BSONObj IndexStatistics::toBSON() const {
+    BSONObjBuilder bob;
+    bob.append("key", _keyPattern);
+    bob.appendNumber("numKeys", _numKeys);
+    bob.append("keysPerDocument", keysPerDocument());
+
+    BSONArrayBuilder distinctBob(bob.subarrayStart("distinctPrefixes"));
+    for (long long distinct : _distinctPrefixes) {
+        distinctBob.append(distinct);
+    }
+    distinctBob.doneFast();
+
+    if (!_lowest.isEmpty()) {
+        bob.appendAs(_lowest.firstElement(), "lowest");
+    }
+    BSONArrayBuilder bucketsBob(bob.subarrayStart("buckets"));
+    for (const Bucket& bucket : _buckets) {
+        BSONObjBuilder bucketBob(bucketsBob.subobjStart());
+        bucketBob.appendAs(bucket.upper.firstElement(), "upper");
+        bucketBob.appendNumber("count", bucket.count);
+        bucketBob.appendNumber("distinct", bucket.distinct);
+    }
+    bucketsBob.doneFast();
+
+    return bob.obj();
+}
+
+const IndexStatistics* CollectionStatistics::getIndex(const BSONObj& keyPattern) const {
+    for (const IndexStatistics& stats : _indexes) {
+        if (0 == stats.getKeyPattern().woCompare(keyPattern)) {
+            return &stats;
+        }
+    }
+    return NULL;
+}
+
+BSONObj CollectionStatistics::toBSON() const {
+    BSONObjBuilder bob;
+    bob.appendNumber("numRecords", _numRecords);
+    bob.appendNumber("sampled", _numSampled);
+
+    BSONObjBuilder indexesBob(bob.subobjStart("indexes"));
+    for (const IndexStatistics& stats : _indexes) {
+        indexesBob.append(stats.getName(), stats.toBSON());
+    }
+    indexesBob.doneFast();
+
+    return bob.obj();
+}
+
+}  // namespace mongo
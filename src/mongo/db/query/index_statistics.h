@@ -0,0 +1,163 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/index_bounds.h"
+
+namespace mongo {
+
+/**
+ * Statistics about the keys of one index, computed from the keys generated for a sample of the
+ * collection's documents: an equi-depth histogram over the values of the leading field, and the
+ * number of distinct values of each prefix of the key.
+ *
+ * Instances are immutable once built.
+ */
+class IndexStatistics {
+public:
+    static const size_t kDefaultNumBuckets = 64;
+
+    /**
+     * Builds the statistics of the index with key pattern 'keyPattern' from the 'keys' it
+     * generates for 'numDocs' sampled documents. The keys need not be sorted, and their field
+     * names are ignored.
+     */
+    static IndexStatistics build(const std::string& name,
+                                 const BSONObj& keyPattern,
+                                 std::vector<BSONObj> keys,
+                                 long long numDocs,
+                                 size_t numBuckets = kDefaultNumBuckets);
+
+    const std::string& getName() const {
+        return _name;
+    }
+
+    const BSONObj& getKeyPattern() const {
+        return _keyPattern;
+    }
+
+    /**
+     * Average number of keys per sampled document. Greater than 1 for multikey indexes, less
+     * than 1 for sparse or partial indexes.
+     */
+    double keysPerDocument() const;
+
+    /**
+     * Number of distinct values of the first 'prefixLen' fields of the sampled keys.
+     */
+    long long distinctPrefixes(size_t prefixLen) const;
+
+    /**
+     * Estimated fraction of the index keys which fall within 'bounds', between 0 and 1. Each
+     * interval is estimated to hold at least one of the sampled keys, as the sample cannot tell
+     * less apart from none.
+     */
+    double estimateSelectivity(const IndexBounds& bounds) const;
+
+    /**
+     * Estimated fraction of the index keys whose leading field falls within 'interval'.
+     */
+    double estimateSelectivity(const Interval& interval) const;
+
+    BSONObj toBSON() const;
+
+private:
+    // Holds the sampled keys whose leading value is greater than the upper bound of the previous
+    // bucket, and less than or equal to 'upper'.
+    struct Bucket {
+        BSONObj upper;  // Wraps the upper bound in its only element.
+        long long count;
+        long long distinct;
+    };
+
+    IndexStatistics() : _numKeys(0), _numDocs(0) {}
+
+    // Fraction of the keys whose leading value is between 'start' and 'end', with 'start' not
+    // greater than 'end'.
+    double rangeSelectivity(const BSONElement& start,
+                            bool startInclusive,
+                            const BSONElement& end,
+                            bool endInclusive) const;
+
+    std::string _name;
+    BSONObj _keyPattern;
+    long long _numKeys;
+    long long _numDocs;
+
+    // Wraps the lowest leading value of the sample in its only element.
+    BSONObj _lowest;
+    std::vector<Bucket> _buckets;
+
+    // _distinctPrefixes[i] is the number of distinct values of the first i + 1 key fields.
+    std::vector<long long> _distinctPrefixes;
+};
+
+/**
+ * The statistics of a collection and of its indexes, as of the last time it was analyzed.
+ */
+class CollectionStatistics {
+public:
+    CollectionStatistics(long long numRecords, long long numSampled)
+        : _numRecords(numRecords), _numSampled(numSampled) {}
+
+    void addIndex(IndexStatistics stats) {
+        _indexes.push_back(std::move(stats));
+    }
+
+    /**
+     * Returns the statistics of the index with key pattern 'keyPattern', or NULL if the index
+     * was not analyzed.
+     */
+    const IndexStatistics* getIndex(const BSONObj& keyPattern) const;
+
+    /**
+     * Number of records in the collection when it was analyzed.
+     */
+    long long numRecords() const {
+        return _numRecords;
+    }
+
+    long long numSampled() const {
+        return _numSampled;
+    }
+
+    BSONObj toBSON() const;
+
+private:
+    long long _numRecords;
+    long long _numSampled;
+    std::vector<IndexStatistics> _indexes;
+};
+
+}  // namespace mongo
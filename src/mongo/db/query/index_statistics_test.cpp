@@ -0,0 +1,170 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/index_statistics.cpp
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/index_statistics.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+using std::vector;
+
+/**
+ * Keys of the index {a: 1, b: 1} for 'n' documents, where 'a' goes from 0 to n - 1 and 'b' takes
+ * 'numB' values.
+ */
+vector<BSONObj> uniformKeys(int n, int numB) {
+    vector<BSONObj> keys;
+    for (int i = n - 1; i >= 0; --i) {
+        keys.push_back(BSON("" << i << "" << i % numB));
+    }
+    return keys;
+}
+
+IndexBounds pointBounds(int a) {
+    OrderedIntervalList oil("a");
+    oil.intervals.push_back(Interval(BSON("" << a << "" << a), true, true));
+    IndexBounds bounds;
+    bounds.fields.push_back(oil);
+    return bounds;
+}
+
+TEST(IndexStatisticsTest, Empty) {
+    IndexStatistics stats = IndexStatistics::build("a_1", BSON("a" << 1), vector<BSONObj>(), 0);
+    ASSERT_EQUALS(0.0, stats.estimateSelectivity(pointBounds(3)));
+    ASSERT_EQUALS(0, stats.distinctPrefixes(1));
+}
+
+TEST(IndexStatisticsTest, DistinctPrefixes) {
+    vector<BSONObj> keys;
+    for (int i = 0; i < 100; ++i) {
+        keys.push_back(BSON("" << i % 4 << "" << i % 10));
+    }
+    IndexStatistics stats = IndexStatistics::build("a_1_b_1", BSON("a" << 1 << "b" << 1), keys, 50);
+    ASSERT_EQUALS(4, stats.distinctPrefixes(1));
+    ASSERT_EQUALS(20, stats.distinctPrefixes(2));
+    ASSERT_EQUALS(2.0, stats.keysPerDocument());
+}
+
+TEST(IndexStatisticsTest, PointSelectivity) {
+    IndexStatistics stats =
+        IndexStatistics::build("a_1_b_1", BSON("a" << 1 << "b" << 1), uniformKeys(1000, 10), 1000);
+    ASSERT_APPROX_EQUAL(0.001, stats.estimateSelectivity(pointBounds(500)), 1e-9);
+}
+
+TEST(IndexStatisticsTest, SkewedPointSelectivity) {
+    // Half of the keys hold 0, the others are distinct.
+    vector<BSONObj> keys;
+    for (int i = 0; i < 1000; ++i) {
+        keys.push_back(BSON("" << ((i % 2) ? i : 0)));
+    }
+    IndexStatistics stats = IndexStatistics::build("a_1", BSON("a" << 1), keys, 1000);
+    ASSERT_APPROX_EQUAL(0.5, stats.estimateSelectivity(pointBounds(0)), 1e-9);
+    ASSERT_LESS_THAN(stats.estimateSelectivity(pointBounds(501)), 0.01);
+}
+
+TEST(IndexStatisticsTest, RangeSelectivity) {
+    IndexStatistics stats =
+        IndexStatistics::build("a_1_b_1", BSON("a" << 1 << "b" << 1), uniformKeys(1000, 10), 1000);
+
+    ASSERT_APPROX_EQUAL(
+        0.25, stats.estimateSelectivity(Interval(BSON("" << 0 << "" << 250), true, false)), 0.02);
+    ASSERT_APPROX_EQUAL(
+        0.5, stats.estimateSelectivity(Interval(BSON("" << 500 << "" << 5000), true, true)), 0.02);
+    ASSERT_APPROX_EQUAL(
+        0.1,
+        stats.estimateSelectivity(Interval(BSON("" << 100.5 << "" << 200.5), true, true)),
+        0.02);
+
+    // Whatever the direction of the interval.
+    ASSERT_APPROX_EQUAL(
+        0.25, stats.estimateSelectivity(Interval(BSON("" << 250 << "" << 0), false, true)), 0.02);
+
+    // Outside of the sampled values, an interval may still hold as many keys as one sample.
+    ASSERT_APPROX_EQUAL(
+        0.001,
+        stats.estimateSelectivity(Interval(BSON("" << 2000 << "" << 3000), true, true)),
+        1e-9);
+    ASSERT_APPROX_EQUAL(
+        0.001, stats.estimateSelectivity(Interval(BSON("" << "a" << "" << "z"), true, true)), 1e-9);
+
+    // Every value.
+    BSONObjBuilder allValues;
+    allValues.appendMinKey("");
+    allValues.appendMaxKey("");
+    ASSERT_EQUALS(1.0, stats.estimateSelectivity(Interval(allValues.obj(), true, true)));
+}
+
+TEST(IndexStatisticsTest, PointBeyondHistogramHoldsOneSample) {
+    // 100 sampled keys for a collection of 10000 documents, each of them standing for 100.
+    IndexStatistics stats =
+        IndexStatistics::build("a_1_b_1", BSON("a" << 1 << "b" << 1), uniformKeys(100, 10), 100);
+    ASSERT_APPROX_EQUAL(0.01, stats.estimateSelectivity(pointBounds(1000)), 1e-9);
+    ASSERT_APPROX_EQUAL(0.01, stats.estimateSelectivity(pointBounds(-1)), 1e-9);
+}
+
+TEST(IndexStatisticsTest, CompoundPointSelectivity) {
+    vector<BSONObj> keys;
+    for (int i = 0; i < 1000; ++i) {
+        keys.push_back(BSON("" << 7 << "" << i));
+    }
+    IndexStatistics stats =
+        IndexStatistics::build("b_1_a_1", BSON("b" << 1 << "a" << 1), keys, 1000);
+
+    // Every key holds the same 'b', the distinct count of the whole key tells more.
+    OrderedIntervalList oilB("b");
+    oilB.intervals.push_back(Interval(BSON("" << 7 << "" << 7), true, true));
+    OrderedIntervalList oilA("a");
+    oilA.intervals.push_back(Interval(BSON("" << 0 << "" << 0), true, true));
+    oilA.intervals.push_back(Interval(BSON("" << 1 << "" << 1), true, true));
+    IndexBounds bounds;
+    bounds.fields.push_back(oilB);
+    bounds.fields.push_back(oilA);
+
+    ASSERT_APPROX_EQUAL(0.002, stats.estimateSelectivity(bounds), 1e-9);
+}
+
+TEST(CollectionStatisticsTest, GetIndex) {
+    CollectionStatistics stats(100, 10);
+    stats.addIndex(IndexStatistics::build("a_1", BSON("a" << 1), uniformKeys(10, 1), 10));
+    ASSERT(stats.getIndex(BSON("a" << 1)));
+    ASSERT_EQUALS("a_1", stats.getIndex(BSON("a" << 1))->getName());
+    ASSERT_FALSE(stats.getIndex(BSON("a" << -1)));
+    ASSERT_FALSE(stats.getIndex(BSON("b" << 1)));
+}
+
+}  // namespace
@@ -0,0 +1,163 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cost_estimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mongo {
+
+const double PlanCostEstimator::kFilterSelectivity = 0.5;
+
+bool PlanCostEstimator::estimate(const QuerySolution& solution, double* costOut) const {
+    if (NULL == solution.root.get()) {
+        return false;
+    }
+
+    Estimate estimate;
+    if (!estimateNode(solution.root.get(), &estimate)) {
+        return false;
+    }
+
+    *costOut = estimate.cost;
+    return true;
+}
+
+bool PlanCostEstimator::estimateNode(const QuerySolutionNode* node, Estimate* out) const {
+    std::vector<Estimate> children(node->children.size());
+    for (size_t i = 0; i < node->children.size(); ++i) {
+        if (!estimateNode(node->children[i], &children[i])) {
+            return false;
+        }
+    }
+
+    const double numRecords = static_cast<double>(_numRecords);
+
+    switch (node->getType()) {
+        case STAGE_COLLSCAN: {
+            // Every stage pays for being opened, so that an empty plan is never free.
+            out->cost = 1 + numRecords;
+            out->rows = numRecords;
+            break;
+        }
+        case STAGE_IXSCAN: {
+            const IndexScanNode* ixn = static_cast<const IndexScanNode*>(node);
+            const IndexStatistics* indexStats = _stats.getIndex(ixn->indexKeyPattern);
+            if (NULL == indexStats) {
+                return false;
+            }
+
+            const double selectivity = indexStats->estimateSelectivity(ixn->bounds);
+            const double keys = selectivity * indexStats->keysPerDocument() * numRecords;
+            out->cost = 1 + keys;
+            // A multikey index scan returns each document once.
+            out->rows = ixn->indexIsMultiKey ? std::min(keys, selectivity * numRecords) : keys;
+            break;
+        }
+        case STAGE_FETCH: {
+            invariant(1 == children.size());
+            *out = children[0];
+            out->cost += children[0].rows;
+            break;
+        }
+        case STAGE_SORT: {
+            invariant(1 == children.size());
+            const SortNode* sn = static_cast<const SortNode*>(node);
+            *out = children[0];
+            const double rows = std::max(1.0, children[0].rows);
+            out->cost += rows * std::log2(rows);
+            out->blockingCost = out->cost;
+            if (sn->limit > 0) {
+                out->rows = std::min(out->rows, static_cast<double>(sn->limit));
+            }
+            break;
+        }
+        case STAGE_LIMIT: {
+            invariant(1 == children.size());
+            const LimitNode* ln = static_cast<const LimitNode*>(node);
+            *out = children[0];
+            const double limit = static_cast<double>(ln->limit);
+            if (out->rows > limit) {
+                // Stages that stream their results stop working once the limit is reached.
+                const double streamingCost = out->cost - out->blockingCost;
+                out->cost = out->blockingCost + streamingCost * (limit / out->rows);
+                out->rows = limit;
+            }
+            break;
+        }
+        case STAGE_SKIP: {
+            invariant(1 == children.size());
+            const SkipNode* sn = static_cast<const SkipNode*>(node);
+            *out = children[0];
+            out->rows = std::max(0.0, out->rows - sn->skip);
+            break;
+        }
+        case STAGE_AND_HASH:
+        case STAGE_AND_SORTED: {
+            // Every child is read to the end.
+            for (size_t i = 0; i < children.size(); ++i) {
+                out->cost += children[i].cost;
+                out->blockingCost += children[i].blockingCost;
+                out->rows = (0 == i) ? children[i].rows : std::min(out->rows, children[i].rows);
+            }
+            if (STAGE_AND_HASH == node->getType()) {
+                out->blockingCost = out->cost;
+            }
+            break;
+        }
+        case STAGE_OR:
+        case STAGE_SORT_MERGE: {
+            for (const Estimate& child : children) {
+                out->cost += child.cost;
+                out->blockingCost += child.blockingCost;
+                out->rows += child.rows;
+            }
+            out->rows = std::min(out->rows, numRecords);
+            break;
+        }
+        default: {
+            // Projections, shard filters and the like pass their child's results through.
+            if (1 != children.size()) {
+                return false;
+            }
+            *out = children[0];
+            break;
+        }
+    }
+
+    if (NULL != node->filter.get()) {
+        out->rows *= kFilterSelectivity;
+    }
+
+    return true;
+}
+
+}  // namespace mongo
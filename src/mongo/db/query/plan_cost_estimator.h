@@ -0,0 +1,83 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/query/index_statistics.h"
+#include "mongo/db/query/query_solution.h"
+
+namespace mongo {
+
+/**
+ * Estimates the cost of running a query solution to completion from the statistics of the
+ * collection and of its indexes, so that the candidates which are clearly too expensive need
+ * not be run by the MultiPlanStage.
+ *
+ * Costs are in abstract units, roughly the number of index keys and documents the plan reads.
+ * They are only meaningful relative to the costs of other candidates for the same query.
+ */
+class PlanCostEstimator {
+public:
+    // Fraction of its input a filter is assumed to let through, since the statistics say
+    // nothing about the fields it reads.
+    static const double kFilterSelectivity;
+
+    /**
+     * 'numRecords' is the current number of documents in the collection, which the statistics
+     * are scaled to.
+     */
+    PlanCostEstimator(const CollectionStatistics& stats, long long numRecords)
+        : _stats(stats), _numRecords(numRecords) {}
+
+    /**
+     * Estimates the cost of 'solution' into 'costOut'. Returns false if the solution has a
+     * stage the estimator knows nothing about, or reads an index the statistics don't cover.
+     */
+    bool estimate(const QuerySolution& solution, double* costOut) const;
+
+private:
+    struct Estimate {
+        Estimate() : cost(0), blockingCost(0), rows(0) {}
+
+        // Cost of producing every result.
+        double cost;
+
+        // Part of 'cost' paid before the first result, which no limit can save.
+        double blockingCost;
+
+        // Number of results.
+        double rows;
+    };
+
+    bool estimateNode(const QuerySolutionNode* node, Estimate* out) const;
+
+    const CollectionStatistics& _stats;
+    const long long _numRecords;
+};
+
+}  // namespace mongo
@@ -0,0 +1,162 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/plan_cost_estimator.cpp
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cost_estimator.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+using std::vector;
+
+const long long kNumRecords = 1000;
+
+/**
+ * Statistics of a collection where 'a' is unique, 'b' takes two values and only 'a' and 'b' are
+ * indexed.
+ */
+CollectionStatistics makeStats() {
+    vector<BSONObj> aKeys;
+    vector<BSONObj> bKeys;
+    for (int i = 0; i < kNumRecords; ++i) {
+        aKeys.push_back(BSON("" << i));
+        bKeys.push_back(BSON("" << i % 2));
+    }
+
+    CollectionStatistics stats(kNumRecords, kNumRecords);
+    stats.addIndex(IndexStatistics::build("a_1", BSON("a" << 1), aKeys, kNumRecords));
+    stats.addIndex(IndexStatistics::build("b_1", BSON("b" << 1), bKeys, kNumRecords));
+    return stats;
+}
+
+QuerySolutionNode* pointScan(const char* field, int value) {
+    IndexScanNode* ixn = new IndexScanNode();
+    ixn->indexKeyPattern = BSON(field << 1);
+    OrderedIntervalList oil(field);
+    oil.intervals.push_back(Interval(BSON("" << value << "" << value), true, true));
+    ixn->bounds.fields.push_back(oil);
+    return ixn;
+}
+
+QuerySolutionNode* fetch(QuerySolutionNode* child) {
+    FetchNode* fetch = new FetchNode();
+    fetch->children.push_back(child);
+    return fetch;
+}
+
+QuerySolutionNode* limit(QuerySolutionNode* child, long long n) {
+    LimitNode* limit = new LimitNode();
+    limit->limit = n;
+    limit->children.push_back(child);
+    return limit;
+}
+
+QuerySolutionNode* sort(QuerySolutionNode* child) {
+    SortNode* sort = new SortNode();
+    sort->pattern = BSON("c" << 1);
+    sort->children.push_back(child);
+    return sort;
+}
+
+double estimate(const CollectionStatistics& stats, QuerySolutionNode* root) {
+    QuerySolution solution;
+    solution.root.reset(root);
+    double cost;
+    ASSERT(PlanCostEstimator(stats, kNumRecords).estimate(solution, &cost));
+    return cost;
+}
+
+TEST(PlanCostEstimatorTest, SelectiveIndexIsCheapest) {
+    CollectionStatistics stats = makeStats();
+    const double selective = estimate(stats, fetch(pointScan("a", 5)));
+    const double unselective = estimate(stats, fetch(pointScan("b", 1)));
+    const double collScan = estimate(stats, new CollectionScanNode());
+
+    ASSERT_LESS_THAN(selective * 100, unselective);
+    ASSERT_LESS_THAN(selective * 100, collScan);
+}
+
+TEST(PlanCostEstimatorTest, ValueBeyondHistogramCostsAtLeastOneSample) {
+    // Only one in ten documents was sampled, so each sampled key stands for ten documents.
+    vector<BSONObj> aKeys;
+    for (int i = 0; i < kNumRecords / 10; ++i) {
+        aKeys.push_back(BSON("" << i));
+    }
+    CollectionStatistics stats(kNumRecords, kNumRecords / 10);
+    stats.addIndex(IndexStatistics::build("a_1", BSON("a" << 1), aKeys, kNumRecords / 10));
+
+    // Scanning and fetching the ten documents one sampled key may hold.
+    const double beyond = estimate(stats, fetch(pointScan("a", 5000)));
+    ASSERT_APPROX_EQUAL(21.0, beyond, 1e-9);
+    ASSERT_APPROX_EQUAL(beyond, estimate(stats, fetch(pointScan("a", 5))), 1e-9);
+}
+
+TEST(PlanCostEstimatorTest, LimitStopsStreamingPlans) {
+    CollectionStatistics stats = makeStats();
+    const double collScan = estimate(stats, new CollectionScanNode());
+    const double limited = estimate(stats, limit(new CollectionScanNode(), 10));
+    ASSERT_LESS_THAN(limited * 50, collScan);
+}
+
+TEST(PlanCostEstimatorTest, LimitDoesNotStopBlockingSort) {
+    CollectionStatistics stats = makeStats();
+    const double sorted = estimate(stats, sort(new CollectionScanNode()));
+    const double limited = estimate(stats, limit(sort(new CollectionScanNode()), 10));
+    ASSERT_EQUALS(sorted, limited);
+    ASSERT_LESS_THAN(estimate(stats, new CollectionScanNode()), sorted);
+}
+
+TEST(PlanCostEstimatorTest, UnknownIndex) {
+    CollectionStatistics stats = makeStats();
+    QuerySolution solution;
+    solution.root.reset(fetch(pointScan("c", 5)));
+    double cost;
+    ASSERT_FALSE(PlanCostEstimator(stats, kNumRecords).estimate(solution, &cost));
+}
+
+TEST(PlanCostEstimatorTest, ScalesToCurrentCollectionSize) {
+    CollectionStatistics stats = makeStats();
+    QuerySolution solution;
+    solution.root.reset(fetch(pointScan("b", 1)));
+    double small;
+    double large;
+    ASSERT(PlanCostEstimator(stats, kNumRecords).estimate(solution, &small));
+    ASSERT(PlanCostEstimator(stats, 10 * kNumRecords).estimate(solution, &large));
+    ASSERT_LESS_THAN(5 * small, large);
+}
+
+}  // namespace
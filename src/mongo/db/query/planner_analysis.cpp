@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/util/log.h"
@@ -517,6 +518,14 @@ QuerySolutionNode* QueryPlannerAnalysis::analyzeSort(const CanonicalQuery& query
         sort->limit = 0;
     }
 
+    // A limited sort by text score only needs the highest scoring documents of a text search
+    // whose results all reach the sort. A sharding filter in between could drop some of them.
+    if (sort->limit && internalQueryExecTextOrTopK && sortObj.nFields() == 1 &&
+        LiteParsedQuery::isTextScoreMeta(sortObj.firstElement()) &&
+        STAGE_TEXT == sort->children[0]->getType()) {
+        static_cast<TextNode*>(sort->children[0])->limit = sort->limit;
+    }
+
     *blockingSortOut = true;
 
     return solnRoot;
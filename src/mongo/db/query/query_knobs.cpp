@@ -58,12 +58,28 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableIndexIntersection, bool,
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableHashIntersection, bool, false);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanUseStatistics, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanStatisticsPruneRatio, double, 10.0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanStatisticsPruneMinCostDifference, double, 100.0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryStatisticsStaleWriteRatio, double, 0.2);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryStatisticsSampleSize, int, 10000);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanOrChildrenIndependently, bool, true);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecCompileFilters, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecTextOrTopK, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecTextOrMaxMemoryBytes, int, 32 * 1024 * 1024);
+
 // Yield every 128 cycles or 10ms.
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
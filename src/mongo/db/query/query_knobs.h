@@ -54,6 +54,23 @@ extern bool internalQueryPlannerEnableIndexIntersection;
 // Do we use hash-based intersection for rooted $and queries?
 extern bool internalQueryPlannerEnableHashIntersection;
 
+// When the collection was analyzed, do we estimate the cost of candidate plans from its
+// statistics before running them?
+extern bool internalQueryPlanUseStatistics;
+
+// Candidate plans whose estimated cost is this many times the cost of the cheapest one, and
+// exceeds it by at least internalQueryPlanStatisticsPruneMinCostDifference, are not run.  If a
+// single candidate remains, no trial period is needed.
+extern double internalQueryPlanStatisticsPruneRatio;
+extern double internalQueryPlanStatisticsPruneMinCostDifference;
+
+// The statistics of a collection are dropped once the writes since it was analyzed amount to
+// this fraction of its documents at the time.
+extern double internalQueryStatisticsStaleWriteRatio;
+
+// How many documents does analyze sample by default?
+extern int internalQueryStatisticsSampleSize;
+
 //
 // plan cache
 //
@@ -98,6 +115,17 @@ extern int internalQueryMaxScansToExplode;
 
 extern int internalQueryExecMaxBlockingSortBytes;
 
+// Do collection scans and fetches evaluate their filters in a single pass over the document
+// when they can?
+extern bool internalQueryExecCompileFilters;
+
+// Can a text search whose results are sorted by score and limited keep only the highest scoring
+// documents, and stop reading the text index once it knows them?
+extern bool internalQueryExecTextOrTopK;
+
+// Bytes of document scores a text search keeps in memory before spilling them to disk.
+extern int internalQueryExecTextOrMaxMemoryBytes;
+
 // Yield after this many "should yield?" checks.
 extern int internalQueryExecYieldIterations;
 
@@ -327,6 +327,13 @@ bool QueryPlannerTestLib::solutionMatches(const BSONObj& testSoln,
             }
         }
 
+        BSONElement limitElt = textObj["limit"];
+        if (!limitElt.eoo()) {
+            if (!limitElt.isNumber() || static_cast<size_t>(limitElt.numberLong()) != node->limit) {
+                return false;
+            }
+        }
+
         BSONElement filter = textObj["filter"];
         if (!filter.eoo()) {
             if (filter.isNull()) {
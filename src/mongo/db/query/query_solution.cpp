@@ -80,6 +80,10 @@ void TextNode::appendToString(mongoutils::str::stream* ss, int indent) const {
     *ss << "caseSensitive= " << caseSensitive << '\n';
     addIndent(ss, indent + 1);
     *ss << "indexPrefix = " << indexPrefix.toString() << '\n';
+    if (limit) {
+        addIndent(ss, indent + 1);
+        *ss << "limit = " << limit << '\n';
+    }
     if (NULL != filter) {
         addIndent(ss, indent + 1);
         *ss << " filter = " << filter->toString();
@@ -97,6 +101,7 @@ QuerySolutionNode* TextNode::clone() const {
     copy->language = this->language;
     copy->caseSensitive = this->caseSensitive;
     copy->indexPrefix = this->indexPrefix;
+    copy->limit = this->limit;
 
     return copy;
 }
@@ -255,6 +255,10 @@ struct TextNode : public QuerySolutionNode {
     // text node while creating the text leaf node and convert them into a BSONObj index prefix
     // when we finish the text leaf node.
     BSONObj indexPrefix;
+
+    // If not 0, the results are sorted by text score and only this many of the highest scoring
+    // ones are needed.
+    size_t limit = 0;
 };
 
 struct CollectionScanNode : public QuerySolutionNode {
@@ -265,6 +265,7 @@ PlanStage* buildStages(OperationContext* txn,
         params.index = index;
         params.spec = fam->getSpec();
         params.indexPrefix = node->indexPrefix;
+        params.limit = node->limit;
 
         const std::string& language =
             ("" == node->language ? fam->getSpec().defaultLanguage().str() : node->language);
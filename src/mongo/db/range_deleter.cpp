@@ -32,6 +32,7 @@
 
 #include "mongo/db/range_deleter.h"
 
+#include <algorithm>
 #include <boost/date_time/posix_time/posix_time_duration.hpp>
 #include <memory>
 
@@ -57,6 +58,10 @@ const long int kNotEmptyTimeoutMillis = 200;
 const long long int kMaxCursorCheckIntervalMillis = 500;
 const size_t kDeleteJobsHistory = 10;  // entries
 
+// Bounds of the delay between two batches of a throttled range delete.
+const mongo::Milliseconds kMinThrottleDelay{10};
+const mongo::Milliseconds kMaxThrottleDelay{1000};
+
 /**
  * Removes an element from the container that holds a pointer type, and deletes the
  * pointer as well. Returns true if the element was found.
@@ -157,7 +162,8 @@ bool RangeDeleter::NSMinMaxCmp::operator()(const NSMinMax* lhs, const NSMinMax*
 RangeDeleter::RangeDeleter(RangeDeleterEnv* env)
     : _env(env),  // ownership xfer
       _stopRequested(false),
-      _deletesInProgress(0) {}
+      _deletesInProgress(0),
+      _throttle(kMinThrottleDelay, kMaxThrottleDelay) {}
 
 RangeDeleter::~RangeDeleter() {
     for (TaskList::iterator it = _notReadyQueue.begin(); it != _notReadyQueue.end(); ++it) {
@@ -179,9 +185,14 @@ RangeDeleter::~RangeDeleter() {
     }
 }
 
-void RangeDeleter::startWorkers() {
-    if (!_worker) {
-        _worker.reset(new stdx::thread(stdx::bind(&RangeDeleter::doWork, this)));
+void RangeDeleter::startWorkers(size_t numWorkers) {
+    invariant(numWorkers > 0);
+    if (!_workers.empty()) {
+        return;
+    }
+
+    for (size_t i = 0; i < numWorkers; i++) {
+        _workers.emplace_back(new stdx::thread(stdx::bind(&RangeDeleter::doWork, this)));
     }
 }
 
@@ -191,8 +202,8 @@ void RangeDeleter::stopWorkers() {
         _stopRequested = true;
     }
 
-    if (_worker) {
-        _worker->join();
+    for (auto&& worker : _workers) {
+        worker->join();
     }
 
     stdx::unique_lock<stdx::mutex> sl(_queueMutex);
@@ -435,7 +446,8 @@ void RangeDeleter::doWork() {
 
         {
             stdx::unique_lock<stdx::mutex> sl(_queueMutex);
-            while (_taskQueue.empty()) {
+            TaskList::iterator taskIter = findRunnableTask_inlock();
+            while (taskIter == _taskQueue.end()) {
                 _taskQueueNotEmptyCV.wait_for(sl,
                                               stdx::chrono::milliseconds(kNotEmptyTimeoutMillis));
 
@@ -444,7 +456,7 @@ void RangeDeleter::doWork() {
                     return;
                 }
 
-                if (_taskQueue.empty()) {
+                if (findRunnableTask_inlock() == _taskQueue.end()) {
                     // Try to check if some deletes are ready and move them to the
                     // ready queue.
 
@@ -478,6 +490,9 @@ void RangeDeleter::doWork() {
                         }
                     }
                 }
+
+                // Moving tasks to the ready queue invalidates its iterators.
+                taskIter = findRunnableTask_inlock();
             }
 
             if (stopRequested()) {
@@ -485,9 +500,10 @@ void RangeDeleter::doWork() {
                 return;
             }
 
-            nextTask = _taskQueue.front();
-            _taskQueue.pop_front();
+            nextTask = *taskIter;
+            _taskQueue.erase(taskIter);
 
+            _nsInProgress.insert(nextTask->options.range.ns);
             _deletesInProgress++;
         }
 
@@ -518,8 +534,12 @@ void RangeDeleter::doWork() {
                               nextTask->options.range.minKey,
                               nextTask->options.range.maxKey);
             deletePtrElement(&_deleteSet, &setEntry);
+            _nsInProgress.erase(nextTask->options.range.ns);
             _deletesInProgress--;
 
+            // Other tasks on this namespace can be worked on again.
+            _taskQueueNotEmptyCV.notify_all();
+
             if (nextTask->notifyDone) {
                 nextTask->notifyDone->notifyOne();
             }
@@ -531,6 +551,15 @@ void RangeDeleter::doWork() {
     }
 }
 
+RangeDeleter::TaskList::iterator RangeDeleter::findRunnableTask_inlock() {
+    TaskList::iterator iter = _taskQueue.begin();
+    while (iter != _taskQueue.end() && _nsInProgress.count((*iter)->options.range.ns) > 0) {
+        ++iter;
+    }
+
+    return iter;
+}
+
 bool RangeDeleter::canEnqueue_inlock(StringData ns,
                                      const BSONObj& min,
                                      const BSONObj& max,
@@ -565,6 +594,10 @@ size_t RangeDeleter::getDeletesInProgress() const {
     return _deletesInProgress;
 }
 
+size_t RangeDeleter::getNumWorkers() const {
+    return _workers.size();
+}
+
 void RangeDeleter::recordDelStats(DeleteJobStats* newStat) {
     stdx::lock_guard<stdx::mutex> sl(_statsHistoryMutex);
     if (_statsHistory.size() == kDeleteJobsHistory) {
@@ -575,6 +608,46 @@ void RangeDeleter::recordDelStats(DeleteJobStats* newStat) {
     _statsHistory.push_back(newStat);
 }
 
+RangeDeleterThrottle::RangeDeleterThrottle(Milliseconds minDelay, Milliseconds maxDelay)
+    : _minDelay(minDelay), _maxDelay(maxDelay) {
+    invariant(_minDelay > Milliseconds(0));
+    invariant(_minDelay <= _maxDelay);
+}
+
+Milliseconds RangeDeleterThrottle::onBatchRemoved(long long numDeleted, bool underPressure) {
+    stdx::lock_guard<stdx::mutex> sl(_mutex);
+
+    _batches++;
+    _deletedDocs += numDeleted;
+
+    if (underPressure) {
+        _throttledBatches++;
+        _currentDelay = std::min(_maxDelay, std::max(_minDelay, _currentDelay * 2));
+    } else {
+        _currentDelay = _currentDelay / 2;
+        if (_currentDelay < _minDelay) {
+            _currentDelay = Milliseconds(0);
+        }
+    }
+
+    _totalDelay += _currentDelay;
+    return _currentDelay;
+}
+
+Milliseconds RangeDeleterThrottle::getCurrentDelay() const {
+    stdx::lock_guard<stdx::mutex> sl(_mutex);
+    return _currentDelay;
+}
+
+void RangeDeleterThrottle::appendStats(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> sl(_mutex);
+    builder->append("batches", _batches);
+    builder->append("throttledBatches", _throttledBatches);
+    builder->append("deletedDocs", _deletedDocs);
+    builder->append("currentDelayMillis", durationCount<Milliseconds>(_currentDelay));
+    builder->append("totalDelayMillis", durationCount<Milliseconds>(_totalDelay));
+}
+
 RangeDeleteEntry::RangeDeleteEntry(const RangeDeleterOptions& options)
     : options(options), notifyDone(NULL) {}
 
@@ -53,6 +53,52 @@ struct RangeDeleteEntry;
 struct RangeDeleterEnv;
 struct RangeDeleterOptions;
 
+/**
+ * Adaptive pacing for range deletes. The deleting thread reports every batch of documents
+ * it removes, along with whether the server is under pressure (replication falling behind
+ * or the storage engine cache filling up), and sleeps for the returned delay before
+ * removing the next batch.
+ *
+ * The delay starts at zero. Every batch under pressure doubles it, starting from minDelay
+ * and up to maxDelay, and every batch without pressure halves it back until it drops below
+ * minDelay and goes back to zero. The delay is shared by all the threads deleting ranges,
+ * since they all contribute to the same pressure.
+ *
+ * This class is thread safe.
+ */
+class RangeDeleterThrottle {
+    MONGO_DISALLOW_COPYING(RangeDeleterThrottle);
+
+public:
+    RangeDeleterThrottle(Milliseconds minDelay, Milliseconds maxDelay);
+
+    /**
+     * Records a removed batch and returns how long to wait before the next one.
+     */
+    Milliseconds onBatchRemoved(long long numDeleted, bool underPressure);
+
+    Milliseconds getCurrentDelay() const;
+
+    /**
+     * Appends the throttling statistics, for the rangeDeleter serverStatus section.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    const Milliseconds _minDelay;
+    const Milliseconds _maxDelay;
+
+    // Protects all the members below.
+    mutable stdx::mutex _mutex;
+
+    Milliseconds _currentDelay{0};
+
+    long long _batches{0};
+    long long _throttledBatches{0};
+    long long _deletedDocs{0};
+    Milliseconds _totalDelay{0};
+};
+
 /**
  * Class for deleting documents for a given namespace and range.  It contains a queue of
  * jobs to be deleted. Deletions can be "immediate", in which case they are going to be put
@@ -61,9 +107,11 @@ struct RangeDeleterOptions;
  *
  * Threading assumptions:
  *
- *   This class has (currently) one worker thread attacking the queue, one
- *   job at a time. If we want an immediate deletion, that job is going to
- *   be performed on the thread that is requesting it.
+ *   This class has a configurable number of worker threads attacking the queue,
+ *   each one working on one job at a time. Queued deletes on the same namespace are
+ *   never worked on concurrently, so a worker skips over the tasks of a namespace that
+ *   another worker is already deleting from. If we want an immediate deletion, that job
+ *   is going to be performed on the thread that is requesting it.
  *
  *   All calls regarding deletion are synchronized.
  *
@@ -96,15 +144,15 @@ public:
     //
 
     /**
-     * Starts the background thread to work on this queue. Does nothing if the worker
-     * thread is already active.
+     * Starts numWorkers background threads to work on this queue. Does nothing if the
+     * worker threads are already active.
      *
      * This call is _not_ thread safe and must be issued before any other call.
      */
-    void startWorkers();
+    void startWorkers(size_t numWorkers = 1);
 
     /**
-     * Stops the background thread working on this queue. This will block if there are
+     * Stops the background threads working on this queue. This will block if there are
      * tasks that are being deleted, but will leave the pending tasks in the queue.
      *
      * Steps:
@@ -160,6 +208,15 @@ public:
     size_t getTotalDeletes() const;
     size_t getPendingDeletes() const;
     size_t getDeletesInProgress() const;
+    size_t getNumWorkers() const;
+
+    /**
+     * Returns the throttle shared by all the deletes of this deleter. The environment is
+     * expected to report every removed batch to it. Owned by this deleter.
+     */
+    RangeDeleterThrottle* getThrottle() {
+        return &_throttle;
+    }
 
     //
     // Methods meant to be only used for testing. Should be treated like private
@@ -184,9 +241,15 @@ private:
 
     typedef std::set<NSMinMax*, NSMinMaxCmp> NSMinMaxSet;  // owned here
 
-    /** Body of the worker thread */
+    /** Body of the worker threads */
     void doWork();
 
+    /**
+     * Returns the first ready task whose namespace is not being deleted from by another
+     * worker, or _taskQueue.end() if there is none.
+     */
+    TaskList::iterator findRunnableTask_inlock();
+
     /** Returns true if the range doesn't intersect with one other range */
     bool canEnqueue_inlock(StringData ns,
                            const BSONObj& min,
@@ -199,7 +262,7 @@ private:
     std::unique_ptr<RangeDeleterEnv> _env;
 
     // Initially not active. Must be started explicitly.
-    std::unique_ptr<stdx::thread> _worker;
+    std::vector<std::unique_ptr<stdx::thread>> _workers;
 
     // Protects _stopRequested.
     mutable stdx::mutex _stopMutex;
@@ -238,6 +301,11 @@ private:
     // Keeps track of number of tasks that are in progress, including the inline deletes.
     size_t _deletesInProgress;
 
+    // Namespaces of the queued deletes that a worker is currently working on.
+    std::set<std::string> _nsInProgress;
+
+    RangeDeleterThrottle _throttle;
+
     // Protects _statsHistory
     mutable stdx::mutex _statsHistoryMutex;
     std::deque<DeleteJobStats*> _statsHistory;
@@ -39,7 +39,12 @@
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
+#include "mongo/db/range_deleter_service.h"
+#include "mongo/db/repl/optime.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/s/d_state.h"
 #include "mongo/util/log.h"
@@ -49,6 +54,55 @@ namespace mongo {
 using std::endl;
 using std::string;
 
+namespace {
+
+// The range deleter slows down when the majority commit point falls behind by more than
+// this many seconds, or when the storage engine cache is fuller than this ratio.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxReplicationLagSecs, int, 10);
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxCacheUsageRatio, double, 0.9);
+
+// Longest sleep between two checks for interruption while throttled.
+const Milliseconds kMaxThrottleSleep{100};
+
+/**
+ * Reports every batch of a range delete to the deleter's throttle and sleeps for as long
+ * as it says.
+ */
+class ThrottlingPacer : public Helpers::RemoveRangePacer {
+public:
+    explicit ThrottlingPacer(RangeDeleterThrottle* throttle) : _throttle(throttle) {}
+
+    void afterBatch(OperationContext* txn, long long numDeleted) override {
+        Milliseconds delay = _throttle->onBatchRemoved(numDeleted, _isUnderPressure());
+        while (delay > Milliseconds(0)) {
+            const Milliseconds sleep = std::min(delay, kMaxThrottleSleep);
+            sleepmillis(durationCount<Milliseconds>(sleep));
+            delay -= sleep;
+            txn->checkForInterrupt();
+        }
+    }
+
+private:
+    static bool _isUnderPressure() {
+        repl::ReplicationCoordinator* replCoord = repl::getGlobalReplicationCoordinator();
+        if (replCoord->getReplicationMode() == repl::ReplicationCoordinator::modeReplSet) {
+            const repl::OpTime lastCommitted = replCoord->getLastCommittedOpTime();
+            const repl::OpTime lastApplied = replCoord->getMyLastOptime();
+            if (!lastCommitted.isNull() &&
+                lastApplied.getSecs() - lastCommitted.getSecs() >
+                    rangeDeleterMaxReplicationLagSecs) {
+                return true;
+            }
+        }
+
+        StorageEngine* storageEngine = getGlobalServiceContext()->getGlobalStorageEngine();
+        return storageEngine->getCacheUsageRatio() > rangeDeleterMaxCacheUsageRatio;
+    }
+
+    RangeDeleterThrottle* const _throttle;
+};
+}
+
 /**
  * Outline of the delete process:
  * 1. Initialize the client for this thread if there is no client. This is for the worker
@@ -56,7 +110,7 @@ using std::string;
  * 2. Grant this thread authorization to perform deletes.
  * 3. Temporarily enable mode to bypass shard version checks. TODO: Replace this hack.
  * 4. Setup callback to save deletes to moveChunk directory (only if moveParanoia is true).
- * 5. Delete range.
+ * 5. Delete range, in batches paced by the deleter's throttle.
  * 6. Wait until the majority of the secondaries catch up.
  */
 bool RangeDeleterDBEnv::deleteRange(OperationContext* txn,
@@ -87,6 +141,8 @@ bool RangeDeleterDBEnv::deleteRange(OperationContext* txn,
         log() << "Deleter starting delete for: " << ns << " from " << inclusiveLower << " -> "
               << exclusiveUpper << ", with opId: " << opId << endl;
 
+        ThrottlingPacer pacer(getDeleter()->getThrottle());
+
         try {
             *deletedDocs =
                 Helpers::removeRange(txn,
@@ -95,7 +151,8 @@ bool RangeDeleterDBEnv::deleteRange(OperationContext* txn,
                                      writeConcern,
                                      removeSaverPtr,
                                      fromMigrate,
-                                     onlyRemoveOrphans);
+                                     onlyRemoveOrphans,
+                                     &pacer);
 
             if (*deletedDocs < 0) {
                 *errMsg = "collection or index dropped before data could be cleaned";
@@ -30,6 +30,7 @@
 
 #include "mongo/base/init.h"
 #include "mongo/db/range_deleter_db_env.h"
+#include "mongo/db/server_parameters.h"
 
 namespace {
 
@@ -38,6 +39,28 @@ mongo::RangeDeleter* _deleter = NULL;
 
 namespace mongo {
 
+int rangeDeleterWorkers = 2;
+
+namespace {
+
+class ExportedRangeDeleterWorkersParameter : public ExportedServerParameter<int> {
+public:
+    ExportedRangeDeleterWorkersParameter()
+        : ExportedServerParameter<int>(ServerParameterSet::getGlobal(),
+                                       "rangeDeleterWorkers",
+                                       &rangeDeleterWorkers,
+                                       true,
+                                       false) {}
+
+    virtual Status validate(const int& potentialNewValue) {
+        if (potentialNewValue < 1 || potentialNewValue > 16) {
+            return Status(ErrorCodes::BadValue, "rangeDeleterWorkers must be between 1 and 16");
+        }
+        return Status::OK();
+    }
+} exportedRangeDeleterWorkersParam;
+}
+
 MONGO_INITIALIZER(RangeDeleterInit)(InitializerContext* context) {
     _deleter = new RangeDeleter(new RangeDeleterDBEnv);
     return Status::OK();
@@ -32,6 +32,12 @@
 
 namespace mongo {
 
+/**
+ * Number of worker threads of the global deleter. Set at startup with the
+ * rangeDeleterWorkers server parameter.
+ */
+extern int rangeDeleterWorkers;
+
 /**
  * Gets the global instance of the deleter and starts it.
  */
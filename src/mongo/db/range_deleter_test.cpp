@@ -362,5 +362,92 @@ TEST(MixedDeletes, MultipleDeletes) {
     deleter.stopWorkers();
 }
 
+// Tests that multiple workers delete ranges from different namespaces concurrently, but
+// never two ranges from the same namespace.
+TEST(MultipleWorkers, OneDeletePerNamespace) {
+    const string ns1("test.user");
+    const string ns2("foo.bar");
+
+    RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
+    RangeDeleter deleter(env);
+
+    std::unique_ptr<mongo::repl::ReplicationCoordinatorMock> mock(
+        new mongo::repl::ReplicationCoordinatorMock(replSettings));
+
+    mongo::repl::ReplicationCoordinator::set(mongo::getGlobalServiceContext(), std::move(mock));
+
+    deleter.startWorkers(2);
+    ASSERT_EQUALS(2U, deleter.getNumWorkers());
+
+    env->pauseDeletes();
+
+    Notification notifyDone1;
+    RangeDeleterOptions deleterOption1(
+        KeyRange(ns1, BSON("x" << 10), BSON("x" << 20), BSON("x" << 1)));
+    ASSERT_TRUE(
+        deleter.queueDelete(noTxn, deleterOption1, &notifyDone1, NULL /* don't care errMsg */));
+
+    Notification notifyDone2;
+    RangeDeleterOptions deleterOption2(
+        KeyRange(ns1, BSON("x" << 20), BSON("x" << 30), BSON("x" << 1)));
+    ASSERT_TRUE(
+        deleter.queueDelete(noTxn, deleterOption2, &notifyDone2, NULL /* don't care errMsg */));
+
+    Notification notifyDone3;
+    RangeDeleterOptions deleterOption3(
+        KeyRange(ns2, BSON("x" << 10), BSON("x" << 20), BSON("x" << 1)));
+    ASSERT_TRUE(
+        deleter.queueDelete(noTxn, deleterOption3, &notifyDone3, NULL /* don't care errMsg */));
+
+    // Both workers are now deleting, one from each namespace. The second range of ns1 has
+    // to wait for the first one even though a worker would be free to take it.
+    env->waitForNthPausedDelete(2u);
+
+    ASSERT_EQUALS(3U, deleter.getTotalDeletes());
+    ASSERT_EQUALS(2U, deleter.getDeletesInProgress());
+    ASSERT_EQUALS(1U, deleter.getPendingDeletes());
+    ASSERT_FALSE(env->deleteOccured());
+
+    while (deleter.getTotalDeletes() > 0) {
+        env->resumeOneDelete();
+        sleepmillis(10);
+    }
+
+    notifyDone1.waitToBeNotified();
+    notifyDone2.waitToBeNotified();
+    notifyDone3.waitToBeNotified();
+
+    deleter.stopWorkers();
+}
+
+TEST(RangeDeleterThrottle, BacksOffUnderPressure) {
+    RangeDeleterThrottle throttle(Milliseconds(10), Milliseconds(100));
+
+    ASSERT_EQUALS(Milliseconds(0), throttle.onBatchRemoved(10, false));
+
+    ASSERT_EQUALS(Milliseconds(10), throttle.onBatchRemoved(10, true));
+    ASSERT_EQUALS(Milliseconds(20), throttle.onBatchRemoved(10, true));
+    ASSERT_EQUALS(Milliseconds(40), throttle.onBatchRemoved(10, true));
+    ASSERT_EQUALS(Milliseconds(80), throttle.onBatchRemoved(10, true));
+    ASSERT_EQUALS(Milliseconds(100), throttle.onBatchRemoved(10, true));
+    ASSERT_EQUALS(Milliseconds(100), throttle.onBatchRemoved(10, true));
+    ASSERT_EQUALS(Milliseconds(100), throttle.getCurrentDelay());
+
+    ASSERT_EQUALS(Milliseconds(50), throttle.onBatchRemoved(10, false));
+    ASSERT_EQUALS(Milliseconds(25), throttle.onBatchRemoved(10, false));
+    ASSERT_EQUALS(Milliseconds(12), throttle.onBatchRemoved(10, false));
+    ASSERT_EQUALS(Milliseconds(0), throttle.onBatchRemoved(10, false));
+    ASSERT_EQUALS(Milliseconds(0), throttle.getCurrentDelay());
+
+    BSONObjBuilder builder;
+    throttle.appendStats(&builder);
+    BSONObj stats = builder.obj();
+    ASSERT_EQUALS(11, stats["batches"].numberLong());
+    ASSERT_EQUALS(6, stats["throttledBatches"].numberLong());
+    ASSERT_EQUALS(110, stats["deletedDocs"].numberLong());
+    ASSERT_EQUALS(0, stats["currentDelayMillis"].numberLong());
+    ASSERT_EQUALS(437, stats["totalDelayMillis"].numberLong());
+}
+
 }  // unnamed namespace
 }  // namespace mongo
@@ -126,44 +126,58 @@ void checkOplogInsert(StatusWith<RecordId> result) {
 }
 
 /**
- * Allocates an optime for a new entry in the oplog, and updates the replication coordinator to
- * reflect that new optime.  Returns the new optime and the correct value of the "h" field for
- * the new oplog entry.
+ * An optime reserved for a new oplog entry, with the value of its "h" field.
+ */
+struct OplogSlot {
+    OpTime opTime;
+    long long hash;
+};
+
+/**
+ * Allocates 'count' consecutive optimes for new entries in the oplog, and updates the
+ * replication coordinator to reflect the last of them. The whole range is reserved with a
+ * single acquisition of newOpMutex, and only its first optime is registered with the storage
+ * system: all of the entries are written by the same storage transaction, so that one hole
+ * hides the others from readers until the transaction commits.
  *
- * NOTE: From the time this function returns to the time that the new oplog entry is written
+ * NOTE: From the time this function returns to the time that the new oplog entries are written
  * to the storage system, all errors must be considered fatal.  This is because the this
- * function registers the new optime with the storage system and the replication coordinator,
+ * function registers the new optimes with the storage system and the replication coordinator,
  * and provides no facility to revert those registrations on rollback.
  */
-std::pair<OpTime, long long> getNextOpTime(OperationContext* txn,
-                                           Collection* oplog,
-                                           const char* ns,
-                                           ReplicationCoordinator* replCoord,
-                                           const char* opstr) {
+void getNextOpTimes(OperationContext* txn,
+                    Collection* oplog,
+                    ReplicationCoordinator* replCoord,
+                    size_t count,
+                    std::vector<OplogSlot>* slotsOut) {
+    invariant(count > 0);
     synchronizeOnCappedInFlightResource(txn->lockState());
 
-    stdx::lock_guard<stdx::mutex> lk(newOpMutex);
-    Timestamp ts = getNextGlobalTimestamp();
-    newTimestampNotifier.notify_all();
+    long long term = OpTime::kProtocolVersionV0Term;
+    const bool isReplSet =
+        replCoord->getReplicationMode() == ReplicationCoordinator::modeReplSet;
 
-    fassert(28560, oplog->getRecordStore()->oplogDiskLocRegister(txn, ts));
+    // Current term. If we're not a replset of pv=1, it remains kOldProtocolVersionTerm.
+    if (isReplSet && replCoord->isV1ElectionProtocol()) {
+        term = ReplClientInfo::forClient(txn->getClient()).getTerm();
+    }
 
-    long long hashNew = 0;
-    long long term = OpTime::kProtocolVersionV0Term;
+    slotsOut->resize(count);
 
-    // Set hash and term if we're in replset mode, otherwise they remain 0 in master/slave.
-    if (replCoord->getReplicationMode() == ReplicationCoordinator::modeReplSet) {
-        // Current term. If we're not a replset of pv=1, it remains kOldProtocolVersionTerm.
-        if (replCoord->isV1ElectionProtocol()) {
-            term = ReplClientInfo::forClient(txn->getClient()).getTerm();
-        }
+    stdx::lock_guard<stdx::mutex> lk(newOpMutex);
+    const Timestamp first = getNextGlobalTimestamps(count);
+    newTimestampNotifier.notify_all();
+
+    fassert(28560, oplog->getRecordStore()->oplogDiskLocRegister(txn, first));
 
-        hashNew = hashGenerator.nextInt64();
+    for (size_t i = 0; i < count; i++) {
+        OplogSlot& slot = (*slotsOut)[i];
+        slot.opTime = OpTime(Timestamp(first.getSecs(), first.getInc() + i), term);
+        // Set the hash if we're in replset mode, otherwise it remains 0 in master/slave.
+        slot.hash = isReplSet ? hashGenerator.nextInt64() : 0;
     }
 
-    OpTime opTime(ts, term);
-    replCoord->setMyLastOptime(opTime);
-    return std::pair<OpTime, long long>(opTime, hashNew);
+    replCoord->setMyLastOptime(slotsOut->back().opTime);
 }
 
 /**
@@ -235,12 +249,22 @@ void setOplogCollectionName() {
 
 */
 
-void _logOp(OperationContext* txn,
-            const char* opstr,
-            const char* ns,
-            const BSONObj& obj,
-            BSONObj* o2,
-            bool fromMigrate) {
+namespace {
+/**
+ * Writes one oplog entry of type 'opstr' for each of the 'count' objects starting at 'objs',
+ * reserving their optimes together.
+ */
+void _logOps(OperationContext* txn,
+             const char* opstr,
+             const char* ns,
+             const BSONObj* objs,
+             size_t count,
+             BSONObj* o2,
+             bool fromMigrate) {
+    if (count == 0) {
+        return;
+    }
+
     NamespaceString nss(ns);
     if (nss.db() == "local") {
         return;
@@ -283,36 +307,59 @@ void _logOp(OperationContext* txn,
                 _localOplogCollection);
     }
 
-    std::pair<OpTime, long long> slot =
-        getNextOpTime(txn, _localOplogCollection, ns, replCoord, opstr);
+    std::vector<OplogSlot> slots;
+    getNextOpTimes(txn, _localOplogCollection, replCoord, count, &slots);
 
-    /* we jump through a bunch of hoops here to avoid copying the obj buffer twice --
-       instead we do a single copy to the destination position in the memory mapped file.
-    */
+    for (size_t i = 0; i < count; i++) {
+        /* we jump through a bunch of hoops here to avoid copying the obj buffer twice --
+           instead we do a single copy to the destination position in the memory mapped file.
+        */
 
-    BSONObjBuilder b(256);
-    b.append(kTimestampFieldName, slot.first.getTimestamp());
-    // Don't add term in protocol version 0.
-    if (slot.first.getTerm() != OpTime::kProtocolVersionV0Term) {
-        b.append(kTermFieldName, slot.first.getTerm());
-    }
-    b.append("h", slot.second);
-    b.append("v", OPLOG_VERSION);
-    b.append("op", opstr);
-    b.append("ns", ns);
-    if (fromMigrate) {
-        b.appendBool("fromMigrate", true);
-    }
+        BSONObjBuilder b(256);
+        b.append(kTimestampFieldName, slots[i].opTime.getTimestamp());
+        // Don't add term in protocol version 0.
+        if (slots[i].opTime.getTerm() != OpTime::kProtocolVersionV0Term) {
+            b.append(kTermFieldName, slots[i].opTime.getTerm());
+        }
+        b.append("h", slots[i].hash);
+        b.append("v", OPLOG_VERSION);
+        b.append("op", opstr);
+        b.append("ns", ns);
+        if (fromMigrate) {
+            b.appendBool("fromMigrate", true);
+        }
+
+        if (o2) {
+            b.append("o2", *o2);
+        }
+        BSONObj partial = b.done();
 
-    if (o2) {
-        b.append("o2", *o2);
+        OplogDocWriter writer(partial, objs[i]);
+        checkOplogInsert(_localOplogCollection->insertDocument(txn, &writer, false));
     }
-    BSONObj partial = b.done();
 
-    OplogDocWriter writer(partial, obj);
-    checkOplogInsert(_localOplogCollection->insertDocument(txn, &writer, false));
+    ReplClientInfo::forClient(txn->getClient()).setLastOp(slots.back().opTime);
+}
+}  // namespace
 
-    ReplClientInfo::forClient(txn->getClient()).setLastOp(slot.first);
+void _logOp(OperationContext* txn,
+            const char* opstr,
+            const char* ns,
+            const BSONObj& obj,
+            BSONObj* o2,
+            bool fromMigrate) {
+    _logOps(txn, opstr, ns, &obj, 1, o2, fromMigrate);
+}
+
+void _logInserts(OperationContext* txn,
+                 const char* ns,
+                 std::vector<BSONObj>::const_iterator begin,
+                 std::vector<BSONObj>::const_iterator end,
+                 bool fromMigrate) {
+    if (begin == end) {
+        return;
+    }
+    _logOps(txn, "i", ns, &*begin, std::distance(begin, end), nullptr, fromMigrate);
 }
 
 OpTime writeOpsToOplog(OperationContext* txn, const std::deque<BSONObj>& ops) {
@@ -31,9 +31,11 @@
 #include <cstddef>
 #include <deque>
 #include <string>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/time_support.h"
@@ -87,6 +89,17 @@ void _logOp(OperationContext* txn,
             BSONObj* o2,
             bool fromMigrate);
 
+/**
+ * Log an insert of each document in [begin, end) to the local oplog. The optimes of all of the
+ * entries are reserved in one step, so a batch of N documents costs one reservation rather
+ * than N.
+ */
+void _logInserts(OperationContext* txn,
+                 const char* ns,
+                 std::vector<BSONObj>::const_iterator begin,
+                 std::vector<BSONObj>::const_iterator end,
+                 bool fromMigrate);
+
 // Flush out the cached pointers to the local database and oplog.
 // Used by the closeDatabase command to ensure we don't cache closed things.
 void oplogCheckCloseDatabase(OperationContext* txn, Database* db);
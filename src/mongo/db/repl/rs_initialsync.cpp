@@ -54,6 +54,7 @@
 #include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -69,6 +70,12 @@ using std::string;
 // Failpoint which fails initial sync and leaves on oplog entry in the buffer.
 MONGO_FP_DECLARE(failInitSyncWithBufferedEntriesLeft);
 
+// Number of collections of a database cloned at the same time during initial sync.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncCloneThreads, int, 4);
+
+// Feed the _id and non-unique indexes while cloning rather than scanning each collection again.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncBuildIndexesDuringClone, bool, true);
+
 /**
  * Truncates the oplog (removes any documents) and resets internal variables that were
  * originally initialized or affected by using values from the oplog at startup time.  These
@@ -188,6 +195,8 @@ bool _initialSyncClone(OperationContext* txn,
         options.mayBeInterrupted = false;
         options.syncData = dataPass;
         options.syncIndexes = !dataPass;
+        options.parallelCollections = std::max(1, initialSyncCloneThreads);
+        options.buildIndexesDuringClone = initialSyncBuildIndexesDuringClone;
 
         // Make database stable
         ScopedTransaction transaction(txn, MODE_IX);
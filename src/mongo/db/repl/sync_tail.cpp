@@ -38,6 +38,7 @@
 #include "third_party/murmurhash3/MurmurHash3.h"
 
 #include "mongo/base/counter.h"
+#include "mongo/base/init.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
@@ -58,11 +59,14 @@
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replica_set_config.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/timer_stats.h"
+#include "mongo/platform/unordered_map.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/processinfo.h"
 
 namespace mongo {
 
@@ -70,15 +74,51 @@ using std::endl;
 
 namespace repl {
 #if defined(MONGO_PLATFORM_64)
-const int replWriterThreadCount = 16;
 const int replPrefetcherThreadCount = 16;
+const int kMinDefaultReplWriterThreadCount = 16;
 #elif defined(MONGO_PLATFORM_32)
-const int replWriterThreadCount = 2;
 const int replPrefetcherThreadCount = 2;
+const int kMinDefaultReplWriterThreadCount = 2;
 #else
 #error need to include something that defines MONGO_PLATFORM_XX
 #endif
 
+const int kMaxReplWriterThreadCount = 256;
+
+// Number of threads applying each batch of replicated operations. 0 sizes the pool from the
+// number of cores.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(replWriterThreadCount, int, 0);
+MONGO_INITIALIZER(replWriterThreadCount)(InitializerContext*) {
+    if (replWriterThreadCount < 0 || replWriterThreadCount > kMaxReplWriterThreadCount) {
+        return Status(ErrorCodes::BadValue,
+                      str::stream() << "replWriterThreadCount must be between 0 and "
+                                    << kMaxReplWriterThreadCount << ", but was "
+                                    << replWriterThreadCount);
+    }
+    return Status::OK();
+}
+
+namespace {
+int computeReplWriterThreadCount() {
+    if (replWriterThreadCount > 0)
+        return replWriterThreadCount;
+
+#if defined(MONGO_PLATFORM_64)
+    const int numCores = ProcessInfo().getNumCores();
+    return std::min(std::max(2 * numCores, kMinDefaultReplWriterThreadCount),
+                    kMaxReplWriterThreadCount);
+#else
+    return kMinDefaultReplWriterThreadCount;
+#endif
+}
+
+// The writer pool and the vectors of ops handed to it must always have the same size.
+int getReplWriterThreadCount() {
+    static const int count = computeReplWriterThreadCount();
+    return count;
+}
+}  // namespace
+
 static Counter64 opsAppliedStats;
 
 // The oplog entries applied
@@ -111,7 +151,7 @@ bool isCrudOpType(const char* field) {
 SyncTail::SyncTail(BackgroundSyncInterface* q, MultiSyncApplyFunc func)
     : _networkQueue(q),
       _applyFunc(func),
-      _writerPool(replWriterThreadCount, "repl writer worker "),
+      _writerPool(getReplWriterThreadCount(), "repl writer worker "),
       _prefetcherPool(replPrefetcherThreadCount, "repl prefetch worker ") {}
 
 SyncTail::~SyncTail() {}
@@ -291,8 +331,42 @@ void applyOps(const std::vector<std::vector<BSONObj>>& writerVectors,
     writerPool->join();
 }
 
-void fillWriterVectors(const std::deque<BSONObj>& ops,
+// Returns whether "ns" is a capped collection, caching the answer for the rest of the batch.
+bool isCappedCollection(OperationContext* txn,
+                        StringData ns,
+                        unordered_map<std::string, bool>* cappedByNs) {
+    auto it = cappedByNs->find(ns.toString());
+    if (it != cappedByNs->end())
+        return it->second;
+
+    bool isCapped = false;
+    {
+        ScopedTransaction transaction(txn, MODE_IS);
+        Lock::DBLock dbLock(txn->lockState(), nsToDatabaseSubstring(ns), MODE_IS);
+        Lock::CollectionLock collLock(txn->lockState(), ns, MODE_IS);
+        Database* db = dbHolder().get(txn, ns);
+        Collection* collection = db ? db->getCollection(ns) : nullptr;
+        isCapped = collection && collection->isCapped();
+    }
+
+    cappedByNs->insert(std::make_pair(ns.toString(), isCapped));
+    return isCapped;
+}
+
+// Partitions the ops of a batch between the writer threads. Ops on the same namespace go to the
+// same writer, except for CRUD ops with document level locking, which are further partitioned by
+// _id so that a batch which only touches one collection is still applied in parallel. All ops on
+// the same document keep going to the same writer, which applies them in oplog order.
+//
+// Capped collections are not partitioned by _id, because their documents must be inserted in the
+// same order as on the primary.
+void fillWriterVectors(OperationContext* txn,
+                       const std::deque<BSONObj>& ops,
                        std::vector<std::vector<BSONObj>>* writerVectors) {
+    const bool supportsDocLocking =
+        getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking();
+    unordered_map<std::string, bool> cappedByNs;
+
     for (std::deque<BSONObj>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
         const BSONElement e = it->getField("ns");
         verify(e.type() == String);
@@ -303,8 +377,8 @@ void fillWriterVectors(const std::deque<BSONObj>& ops,
 
         const char* opType = it->getField("op").valuestrsafe();
 
-        if (getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking() &&
-            isCrudOpType(opType)) {
+        if (supportsDocLocking && isCrudOpType(opType) &&
+            !isCappedCollection(txn, StringData(ns, len - 1), &cappedByNs)) {
             BSONElement id;
             switch (opType[0]) {
                 case 'u':
@@ -345,9 +419,9 @@ OpTime SyncTail::multiApply(OperationContext* txn,
         prefetchOps(ops.getDeque(), prefetcherPool);
     }
 
-    std::vector<std::vector<BSONObj>> writerVectors(replWriterThreadCount);
+    std::vector<std::vector<BSONObj>> writerVectors(getReplWriterThreadCount());
 
-    fillWriterVectors(ops.getDeque(), &writerVectors);
+    fillWriterVectors(txn, ops.getDeque(), &writerVectors);
     LOG(2) << "replication batch size is " << ops.getDeque().size() << endl;
     // We must grab this because we're going to grab write locks later.
     // We hold this mutex the entire time we're writing; it doesn't matter
@@ -49,6 +49,7 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <snappy.h>
+#include <third_party/murmurhash3/MurmurHash3.h>
 
 #include "mongo/base/string_data.h"
 #include "mongo/config.h"
@@ -56,8 +57,11 @@
 #include "mongo/db/storage_options.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/s/mongos_options.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/print.h"
 #include "mongo/util/unowned_ptr.h"
@@ -76,6 +80,20 @@ inline std::string myErrnoWithDescription() {
     return sb.str();
 }
 
+/**
+ * Spill files are a sequence of blocks, each holding a whole number of serialized key/value
+ * pairs:
+ *
+ *   int32  size      // size of the data. Negative if the data is snappy compressed.
+ *   uint32 checksum  // MurmurHash3_x86_32 of the data as stored
+ *   char   data[abs(size)]
+ */
+inline uint32_t blockChecksum(const char* data, int32_t size) {
+    uint32_t checksum;
+    MurmurHash3_x86_32(data, size, 0, &checksum);
+    return checksum;
+}
+
 template <typename Data, typename Comparator>
 void compIsntSane(const Comparator& comp, const Data& lhs, const Data& rhs) {
     PRINT(typeid(comp).name());
@@ -215,6 +233,10 @@ private:
         if (_done)
             return;
 
+        uint32_t checksum;
+        read(&checksum, sizeof(checksum));
+        massert(28729, "file too short?", !_done);
+
         // negative size means compressed
         const bool compressed = rawSize < 0;
         const int32_t blockSize = std::abs(rawSize);
@@ -223,6 +245,11 @@ private:
         read(_buffer.get(), blockSize);
         massert(16816, "file too short?", !_done);
 
+        massert(28728,
+                str::stream() << "checksum mismatch in sorter spill file \"" << _fileName
+                              << "\": the file is corrupt",
+                blockChecksum(_buffer.get(), blockSize) == checksum);
+
         if (!compressed) {
             _reader.reset(new BufReader(_buffer.get(), blockSize));
             return;
@@ -270,6 +297,115 @@ private:
     std::ifstream _file;
 };
 
+/**
+ * Wraps an iterator over a spill file and reads the next batch of its data on a thread pool
+ * while the current batch is being consumed, so that reading and decompressing spill files
+ * overlaps with merging them.
+ */
+template <typename Key, typename Value>
+class ReadAheadIterator : public SortIteratorInterface<Key, Value> {
+public:
+    typedef SortIteratorInterface<Key, Value> Input;
+    typedef std::pair<Key, Value> Data;
+
+    ReadAheadIterator(std::shared_ptr<Input> source,
+                      std::shared_ptr<ThreadPool> pool,
+                      size_t batchBytes)
+        : _pool(pool), _state(std::make_shared<State>(source, batchBytes)), _pos(0) {
+        scheduleFill();
+    }
+
+    ~ReadAheadIterator() {
+        // A pending fill still references the source, so let it finish before the source goes
+        // away.
+        waitForFill();
+    }
+
+    bool more() {
+        if (_pos < _batch.size())
+            return true;
+
+        waitForFill();
+        uassertStatusOK(_state->status);
+        _batch.clear();
+        _batch.swap(_state->batch);
+        _pos = 0;
+
+        if (_batch.empty())
+            return false;
+
+        scheduleFill();
+        return true;
+    }
+
+    Data next() {
+        verify(more());
+        return _batch[_pos++];
+    }
+
+private:
+    struct State {
+        State(std::shared_ptr<Input> source, size_t batchBytes)
+            : source(source), batchBytes(batchBytes), filling(false), status(Status::OK()) {}
+
+        const std::shared_ptr<Input> source;
+        const size_t batchBytes;
+
+        stdx::mutex mutex;
+        stdx::condition_variable cond;
+        bool filling;  // true while a fill task is scheduled or running
+        Status status;
+        std::vector<Data> batch;
+    };
+
+    void scheduleFill() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+            _state->filling = true;
+        }
+
+        std::shared_ptr<State> state = _state;
+        fassert(28726, _pool->schedule([state] { fill(state.get()); }));
+    }
+
+    void waitForFill() {
+        stdx::unique_lock<stdx::mutex> lk(_state->mutex);
+        while (_state->filling) {
+            _state->cond.wait(lk);
+        }
+    }
+
+    static void fill(State* state) {
+        std::vector<Data> batch;
+        Status status = Status::OK();
+        try {
+            size_t bytes = 0;
+            while (bytes < state->batchBytes && state->source->more()) {
+                Data data = state->source->next();
+                bytes += data.first.memUsageForSorter() + data.second.memUsageForSorter();
+
+                // The source only guarantees its output until the next call into it.
+                batch.push_back(std::make_pair(data.first.getOwned(), data.second.getOwned()));
+            }
+        } catch (const DBException& ex) {
+            status = ex.toStatus();
+        } catch (const std::exception& ex) {
+            status = Status(ErrorCodes::InternalError, ex.what());
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(state->mutex);
+        state->batch.swap(batch);
+        state->status = status;
+        state->filling = false;
+        state->cond.notify_all();
+    }
+
+    const std::shared_ptr<ThreadPool> _pool;
+    const std::shared_ptr<State> _state;
+    std::vector<Data> _batch;  // the batch being consumed
+    size_t _pos;
+};
+
 /** Merge-sorts results from 0 or more FileIterators */
 template <typename Key, typename Value, typename Comparator>
 class MergeIterator : public SortIteratorInterface<Key, Value> {
@@ -495,6 +631,222 @@ private:
     std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
 };
 
+/**
+ * A NoLimitSorter which sorts and spills its runs on a pool of opts.numThreads threads while
+ * the caller keeps adding data, and reads the spill files ahead while merging them.
+ *
+ * Until the first spill this behaves like NoLimitSorter: data that fits into
+ * opts.maxMemoryUsageBytes is sorted in memory by done(). The first full run is split into one
+ * run per thread. After that, runs are sized so that the runs being sorted plus the one being
+ * filled stay within the memory limit; add() blocks while that is not the case.
+ */
+template <typename Key, typename Value, typename Comparator>
+class ParallelNoLimitSorter : public Sorter<Key, Value> {
+public:
+    typedef std::pair<Key, Value> Data;
+    typedef SortIteratorInterface<Key, Value> Iterator;
+    typedef std::pair<typename Key::SorterDeserializeSettings,
+                      typename Value::SorterDeserializeSettings> Settings;
+
+    ParallelNoLimitSorter(const SortOptions& opts,
+                          const Comparator& comp,
+                          const Settings& settings = Settings())
+        : _comp(comp),
+          _settings(settings),
+          _opts(opts),
+          _pool(makePool(opts.numThreads)),
+          _runMemoryLimit(opts.maxMemoryUsageBytes),
+          _memUsed(0),
+          _inFlightMemUsed(0),
+          _runsInFlight(0),
+          _workerStatus(Status::OK()) {
+        verify(_opts.limit == 0);
+        verify(_opts.numThreads > 1);
+        verify(_opts.extSortAllowed);
+    }
+
+    ~ParallelNoLimitSorter() {
+        // Runs in flight reference this sorter.
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (_runsInFlight > 0) {
+            _cond.wait(lk);
+        }
+    }
+
+    void add(const Key& key, const Value& val) {
+        _data.push_back(std::make_pair(key, val));
+
+        _memUsed += key.memUsageForSorter();
+        _memUsed += val.memUsageForSorter();
+
+        if (_memUsed > _runMemoryLimit)
+            spill();
+    }
+
+    Iterator* done() {
+        if (_iters.empty()) {
+            STLComparator less(_comp);
+            std::stable_sort(_data.begin(), _data.end(), less);
+            return new InMemIterator<Key, Value>(_data);
+        }
+
+        if (!_data.empty())
+            startRun(&_data, _memUsed);
+
+        std::vector<std::shared_ptr<Iterator>> iters;
+        {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            while (_runsInFlight > 0) {
+                _cond.wait(lk);
+            }
+            uassertStatusOK(_workerStatus);
+            iters.swap(_iters);
+        }
+
+        const size_t batchBytes =
+            std::max(size_t(64 * 1024), _opts.maxMemoryUsageBytes / (2 * iters.size()));
+        for (auto&& it : iters) {
+            it = std::make_shared<ReadAheadIterator<Key, Value>>(it, _pool, batchBytes);
+        }
+        return Iterator::merge(iters, _opts, _comp);
+    }
+
+    // TEMP these are here for compatibility. Will be replaced with a general stats API
+    int numFiles() const {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _iters.size();
+    }
+    size_t memUsed() const {
+        return _memUsed;
+    }
+
+private:
+    class STLComparator {
+    public:
+        explicit STLComparator(const Comparator& comp) : _comp(comp) {}
+        bool operator()(const Data& lhs, const Data& rhs) const {
+            dassertCompIsSane(_comp, lhs, rhs);
+            return _comp(lhs, rhs) < 0;
+        }
+
+    private:
+        const Comparator& _comp;
+    };
+
+    static std::shared_ptr<ThreadPool> makePool(size_t numThreads) {
+        ThreadPool::Options options;
+        options.poolName = "sorter";
+        options.minThreads = 0;
+        options.maxThreads = numThreads;
+        auto pool = std::make_shared<ThreadPool>(options);
+        pool->startup();
+        return pool;
+    }
+
+    void spill() {
+        if (_data.empty())
+            return;
+
+        if (_iters.empty()) {
+            // First spill: split the full run so that all threads work on it.
+            const size_t numRuns = std::min(_opts.numThreads, _data.size());
+            const size_t runSize = (_data.size() + numRuns - 1) / numRuns;
+            for (size_t start = 0; start < _data.size(); start += runSize) {
+                const size_t end = std::min(start + runSize, _data.size());
+                std::vector<Data> run(std::make_move_iterator(_data.begin() + start),
+                                      std::make_move_iterator(_data.begin() + end));
+                size_t runMemUsed = 0;
+                for (const auto& data : run) {
+                    runMemUsed += data.first.memUsageForSorter();
+                    runMemUsed += data.second.memUsageForSorter();
+                }
+                startRun(&run, runMemUsed);
+            }
+            _data.clear();
+            _runMemoryLimit = _opts.maxMemoryUsageBytes / (_opts.numThreads + 1);
+        } else {
+            startRun(&_data, _memUsed);
+        }
+        _memUsed = 0;
+
+        // Don't fill the next run until there is room for it.
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (_runsInFlight > 0 &&
+               _inFlightMemUsed + _runMemoryLimit > _opts.maxMemoryUsageBytes) {
+            _cond.wait(lk);
+        }
+        uassertStatusOK(_workerStatus);
+    }
+
+    /**
+     * Hands the contents of 'run' to the pool, leaving it empty. The run gets the next slot in
+     * _iters so that the merge keeps equal keys in insertion order.
+     */
+    void startRun(std::vector<Data>* run, size_t runMemUsed) {
+        auto runData = std::make_shared<std::vector<Data>>();
+        runData->swap(*run);
+
+        size_t runNumber;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            runNumber = _iters.size();
+            _iters.push_back(std::shared_ptr<Iterator>());
+            _runsInFlight++;
+            _inFlightMemUsed += runMemUsed;
+        }
+
+        Status status =
+            _pool->schedule([this, runData, runNumber, runMemUsed] {
+                sortAndSpillRun(runData.get(), runNumber, runMemUsed);
+            });
+        fassert(28727, status);
+    }
+
+    void sortAndSpillRun(std::vector<Data>* run, size_t runNumber, size_t runMemUsed) {
+        std::shared_ptr<Iterator> iter;
+        Status status = Status::OK();
+        try {
+            STLComparator less(_comp);
+            std::stable_sort(run->begin(), run->end(), less);
+
+            SortedFileWriter<Key, Value> writer(_opts, _settings);
+            for (const auto& data : *run) {
+                writer.addAlreadySorted(data.first, data.second);
+            }
+            std::vector<Data>().swap(*run);
+            iter.reset(writer.done());
+        } catch (const DBException& ex) {
+            status = ex.toStatus();
+        } catch (const std::exception& ex) {
+            status = Status(ErrorCodes::InternalError, ex.what());
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _iters[runNumber] = iter;
+        if (!status.isOK() && _workerStatus.isOK())
+            _workerStatus = status;
+        _inFlightMemUsed -= runMemUsed;
+        _runsInFlight--;
+        _cond.notify_all();
+    }
+
+    const Comparator _comp;
+    const Settings _settings;
+    SortOptions _opts;
+    const std::shared_ptr<ThreadPool> _pool;
+    size_t _runMemoryLimit;  // spill once the current run uses more than this
+    size_t _memUsed;         // memory used by _data
+    std::vector<Data> _data;  // the run being filled
+
+    // Shared with the runs being sorted and spilled on _pool.
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _cond;
+    size_t _inFlightMemUsed;
+    size_t _runsInFlight;
+    Status _workerStatus;                           // first error from a run
+    std::vector<std::shared_ptr<Iterator>> _iters;  // one per run, in the order they started
+};
+
 template <typename Key, typename Value, typename Comparator>
 class LimitOneSorter : public Sorter<Key, Value> {
     // Since this class is only used for limit==1, it omits all logic to
@@ -823,6 +1175,7 @@ SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts, const Se
             _file.good());
 
     _fileDeleter = std::make_shared<sorter::FileDeleter>(_fileName);
+    sorterSpillStats().files.increment();
 
     // throw on failure
     _file.exceptions(std::ios::failbit | std::ios::badbit | std::ios::eofbit);
@@ -848,22 +1201,26 @@ void SortedFileWriter<Key, Value>::spill() {
     snappy::Compress(_buffer.buf(), _buffer.len(), &compressed);
     verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
 
+    // Only keep the compressed data if it saves at least 10%.
+    const bool useCompressed = compressed.size() < size_t(_buffer.len() / 10 * 9);
+    const char* data = useCompressed ? compressed.data() : _buffer.buf();
+    const int32_t dataSize = useCompressed ? int32_t(compressed.size()) : _buffer.len();
+    const int32_t size = useCompressed ? -dataSize : dataSize;  // negative means compressed
+    const uint32_t checksum = sorter::blockChecksum(data, dataSize);
+
     try {
-        if (compressed.size() < size_t(_buffer.len() / 10 * 9)) {
-            const int32_t size = -int32_t(compressed.size());  // negative means compressed
-            _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-            _file.write(compressed.data(), compressed.size());
-        } else {
-            const int32_t size = _buffer.len();
-            _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-            _file.write(_buffer.buf(), _buffer.len());
-        }
+        _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        _file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+        _file.write(data, dataSize);
     } catch (const std::exception&) {
         msgasserted(16821,
                     str::stream() << "error writing to file \"" << _fileName
                                   << "\": " << sorter::myErrnoWithDescription());
     }
 
+    sorterSpillStats().uncompressedBytes.increment(_buffer.len());
+    sorterSpillStats().bytesWritten.increment(sizeof(size) + sizeof(checksum) + dataSize);
+
     _buffer.reset();
 }
 
@@ -903,6 +1260,10 @@ Sorter<Key, Value>* Sorter<Key, Value>::make(const SortOptions& opts,
 
     switch (opts.limit) {
         case 0:
+            if (opts.numThreads > 1 && opts.extSortAllowed) {
+                return new sorter::ParallelNoLimitSorter<Key, Value, Comparator>(
+                    opts, comp, settings);
+            }
             return new sorter::NoLimitSorter<Key, Value, Comparator>(opts, comp, settings);
         case 1:
             return new sorter::LimitOneSorter<Key, Value, Comparator>(opts, comp);
@@ -34,6 +34,7 @@
 #include <utility>
 #include <vector>
 
+#include "mongo/base/counter.h"
 #include "mongo/base/disallow_copying.h"
 #include "mongo/bson/util/builder.h"
 
@@ -88,6 +89,20 @@ namespace sorter {
 class FileDeleter;
 }
 
+/**
+ * Totals over all spill files written by any Sorter in this process.
+ */
+struct SorterSpillStats {
+    Counter64 files;              /// spill files created
+    Counter64 uncompressedBytes;  /// serialized data before compression
+    Counter64 bytesWritten;       /// bytes written to spill files, including block headers
+};
+
+inline SorterSpillStats& sorterSpillStats() {
+    static SorterSpillStats stats;
+    return stats;
+}
+
 /**
  * Runtime options that control the Sorter's behavior
  */
@@ -97,8 +112,12 @@ struct SortOptions {
     bool extSortAllowed;         /// If false, uassert if more mem needed than allowed.
     std::string tempDir;         /// Directory to directly place files in.
                                  /// Must be explicitly set if extSortAllowed is true.
+    size_t numThreads;           /// Threads used to sort and spill runs and to read spill
+                                 /// files ahead while merging. Only used for external sorts
+                                 /// without a limit. 1 sorts on the caller's thread.
 
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    SortOptions()
+        : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false), numThreads(1) {}
 
     /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -121,6 +140,11 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& NumThreads(size_t newNumThreads) {
+        numThreads = newNumThreads;
+        return *this;
+    }
 };
 
 /// This is the output from the sorting framework
@@ -215,11 +239,13 @@ private:
     template class ::mongo::SortedFileWriter<Key, Value>;                                \
     /* internal classes */                                                               \
     template class ::mongo::sorter::NoLimitSorter<Key, Value, Comparator>;               \
+    template class ::mongo::sorter::ParallelNoLimitSorter<Key, Value, Comparator>;       \
     template class ::mongo::sorter::LimitOneSorter<Key, Value, Comparator>;              \
     template class ::mongo::sorter::TopKSorter<Key, Value, Comparator>;                  \
     template class ::mongo::sorter::MergeIterator<Key, Value, Comparator>;               \
     template class ::mongo::sorter::InMemIterator<Key, Value>;                           \
     template class ::mongo::sorter::FileIterator<Key, Value>;                            \
+    template class ::mongo::sorter::ReadAheadIterator<Key, Value>;                       \
     /* factory functions */                                                              \
     template ::mongo::SortIteratorInterface<Key, Value>* ::mongo::                       \
         SortIteratorInterface<Key, Value>::merge<Comparator>(                            \
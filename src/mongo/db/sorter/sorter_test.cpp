@@ -262,6 +262,37 @@ public:
             ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
                                         make_shared<IntIterator>(0, 10 * 1000 * 1000));
         }
+        {  // spill stats
+            const long long files = sorterSpillStats().files.get();
+            const long long uncompressedBytes = sorterSpillStats().uncompressedBytes.get();
+            const long long bytesWritten = sorterSpillStats().bytesWritten.get();
+
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(opts);
+            for (int i = 0; i < 5; i++)
+                sorter.addAlreadySorted(i, -i);
+            std::shared_ptr<IWIterator> iter(sorter.done());
+
+            // 5 pairs of two ints in a single uncompressed block with an 8 byte header.
+            ASSERT_EQUALS(files + 1, sorterSpillStats().files.get());
+            ASSERT_EQUALS(uncompressedBytes + 40, sorterSpillStats().uncompressedBytes.get());
+            ASSERT_EQUALS(bytesWritten + 48, sorterSpillStats().bytesWritten.get());
+        }
+        {  // corrupt block
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(opts);
+            for (int i = 0; i < 5; i++)
+                sorter.addAlreadySorted(i, -i);
+            std::shared_ptr<IWIterator> iter(sorter.done());
+
+            const boost::filesystem::path file =
+                boost::filesystem::directory_iterator(tempDir.path())->path();
+            std::fstream stream(file.string().c_str(),
+                                std::ios::in | std::ios::out | std::ios::binary);
+            stream.seekp(-1, std::ios::end);
+            stream.put('x');
+            stream.close();
+
+            ASSERT_THROWS(iter->more(), MsgAssertionException);
+        }
 
         ASSERT(boost::filesystem::is_empty(tempDir.path()));
     }
@@ -510,6 +541,15 @@ public:
     std::unique_ptr<int[]> _array;
 };
 
+// Same as LotsOfDataLittleMemory, but runs are sorted and spilled on a thread pool and the
+// spill files are read ahead while merging.
+template <bool Random = true>
+class ParallelLotsOfDataLittleMemory : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+    SortOptions adjustSortOptions(SortOptions opts) {
+        return Parent::adjustSortOptions(opts).NumThreads(4);
+    }
+};
 
 template <long long Limit, bool Random = true>
 class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
@@ -553,6 +593,8 @@ public:
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::ParallelLotsOfDataLittleMemory</*random=*/false>>();
+        add<SorterTests::ParallelLotsOfDataLittleMemory</*random=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
@@ -165,8 +165,56 @@ void NetworkCounter::append(BSONObjBuilder& b) {
     _lock.unlock();
 }
 
+void ServiceReactorCounter::enable(int ioThreads, int minWorkerThreads) {
+    _enabled = true;
+    _ioThreads = ioThreads;
+    _minWorkerThreads = minWorkerThreads;
+}
+
+void ServiceReactorCounter::gotConnection() {
+    _connections.addAndFetch(1);
+}
+
+void ServiceReactorCounter::gotDisconnection() {
+    _connections.subtractAndFetch(1);
+}
+
+void ServiceReactorCounter::gotQueued() {
+    _queueDepth.addAndFetch(1);
+    _totalQueued.addAndFetch(1);
+}
+
+void ServiceReactorCounter::gotDequeued(long long queuedMicros) {
+    _queueDepth.subtractAndFetch(1);
+    _totalQueuedMicros.addAndFetch(queuedMicros);
+
+    long long currentMax = _maxQueuedMicros.loadRelaxed();
+    while (queuedMicros > currentMax) {
+        const long long prev = _maxQueuedMicros.compareAndSwap(currentMax, queuedMicros);
+        if (prev == currentMax)
+            break;
+        currentMax = prev;
+    }
+}
+
+void ServiceReactorCounter::append(BSONObjBuilder& b) {
+    if (!_enabled)
+        return;
+
+    BSONObjBuilder reactor(b.subobjStart("serviceReactor"));
+    reactor.append("ioThreads", _ioThreads);
+    reactor.append("minWorkerThreads", _minWorkerThreads);
+    reactor.appendNumber("connections", _connections.loadRelaxed());
+    reactor.appendNumber("queueDepth", _queueDepth.loadRelaxed());
+    reactor.appendNumber("totalQueued", _totalQueued.loadRelaxed());
+    reactor.appendNumber("totalQueuedMicros", _totalQueuedMicros.loadRelaxed());
+    reactor.appendNumber("maxQueuedMicros", _maxQueuedMicros.loadRelaxed());
+    reactor.doneFast();
+}
+
 
 OpCounters globalOpCounters;
 OpCounters replOpCounters;
 NetworkCounter networkCounter;
+ServiceReactorCounter serviceReactorCounter;
 }
@@ -110,4 +110,43 @@ private:
 };
 
 extern NetworkCounter networkCounter;
+
+/**
+ * Statistics of the reactor service model, in which connections are multiplexed over a pool of
+ * worker threads. Reported in the "network" serverStatus section once enabled.
+ */
+class ServiceReactorCounter {
+public:
+    ServiceReactorCounter() : _enabled(false), _ioThreads(0), _minWorkerThreads(0) {}
+
+    /**
+     * Called once at startup, before any other method, if the reactor model is in use.
+     */
+    void enable(int ioThreads, int minWorkerThreads);
+
+    void gotConnection();
+    void gotDisconnection();
+
+    /**
+     * Called when a received message is handed to the worker pool, and when a worker starts
+     * processing it "queuedMicros" later.
+     */
+    void gotQueued();
+    void gotDequeued(long long queuedMicros);
+
+    void append(BSONObjBuilder& b);
+
+private:
+    bool _enabled;
+    int _ioThreads;
+    int _minWorkerThreads;
+
+    AtomicInt64 _connections;
+    AtomicInt64 _queueDepth;
+    AtomicInt64 _totalQueued;
+    AtomicInt64 _totalQueuedMicros;
+    AtomicInt64 _maxQueuedMicros;
+};
+
+extern ServiceReactorCounter serviceReactorCounter;
 }
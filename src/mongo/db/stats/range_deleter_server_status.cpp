@@ -38,6 +38,16 @@ namespace mongo {
  * Sample format:
  *
  * rangeDeleter: {
+ *   workers: 2,
+ *   deletesInProgress: 1,
+ *   pendingDeletes: 3,
+ *   throttle: {
+ *     batches: NumberLong(120),
+ *     throttledBatches: NumberLong(4),
+ *     deletedDocs: NumberLong(15360),
+ *     currentDelayMillis: NumberLong(0),
+ *     totalDelayMillis: NumberLong(150)
+ *   },
  *   lastDeleteStats: [
  *     {
  *       deleteDocs: NumberLong(5);
@@ -66,6 +76,14 @@ public:
 
         BSONObjBuilder result;
 
+        result.append("workers", static_cast<int>(deleter->getNumWorkers()));
+        result.append("deletesInProgress", static_cast<int>(deleter->getDeletesInProgress()));
+        result.append("pendingDeletes", static_cast<int>(deleter->getPendingDeletes()));
+
+        BSONObjBuilder throttleBuilder(result.subobjStart("throttle"));
+        deleter->getThrottle()->appendStats(&throttleBuilder);
+        throttleBuilder.doneFast();
+
         OwnedPointerVector<DeleteJobStats> statsList;
         deleter->getStatsHistory(&statsList.mutableVector());
         BSONArrayBuilder oldStatsBuilder;
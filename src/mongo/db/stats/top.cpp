@@ -35,6 +35,8 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
 
@@ -49,6 +51,10 @@ namespace {
 
 const auto getTop = ServiceContext::declareDecoration<Top>();
 
+// Partition of Top that the current thread records into, plus one. 0 means not assigned yet.
+MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL unsigned myTopPartition;
+AtomicUInt32 nextTopPartition;
+
 }  // namespace
 
 Top::UsageData::UsageData(const UsageData& older, const UsageData& newer) {
@@ -68,6 +74,18 @@ Top::CollectionData::CollectionData(const CollectionData& older, const Collectio
       remove(older.remove, newer.remove),
       commands(older.commands, newer.commands) {}
 
+void Top::CollectionData::add(const CollectionData& other) {
+    total.add(other.total);
+    readLock.add(other.readLock);
+    writeLock.add(other.writeLock);
+    queries.add(other.queries);
+    getmore.add(other.getmore);
+    insert.add(other.insert);
+    update.add(other.update);
+    remove.add(other.remove);
+    commands.add(other.commands);
+}
+
 // static
 Top& Top::get(ServiceContext* service) {
     return getTop(service);
@@ -78,17 +96,37 @@ void Top::record(StringData ns, int op, int lockType, long long micros, bool com
         return;
 
     // cout << "record: " << ns << "\t" << op << "\t" << command << endl;
-    stdx::lock_guard<SimpleMutex> lk(_lock);
+    Partition& partition = _myPartition();
+    stdx::lock_guard<SimpleMutex> lk(partition.lock);
 
-    if ((command || op == dbQuery) && ns == _lastDropped) {
-        _lastDropped = "";
+    if ((command || op == dbQuery) && ns == partition.lastDropped) {
+        partition.lastDropped = "";
         return;
     }
 
-    CollectionData& coll = _usage[ns];
+    CollectionData& coll = partition.usage[ns];
     _record(coll, op, lockType, micros, command);
 }
 
+Top::Partition& Top::_myPartition() {
+    if (myTopPartition == 0) {
+        myTopPartition = 1 + nextTopPartition.fetchAndAdd(1) % kNumPartitions;
+    }
+    return _partitions[myTopPartition - 1];
+}
+
+void Top::_aggregate(UsageMap* out) const {
+    *out = UsageMap();
+    for (size_t i = 0; i < kNumPartitions; i++) {
+        stdx::lock_guard<SimpleMutex> lk(_partitions[i].lock);
+        for (UsageMap::const_iterator it = _partitions[i].usage.begin();
+             it != _partitions[i].usage.end();
+             ++it) {
+            (*out)[it->first].add(it->second);
+        }
+    }
+}
+
 void Top::_record(CollectionData& c, int op, int lockType, long long micros, bool command) {
     c.total.inc(micros);
 
@@ -135,19 +173,26 @@ void Top::_record(CollectionData& c, int op, int lockType, long long micros, boo
 }
 
 void Top::collectionDropped(StringData ns) {
-    stdx::lock_guard<SimpleMutex> lk(_lock);
-    _usage.erase(ns);
-    _lastDropped = ns.toString();
+    // The drop command records its own usage on this thread, so only this thread's partition
+    // needs to remember the dropped namespace.
+    Partition& mine = _myPartition();
+    for (size_t i = 0; i < kNumPartitions; i++) {
+        stdx::lock_guard<SimpleMutex> lk(_partitions[i].lock);
+        _partitions[i].usage.erase(ns);
+        if (&_partitions[i] == &mine) {
+            _partitions[i].lastDropped = ns.toString();
+        }
+    }
 }
 
 void Top::cloneMap(Top::UsageMap& out) const {
-    stdx::lock_guard<SimpleMutex> lk(_lock);
-    out = _usage;
+    _aggregate(&out);
 }
 
 void Top::append(BSONObjBuilder& b) {
-    stdx::lock_guard<SimpleMutex> lk(_lock);
-    _appendToUsageMap(b, _usage);
+    UsageMap usage;
+    _aggregate(&usage);
+    _appendToUsageMap(b, usage);
 }
 
 void Top::_appendToUsageMap(BSONObjBuilder& b, const UsageMap& map) const {
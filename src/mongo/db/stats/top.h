@@ -40,6 +40,10 @@ class ServiceContext;
 
 /**
  * tracks usage by collection
+ *
+ * Usage is recorded into one of kNumPartitions partitions, each with its own lock. A thread
+ * always records into the same partition, so threads rarely contend with each other. Readers
+ * sum the partitions.
  */
 class Top {
 public:
@@ -57,6 +61,11 @@ public:
             count++;
             time += micros;
         }
+
+        void add(const UsageData& other) {
+            count += other.count;
+            time += other.time;
+        }
     };
 
     struct CollectionData {
@@ -77,6 +86,11 @@ public:
         UsageData update;
         UsageData remove;
         UsageData commands;
+
+        /**
+         * Adds the counters of 'other' to this one.
+         */
+        void add(const CollectionData& other);
     };
 
     typedef StringMap<CollectionData> UsageMap;
@@ -92,9 +106,28 @@ private:
     void _appendStatsEntry(BSONObjBuilder& b, const char* statsName, const UsageData& map) const;
     void _record(CollectionData& c, int op, int lockType, long long micros, bool command);
 
-    mutable SimpleMutex _lock;
-    UsageMap _usage;
-    std::string _lastDropped;
+    static const size_t kNumPartitions = 16;
+
+    struct Partition {
+        mutable SimpleMutex lock;
+        UsageMap usage;
+        std::string lastDropped;
+
+        // Threads recording into different partitions must not contend on a shared cache line.
+        char padding[64];
+    };
+
+    /**
+     * Returns the partition the current thread records into.
+     */
+    Partition& _myPartition();
+
+    /**
+     * Sums the usage of all partitions into 'out'.
+     */
+    void _aggregate(UsageMap* out) const;
+
+    Partition _partitions[kNumPartitions];
 };
 
 }  // namespace mongo
@@ -29,7 +29,9 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/stats/top.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
 
 namespace {
 
@@ -39,4 +41,33 @@ TEST(TopTest, CollectionDropped) {
     Top().collectionDropped("coll");
 }
 
+TEST(TopTest, UsageFromAllThreadsIsSummed) {
+    Top top;
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < 20; i++) {
+        threads.emplace_back([&top]() {
+            top.record("test.coll", dbInsert, 1, 10, false);
+            top.record("test.coll", dbQuery, -1, 5, false);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    Top::UsageMap usage;
+    top.cloneMap(usage);
+    ASSERT_EQUALS(1U, usage.size());
+    const Top::CollectionData& coll = usage["test.coll"];
+    ASSERT_EQUALS(40, coll.total.count);
+    ASSERT_EQUALS(300, coll.total.time);
+    ASSERT_EQUALS(20, coll.insert.count);
+    ASSERT_EQUALS(20, coll.queries.count);
+    ASSERT_EQUALS(20, coll.writeLock.count);
+    ASSERT_EQUALS(20, coll.readLock.count);
+
+    top.collectionDropped("test.coll");
+    top.cloneMap(usage);
+    ASSERT_EQUALS(0U, usage.size());
+}
+
 }  // namespace
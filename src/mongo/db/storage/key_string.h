@@ -233,6 +233,11 @@ public:
      */
     static RecordId decodeRecordIdAtEnd(const void* buf, size_t size);
 
+    /**
+     * Returns the size of the key encoded in a buffer which ends with a RecordId.
+     */
+    static size_t sizeWithoutRecordIdAtEnd(const void* buf, size_t size);
+
     /**
      * Decodes a RecordId, consuming all bytes needed from reader.
      */
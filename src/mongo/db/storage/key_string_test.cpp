@@ -839,3 +839,15 @@ TEST(KeyStringTest, RecordIds) {
         }
     }
 }
+
+TEST(KeyStringTest, SizeWithoutRecordIdAtEnd) {
+    const BSONObj key = BSON("" << 5 << "" << "abc");
+    const KeyString keyOnly(key, ALL_ASCENDING);
+    for (int i = 0; i < 63; i++) {
+        const RecordId rid = RecordId(1ll << i);
+        const KeyString ks(key, ALL_ASCENDING, rid);
+        ASSERT_EQ(KeyString::sizeWithoutRecordIdAtEnd(ks.getBuffer(), ks.getSize()),
+                  keyOnly.getSize());
+        ASSERT_EQ(memcmp(ks.getBuffer(), keyOnly.getBuffer(), keyOnly.getSize()), 0);
+    }
+}
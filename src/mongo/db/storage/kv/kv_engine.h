@@ -138,6 +138,13 @@ public:
         return nullptr;
     }
 
+    /**
+     * See StorageEngine::getCacheUsageRatio.
+     */
+    virtual double getCacheUsageRatio() const {
+        return 0;
+    }
+
     /**
      * The destructor will never be called from mongod, but may be called from tests.
      * Engines may assume that this will only be called in the case of clean shutdown, even if
@@ -255,6 +255,10 @@ SnapshotManager* KVStorageEngine::getSnapshotManager() const {
     return _engine->getSnapshotManager();
 }
 
+double KVStorageEngine::getCacheUsageRatio() const {
+    return _engine->getCacheUsageRatio();
+}
+
 Status KVStorageEngine::repairRecordStore(OperationContext* txn, const std::string& ns) {
     Status status = _engine->repairIdent(txn, _catalog->getCollectionIdent(ns));
     if (!status.isOK())
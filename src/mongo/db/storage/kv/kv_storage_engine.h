@@ -88,6 +88,8 @@ public:
 
     SnapshotManager* getSnapshotManager() const final;
 
+    double getCacheUsageRatio() const final;
+
     // ------ kv ------
 
     KVEngine* getEngine() {
@@ -330,28 +330,79 @@ StatusWith<RecordId> RecordStoreV1Base::insertRecord(OperationContext* txn,
                                                      const char* data,
                                                      int len,
                                                      bool enforceQuota) {
+    Status status = _checkRecordLength(len);
+    if (!status.isOK())
+        return StatusWith<RecordId>(status);
+
+    return _insertRecord(txn, data, len, enforceQuota);
+}
+
+Status RecordStoreV1Base::insertRecords(OperationContext* txn,
+                                        std::vector<Record>* records,
+                                        bool enforceQuota) {
+    // Allocating in a capped collection may delete records inserted earlier in the same batch.
+    if (isCapped())
+        return RecordStore::insertRecords(txn, records, enforceQuota);
+
+    for (const auto& record : *records) {
+        Status status = _checkRecordLength(record.data.size());
+        if (!status.isOK())
+            return status;
+    }
+
+    long long totalNetLength = 0;
+    for (auto& record : *records) {
+        StatusWith<DiskLoc> loc =
+            _allocAndCopyRecord(txn, record.data.data(), record.data.size(), enforceQuota);
+        if (!loc.isOK())
+            return loc.getStatus();
+
+        totalNetLength += recordFor(loc.getValue())->netLength();
+        record.id = loc.getValue().toRecordId();
+    }
+
+    // Update the collection stats once for the whole batch.
+    _details->incrementStats(txn, totalNetLength, records->size());
+
+    return Status::OK();
+}
+
+Status RecordStoreV1Base::_checkRecordLength(int len) {
     if (len < 4) {
-        return StatusWith<RecordId>(ErrorCodes::InvalidLength, "record has to be >= 4 bytes");
+        return Status(ErrorCodes::InvalidLength, "record has to be >= 4 bytes");
     }
 
     if (len + MmapV1RecordHeader::HeaderSize > MaxAllowedAllocation) {
-        return StatusWith<RecordId>(ErrorCodes::InvalidLength, "record has to be <= 16.5MB");
+        return Status(ErrorCodes::InvalidLength, "record has to be <= 16.5MB");
     }
 
-    return _insertRecord(txn, data, len, enforceQuota);
+    return Status::OK();
 }
 
 StatusWith<RecordId> RecordStoreV1Base::_insertRecord(OperationContext* txn,
                                                       const char* data,
                                                       int len,
                                                       bool enforceQuota) {
+    StatusWith<DiskLoc> loc = _allocAndCopyRecord(txn, data, len, enforceQuota);
+    if (!loc.isOK())
+        return StatusWith<RecordId>(loc.getStatus());
+
+    _details->incrementStats(txn, recordFor(loc.getValue())->netLength(), 1);
+
+    return StatusWith<RecordId>(loc.getValue().toRecordId());
+}
+
+StatusWith<DiskLoc> RecordStoreV1Base::_allocAndCopyRecord(OperationContext* txn,
+                                                           const char* data,
+                                                           int len,
+                                                           bool enforceQuota) {
     const int lenWHdr = len + MmapV1RecordHeader::HeaderSize;
     const int lenToAlloc = shouldPadInserts() ? quantizeAllocationSpace(lenWHdr) : lenWHdr;
     fassert(17208, lenToAlloc >= lenWHdr);
 
     StatusWith<DiskLoc> loc = allocRecord(txn, lenToAlloc, enforceQuota);
     if (!loc.isOK())
-        return StatusWith<RecordId>(loc.getStatus());
+        return loc;
 
     MmapV1RecordHeader* r = recordFor(loc.getValue());
     fassert(17210, r->lengthWithHeaders() >= lenWHdr);
@@ -362,9 +413,7 @@ StatusWith<RecordId> RecordStoreV1Base::_insertRecord(OperationContext* txn,
 
     _addRecordToRecListInExtent(txn, r, loc.getValue());
 
-    _details->incrementStats(txn, r->netLength(), 1);
-
-    return StatusWith<RecordId>(loc.getValue().toRecordId());
+    return loc;
 }
 
 StatusWith<RecordId> RecordStoreV1Base::updateRecord(OperationContext* txn,
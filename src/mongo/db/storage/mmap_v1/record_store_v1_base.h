@@ -199,6 +199,10 @@ public:
                                       const DocWriter* doc,
                                       bool enforceQuota);
 
+    virtual Status insertRecords(OperationContext* txn,
+                                 std::vector<Record>* records,
+                                 bool enforceQuota);
+
     virtual StatusWith<RecordId> updateRecord(OperationContext* txn,
                                               const RecordId& oldLocation,
                                               const char* data,
@@ -312,6 +316,18 @@ protected:
                                        int len,
                                        bool enforceQuota);
 
+    /**
+     * internal
+     * allocates the record, copies in the data and links it into its extent, but leaves the
+     * collection stats to the caller
+     */
+    StatusWith<DiskLoc> _allocAndCopyRecord(OperationContext* txn,
+                                            const char* data,
+                                            int len,
+                                            bool enforceQuota);
+
+    static Status _checkRecordLength(int len);
+
     std::unique_ptr<RecordStoreV1MetaData> _details;
     ExtentManager* _extentManager;
     bool _isSystemIndexes;
@@ -31,6 +31,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/mutable/damage_vector.h"
@@ -341,6 +342,28 @@ public:
                                               const DocWriter* doc,
                                               bool enforceQuota) = 0;
 
+    /**
+     * Inserts the data of each of "records", in order, and sets their ids to the RecordIds they
+     * were inserted at. Equivalent to calling insertRecord() for each of them, but lets record
+     * stores reserve ids, update their size statistics and set up their cursors once per batch.
+     *
+     * On error, some records may have been inserted; the caller must roll back the enclosing
+     * WriteUnitOfWork.
+     */
+    virtual Status insertRecords(OperationContext* txn,
+                                 std::vector<Record>* records,
+                                 bool enforceQuota) {
+        for (auto& record : *records) {
+            StatusWith<RecordId> res =
+                insertRecord(txn, record.data.data(), record.data.size(), enforceQuota);
+            if (!res.isOK())
+                return res.getStatus();
+
+            record.id = res.getValue();
+        }
+        return Status::OK();
+    }
+
     /**
      * @param notifier - Only used by record stores which do not support doc-locking.
      *                   In the case of a document move, this is called after the document
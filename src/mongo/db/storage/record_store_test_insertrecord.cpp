@@ -30,6 +30,8 @@
 
 #include "mongo/db/storage/record_store_test_harness.h"
 
+#include <set>
+#include <vector>
 
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/record_data.h"
@@ -109,6 +111,52 @@ TEST(RecordStoreTestHarness, InsertMultipleRecords) {
     }
 }
 
+// Insert multiple records with a single call to insertRecords() and verify
+// that each record got a distinct RecordId under which its data can be read back.
+TEST(RecordStoreTestHarness, InsertRecordsBatch) {
+    unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(0, rs->numRecords(opCtx.get()));
+    }
+
+    const int nToInsert = 10;
+    string datas[nToInsert];
+    std::vector<Record> records;
+    for (int i = 0; i < nToInsert; i++) {
+        stringstream ss;
+        ss << "record " << i;
+        datas[i] = ss.str();
+        records.push_back(Record{RecordId(), RecordData(datas[i].c_str(), datas[i].size() + 1)});
+    }
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_OK(rs->insertRecords(opCtx.get(), &records, false));
+            uow.commit();
+        }
+    }
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(nToInsert, rs->numRecords(opCtx.get()));
+
+        std::set<RecordId> seen;
+        for (int i = 0; i < nToInsert; i++) {
+            ASSERT(records[i].id.isNormal());
+            ASSERT(seen.insert(records[i].id).second);
+
+            RecordData record = rs->dataFor(opCtx.get(), records[i].id);
+            ASSERT_EQUALS(datas[i].size() + 1, static_cast<size_t>(record.size()));
+            ASSERT_EQUALS(datas[i], record.data());
+        }
+    }
+}
+
 // Insert a record using a DocWriter and verify the number of entries
 // in the collection is 1.
 TEST(RecordStoreTestHarness, InsertRecordUsingDocWriter) {
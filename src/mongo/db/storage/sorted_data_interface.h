@@ -34,6 +34,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/key_string.h"
 
 #pragma once
 
@@ -82,6 +83,15 @@ public:
      */
     virtual SortedDataBuilderInterface* getBulkBuilder(OperationContext* txn, bool dupsAllowed) = 0;
 
+    /**
+     * Returns true if the bulk builders of 'this' index accept keys already encoded as
+     * KeyStrings, through SortedDataBuilderInterface::addKeyString(). Bulk builds can then sort
+     * the encoded keys with memcmp rather than comparing BSON keys.
+     */
+    virtual bool bulkBuilderAcceptsKeyStrings() const {
+        return false;
+    }
+
     /**
      * Insert an entry into the index with the specified key and RecordId.
      *
@@ -360,6 +370,29 @@ public:
      */
     virtual Status addKey(const BSONObj& key, const RecordId& loc) = 0;
 
+    /**
+     * Adds a key encoded as a KeyString with the Ordering of the index and followed by 'loc',
+     * with the TypeBits of the key. 'bsonSize' is the size of the key as a BSONObj, which the
+     * key size limits apply to. The same ordering rules as addKey() apply.
+     *
+     * Only called if SortedDataInterface::bulkBuilderAcceptsKeyStrings() is true.
+     */
+    virtual Status addKeyString(StringData keyWithRecordId,
+                                const KeyString::TypeBits& typeBits,
+                                const RecordId& loc,
+                                int bsonSize) {
+        invariant(false);
+    }
+
+    /**
+     * Returns true if addKey() streams keys directly into the index, outside of any
+     * transaction of the OperationContext the builder was created with. Callers then do not
+     * need to wrap each addKey() call in its own WriteUnitOfWork.
+     */
+    virtual bool isBulkLoading() const {
+        return false;
+    }
+
     /**
      * Do any necessary work to finish building the tree.
      *
@@ -221,6 +221,16 @@ public:
         return nullptr;
     }
 
+    /**
+     * Returns the fraction of the storage engine's cache that is currently in use, between 0
+     * and 1. Engines that do not manage their own cache return 0.
+     *
+     * Background work such as the range deleter uses this to back off under cache pressure.
+     */
+    virtual double getCacheUsageRatio() const {
+        return 0;
+    }
+
 protected:
     /**
      * The destructor will never be called. See cleanShutdown instead.
@@ -116,6 +116,21 @@ Status checkKeySize(const BSONObj& key) {
     return Status::OK();
 }
 
+/**
+ * Checks the size of a key encoded for a bulk build, whose BSON form was 'bsonSize' bytes long.
+ */
+Status checkKeyStringSize(StringData keyWithRecordId,
+                          const KeyString::TypeBits& typeBits,
+                          Ordering ordering,
+                          int bsonSize) {
+    if (bsonSize < TempKeyMaxSize) {
+        return Status::OK();
+    }
+    const size_t keySize =
+        KeyString::sizeWithoutRecordIdAtEnd(keyWithRecordId.rawData(), keyWithRecordId.size());
+    return checkKeySize(KeyString::toBson(keyWithRecordId.rawData(), keySize, ordering, typeBits));
+}
+
 }  // namespace
 
 Status WiredTigerIndex::dupKeyError(const BSONObj& key) {
@@ -431,6 +446,10 @@ public:
         WiredTigerRecoveryUnit::get(_txn)->getSessionCache()->releaseSession(_session);
     }
 
+    bool isBulkLoading() const override {
+        return _isBulk;
+    }
+
 protected:
     WT_CURSOR* openBulkCursor(WiredTigerIndex* idx) {
         // Open cursors can cause bulk open_cursor to fail with EBUSY.
@@ -443,8 +462,16 @@ protected:
         // We use our own session to ensure we aren't in a transaction.
         WT_SESSION* session = _session->getSession();
         int err = session->open_cursor(session, idx->uri().c_str(), NULL, "bulk", &cursor);
-        if (!err)
+        if (err == EBUSY) {
+            // Idle sessions in the cache may still have a cursor on the index cached. The index
+            // is new and the build is in the foreground, so discard them and try once more.
+            WiredTigerRecoveryUnit::get(_txn)->getSessionCache()->closeAll();
+            err = session->open_cursor(session, idx->uri().c_str(), NULL, "bulk", &cursor);
+        }
+        if (!err) {
+            _isBulk = true;
             return cursor;
+        }
 
         warning() << "failed to create WiredTiger bulk cursor: " << wiredtiger_strerror(err);
         warning() << "falling back to non-bulk cursor for index " << idx->uri();
@@ -456,6 +483,7 @@ protected:
     const Ordering _ordering;
     OperationContext* const _txn;
     WiredTigerSession* const _session;
+    bool _isBulk = false;  // Set by openBulkCursor() if the cursor is a real bulk cursor.
     WT_CURSOR* const _cursor;
 };
 
@@ -475,19 +503,23 @@ public:
         }
 
         KeyString data(key, _idx->_ordering, loc);
+        insert(StringData(data.getBuffer(), data.getSize()), data.getTypeBits());
+        return Status::OK();
+    }
 
-        // Can't use WiredTigerCursor since we aren't using the cache.
-        WiredTigerItem item(data.getBuffer(), data.getSize());
-        _cursor->set_key(_cursor, item.Get());
-
-        WiredTigerItem valueItem = data.getTypeBits().isAllZeros()
-            ? emptyItem
-            : WiredTigerItem(data.getTypeBits().getBuffer(), data.getTypeBits().getSize());
-
-        _cursor->set_value(_cursor, valueItem.Get());
-
-        invariantWTOK(_cursor->insert(_cursor));
+    Status addKeyString(StringData keyWithRecordId,
+                        const KeyString::TypeBits& typeBits,
+                        const RecordId& loc,
+                        int bsonSize) {
+        {
+            const Status s =
+                checkKeyStringSize(keyWithRecordId, typeBits, _idx->_ordering, bsonSize);
+            if (!s.isOK())
+                return s;
+        }
 
+        // The key is already encoded as it is stored.
+        insert(keyWithRecordId, typeBits);
         return Status::OK();
     }
 
@@ -499,6 +531,20 @@ public:
     }
 
 private:
+    void insert(StringData keyWithRecordId, const KeyString::TypeBits& typeBits) {
+        // Can't use WiredTigerCursor since we aren't using the cache.
+        WiredTigerItem item(keyWithRecordId.rawData(), keyWithRecordId.size());
+        _cursor->set_key(_cursor, item.Get());
+
+        WiredTigerItem valueItem = typeBits.isAllZeros()
+            ? emptyItem
+            : WiredTigerItem(typeBits.getBuffer(), typeBits.getSize());
+
+        _cursor->set_value(_cursor, valueItem.Get());
+
+        invariantWTOK(_cursor->insert(_cursor));
+    }
+
     WiredTigerIndex* _idx;
 };
 
@@ -522,42 +568,70 @@ public:
                 return s;
         }
 
-        const int cmp = newKey.woCompare(_key, _ordering);
-        if (cmp != 0) {
-            if (!_key.isEmpty()) {   // _key.isEmpty() is only true on the first call to addKey().
-                invariant(cmp > 0);  // newKey must be > the last key
+        KeyString data(newKey, _idx->_ordering, loc);
+        return addEncodedKey(StringData(data.getBuffer(), data.getSize()), data.getTypeBits(), loc);
+    }
+
+    Status addKeyString(StringData keyWithRecordId,
+                        const KeyString::TypeBits& typeBits,
+                        const RecordId& loc,
+                        int bsonSize) {
+        {
+            const Status s =
+                checkKeyStringSize(keyWithRecordId, typeBits, _idx->_ordering, bsonSize);
+            if (!s.isOK())
+                return s;
+        }
+
+        return addEncodedKey(keyWithRecordId, typeBits, loc);
+    }
+
+    void commit(bool mayInterrupt) {
+        WriteUnitOfWork uow(_txn);
+        if (!_records.empty()) {
+            // This handles inserting the last unique key.
+            doInsert();
+        }
+        uow.commit();
+    }
+
+private:
+    Status addEncodedKey(StringData keyWithRecordId,
+                         const KeyString::TypeBits& typeBits,
+                         const RecordId& loc) {
+        // Unique indexes store the key without its RecordId.
+        const StringData newKey = keyWithRecordId.substr(
+            0,
+            KeyString::sizeWithoutRecordIdAtEnd(keyWithRecordId.rawData(),
+                                                keyWithRecordId.size()));
+        const StringData lastKey(_keyString.getBuffer(), _keyString.getSize());
+
+        // KeyStrings of equal keys are equal, whatever the types of the numbers they hold.
+        if (_keyString.isEmpty() || newKey != lastKey) {
+            // _keyString.isEmpty() is only true on the first call to addEncodedKey().
+            if (!_keyString.isEmpty()) {
+                invariant(newKey.compare(lastKey) > 0);  // newKey must be > the last key
                 // We are done with dups of the last key so we can insert it now.
                 doInsert();
             }
             invariant(_records.empty());
+            _keyString.resetFromBuffer(newKey.rawData(), newKey.size());
         } else {
             // Dup found!
             if (!_dupsAllowed) {
-                return _idx->dupKeyError(newKey);
+                return _idx->dupKeyError(KeyString::toBson(
+                    newKey.rawData(), newKey.size(), _idx->ordering(), typeBits));
             }
 
             // If we get here, we are in the weird mode where dups are allowed on a unique
-            // index, so add ourselves to the list of duplicate locs. This also replaces the
-            // _key which is correct since any dups seen later are likely to be newer.
+            // index, so add ourselves to the list of duplicate locs.
         }
 
-        _key = newKey.getOwned();
-        _keyString.resetToKey(_key, _idx->ordering());
-        _records.push_back(std::make_pair(loc, _keyString.getTypeBits()));
+        _records.push_back(std::make_pair(loc, typeBits));
 
         return Status::OK();
     }
 
-    void commit(bool mayInterrupt) {
-        WriteUnitOfWork uow(_txn);
-        if (!_records.empty()) {
-            // This handles inserting the last unique key.
-            doInsert();
-        }
-        uow.commit();
-    }
-
-private:
     void doInsert() {
         invariant(!_records.empty());
 
@@ -584,7 +658,6 @@ private:
 
     WiredTigerIndex* _idx;
     const bool _dupsAllowed;
-    BSONObj _key;
     KeyString _keyString;
     std::vector<std::pair<RecordId, KeyString::TypeBits>> _records;
 };
@@ -76,6 +76,10 @@ public:
      */
     WiredTigerIndex(OperationContext* ctx, const std::string& uri, const IndexDescriptor* desc);
 
+    virtual bool bulkBuilderAcceptsKeyStrings() const {
+        return true;
+    }
+
     virtual Status insert(OperationContext* txn,
                           const BSONObj& key,
                           const RecordId& loc,
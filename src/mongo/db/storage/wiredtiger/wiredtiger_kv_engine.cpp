@@ -206,6 +206,22 @@ int64_t WiredTigerKVEngine::getIdentSize(OperationContext* opCtx, StringData ide
     return WiredTigerUtil::getIdentSize(session->getSession(), _uri(ident));
 }
 
+double WiredTigerKVEngine::getCacheUsageRatio() const {
+    WiredTigerSession* session = _sessionCache->getSession();
+    ON_BLOCK_EXIT([this, session] { _sessionCache->releaseSession(session); });
+
+    StatusWith<int64_t> inUse = WiredTigerUtil::getStatisticsValueAs<int64_t>(
+        session->getSession(), "statistics:", "statistics=(fast)", WT_STAT_CONN_CACHE_BYTES_INUSE);
+    StatusWith<int64_t> max = WiredTigerUtil::getStatisticsValueAs<int64_t>(
+        session->getSession(), "statistics:", "statistics=(fast)", WT_STAT_CONN_CACHE_BYTES_MAX);
+    if (!inUse.isOK() || !max.isOK() || max.getValue() <= 0) {
+        // Statistics are disabled, treat the cache as empty.
+        return 0;
+    }
+
+    return static_cast<double>(inUse.getValue()) / max.getValue();
+}
+
 Status WiredTigerKVEngine::repairIdent(OperationContext* opCtx, StringData ident) {
     WiredTigerSession* session = WiredTigerRecoveryUnit::get(opCtx)->getSession(opCtx);
     session->closeAllCursors();
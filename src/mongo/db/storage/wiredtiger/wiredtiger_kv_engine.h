@@ -110,6 +110,8 @@ public:
         return &_sessionCache->snapshotManager();
     }
 
+    double getCacheUsageRatio() const final;
+
     // wiredtiger specific
     // Calls WT_CONNECTION::reconfigure on the underlying WT_CONNECTION
     // held by this class
@@ -426,7 +426,7 @@ WiredTigerRecordStore::WiredTigerRecordStore(OperationContext* ctx,
     Cursor cursor(ctx, *this, /*forward=*/false);
     if (auto record = cursor.next()) {
         int64_t max = _makeKey(record->id);
-        _oplog_highestSeen = record->id;
+        _oplogHighestSeen.store(record->id.repr());
         _nextIdNum.store(1 + max);
 
         if (_sizeStorer) {
@@ -774,11 +774,9 @@ StatusWith<RecordId> WiredTigerRecordStore::insertRecord(OperationContext* txn,
         if (!status.isOK())
             return status;
         loc = status.getValue();
-        if (loc > _oplog_highestSeen) {
+        if (loc.repr() > _oplogHighestSeen.load()) {
             stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-            if (loc > _oplog_highestSeen) {
-                _oplog_highestSeen = loc;
-            }
+            _noteHighestSeen_inlock(loc);
         }
     } else if (_isCapped) {
         stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
@@ -809,25 +807,89 @@ StatusWith<RecordId> WiredTigerRecordStore::insertRecord(OperationContext* txn,
     return StatusWith<RecordId>(loc);
 }
 
+Status WiredTigerRecordStore::insertRecords(OperationContext* txn,
+                                            std::vector<Record>* records,
+                                            bool enforceQuota) {
+    if (records->empty())
+        return Status::OK();
+
+    int64_t totalLength = 0;
+    for (auto& record : *records) {
+        if (_isCapped && record.data.size() > _cappedMaxSize) {
+            return Status(ErrorCodes::BadValue, "object to insert exceeds cappedMaxSize");
+        }
+        totalLength += record.data.size();
+    }
+
+    // Reserve the RecordIds of the whole batch at once.
+    if (_useOplogHack) {
+        RecordId highestLoc;
+        for (auto& record : *records) {
+            StatusWith<RecordId> status =
+                extractAndCheckLocForOplog(record.data.data(), record.data.size());
+            if (!status.isOK())
+                return status.getStatus();
+            record.id = status.getValue();
+            if (record.id > highestLoc)
+                highestLoc = record.id;
+        }
+        if (highestLoc.repr() > _oplogHighestSeen.load()) {
+            stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
+            _noteHighestSeen_inlock(highestLoc);
+        }
+    } else if (_isCapped) {
+        stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
+        const int64_t firstId = _nextIdNum.fetchAndAdd(records->size());
+        for (size_t i = 0; i < records->size(); i++) {
+            (*records)[i].id = RecordId(firstId + i);
+            _addUncommitedDiskLoc_inlock(txn, (*records)[i].id);
+        }
+    } else {
+        const int64_t firstId = _nextIdNum.fetchAndAdd(records->size());
+        for (size_t i = 0; i < records->size(); i++) {
+            (*records)[i].id = RecordId(firstId + i);
+        }
+    }
+
+    WiredTigerCursor curwrap(_uri, _tableId, true, txn);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+    invariant(c);
+
+    for (auto& record : *records) {
+        invariant(record.id.isNormal());
+        c->set_key(c, _makeKey(record.id));
+        WiredTigerItem value(record.data.data(), record.data.size());
+        c->set_value(c, value.Get());
+        int ret = WT_OP_CHECK(c->insert(c));
+        if (ret) {
+            return wtRCToStatus(ret, "WiredTigerRecordStore::insertRecords");
+        }
+    }
+
+    _changeNumRecords(txn, records->size());
+    _increaseDataSize(txn, totalLength);
+
+    cappedDeleteAsNeeded(txn, records->back().id);
+
+    return Status::OK();
+}
+
 void WiredTigerRecordStore::dealtWithCappedLoc(const RecordId& loc) {
     stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-    SortedDiskLocs::iterator it =
-        std::find(_uncommittedDiskLocs.begin(), _uncommittedDiskLocs.end(), loc);
-    invariant(it != _uncommittedDiskLocs.end());
-    _uncommittedDiskLocs.erase(it);
+    const size_t numErased = _uncommittedDiskLocs.erase(loc);
+    invariant(numErased == 1);
+    _publishLowestHidden_inlock();
 }
 
 bool WiredTigerRecordStore::isCappedHidden(const RecordId& loc) const {
-    stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-    if (_uncommittedDiskLocs.empty()) {
-        return false;
-    }
-    return _uncommittedDiskLocs.front() <= loc;
+    const int64_t lowestHidden = _oplogLowestHidden.load();
+    return lowestHidden != 0 && lowestHidden <= loc.repr();
 }
 
 RecordId WiredTigerRecordStore::lowestCappedHiddenRecord() const {
-    stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-    return _uncommittedDiskLocs.empty() ? RecordId() : _uncommittedDiskLocs.front();
+    const int64_t lowestHidden = _oplogLowestHidden.load();
+    return lowestHidden == 0 ? RecordId() : RecordId(lowestHidden);
 }
 
 StatusWith<RecordId> WiredTigerRecordStore::insertRecord(OperationContext* txn,
@@ -887,12 +949,12 @@ Status WiredTigerRecordStore::updateWithDamages(OperationContext* txn,
 }
 
 void WiredTigerRecordStore::_oplogSetStartHack(WiredTigerRecoveryUnit* wru) const {
-    stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-    if (_uncommittedDiskLocs.empty()) {
-        wru->setOplogReadTill(_oplog_highestSeen);
-    } else {
-        wru->setOplogReadTill(_uncommittedDiskLocs.front());
-    }
+    // Load the highest RecordId before the lowest hidden one. Every RecordId at or below the
+    // highest was registered before the load, so if nothing is hidden afterwards they have all
+    // been committed or rolled back.
+    const int64_t highestSeen = _oplogHighestSeen.load();
+    const int64_t lowestHidden = _oplogLowestHidden.load();
+    wru->setOplogReadTill(RecordId(lowestHidden == 0 ? highestSeen : lowestHidden));
 }
 
 std::unique_ptr<RecordCursor> WiredTigerRecordStore::getCursor(OperationContext* txn,
@@ -1097,10 +1159,22 @@ private:
 void WiredTigerRecordStore::_addUncommitedDiskLoc_inlock(OperationContext* txn,
                                                          const RecordId& loc) {
     // todo: make this a dassert at some point
-    invariant(_uncommittedDiskLocs.empty() || _uncommittedDiskLocs.back() < loc);
-    _uncommittedDiskLocs.push_back(loc);
+    invariant(_uncommittedDiskLocs.empty() || *_uncommittedDiskLocs.rbegin() < loc);
+    _uncommittedDiskLocs.insert(_uncommittedDiskLocs.end(), loc);
     txn->recoveryUnit()->registerChange(new CappedInsertChange(this, loc));
-    _oplog_highestSeen = loc;
+    _publishLowestHidden_inlock();
+    _noteHighestSeen_inlock(loc);
+}
+
+void WiredTigerRecordStore::_publishLowestHidden_inlock() {
+    _oplogLowestHidden.store(_uncommittedDiskLocs.empty() ? 0
+                                                          : _uncommittedDiskLocs.begin()->repr());
+}
+
+void WiredTigerRecordStore::_noteHighestSeen_inlock(const RecordId& loc) {
+    if (loc.repr() > _oplogHighestSeen.load()) {
+        _oplogHighestSeen.store(loc.repr());
+    }
 }
 
 boost::optional<RecordId> WiredTigerRecordStore::oplogStartHack(
@@ -1175,7 +1249,7 @@ void WiredTigerRecordStore::_changeNumRecords(OperationContext* txn, int64_t dif
 
 class WiredTigerRecordStore::DataSizeChange : public RecoveryUnit::Change {
 public:
-    DataSizeChange(WiredTigerRecordStore* rs, int amount) : _rs(rs), _amount(amount) {}
+    DataSizeChange(WiredTigerRecordStore* rs, int64_t amount) : _rs(rs), _amount(amount) {}
     virtual void commit() {}
     virtual void rollback() {
         _rs->_increaseDataSize(NULL, -_amount);
@@ -1183,10 +1257,10 @@ public:
 
 private:
     WiredTigerRecordStore* _rs;
-    bool _amount;
+    int64_t _amount;
 };
 
-void WiredTigerRecordStore::_increaseDataSize(OperationContext* txn, int amount) {
+void WiredTigerRecordStore::_increaseDataSize(OperationContext* txn, int64_t amount) {
     if (txn)
         txn->recoveryUnit()->registerChange(new DataSizeChange(this, amount));
 
@@ -121,6 +121,10 @@ public:
                                               const DocWriter* doc,
                                               bool enforceQuota);
 
+    virtual Status insertRecords(OperationContext* txn,
+                                 std::vector<Record>* records,
+                                 bool enforceQuota);
+
     virtual StatusWith<RecordId> updateRecord(OperationContext* txn,
                                               const RecordId& oldLocation,
                                               const char* data,
@@ -225,12 +229,14 @@ private:
     static RecordId _fromKey(int64_t k);
 
     void _addUncommitedDiskLoc_inlock(OperationContext* txn, const RecordId& loc);
+    void _publishLowestHidden_inlock();
+    void _noteHighestSeen_inlock(const RecordId& loc);
 
     RecordId _nextId();
     void _setId(RecordId loc);
     bool cappedAndNeedDelete() const;
     void _changeNumRecords(OperationContext* txn, int64_t diff);
-    void _increaseDataSize(OperationContext* txn, int amount);
+    void _increaseDataSize(OperationContext* txn, int64_t amount);
     RecordData _getData(const WiredTigerCursor& cursor) const;
     StatusWith<RecordId> extractAndCheckLocForOplog(const char* data, int len);
     void _oplogSetStartHack(WiredTigerRecoveryUnit* wru) const;
@@ -252,10 +258,13 @@ private:
 
     const bool _useOplogHack;
 
-    typedef std::vector<RecordId> SortedDiskLocs;
+    // Writers register and retire uncommitted RecordIds under _uncommittedDiskLocsMutex and then
+    // publish the lowest one and the highest one seen through the atomics below, so that cursors
+    // can find the visibility point of the oplog without taking the mutex.
+    typedef std::set<RecordId> SortedDiskLocs;
     SortedDiskLocs _uncommittedDiskLocs;
-    RecordId _oplog_visibleTo;
-    RecordId _oplog_highestSeen;
+    AtomicInt64 _oplogLowestHidden;  // repr of the lowest uncommitted RecordId, 0 if none
+    AtomicInt64 _oplogHighestSeen;   // repr of the highest RecordId inserted or registered
     mutable stdx::mutex _uncommittedDiskLocsMutex;
 
     AtomicInt64 _nextIdNum;
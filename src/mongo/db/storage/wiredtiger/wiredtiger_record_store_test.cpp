@@ -816,6 +816,68 @@ TEST(WiredTigerRecordStoreTest, OplogOrder) {
     }
 }
 
+RecordId _oplogInsertUnregistered(OperationContext* txn,
+                                  unique_ptr<RecordStore>& rs,
+                                  const Timestamp& opTime) {
+    BSONObj obj = BSON("ts" << opTime);
+    StatusWith<RecordId> res = rs->insertRecord(txn, obj.objdata(), obj.objsize(), false);
+    ASSERT_OK(res.getStatus());
+    return res.getValue();
+}
+
+TEST(WiredTigerRecordStoreTest, OplogBatchVisibility) {
+    unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("local.oplog.foo", 100000, -1));
+    WiredTigerRecordStore* wrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+
+    RecordId loc1;
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        loc1 = _oplogOrderInsertOplog(opCtx.get(), rs, 1);
+        uow.commit();
+    }
+    ASSERT(wrs->lowestCappedHiddenRecord().isNull());
+
+    // A batch of three entries registers only its first optime.
+    unique_ptr<OperationContext> t1(harnessHelper->newOperationContext());
+    unique_ptr<WriteUnitOfWork> w1(new WriteUnitOfWork(t1.get()));
+    ASSERT_OK(wrs->oplogDiskLocRegister(t1.get(), Timestamp(5, 2)));
+    RecordId batchStart = _oplogInsertUnregistered(t1.get(), rs, Timestamp(5, 2));
+    _oplogInsertUnregistered(t1.get(), rs, Timestamp(5, 3));
+    _oplogInsertUnregistered(t1.get(), rs, Timestamp(5, 4));
+
+    {  // a later writer commits first
+        unique_ptr<OperationContext> t2(harnessHelper->newOperationContext());
+        WriteUnitOfWork w2(t2.get());
+        RecordId loc = _oplogOrderInsertOplog(t2.get(), rs, 5);
+        w2.commit();
+        ASSERT(wrs->isCappedHidden(loc));
+    }
+
+    ASSERT_EQ(batchStart, wrs->lowestCappedHiddenRecord());
+    ASSERT(!wrs->isCappedHidden(loc1));
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        auto cursor = rs->getCursor(opCtx.get());
+        ASSERT_EQ(loc1, cursor->seekExact(loc1)->id);
+        ASSERT(!cursor->next());
+    }
+
+    w1->commit();
+    ASSERT(wrs->lowestCappedHiddenRecord().isNull());
+
+    {  // the whole batch and the later entry become visible together
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        auto cursor = rs->getCursor(opCtx.get());
+        ASSERT_EQ(loc1, cursor->seekExact(loc1)->id);
+        for (int i = 0; i < 4; i++) {
+            ASSERT(cursor->next());
+        }
+        ASSERT(!cursor->next());
+    }
+}
+
 TEST(WiredTigerRecordStoreTest, StorageSizeStatisticsDisabled) {
     WiredTigerHarnessHelper harnessHelper("statistics=(none)");
     unique_ptr<RecordStore> rs(harnessHelper.newNonCappedRecordStore("a.b"));
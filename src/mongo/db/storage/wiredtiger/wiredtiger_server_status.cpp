@@ -73,6 +73,7 @@ BSONObj WiredTigerServerStatusSection::generateSection(OperationContext* txn,
     }
 
     WiredTigerRecoveryUnit::appendGlobalStats(bob);
+    WiredTigerSessionCache::appendGlobalStats(bob);
 
     return bob.obj();
 }
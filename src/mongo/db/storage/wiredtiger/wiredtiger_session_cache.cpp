@@ -33,38 +33,71 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include <iterator>
+
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
+namespace {
+AtomicUInt64 cursorCacheHits;
+AtomicUInt64 cursorCacheMisses;
+AtomicUInt64 cursorsEvicted;
+AtomicUInt64 sessionsCreated;
+AtomicUInt64 sessionsFromSharedPool;
+
+// Affinity slot of the current thread, plus one. 0 means not assigned yet.
+MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL unsigned myAffinitySlot;
+AtomicUInt32 nextAffinitySlot;
+}  // namespace
+
 WiredTigerSession::WiredTigerSession(WT_CONNECTION* conn, int epoch)
-    : _epoch(epoch), _session(NULL), _cursorGen(0), _cursorsCached(0), _cursorsOut(0) {
+    : _epoch(epoch),
+      _session(NULL),
+      _cursorGen(0),
+      _cursorsCached(0),
+      _cursorsOut(0),
+      _cursorCacheHits(0),
+      _cursorCacheMisses(0),
+      _cursorsEvicted(0) {
     invariantWTOK(conn->open_session(conn, NULL, "isolation=snapshot", &_session));
 }
 
 WiredTigerSession::~WiredTigerSession() {
+    _flushStats();
     if (_session) {
         invariantWTOK(_session->close(_session, NULL));
     }
 }
 
 WT_CURSOR* WiredTigerSession::getCursor(const std::string& uri, uint64_t id, bool forRecordStore) {
-    // Find the most recently used cursor
-    for (CursorCache::iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
-        if (i->_id == id) {
-            WT_CURSOR* c = i->_cursor;
-            _cursors.erase(i);
-            _cursorsOut++;
-            _cursorsCached--;
-            return c;
-        }
+    // Several cursors may be cached under the same id. Take the most recently released one, as
+    // the list scan did, so that older duplicates age out.
+    auto range = _cursorIndex.equal_range(id);
+    CursorIndex::iterator it = range.first;
+    for (CursorIndex::iterator i = range.first; i != range.second; ++i) {
+        if (i->second->_gen > it->second->_gen)
+            it = i;
+    }
+    if (it != range.second) {
+        CursorCache::iterator entry = it->second;
+        WT_CURSOR* c = entry->_cursor;
+        _cursorIndex.erase(it);
+        _cursors.erase(entry);
+        _cursorsOut++;
+        _cursorsCached--;
+        _cursorCacheHits++;
+        return c;
     }
 
+    _cursorCacheMisses++;
     WT_CURSOR* c = NULL;
     int ret = _session->open_cursor(
         _session, uri.c_str(), NULL, forRecordStore ? "" : "overwrite=false", &c);
@@ -84,6 +117,7 @@ void WiredTigerSession::releaseCursor(uint64_t id, WT_CURSOR* cursor) {
 
     // Cursors are pushed to the front of the list and removed from the back
     _cursors.push_front(WiredTigerCachedCursor(id, _cursorGen++, cursor));
+    _cursorIndex.insert(std::make_pair(id, _cursors.begin()));
     _cursorsCached++;
 
     // "Old" is defined as not used in the last N**2 operations, if we have N cursors cached.
@@ -94,11 +128,35 @@ void WiredTigerSession::releaseCursor(uint64_t id, WT_CURSOR* cursor) {
     uint64_t cutoff = std::max(100, _cursorsCached * _cursorsCached);
     while (_cursorGen - _cursors.back()._gen > cutoff) {
         cursor = _cursors.back()._cursor;
+        _unindexCursor(std::prev(_cursors.end()));
         _cursors.pop_back();
+        _cursorsCached--;
+        _cursorsEvicted++;
         invariantWTOK(cursor->close(cursor));
     }
 }
 
+void WiredTigerSession::_unindexCursor(const CursorCache::iterator& entry) {
+    auto range = _cursorIndex.equal_range(entry->_id);
+    for (CursorIndex::iterator it = range.first; it != range.second; ++it) {
+        if (it->second == entry) {
+            _cursorIndex.erase(it);
+            return;
+        }
+    }
+    invariant(false);
+}
+
+void WiredTigerSession::_flushStats() {
+    if (_cursorCacheHits)
+        cursorCacheHits.fetchAndAdd(_cursorCacheHits);
+    if (_cursorCacheMisses)
+        cursorCacheMisses.fetchAndAdd(_cursorCacheMisses);
+    if (_cursorsEvicted)
+        cursorsEvicted.fetchAndAdd(_cursorsEvicted);
+    _cursorCacheHits = _cursorCacheMisses = _cursorsEvicted = 0;
+}
+
 void WiredTigerSession::closeAllCursors() {
     invariant(_session);
     for (CursorCache::iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
@@ -108,6 +166,8 @@ void WiredTigerSession::closeAllCursors() {
         }
     }
     _cursors.clear();
+    _cursorIndex.clear();
+    _cursorsCached = 0;
 }
 
 namespace {
@@ -161,6 +221,13 @@ void WiredTigerSessionCache::closeAll() {
         _sessions.swap(swap);
     }
 
+    // Sessions parked after this point see the new epoch and are not kept, see releaseSession.
+    for (size_t i = 0; i < kNumAffinitySlots; i++) {
+        if (uint64_t parked = _affinitySlots[i].session.swap(0)) {
+            swap.push_back(reinterpret_cast<WiredTigerSession*>(parked));
+        }
+    }
+
     for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
         delete (*i);
     }
@@ -171,6 +238,15 @@ WiredTigerSession* WiredTigerSessionCache::getSession() {
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
+    // The session this thread released last, if nobody took it since.
+    if (uint64_t parked = _affinitySlotForThisThread().session.swap(0)) {
+        WiredTigerSession* session = reinterpret_cast<WiredTigerSession*>(parked);
+        if (session->_getEpoch() == _epoch.load())
+            return session;
+        // closeAll ran after the session was parked.
+        delete session;
+    }
+
     {
         stdx::lock_guard<SpinLock> lock(_cacheLock);
         if (!_sessions.empty()) {
@@ -178,14 +254,35 @@ WiredTigerSession* WiredTigerSessionCache::getSession() {
             // discarding older ones
             WiredTigerSession* cachedSession = _sessions.back();
             _sessions.pop_back();
+            sessionsFromSharedPool.fetchAndAdd(1);
             return cachedSession;
         }
     }
 
     // Outside of the cache partition lock, but on release will be put back on the cache
+    sessionsCreated.fetchAndAdd(1);
     return new WiredTigerSession(_conn, _epoch.load());
 }
 
+WiredTigerSessionCache::AffinitySlot& WiredTigerSessionCache::_affinitySlotForThisThread() {
+    if (myAffinitySlot == 0) {
+        myAffinitySlot = 1 + nextAffinitySlot.fetchAndAdd(1) % kNumAffinitySlots;
+    }
+    return _affinitySlots[myAffinitySlot - 1];
+}
+
+// static
+void WiredTigerSessionCache::appendGlobalStats(BSONObjBuilder& b) {
+    BSONObjBuilder bb(b.subobjStart("sessionCache"));
+    bb.appendNumber("sessionsCreated", static_cast<long long>(sessionsCreated.load()));
+    bb.appendNumber("sessionsFromSharedPool",
+                    static_cast<long long>(sessionsFromSharedPool.load()));
+    bb.appendNumber("cursorCacheHits", static_cast<long long>(cursorCacheHits.load()));
+    bb.appendNumber("cursorCacheMisses", static_cast<long long>(cursorCacheMisses.load()));
+    bb.appendNumber("cursorsEvicted", static_cast<long long>(cursorsEvicted.load()));
+    bb.done();
+}
+
 void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
     invariant(session);
     invariant(session->cursorsOut() == 0);
@@ -210,17 +307,34 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
         invariant(range == 0);
     }
 
-    bool returnedToCache = false;
-    uint64_t currentEpoch = _epoch.load();
+    session->_flushStats();
 
-    if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<SpinLock> lock(_cacheLock);
-        if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
-            returnedToCache = true;
-            _sessions.push_back(session);
+    bool returnedToCache = false;
+    const uint64_t currentEpoch = _epoch.load();
+    const uint64_t sessionEpoch = session->_getEpoch();
+    invariant(sessionEpoch <= currentEpoch);
+
+    if (sessionEpoch == currentEpoch) {
+        // Park the session for this thread if its slot is free. Once parked, the session may be
+        // taken by another thread sharing the slot or deleted by closeAll at any time, so it must
+        // not be touched again. If closeAll bumped the epoch meanwhile it may have missed the
+        // slot, so take the session back unless somebody else already did.
+        AffinitySlot& slot = _affinitySlotForThisThread();
+        const uint64_t parked = reinterpret_cast<uint64_t>(session);
+        if (slot.session.compareAndSwap(0, parked) == 0) {
+            if (_epoch.load() == currentEpoch ||
+                slot.session.compareAndSwap(parked, 0) != parked) {
+                returnedToCache = true;
+            }
+        } else {
+            // The slot is taken, so fall back to the shared pool.
+            stdx::lock_guard<SpinLock> lock(_cacheLock);
+            if (sessionEpoch == _epoch.load()) {  // recheck inside the lock for correctness
+                returnedToCache = true;
+                _sessions.push_back(session);
+            }
         }
-    } else
-        invariant(session->_getEpoch() < currentEpoch);
+    }
 
     if (!returnedToCache)
         delete session;
@@ -33,17 +33,20 @@
 
 #include <list>
 #include <string>
+#include <unordered_map>
 
 #include <boost/thread/shared_mutex.hpp>
 #include <wiredtiger.h>
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/compiler.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
 class WiredTigerKVEngine;
 
 class WiredTigerCachedCursor {
@@ -59,6 +62,7 @@ public:
 /**
  * This is a structure that caches 1 cursor for each uri.
  * The idea is that there is a pool of these somewhere.
+ * The cached cursors are kept in least recently used order and indexed by table id.
  * NOT THREADSAFE
  */
 class WiredTigerSession {
@@ -101,24 +105,42 @@ public:
 private:
     friend class WiredTigerSessionCache;
 
-    // The cursor cache is a list of pairs that contain an ID and cursor
+    // The cursor cache is a list of pairs that contain an ID and cursor, most recently used
+    // first. The index maps an ID to the entries of the list that hold a cursor for it.
     typedef std::list<WiredTigerCachedCursor> CursorCache;
+    typedef std::unordered_multimap<uint64_t, CursorCache::iterator> CursorIndex;
 
     // Used internally by WiredTigerSessionCache
     uint64_t _getEpoch() const {
         return _epoch;
     }
 
+    void _unindexCursor(const CursorCache::iterator& entry);
+
+    /**
+     * Adds the cursor cache counters of this session to the global ones and resets them.
+     */
+    void _flushStats();
+
     const uint64_t _epoch;
     WT_SESSION* _session;  // owned
     CursorCache _cursors;  // owned
+    CursorIndex _cursorIndex;
     uint64_t _cursorGen;
     int _cursorsCached, _cursorsOut;
+
+    // Counted per session and flushed to the global counters when the session is released, so
+    // that cursor lookups do not touch shared cache lines.
+    uint64_t _cursorCacheHits, _cursorCacheMisses, _cursorsEvicted;
 };
 
 /**
  *  This cache implements a shared pool of WiredTiger sessions with the goal to amortize the
  *  cost of session creation and destruction over multiple uses.
+ *
+ *  A released session is first parked in the affinity slot of the releasing thread, so that the
+ *  next getSession on that thread takes it back, together with its cached cursors, without any
+ *  lock. Only sessions that find the slot taken go to the shared pool.
  */
 class WiredTigerSessionCache {
 public:
@@ -163,7 +185,24 @@ public:
         return _snapshotManager;
     }
 
+    /**
+     * Appends the session and cursor cache counters of all session caches to 'b'.
+     */
+    static void appendGlobalStats(BSONObjBuilder& b);
+
+    // Number of slots in which threads park the session they released last. Threads are assigned
+    // to slots round-robin, so threads beyond this number share slots.
+    static const size_t kNumAffinitySlots = 128;
+
 private:
+
+    // Holds a WiredTigerSession* or 0. Padded so that threads do not share cache lines.
+    struct MONGO_COMPILER_ALIGN_TYPE(64) AffinitySlot {
+        AtomicUInt64 session;
+    };
+
+    AffinitySlot& _affinitySlotForThisThread();
+
     WiredTigerKVEngine* _engine;  // not owned, might be NULL
     WT_CONNECTION* _conn;         // not owned
     WiredTigerSnapshotManager _snapshotManager;
@@ -180,5 +219,7 @@ private:
 
     // Bumped when all open sessions need to be closed
     AtomicUInt64 _epoch;  // atomic so we can check it outside of the lock
+
+    AffinitySlot _affinitySlots[kNumAffinitySlots];
 };
 }
@@ -0,0 +1,198 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class WiredTigerConnection {
+public:
+    WiredTigerConnection(StringData dbpath, StringData extraStrings) : _conn(NULL) {
+        std::stringstream ss;
+        ss << "create,";
+        ss << extraStrings;
+        std::string config = ss.str();
+        int ret = wiredtiger_open(dbpath.toString().c_str(), NULL, config.c_str(), &_conn);
+        ASSERT_OK(wtRCToStatus(ret));
+        ASSERT(_conn);
+    }
+    ~WiredTigerConnection() {
+        _conn->close(_conn, NULL);
+    }
+    WT_CONNECTION* getConnection() const {
+        return _conn;
+    }
+
+private:
+    WT_CONNECTION* _conn;
+};
+
+class WiredTigerSessionCacheHarnessHelper {
+public:
+    WiredTigerSessionCacheHarnessHelper(StringData extraStrings)
+        : _dbpath("wt_session_cache_test"),
+          _connection(_dbpath.path(), extraStrings),
+          _sessionCache(_connection.getConnection()) {}
+
+    WiredTigerSessionCache* getSessionCache() {
+        return &_sessionCache;
+    }
+
+private:
+    unittest::TempDir _dbpath;
+    WiredTigerConnection _connection;
+    WiredTigerSessionCache _sessionCache;
+};
+
+long long sessionsCreated() {
+    BSONObjBuilder b;
+    WiredTigerSessionCache::appendGlobalStats(b);
+    return b.obj()["sessionCache"]["sessionsCreated"].numberLong();
+}
+
+TEST(WiredTigerSessionCacheTest, ReleasedSessionIsReusedBySameThread) {
+    WiredTigerSessionCacheHarnessHelper harnessHelper("");
+    WiredTigerSessionCache* sessionCache = harnessHelper.getSessionCache();
+
+    WiredTigerSession* first = sessionCache->getSession();
+    sessionCache->releaseSession(first);
+
+    const long long created = sessionsCreated();
+    WiredTigerSession* second = sessionCache->getSession();
+    ASSERT_EQUALS(first, second);
+    ASSERT_EQUALS(created, sessionsCreated());
+    sessionCache->releaseSession(second);
+}
+
+TEST(WiredTigerSessionCacheTest, CloseAllDiscardsParkedSession) {
+    WiredTigerSessionCacheHarnessHelper harnessHelper("");
+    WiredTigerSessionCache* sessionCache = harnessHelper.getSessionCache();
+
+    sessionCache->releaseSession(sessionCache->getSession());
+    sessionCache->closeAll();
+
+    // The parked session was closed, so the next one has to be opened from scratch.
+    const long long created = sessionsCreated();
+    WiredTigerSession* session = sessionCache->getSession();
+    ASSERT_EQUALS(created + 1, sessionsCreated());
+    sessionCache->releaseSession(session);
+}
+
+TEST(WiredTigerSessionCacheTest, ReleaseRacesWithCloseAll) {
+    // Twice as many threads as affinity slots, so that every slot is shared by several threads
+    // which take each other's parked sessions, while closeAll keeps deleting parked sessions. A
+    // releasing thread must not touch its session once parked, which this exercises under ASAN.
+    const size_t kNumThreads = 2 * WiredTigerSessionCache::kNumAffinitySlots;
+    const int kIterations = 200;
+
+    WiredTigerSessionCacheHarnessHelper harnessHelper("session_max=1000");
+    WiredTigerSessionCache* sessionCache = harnessHelper.getSessionCache();
+
+    AtomicWord<bool> done(false);
+    stdx::thread closer([&] {
+        while (!done.load()) {
+            sessionCache->closeAll();
+        }
+    });
+
+    std::vector<stdx::thread> threads;
+    for (size_t i = 0; i < kNumThreads; i++) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < kIterations; j++) {
+                sessionCache->releaseSession(sessionCache->getSession());
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    done.store(true);
+    closer.join();
+}
+
+TEST(WiredTigerSessionCacheTest, CachedCursorIsFoundById) {
+    WiredTigerSessionCacheHarnessHelper harnessHelper("");
+    WiredTigerSession* session = harnessHelper.getSessionCache()->getSession();
+    WT_SESSION* wtSession = session->getSession();
+    ASSERT_OK(wtRCToStatus(wtSession->create(wtSession, "table:a", "key_format=q,value_format=u")));
+    ASSERT_OK(wtRCToStatus(wtSession->create(wtSession, "table:b", "key_format=q,value_format=u")));
+
+    WT_CURSOR* a = session->getCursor("table:a", 1, true);
+    WT_CURSOR* b = session->getCursor("table:b", 2, true);
+    session->releaseCursor(1, a);
+    session->releaseCursor(2, b);
+
+    // Lookups by id return the cursor for that id regardless of its position in the cache.
+    ASSERT_EQUALS(a, session->getCursor("table:a", 1, true));
+    ASSERT_EQUALS(b, session->getCursor("table:b", 2, true));
+    session->releaseCursor(1, a);
+    session->releaseCursor(2, b);
+
+    session->closeAllCursors();
+    harnessHelper.getSessionCache()->releaseSession(session);
+}
+
+TEST(WiredTigerSessionCacheTest, MostRecentlyReleasedCursorIsReused) {
+    WiredTigerSessionCacheHarnessHelper harnessHelper("");
+    WiredTigerSession* session = harnessHelper.getSessionCache()->getSession();
+    WT_SESSION* wtSession = session->getSession();
+    ASSERT_OK(wtRCToStatus(wtSession->create(wtSession, "table:a", "key_format=q,value_format=u")));
+
+    // Two cursors cached under the same id.
+    WT_CURSOR* older = session->getCursor("table:a", 1, true);
+    WT_CURSOR* newer = session->getCursor("table:a", 1, true);
+    ASSERT_NOT_EQUALS(older, newer);
+    session->releaseCursor(1, older);
+    session->releaseCursor(1, newer);
+
+    ASSERT_EQUALS(newer, session->getCursor("table:a", 1, true));
+    ASSERT_EQUALS(older, session->getCursor("table:a", 1, true));
+    session->releaseCursor(1, older);
+    session->releaseCursor(1, newer);
+
+    session->closeAllCursors();
+    harnessHelper.getSessionCache()->releaseSession(session);
+}
+
+}  // namespace
+}  // namespace mongo
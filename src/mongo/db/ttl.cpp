@@ -34,6 +34,9 @@
 
 #include "mongo/db/ttl.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "mongo/base/counter.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_name.h"
@@ -54,12 +57,20 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/timer_stats.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/background.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
+using std::deque;
 using std::set;
 using std::endl;
 using std::list;
@@ -67,16 +78,51 @@ using std::string;
 using std::vector;
 using std::unique_ptr;
 
+namespace {
+
+// Largest delay between the expiry of a document and its deletion during the last pass.
+class TTLLastPassMaxLag {
+public:
+    operator long long() const {
+        return millis.load();
+    }
+
+    AtomicInt64 millis;
+};
+
+}  // namespace
+
 Counter64 ttlPasses;
+Counter64 ttlIncompletePasses;
 Counter64 ttlDeletedDocuments;
+TimerStats ttlDeletionLag;
+TTLLastPassMaxLag ttlLastPassMaxDeletionLag;
 
 ServerStatusMetricField<Counter64> ttlPassesDisplay("ttl.passes", &ttlPasses);
+ServerStatusMetricField<Counter64> ttlIncompletePassesDisplay("ttl.incompletePasses",
+                                                              &ttlIncompletePasses);
 ServerStatusMetricField<Counter64> ttlDeletedDocumentsDisplay("ttl.deletedDocuments",
                                                               &ttlDeletedDocuments);
+ServerStatusMetricField<TimerStats> ttlDeletionLagDisplay("ttl.deletionLag", &ttlDeletionLag);
+ServerStatusMetricField<TTLLastPassMaxLag> ttlLastPassMaxDeletionLagDisplay(
+    "ttl.lastPassMaxDeletionLagMillis", &ttlLastPassMaxDeletionLag);
 
 MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorEnabled, bool, true);
 MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorSleepSecs, int, 60);  // used for testing
 
+// Number of threads deleting expired documents during a pass, each one from a different
+// collection.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorWorkers, int, 2);
+
+// Number of documents deleted from a TTL index before moving on to the next one. Indexes with
+// more expired documents are visited again once every other index had its turn.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorSliceDocs, int, 1000);
+
+// Budget of a pass, in deleted documents and in seconds. The expired documents left when either
+// runs out are deleted by the next pass. Zero means no limit.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorPassMaxDocs, long long, 0);
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorPassMaxSecs, int, 0);
+
 class TTLMonitor : public BackgroundJob {
 public:
     TTLMonitor() {}
@@ -118,6 +164,144 @@ public:
     }
 
 private:
+    /**
+     * A TTL index to visit during a pass.
+     */
+    struct IndexTask {
+        string dbName;
+        string ns;
+        BSONObj idx;
+    };
+
+    enum IndexVisitResult {
+        // No expired documents are left, or the index was skipped.
+        kIndexDone,
+
+        // The slice or the pass budget ran out before the expired documents.
+        kIndexHasMore,
+
+        // The database is gone, or this node stepped down. Stop processing its TTL indexes.
+        kStopDatabase,
+    };
+
+    /**
+     * Work shared by the threads of one TTL pass. The indexes are visited round-robin, and two
+     * threads never visit indexes of the same collection at the same time.
+     */
+    class Pass {
+    public:
+        Pass(deque<IndexTask> tasks, Date_t now)
+            : now(now), _tasks(std::move(tasks)), _maxDocs(ttlMonitorPassMaxDocs) {
+            const int maxSecs = ttlMonitorPassMaxSecs;
+            if (maxSecs > 0) {
+                _deadline = now + Seconds(maxSecs);
+            }
+        }
+
+        /**
+         * Waits for an index whose collection no other thread is working on. Returns false
+         * once every index is done.
+         */
+        bool getNext(IndexTask* task) {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            while (true) {
+                if (_tasks.empty() && _nsInProgress.empty()) {
+                    return false;
+                }
+
+                for (auto it = _tasks.begin(); it != _tasks.end(); ++it) {
+                    if (_nsInProgress.count(it->ns) == 0) {
+                        *task = std::move(*it);
+                        _tasks.erase(it);
+                        _nsInProgress.insert(task->ns);
+                        return true;
+                    }
+                }
+
+                _taskDoneCV.wait(lk);
+            }
+        }
+
+        /**
+         * Reports the outcome of a visit of 'task', returned by getNext.
+         */
+        void done(IndexTask task, IndexVisitResult result) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _nsInProgress.erase(task.ns);
+
+            if (result == kStopDatabase) {
+                const string dbName = task.dbName;
+                _tasks.erase(std::remove_if(_tasks.begin(),
+                                            _tasks.end(),
+                                            [&dbName](const IndexTask& other) {
+                                                return other.dbName == dbName;
+                                            }),
+                             _tasks.end());
+            } else if (result == kIndexHasMore) {
+                if (_budgetExhausted_inlock()) {
+                    _incomplete = true;
+                } else {
+                    _tasks.push_back(std::move(task));
+                }
+            }
+
+            if (_budgetExhausted_inlock() && !_tasks.empty()) {
+                _incomplete = true;
+                _tasks.clear();
+            }
+
+            _taskDoneCV.notify_all();
+        }
+
+        /**
+         * Returns how many documents a visit may delete, given the slice size and what is left
+         * of the pass budget.
+         */
+        long long getDocsForVisit() const {
+            const long long sliceDocs = std::max(1, static_cast<int>(ttlMonitorSliceDocs));
+            if (_maxDocs <= 0) {
+                return sliceDocs;
+            }
+
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            return std::max(0LL, std::min(sliceDocs, _maxDocs - _numDeleted));
+        }
+
+        void recordDeleted(long long numDeleted) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _numDeleted += numDeleted;
+        }
+
+        bool pastDeadline() const {
+            return _deadline != Date_t() && Date_t::now() >= _deadline;
+        }
+
+        bool isIncomplete() const {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            return _incomplete;
+        }
+
+        // Time the pass started at. Documents expired at that time are deleted during the pass.
+        const Date_t now;
+
+    private:
+        bool _budgetExhausted_inlock() const {
+            return (_maxDocs > 0 && _numDeleted >= _maxDocs) || pastDeadline();
+        }
+
+        Date_t _deadline;
+
+        mutable stdx::mutex _mutex;
+        stdx::condition_variable _taskDoneCV;
+
+        deque<IndexTask> _tasks;
+        set<string> _nsInProgress;
+
+        const long long _maxDocs;
+        long long _numDeleted = 0;
+        bool _incomplete = false;
+    };
+
     void doTTLPass() {
         // Count it as active from the moment the TTL thread wakes up
         OperationContextImpl txn;
@@ -132,7 +316,9 @@ private:
         dbHolder().getAllShortNames(dbs);
 
         ttlPasses.increment();
+        ttlLastPassMaxDeletionLag.millis.store(0);
 
+        deque<IndexTask> tasks;
         for (set<string>::const_iterator i = dbs.begin(); i != dbs.end(); ++i) {
             string db = *i;
 
@@ -140,18 +326,62 @@ private:
             getTTLIndexesForDB(&txn, db, &indexes);
 
             for (vector<BSONObj>::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
-                BSONObj idx = *it;
-                try {
-                    if (!doTTLForIndex(&txn, db, idx)) {
-                        break;  // stop processing TTL indexes on this database
-                    }
-                } catch (const DBException& dbex) {
-                    error() << "Error processing ttl index: " << idx << " -- " << dbex.toString();
-                    // continue on to the next index
-                    continue;
-                }
+                tasks.push_back(IndexTask{db, (*it)["ns"].String(), *it});
             }
         }
+
+        if (tasks.empty()) {
+            return;
+        }
+
+        // Read the current time once for the whole pass, so that we don't expand our index
+        // bounds after every WriteConflictException or every visit of an index.
+        Pass pass(std::move(tasks), Date_t::now());
+
+        const int numWorkers = std::max(1, static_cast<int>(ttlMonitorWorkers));
+        vector<stdx::thread> workers;
+        for (int i = 1; i < numWorkers; i++) {
+            workers.emplace_back([this, &pass, i] {
+                const string threadName = str::stream() << name() << "-" << i;
+                Client::initThread(threadName.c_str());
+                AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+                OperationContextImpl workerTxn;
+                doTTLWork(&workerTxn, &pass);
+            });
+        }
+
+        doTTLWork(&txn, &pass);
+
+        for (auto&& worker : workers) {
+            worker.join();
+        }
+
+        if (pass.isIncomplete()) {
+            ttlIncompletePasses.increment();
+            LOG(1) << "TTL pass ran out of budget, expired documents left for the next pass";
+        }
+    }
+
+    /**
+     * Visits the indexes of 'pass' until there are none left.
+     */
+    void doTTLWork(OperationContext* txn, Pass* pass) {
+        IndexTask task;
+        while (pass->getNext(&task)) {
+            IndexVisitResult result = kIndexDone;
+            try {
+                result = doTTLForIndex(txn, task.dbName, task.idx, pass);
+            } catch (const WriteConflictException& e) {
+                LOG(1) << "Got WriteConflictException in TTL thread";
+            } catch (const DBException& dbex) {
+                error() << "Error processing ttl index: " << task.idx << " -- "
+                        << dbex.toString();
+                // continue on to the next index
+            }
+
+            pass->done(std::move(task), result);
+        }
     }
 
     /**
@@ -204,38 +434,44 @@ private:
      * after a sufficient amount of time has passed according to its expiry
      * specification.
      *
-     * @return true if caller should continue processing TTL indexes of collections
-     *         on the specified database, and false otherwise
+     * Deletes at most as many documents as the pass allows for one visit of an index, and
+     * returns kIndexHasMore if expired documents may be left.
      */
-    bool doTTLForIndex(OperationContext* txn, const string& dbName, BSONObj idx) {
+    IndexVisitResult doTTLForIndex(OperationContext* txn,
+                                   const string& dbName,
+                                   BSONObj idx,
+                                   Pass* pass) {
         const string ns = idx["ns"].String();
         NamespaceString nss(ns);
         if (!userAllowedWriteNS(nss).isOK()) {
             error() << "namespace '" << ns
                     << "' doesn't allow deletes, skipping ttl job for: " << idx;
-            return true;
+            return kIndexDone;
         }
 
         BSONObj key = idx["key"].Obj();
         if (key.nFields() != 1) {
             error() << "key for ttl index can only have 1 field, skipping ttl job for: " << idx;
-            return true;
+            return kIndexDone;
         }
 
         LOG(1) << "TTL -- ns: " << ns << " key: " << key;
 
-        // Read the current time outside of the while loop, so that we don't expand our index
-        // bounds after every WriteConflictException.
-        const Date_t now = Date_t::now();
+        const Date_t now = pass->now;
+        const long long maxDocs = pass->getDocsForVisit();
+        if (maxDocs == 0) {
+            return kIndexHasMore;
+        }
 
         long long numDeleted = 0;
+        ON_BLOCK_EXIT([&] { pass->recordDeleted(numDeleted); });
         int attempt = 1;
         while (1) {
             ScopedTransaction scopedXact(txn, MODE_IX);
             AutoGetDb autoDb(txn, dbName, MODE_IX);
             Database* db = autoDb.getDb();
             if (!db) {
-                return false;
+                return kStopDatabase;
             }
 
             Lock::CollectionLock collLock(txn->lockState(), ns, MODE_IX);
@@ -243,20 +479,20 @@ private:
             Collection* collection = db->getCollection(ns);
             if (!collection) {
                 // Collection was dropped.
-                return true;
+                return kIndexDone;
             }
 
             if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(nss)) {
                 // We've stepped down since we started this function, so we should stop working
                 // as we only do deletes on the primary.
-                return false;
+                return kStopDatabase;
             }
 
             IndexDescriptor* desc = collection->getIndexCatalog()->findIndexByKeyPattern(txn, key);
             if (!desc) {
                 LOG(1) << "index not found (index build in progress? index dropped?), skipping "
                        << "ttl job for: " << idx;
-                return true;
+                return kIndexDone;
             }
 
             // Re-read 'idx' from the descriptor, in case the collection or index definition
@@ -266,7 +502,7 @@ private:
             if (IndexType::INDEX_BTREE != IndexNames::nameToType(desc->getAccessMethodName())) {
                 error() << "special index can't be used as a ttl index, skipping ttl job for: "
                         << idx;
-                return true;
+                return kIndexDone;
             }
 
             BSONElement secondsExpireElt = idx[secondsExpireField];
@@ -274,13 +510,14 @@ private:
                 error() << "ttl indexes require the " << secondsExpireField << " field to be "
                         << "numeric but received a type of " << typeName(secondsExpireElt.type())
                         << ", skipping ttl job for: " << idx;
-                return true;
+                return kIndexDone;
             }
 
             const Date_t kDawnOfTime =
                 Date_t::fromMillisSinceEpoch(std::numeric_limits<long long>::min());
             const BSONObj startKey = BSON("" << kDawnOfTime);
-            const BSONObj endKey = BSON("" << now - Seconds(secondsExpireElt.numberLong()));
+            const Seconds expireAfter(secondsExpireElt.numberLong());
+            const BSONObj endKey = BSON("" << now - expireAfter);
             const bool endKeyInclusive = true;
             // The canonical check as to whether a key pattern element is "ascending" or
             // "descending" is (elt.number() >= 0).  This is defined by the Ordering class.
@@ -304,8 +541,15 @@ private:
                     }
                     ++numDeleted;
                     ttlDeletedDocuments.increment();
+                    recordDeletionLag(obj.firstElement(), expireAfter);
+
+                    if (numDeleted >= maxDocs || pass->pastDeadline()) {
+                        LOG(1) << "\tTTL deleted: " << numDeleted << ", more may have expired";
+                        return kIndexHasMore;
+                    }
+
                     if (!exec->restoreState(txn)) {
-                        return true;
+                        return kIndexDone;
                     }
                 }
 
@@ -313,11 +557,11 @@ private:
                     if (WorkingSetCommon::isValidStatusMemberObject(obj)) {
                         error() << "ttl query execution for index " << idx
                                 << " failed with: " << WorkingSetCommon::getMemberObjectStatus(obj);
-                        return true;
+                        return kIndexDone;
                     }
                     error() << "ttl query execution for index " << idx
                             << " failed with state: " << PlanExecutor::statestr(state);
-                    return true;
+                    return kIndexDone;
                 }
 
                 invariant(PlanExecutor::IS_EOF == state);
@@ -328,7 +572,32 @@ private:
         }
 
         LOG(1) << "\tTTL deleted: " << numDeleted << endl;
-        return true;
+        return kIndexDone;
+    }
+
+    /**
+     * Records how long after its expiry a document was deleted, given the TTL index key of
+     * the document.
+     */
+    static void recordDeletionLag(const BSONElement& indexKey, Seconds expireAfter) {
+        if (indexKey.type() != Date) {
+            return;
+        }
+
+        const Milliseconds lag = Date_t::now() - (indexKey.date() + expireAfter);
+        const long long lagMillis = std::max(0LL, durationCount<Milliseconds>(lag));
+        ttlDeletionLag.recordMillis(
+            static_cast<int>(std::min<long long>(lagMillis, std::numeric_limits<int>::max())));
+
+        long long maxLag = ttlLastPassMaxDeletionLag.millis.load();
+        while (lagMillis > maxLag) {
+            const long long seen =
+                ttlLastPassMaxDeletionLag.millis.compareAndSwap(maxLag, lagMillis);
+            if (seen == maxLag) {
+                break;
+            }
+            maxLag = seen;
+        }
     }
 };
 
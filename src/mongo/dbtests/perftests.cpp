@@ -50,10 +50,16 @@
 #include <mutex>
 
 #include "mongo/config.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/cursor_manager.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/index_create.h"
 #include "mongo/db/client.h"
 #include "mongo/db/concurrency/lock_state.h"
 #include "mongo/db/db.h"
+#include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/hasher.h"
 #include "mongo/db/json.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/operation_context_impl.h"
@@ -62,6 +68,7 @@
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/db/storage/mmap_v1/durable_mapped_file.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
+#include "mongo/db/stats/top.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
@@ -71,6 +78,7 @@
 #include "mongo/util/checksum.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/timer.h"
 #include "mongo/util/version.h"
 
@@ -330,6 +338,11 @@ public:
         return false;
     }
 
+    /** Numbers of threads to run the threaded test with. Several give a scaling curve. */
+    virtual vector<int> threadCounts() {
+        return vector<int>(1, 8);
+    }
+
     int howLong() {
         int hlm = howLongMillis();
         DEV {
@@ -387,11 +400,18 @@ public:
         }
 
         if (testThreaded()) {
-            const int nThreads = 8;
-            // cout << "testThreaded nThreads:" << nThreads << endl;
-            mongo::Timer t;
-            const unsigned long long result = launchThreads(nThreads);
-            say(result / nThreads, t.micros(), test2name + "-threaded");
+            const vector<int> counts = threadCounts();
+            for (size_t i = 0; i < counts.size(); i++) {
+                const int nThreads = counts[i];
+                // cout << "testThreaded nThreads:" << nThreads << endl;
+                mongo::Timer t;
+                const unsigned long long result = launchThreads(nThreads);
+                string testName = test2name + "-threaded";
+                if (counts.size() > 1) {
+                    testName += str::stream() << "-" << nThreads;
+                }
+                say(result / nThreads, t.micros(), testName);
+            }
         }
     }
 
@@ -523,6 +543,25 @@ public:
     }
 };
 
+/** hashing an _id the way a hashed index with the given hashVersion does */
+template <int HashVersion>
+class Hash64 : public NonDurTest {
+public:
+    long long n;
+    bo b;
+    string name() {
+        return str::stream() << "Hash64-v" << HashVersion;
+    }
+    Hash64() {
+        n = 0;
+        b = BSON("_id" << OID::gen());
+    }
+    void timed() {
+        n += BSONElementHasher::hash64(
+            b.firstElement(), BSONElementHasher::DEFAULT_HASH_SEED, HashVersion);
+    }
+};
+
 class KeyTest : public B {
 public:
     KeyV1Owned a, b, c;
@@ -792,6 +831,16 @@ public:
     virtual bool testThreaded() {
         return true;
     }
+    // Scale from a single thread up to twice the number of cores.
+    virtual vector<int> threadCounts() {
+        const int maxThreads = std::max(8, 2 * static_cast<int>(ProcessInfo().getNumCores()));
+        vector<int> counts;
+        for (int n = 1; n < maxThreads; n *= 2) {
+            counts.push_back(n);
+        }
+        counts.push_back(maxThreads);
+        return counts;
+    }
     virtual void prep() {
         resId.reset(new ResourceId(RESOURCE_COLLECTION, std::string("TestDB.collection")));
         locker.reset(new MMAPV1LockerImpl());
@@ -835,6 +884,34 @@ public:
     }
 };
 
+// Intent locks on the global and database resources, as taken by point reads and writes
+class dblocker : public locker_test {
+public:
+    virtual string name() {
+        return (str::stream() << "dblocker" << glockMode);
+    }
+
+    void timed() {
+        locker->lockGlobal(glockMode);
+        locker->lock(dbResId, glockMode);
+        locker->unlockAll();
+    }
+
+    void timed2(DBClientBase* c) {
+        timed();
+    }
+
+private:
+    const ResourceId dbResId = ResourceId(RESOURCE_DATABASE, std::string("TestDB"));
+};
+
+class dblockerIS : public dblocker {
+public:
+    dblockerIS() {
+        glockMode = MODE_IS;
+    }
+};
+
 class locker_test_uncontested : public locker_test {
 public:
     locker_test_uncontested(LockMode m = MODE_IX, LockMode gm = MODE_IX) : locker_test(m, gm) {}
@@ -881,6 +958,87 @@ public:
     locker_uncontestedS() : locker_test_uncontested(MODE_S, MODE_IS) {}
 };
 
+/** Base for tests of shared registries, run on 1 up to 64 threads to show how they scale. */
+class RegistryScalingTest : public B {
+public:
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual bool testThreaded() {
+        return true;
+    }
+    virtual vector<int> threadCounts() {
+        vector<int> counts;
+        for (int n = 1; n <= 64; n *= 2) {
+            counts.push_back(n);
+        }
+        return counts;
+    }
+    void timed() {
+        timed2(NULL);
+    }
+};
+
+/** Top::record at the end of every operation. */
+class TopRecord : public RegistryScalingTest {
+public:
+    virtual string name() {
+        return "top_record";
+    }
+    void timed2(DBClientBase* c) {
+        Top::get(getGlobalServiceContext()).record("perftest.top", dbQuery, -1, 1, false);
+    }
+};
+
+/**
+ * What a query and a getMore do to the cursor registry of a collection: register an executor
+ * for yielding, look up a cursor id and deregister the executor.
+ */
+class CursorRegistry : public RegistryScalingTest {
+public:
+    CursorRegistry() : cursorManager(NULL) {}
+
+    CursorManager* cursorManager;
+    std::unique_ptr<CursorManager> ownedCursorManager;
+    boost::thread_specific_ptr<int> executorStandIn;
+
+    virtual string name() {
+        return "cursor_registry";
+    }
+    virtual void prep() {
+        ownedCursorManager.reset(
+            new CursorManager("perftest.cursors", CursorManager::kMaxPartitions));
+        cursorManager = ownedCursorManager.get();
+        executorStandIn.reset(new int);
+    }
+    virtual void prepThreaded() {
+        executorStandIn.reset(new int);
+    }
+    void timed2(DBClientBase* c) {
+        // The registry only stores the pointer, it never dereferences it.
+        PlanExecutor* exec = reinterpret_cast<PlanExecutor*>(executorStandIn.get());
+        cursorManager->registerExecutor(exec);
+        if (cursorManager->find(reinterpret_cast<uintptr_t>(exec), false))
+            dontOptimizeOutHopefully++;
+        cursorManager->deregisterExecutor(exec);
+    }
+};
+
+/** The same, on the cursor manager of an actual collection of the running storage engine. */
+class CollectionCursorRegistry : public CursorRegistry {
+public:
+    virtual string name() {
+        return "collection_cursor_registry";
+    }
+    virtual void prep() {
+        client()->insert(ns(), BSONObj());
+        AutoGetCollectionForRead ctx(txn(), ns());
+        verify(ctx.getCollection());
+        cursorManager = ctx.getCollection()->getCursorManager();
+        executorStandIn.reset(new int);
+    }
+};
+
 class CTM : public B {
 public:
     CTM() : last(0), delts(0), n(0) {}
@@ -1437,6 +1595,61 @@ public:
     }
 };
 
+/**
+ * Builds an index on a collection of kIndexBuildDocs documents and drops it again, so the rate
+ * reported is index builds per second. The foreground variant sorts the keys externally and
+ * streams them into the storage engine's bulk builder. The background variant inserts every
+ * key through the regular index write path and serves as the baseline.
+ */
+template <bool background>
+class IndexBuild : public B {
+public:
+    static const int kIndexBuildDocs = 20000;
+
+    string name() {
+        return background ? "index-build-background" : "index-build-bulk";
+    }
+    virtual unsigned batchSize() {
+        return 1;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    void prep() {
+        vector<BSONObj> docs;
+        for (int i = 0; i < kIndexBuildDocs; i++) {
+            docs.push_back(BSON("_id" << i << "x" << std::rand() << "y" << i % 100));
+            if (docs.size() == 1000) {
+                client()->insert(ns(), docs);
+                docs.clear();
+            }
+        }
+    }
+    void timed() {
+        {
+            AutoGetDb autoDb(txn(), nsToDatabaseSubstring(ns()), MODE_X);
+            Collection* coll = autoDb.getDb()->getCollection(ns());
+            verify(coll);
+
+            MultiIndexBlock indexer(txn(), coll);
+            if (background) {
+                indexer.allowBackgroundBuilding();
+                indexer.allowInterruption();
+            }
+            ASSERT_OK(indexer.init(BSON("name"
+                                        << "x_1"
+                                        << "ns" << ns() << "key" << BSON("x" << 1)
+                                        << "background" << background)));
+            ASSERT_OK(indexer.insertAllDocumentsInCollection());
+
+            WriteUnitOfWork wunit(txn());
+            indexer.commit();
+            wunit.commit();
+        }
+        client()->dropIndex(ns(), BSON("x" << 1));
+    }
+};
+
 // Tests what the worst case is for the overhead of enabling a fail point. If 'fpInjected'
 // is false, then the fail point will be compiled out. If 'fpInjected' is true, then the
 // fail point will be compiled in. Since the conditioned block is more or less trivial, any
@@ -1678,10 +1891,15 @@ public:
             add<wlock>();
             add<glockerIX>();
             add<glockerIS>();
+            add<dblocker>();
+            add<dblockerIS>();
             add<locker_contestedX>();
             add<locker_uncontestedX>();
             add<locker_contestedS>();
             add<locker_uncontestedS>();
+            add<TopRecord>();
+            add<CursorRegistry>();
+            add<CollectionCursorRegistry>();
             add<NotifyOne>();
             add<simplemutexspeed>();
             add<boostmutexspeed>();
@@ -1700,6 +1918,8 @@ public:
             add<BSONIter>();
             add<BSONGetFields1>();
             add<BSONGetFields2>();
+            add<Hash64<BSONElementHasher::MD5_HASH_VERSION>>();
+            add<Hash64<BSONElementHasher::MURMUR3_HASH_VERSION>>();
             // add< TaskQueueTest >();
             add<InsertDup>();
             add<Insert1>();
@@ -1708,6 +1928,8 @@ public:
             add<Update1>();
             add<MoreIndexes<Update1>>();
             add<InsertBig>();
+            add<IndexBuild<false>>();
+            add<IndexBuild<true>>();
             add<FailPointTest<false, false>>();
             add<FailPointTest<true, false>>();
             add<FailPointTest<true, true>>();
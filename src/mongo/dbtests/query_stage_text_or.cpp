@@ -0,0 +1,154 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file tests db/exec/text_or.cpp.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/exec/queued_data_stage.h"
+#include "mongo/db/exec/text_or.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/dbtests/dbtests.h"
+
+namespace QueryStageTextOr {
+
+using std::unique_ptr;
+
+class QueryStageTextOrBase {
+public:
+    QueryStageTextOrBase() : _client(&_txn) {}
+
+    virtual ~QueryStageTextOrBase() {
+        OldClientWriteContext ctx(&_txn, ns());
+        _client.dropCollection(ns());
+    }
+
+    static const char* ns() {
+        return "unittests.QueryStageTextOr";
+    }
+
+protected:
+    /**
+     * Queues the index key of 'term' in the document with 'loc' which scores 'score' on it.
+     */
+    void pushKey(QueuedDataStage* child,
+                 IndexDescriptor* index,
+                 const std::string& term,
+                 const RecordId& loc,
+                 double score) {
+        WorkingSetID id = _ws.allocate();
+        WorkingSetMember* member = _ws.get(id);
+        member->loc = loc;
+        member->keyData.push_back(
+            IndexKeyDatum(index->keyPattern(), BSON("" << term << "" << score), NULL));
+        _ws.transitionToLocAndIdx(id);
+        child->pushBack(id);
+    }
+
+    OperationContextImpl _txn;
+    DBDirectClient _client;
+    WorkingSet _ws;
+};
+
+/**
+ * Documents which can't make the top ones are dropped from memory as the keys are read, even
+ * when reading has to go on to the end of the terms.
+ */
+class DroppedDocumentsAreForgotten : public QueryStageTextOrBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_txn, ns());
+        ASSERT_OK(dbtests::createIndex(&_txn, ns(), BSON("text"
+                                                         << "text")));
+        Collection* coll = ctx.getCollection();
+        ASSERT(coll);
+        IndexDescriptor* index = coll->getIndexCatalog()->findIndexByName(&_txn, "text_text");
+        ASSERT(index);
+
+        const RecordId top(1);
+        const RecordId late(2);
+        const int numFiller = 1000;
+
+        // 'top' scores the most. 'late' is read first for "alpha", but only last for "beta", so
+        // it might beat 'top' until the very end of the keys of "beta". Each of the filler
+        // documents is read for "beta" only and can't.
+        unique_ptr<QueuedDataStage> alpha(new QueuedDataStage(&_ws));
+        pushKey(alpha.get(), index, "alpha", late, 100);
+        pushKey(alpha.get(), index, "alpha", top, 99);
+
+        unique_ptr<QueuedDataStage> beta(new QueuedDataStage(&_ws));
+        pushKey(beta.get(), index, "beta", top, 99);
+        for (int i = 0; i < numFiller; ++i) {
+            pushKey(beta.get(), index, "beta", RecordId(3 + i), 98.9 - 0.8 * i / numFiller);
+        }
+        pushKey(beta.get(), index, "beta", late, 1);
+
+        TextOrStage textOr(&_txn, FTSSpec(index->infoObj()), &_ws, NULL, index, 1);
+        textOr.addChild(std::move(alpha), "alpha");
+        textOr.addChild(std::move(beta), "beta");
+
+        std::vector<WorkingSetID> results;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState state;
+        while (PlanStage::IS_EOF != (state = textOr.work(&id))) {
+            ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+            if (PlanStage::ADVANCED == state) {
+                results.push_back(id);
+            }
+        }
+
+        ASSERT_EQUALS(1U, results.size());
+        ASSERT_EQUALS(top, _ws.get(results[0])->loc);
+
+        const TextOrStats* stats = static_cast<const TextOrStats*>(textOr.getSpecificStats());
+        ASSERT_EQUALS(static_cast<size_t>(numFiller + 1), stats->docsPruned);
+
+        // Only the documents read between two checks for the top ones are held at once.
+        ASSERT_LESS_THAN(stats->maxDocsBuffered, static_cast<size_t>(numFiller / 2));
+    }
+};
+
+class All : public Suite {
+public:
+    All() : Suite("query_stage_text_or") {}
+
+    void setupTests() {
+        add<DroppedDocumentsAreForgotten>();
+    }
+};
+
+SuiteInstance<All> queryStageTextOrAll;
+
+}  // namespace QueryStageTextOr
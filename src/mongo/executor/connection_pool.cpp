@@ -0,0 +1,544 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/connection_pool.h"
+
+#include <limits>
+#include <set>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace executor {
+
+namespace {
+
+// Every live pool, for connPoolStats
+stdx::mutex registryMutex;
+std::set<const ConnectionPool*> registry;
+
+}  // namespace
+
+const size_t ConnectionPool::kDefaultMinConns = 1;
+const size_t ConnectionPool::kDefaultMaxConns = std::numeric_limits<size_t>::max();
+const Milliseconds ConnectionPool::kDefaultRefreshRequirement = Seconds(60);
+const Milliseconds ConnectionPool::kDefaultRefreshTimeout = Seconds(20);
+const Milliseconds ConnectionPool::kDefaultHostTimeout = Minutes(5);
+
+/**
+ * The connections and pending requests for a single host.
+ *
+ * Every connection is in exactly one of three states, each with a map that owns it:
+ *  - ready: idle, with the pool's refresh timeout set on it
+ *  - processing: being set up or refreshed
+ *  - checked out: handed to a caller through a ConnectionHandle
+ *
+ * All methods must be called with the parent's mutex held. Those that take the lock by value
+ * release it before returning, and those that take it by reference may release it temporarily
+ * to run callbacks.
+ */
+class ConnectionPool::SpecificPool {
+    MONGO_DISALLOW_COPYING(SpecificPool);
+
+public:
+    SpecificPool(ConnectionPool* parent, const HostAndPort& hostAndPort);
+    ~SpecificPool();
+
+    void getConnection(Milliseconds timeout,
+                       stdx::unique_lock<stdx::mutex> lk,
+                       GetConnectionCallback cb);
+
+    void returnConnection(ConnectionInterface* connection, stdx::unique_lock<stdx::mutex> lk);
+
+    void dropConnections(stdx::unique_lock<stdx::mutex> lk);
+
+    void appendStats(BSONObjBuilder* b) const;
+
+    size_t available() const {
+        return _readyPool.size();
+    }
+
+    size_t inUse() const {
+        return _checkedOutPool.size();
+    }
+
+    size_t refreshing() const {
+        return _processingPool.size();
+    }
+
+    long long created() const {
+        return _created;
+    }
+
+private:
+    using OwnedConnection = std::unique_ptr<ConnectionInterface>;
+    using OwnershipPool = std::unordered_map<ConnectionInterface*, OwnedConnection>;
+
+    // Requests ordered by when they expire; requests with the same deadline keep their order.
+    using RequestQueue = std::multimap<Date_t, GetConnectionCallback>;
+
+    size_t openConnections() const {
+        return _readyPool.size() + _processingPool.size() + _checkedOutPool.size();
+    }
+
+    bool isIdle() const {
+        return _requests.empty() && _processingPool.empty() && _checkedOutPool.empty();
+    }
+
+    OwnedConnection takeFromPool(OwnershipPool& pool, ConnectionInterface* connection);
+
+    void addToReady(stdx::unique_lock<stdx::mutex>& lk, OwnedConnection conn);
+
+    void refresh(stdx::unique_lock<stdx::mutex>& lk, OwnedConnection conn);
+
+    void finishProcessing(stdx::unique_lock<stdx::mutex>& lk,
+                          ConnectionInterface* connPtr,
+                          Status status);
+
+    void fulfillRequests(stdx::unique_lock<stdx::mutex>& lk);
+
+    void failAllRequests(stdx::unique_lock<stdx::mutex>& lk, const Status& status);
+
+    void spawnConnections(stdx::unique_lock<stdx::mutex>& lk);
+
+    void expireRequests(stdx::unique_lock<stdx::mutex>& lk);
+
+    void updateStateInLock();
+
+    ConnectionPool* const _parent;
+
+    const HostAndPort _hostAndPort;
+
+    OwnershipPool _readyPool;
+    OwnershipPool _processingPool;
+    OwnershipPool _checkedOutPool;
+
+    RequestQueue _requests;
+
+    // Fires when the oldest request expires or, while the host is idle, when it times out.
+    std::unique_ptr<TimerInterface> _timer;
+    Date_t _timerExpiration;
+
+    // Bumped by dropConnections() to retire every connection made before it.
+    size_t _generation = 0;
+
+    // The last time a request came in or a connection was returned.
+    Date_t _lastActive;
+
+    // Callbacks currently running with the lock released. The host is never timed out while
+    // this is non-zero.
+    size_t _inFlight = 0;
+
+    long long _created = 0;
+};
+
+ConnectionPool::SpecificPool::SpecificPool(ConnectionPool* parent, const HostAndPort& hostAndPort)
+    : _parent(parent),
+      _hostAndPort(hostAndPort),
+      _timer(parent->_factory->makeTimer()),
+      _timerExpiration(Date_t::max()),
+      _lastActive(parent->_factory->now()) {}
+
+ConnectionPool::SpecificPool::~SpecificPool() {
+    DESTRUCTOR_GUARD(_timer->cancelTimeout();)
+}
+
+void ConnectionPool::SpecificPool::getConnection(Milliseconds timeout,
+                                                 stdx::unique_lock<stdx::mutex> lk,
+                                                 GetConnectionCallback cb) {
+    const auto now = _parent->_factory->now();
+    const auto expiration =
+        (timeout >= Date_t::max() - now) ? Date_t::max() : now + std::max(timeout, Milliseconds(0));
+
+    _lastActive = now;
+    _requests.emplace(expiration, std::move(cb));
+
+    fulfillRequests(lk);
+}
+
+void ConnectionPool::SpecificPool::returnConnection(ConnectionInterface* connPtr,
+                                                    stdx::unique_lock<stdx::mutex> lk) {
+    auto conn = takeFromPool(_checkedOutPool, connPtr);
+    const auto now = _parent->_factory->now();
+    _lastActive = now;
+
+    if (conn->getGeneration() != _generation || !conn->getStatus().isOK()) {
+        // Closes the connection. Another one is spawned if requests are waiting.
+        conn.reset();
+        fulfillRequests(lk);
+        return;
+    }
+
+    if (now - conn->getLastUsed() >= _parent->_options.refreshRequirement) {
+        refresh(lk, std::move(conn));
+        return;
+    }
+
+    addToReady(lk, std::move(conn));
+    fulfillRequests(lk);
+}
+
+void ConnectionPool::SpecificPool::dropConnections(stdx::unique_lock<stdx::mutex> lk) {
+    ++_generation;
+    _readyPool.clear();
+
+    // Waiting requests get connections of the new generation.
+    fulfillRequests(lk);
+}
+
+void ConnectionPool::SpecificPool::appendStats(BSONObjBuilder* b) const {
+    b->appendNumber("available", static_cast<long long>(available()));
+    b->appendNumber("inUse", static_cast<long long>(inUse()));
+    b->appendNumber("refreshing", static_cast<long long>(refreshing()));
+    b->appendNumber("created", _created);
+    b->appendNumber("pendingRequests", static_cast<long long>(_requests.size()));
+}
+
+ConnectionPool::SpecificPool::OwnedConnection ConnectionPool::SpecificPool::takeFromPool(
+    OwnershipPool& pool, ConnectionInterface* connPtr) {
+    auto iter = pool.find(connPtr);
+    invariant(iter != pool.end());
+
+    auto conn = std::move(iter->second);
+    pool.erase(iter);
+    return conn;
+}
+
+void ConnectionPool::SpecificPool::addToReady(stdx::unique_lock<stdx::mutex>& lk,
+                                              OwnedConnection conn) {
+    auto connPtr = conn.get();
+    _readyPool[connPtr] = std::move(conn);
+
+    // An idle connection that is not used within refreshRequirement is either closed, if the
+    // host has more than minConnections, or refreshed.
+    connPtr->setTimeout(_parent->_options.refreshRequirement, [this, connPtr]() {
+        stdx::unique_lock<stdx::mutex> lk(_parent->_mutex);
+
+        // The connection may have been checked out while this callback was waiting for the lock.
+        if (!_readyPool.count(connPtr)) {
+            return;
+        }
+
+        auto conn = takeFromPool(_readyPool, connPtr);
+
+        if (openConnections() + 1 > _parent->_options.minConnections) {
+            conn.reset();
+            updateStateInLock();
+            return;
+        }
+
+        refresh(lk, std::move(conn));
+    });
+}
+
+void ConnectionPool::SpecificPool::refresh(stdx::unique_lock<stdx::mutex>& lk,
+                                           OwnedConnection conn) {
+    auto connPtr = conn.get();
+    _processingPool[connPtr] = std::move(conn);
+    updateStateInLock();
+
+    ++_inFlight;
+    lk.unlock();
+    connPtr->refresh(_parent->_options.refreshTimeout,
+                     [this](ConnectionInterface* connPtr, Status status) {
+                         stdx::unique_lock<stdx::mutex> lk(_parent->_mutex);
+                         finishProcessing(lk, connPtr, std::move(status));
+                     });
+    lk.lock();
+    --_inFlight;
+}
+
+void ConnectionPool::SpecificPool::finishProcessing(stdx::unique_lock<stdx::mutex>& lk,
+                                                    ConnectionInterface* connPtr,
+                                                    Status status) {
+    auto conn = takeFromPool(_processingPool, connPtr);
+
+    if (conn->getGeneration() != _generation) {
+        // The connection was dropped while it was being set up or refreshed.
+        conn.reset();
+        fulfillRequests(lk);
+        return;
+    }
+
+    if (!status.isOK()) {
+        LOG(1) << "Dropping connection to " << _hostAndPort << ": " << status;
+        conn.reset();
+
+        // The host is most likely unreachable, so rather than have the waiting requests spin
+        // through new connections until they time out, fail them now.
+        failAllRequests(lk, status);
+        return;
+    }
+
+    addToReady(lk, std::move(conn));
+    fulfillRequests(lk);
+}
+
+void ConnectionPool::SpecificPool::fulfillRequests(stdx::unique_lock<stdx::mutex>& lk) {
+    while (!_requests.empty() && !_readyPool.empty()) {
+        auto readyIter = _readyPool.begin();
+        auto connPtr = readyIter->first;
+        connPtr->cancelTimeout();
+        _checkedOutPool[connPtr] = std::move(readyIter->second);
+        _readyPool.erase(readyIter);
+
+        auto cb = std::move(_requests.begin()->second);
+        _requests.erase(_requests.begin());
+        updateStateInLock();
+
+        ++_inFlight;
+        lk.unlock();
+        cb(ConnectionHandle(connPtr, ConnectionHandleDeleter(_parent)));
+        lk.lock();
+        --_inFlight;
+    }
+
+    spawnConnections(lk);
+    updateStateInLock();
+}
+
+void ConnectionPool::SpecificPool::failAllRequests(stdx::unique_lock<stdx::mutex>& lk,
+                                                   const Status& status) {
+    RequestQueue requests;
+    requests.swap(_requests);
+    updateStateInLock();
+
+    ++_inFlight;
+    lk.unlock();
+    for (auto& request : requests) {
+        request.second(status);
+    }
+    lk.lock();
+    --_inFlight;
+    updateStateInLock();
+}
+
+void ConnectionPool::SpecificPool::spawnConnections(stdx::unique_lock<stdx::mutex>& lk) {
+    // Open enough connections for the waiting requests on top of the ones in use, but at least
+    // minConnections and at most maxConnections. Connections being set up count towards it.
+    const auto wanted = std::min(
+        _parent->_options.maxConnections,
+        std::max(_parent->_options.minConnections, _requests.size() + _checkedOutPool.size()));
+
+    while (openConnections() < wanted) {
+        auto conn = _parent->_factory->makeConnection(_hostAndPort, _generation);
+        auto connPtr = conn.get();
+        _processingPool[connPtr] = std::move(conn);
+        ++_created;
+
+        ++_inFlight;
+        lk.unlock();
+        connPtr->setup(_parent->_options.refreshTimeout,
+                       [this](ConnectionInterface* connPtr, Status status) {
+                           stdx::unique_lock<stdx::mutex> lk(_parent->_mutex);
+                           finishProcessing(lk, connPtr, std::move(status));
+                       });
+        lk.lock();
+        --_inFlight;
+    }
+}
+
+void ConnectionPool::SpecificPool::expireRequests(stdx::unique_lock<stdx::mutex>& lk) {
+    const auto now = _parent->_factory->now();
+
+    std::vector<GetConnectionCallback> expired;
+    while (!_requests.empty() && _requests.begin()->first <= now) {
+        expired.push_back(std::move(_requests.begin()->second));
+        _requests.erase(_requests.begin());
+    }
+    updateStateInLock();
+
+    ++_inFlight;
+    lk.unlock();
+    for (auto& cb : expired) {
+        cb(Status(ErrorCodes::ExceededTimeLimit,
+                  str::stream() << "Couldn't get a connection to " << _hostAndPort.toString()
+                                << " within the time limit"));
+    }
+    lk.lock();
+    --_inFlight;
+}
+
+void ConnectionPool::SpecificPool::updateStateInLock() {
+    Date_t expiration = Date_t::max();
+    bool hostTimeout = false;
+
+    if (!_requests.empty()) {
+        expiration = _requests.begin()->first;
+    } else if (isIdle()) {
+        const auto hostTimeoutAt = _lastActive + _parent->_options.hostTimeout;
+        expiration = (hostTimeoutAt < _lastActive) ? Date_t::max() : hostTimeoutAt;
+        hostTimeout = true;
+    }
+
+    if (expiration == _timerExpiration) {
+        return;
+    }
+
+    _timerExpiration = expiration;
+    if (expiration == Date_t::max()) {
+        _timer->cancelTimeout();
+        return;
+    }
+
+    const auto timeout = std::max(expiration - _parent->_factory->now(), Milliseconds(0));
+
+    if (!hostTimeout) {
+        _timer->setTimeout(timeout, [this]() {
+            stdx::unique_lock<stdx::mutex> lk(_parent->_mutex);
+            _timerExpiration = Date_t::max();
+            expireRequests(lk);
+            updateStateInLock();
+        });
+        return;
+    }
+
+    _timer->setTimeout(timeout, [this]() {
+        stdx::unique_lock<stdx::mutex> lk(_parent->_mutex);
+        _timerExpiration = Date_t::max();
+
+        if (!isIdle() || _inFlight ||
+            _parent->_factory->now() - _lastActive < _parent->_options.hostTimeout) {
+            updateStateInLock();
+            return;
+        }
+
+        LOG(1) << "Ending idle connection pool to " << _hostAndPort << " after "
+               << _parent->_options.hostTimeout;
+
+        // Destroys this SpecificPool, its timer and its remaining idle connections.
+        auto hostAndPort = _hostAndPort;
+        _parent->_pools.erase(hostAndPort);
+    });
+}
+
+void ConnectionPool::ConnectionHandleDeleter::operator()(ConnectionInterface* connection) {
+    if (_pool && connection) {
+        _pool->returnConnection(connection);
+    }
+}
+
+ConnectionPool::ConnectionPool(std::unique_ptr<DependentTypeFactoryInterface> impl,
+                               std::string name,
+                               Options options)
+    : _name(std::move(name)), _options(std::move(options)), _factory(std::move(impl)) {
+    stdx::lock_guard<stdx::mutex> lk(registryMutex);
+    registry.insert(this);
+}
+
+ConnectionPool::~ConnectionPool() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(registryMutex);
+        registry.erase(this);
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _pools.clear();
+}
+
+void ConnectionPool::get(const HostAndPort& hostAndPort,
+                         Milliseconds timeout,
+                         GetConnectionCallback cb) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+
+    auto& pool = _pools[hostAndPort];
+    if (!pool) {
+        pool = stdx::make_unique<SpecificPool>(this, hostAndPort);
+    }
+
+    // SpecificPools are only destroyed under the lock while idle, and this one is not idle once
+    // the request is queued.
+    pool->getConnection(timeout, std::move(lk), std::move(cb));
+}
+
+void ConnectionPool::returnConnection(ConnectionInterface* conn) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+
+    auto iter = _pools.find(conn->getHostAndPort());
+    invariant(iter != _pools.end());
+
+    iter->second->returnConnection(conn, std::move(lk));
+}
+
+void ConnectionPool::dropConnections(const HostAndPort& hostAndPort) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+
+    auto iter = _pools.find(hostAndPort);
+    if (iter == _pools.end()) {
+        return;
+    }
+
+    iter->second->dropConnections(std::move(lk));
+}
+
+void ConnectionPool::appendConnectionStats(BSONObjBuilder* b) const {
+    long long available = 0;
+    long long inUse = 0;
+    long long refreshing = 0;
+    long long created = 0;
+
+    {
+        BSONObjBuilder hostBuilder(b->subobjStart("hosts"));
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (const auto& pool : _pools) {
+            BSONObjBuilder poolBuilder(hostBuilder.subobjStart(pool.first.toString()));
+            pool.second->appendStats(&poolBuilder);
+
+            available += pool.second->available();
+            inUse += pool.second->inUse();
+            refreshing += pool.second->refreshing();
+            created += pool.second->created();
+        }
+    }
+
+    b->appendNumber("totalAvailable", available);
+    b->appendNumber("totalInUse", inUse);
+    b->appendNumber("totalRefreshing", refreshing);
+    b->appendNumber("totalCreated", created);
+}
+
+void ConnectionPool::appendAllConnectionStats(BSONObjBuilder* b) {
+    stdx::lock_guard<stdx::mutex> lk(registryMutex);
+    for (auto pool : registry) {
+        BSONObjBuilder poolBuilder(b->subobjStart(pool->_name));
+        pool->appendConnectionStats(&poolBuilder);
+    }
+}
+
+}  // namespace executor
+}  // namespace mongo
@@ -0,0 +1,300 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+namespace executor {
+
+/**
+ * An asynchronous pool of connections, kept per remote host.
+ *
+ * Callers ask for a connection with get() and are called back once one is available: either
+ * straight away with an idle connection to that host, or once a new connection has finished its
+ * setup, or with an error if the request's timeout passes first. The pool never blocks: all
+ * connecting, handshaking, health checking and timing is done through the
+ * DependentTypeFactoryInterface it is constructed with, which lets a network interface plug in
+ * its own connections and lets tests drive the pool with a mock network.
+ *
+ * Per host, the pool keeps at least Options::minConnections and at most Options::maxConnections
+ * connections open. A connection which sits idle for refreshRequirement is closed if there are
+ * more than minConnections open, and is otherwise health checked with refresh(). Once a host has
+ * had no requests and no connections in use for hostTimeout, all of its connections are closed.
+ *
+ * The pool is synchronized internally and never runs callbacks while holding its mutex.
+ */
+class ConnectionPool {
+    MONGO_DISALLOW_COPYING(ConnectionPool);
+
+    class SpecificPool;
+
+public:
+    class ConnectionInterface;
+    class DependentTypeFactoryInterface;
+    class TimerInterface;
+
+    /**
+     * Returns a connection to the pool it was drawn from when a ConnectionHandle goes away.
+     */
+    class ConnectionHandleDeleter {
+    public:
+        ConnectionHandleDeleter() = default;
+        explicit ConnectionHandleDeleter(ConnectionPool* pool) : _pool(pool) {}
+
+        void operator()(ConnectionInterface* connection);
+
+    private:
+        ConnectionPool* _pool = nullptr;
+    };
+
+    using ConnectionHandle = std::unique_ptr<ConnectionInterface, ConnectionHandleDeleter>;
+
+    using GetConnectionCallback = stdx::function<void(StatusWith<ConnectionHandle>)>;
+
+    static const size_t kDefaultMinConns;
+    static const size_t kDefaultMaxConns;
+    static const Milliseconds kDefaultRefreshRequirement;
+    static const Milliseconds kDefaultRefreshTimeout;
+    static const Milliseconds kDefaultHostTimeout;
+
+    struct Options {
+        Options() {}
+
+        /**
+         * The number of connections kept open to a host while it is in use, even when they are
+         * idle.
+         */
+        size_t minConnections = kDefaultMinConns;
+
+        /**
+         * The most connections that will be open to a single host at any time. Requests beyond
+         * this wait for a connection to be returned.
+         */
+        size_t maxConnections = kDefaultMaxConns;
+
+        /**
+         * How long a connection may sit idle before it is either closed or refreshed.
+         */
+        Milliseconds refreshRequirement = kDefaultRefreshRequirement;
+
+        /**
+         * How long setting up or refreshing a connection may take before it is abandoned.
+         */
+        Milliseconds refreshTimeout = kDefaultRefreshTimeout;
+
+        /**
+         * How long a host can go without requests or connections in use before all of its
+         * connections are closed.
+         */
+        Milliseconds hostTimeout = kDefaultHostTimeout;
+    };
+
+    /**
+     * Constructs a pool that creates connections and timers through 'impl'. 'name' identifies
+     * the pool in connPoolStats.
+     */
+    ConnectionPool(std::unique_ptr<DependentTypeFactoryInterface> impl,
+                   std::string name,
+                   Options options = Options{});
+
+    /**
+     * All connections must have been returned before the pool is destroyed. Requests still
+     * waiting for a connection are dropped without being called back.
+     */
+    ~ConnectionPool();
+
+    /**
+     * Asks for a connection to 'hostAndPort'. 'cb' is called exactly once, possibly before get()
+     * returns, with either a connection or the reason none could be had within 'timeout'.
+     */
+    void get(const HostAndPort& hostAndPort, Milliseconds timeout, GetConnectionCallback cb);
+
+    /**
+     * Closes the idle connections to 'hostAndPort', and makes sure that connections to it which
+     * are currently being set up or are in use are closed rather than reused.
+     */
+    void dropConnections(const HostAndPort& hostAndPort);
+
+    /**
+     * Appends per-host and total connection counts for this pool to 'b'.
+     */
+    void appendConnectionStats(BSONObjBuilder* b) const;
+
+    /**
+     * Appends the stats of every live ConnectionPool, each as a subobject named after its pool.
+     * Used by connPoolStats.
+     */
+    static void appendAllConnectionStats(BSONObjBuilder* b);
+
+private:
+    void returnConnection(ConnectionInterface* connection);
+
+    const std::string _name;
+
+    const Options _options;
+
+    const std::unique_ptr<DependentTypeFactoryInterface> _factory;
+
+    // The global mutex for the pool and all of its per-host pools
+    mutable stdx::mutex _mutex;
+
+    std::unordered_map<HostAndPort, std::unique_ptr<SpecificPool>> _pools;
+};
+
+/**
+ * A single connection handed out by the pool. Implementations are supplied by a
+ * DependentTypeFactoryInterface.
+ *
+ * Users of a ConnectionHandle call indicateUsed() after each successful round trip and
+ * indicateFailed() when the connection can no longer be trusted (for example after a network
+ * error, or when an operation was abandoned mid-flight), in which case it is closed when it is
+ * returned instead of being reused.
+ */
+class ConnectionPool::ConnectionInterface {
+    MONGO_DISALLOW_COPYING(ConnectionInterface);
+
+public:
+    using SetupCallback = stdx::function<void(ConnectionInterface*, Status)>;
+    using RefreshCallback = stdx::function<void(ConnectionInterface*, Status)>;
+    using TimeoutCallback = stdx::function<void()>;
+
+    ConnectionInterface() = default;
+    virtual ~ConnectionInterface() = default;
+
+    /**
+     * Records that the connection has just been used successfully.
+     */
+    virtual void indicateUsed() = 0;
+
+    /**
+     * Records that the connection is no longer usable.
+     */
+    virtual void indicateFailed(Status status) = 0;
+
+    virtual const HostAndPort& getHostAndPort() const = 0;
+
+    /**
+     * The last time the connection was known to be good: when its setup or last refresh
+     * finished, or when indicateUsed() was last called.
+     */
+    virtual Date_t getLastUsed() const = 0;
+
+    /**
+     * OK, or the status given to indicateFailed() or returned by a failed setup or refresh.
+     */
+    virtual const Status& getStatus() const = 0;
+
+    /**
+     * Calls 'cb' after 'timeout' unless cancelTimeout() is called first. Only the pool sets
+     * timeouts, and only on idle connections.
+     */
+    virtual void setTimeout(Milliseconds timeout, TimeoutCallback cb) = 0;
+
+    virtual void cancelTimeout() = 0;
+
+    /**
+     * Used by the pool to establish a new connection (connect, handshake and authenticate).
+     * 'cb' must be called once the connection is ready or has failed, but not from within
+     * setup() itself unless the implementation can tolerate re-entry.
+     */
+    virtual void setup(Milliseconds timeout, SetupCallback cb) = 0;
+
+    /**
+     * Used by the pool to check that an idle connection is still good.
+     */
+    virtual void refresh(Milliseconds timeout, RefreshCallback cb) = 0;
+
+    /**
+     * The pool generation the connection was made for. Connections from an older generation
+     * (from before dropConnections()) are closed instead of reused.
+     */
+    virtual size_t getGeneration() const = 0;
+};
+
+/**
+ * A timer used by the pool for request timeouts and host idleness.
+ */
+class ConnectionPool::TimerInterface {
+    MONGO_DISALLOW_COPYING(TimerInterface);
+
+public:
+    using TimeoutCallback = stdx::function<void()>;
+
+    TimerInterface() = default;
+    virtual ~TimerInterface() = default;
+
+    /**
+     * Calls 'cb' after 'timeout', replacing any timeout that is already set.
+     */
+    virtual void setTimeout(Milliseconds timeout, TimeoutCallback cb) = 0;
+
+    /**
+     * Makes sure that a pending timeout never fires.
+     */
+    virtual void cancelTimeout() = 0;
+};
+
+/**
+ * Makes the connections and timers used by a ConnectionPool, and tells it the time.
+ */
+class ConnectionPool::DependentTypeFactoryInterface {
+    MONGO_DISALLOW_COPYING(DependentTypeFactoryInterface);
+
+public:
+    DependentTypeFactoryInterface() = default;
+    virtual ~DependentTypeFactoryInterface() = default;
+
+    /**
+     * Makes a new, not yet set up, connection to 'hostAndPort'.
+     */
+    virtual std::unique_ptr<ConnectionInterface> makeConnection(const HostAndPort& hostAndPort,
+                                                                size_t generation) = 0;
+
+    virtual std::unique_ptr<TimerInterface> makeTimer() = 0;
+
+    virtual Date_t now() = 0;
+};
+
+}  // namespace executor
+}  // namespace mongo
@@ -0,0 +1,215 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/connection_pool_asio.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/rpc/protocol.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace executor {
+namespace connection_pool_asio {
+
+ASIOTimer::ASIOTimer(asio::io_service* io_service)
+    : _timer(*io_service), _id(std::make_shared<uint64_t>(0)) {}
+
+ASIOTimer::~ASIOTimer() {
+    cancelTimeout();
+}
+
+void ASIOTimer::setTimeout(Milliseconds timeout, TimeoutCallback cb) {
+    const auto id = ++*_id;
+    std::weak_ptr<uint64_t> currentId = _id;
+
+    std::error_code ec;
+    _timer.cancel(ec);
+    _timer.expires_after(timeout);
+    _timer.async_wait([currentId, id, cb](const std::error_code& ec) {
+        auto liveId = currentId.lock();
+        if (ec || !liveId || *liveId != id) {
+            return;
+        }
+
+        cb();
+    });
+}
+
+void ASIOTimer::cancelTimeout() {
+    ++*_id;
+
+    std::error_code ec;
+    _timer.cancel(ec);
+}
+
+ASIOConnection::ASIOConnection(const HostAndPort& hostAndPort, size_t generation, ASIOImpl* global)
+    : _hostAndPort(hostAndPort),
+      _generation(generation),
+      _global(global),
+      _timer(&global->_impl->_io_service),
+      _impl(asio::ip::tcp::socket(global->_impl->_io_service), rpc::supports::kOpQueryOnly) {}
+
+ASIOConnection::~ASIOConnection() = default;
+
+void ASIOConnection::indicateUsed() {
+    _lastUsed = _global->now();
+}
+
+void ASIOConnection::indicateFailed(Status status) {
+    _status = std::move(status);
+}
+
+const HostAndPort& ASIOConnection::getHostAndPort() const {
+    return _hostAndPort;
+}
+
+Date_t ASIOConnection::getLastUsed() const {
+    return _lastUsed;
+}
+
+const Status& ASIOConnection::getStatus() const {
+    return _status;
+}
+
+void ASIOConnection::setTimeout(Milliseconds timeout, TimeoutCallback cb) {
+    _timer.setTimeout(timeout, std::move(cb));
+}
+
+void ASIOConnection::cancelTimeout() {
+    _timer.cancelTimeout();
+}
+
+void ASIOConnection::setup(Milliseconds timeout, SetupCallback cb) {
+    _handshake(timeout, std::move(cb), true);
+}
+
+void ASIOConnection::refresh(Milliseconds timeout, RefreshCallback cb) {
+    _handshake(timeout, std::move(cb), false);
+}
+
+size_t ASIOConnection::getGeneration() const {
+    return _generation;
+}
+
+NetworkInterfaceASIO::AsyncConnection* ASIOConnection::connection() {
+    return &_impl;
+}
+
+void ASIOConnection::_handshake(Milliseconds timeout, SetupCallback cb, bool connect) {
+    auto net = _global->_impl;
+
+    // The pool is about to be destroyed along with this connection.
+    if (net->inShutdown()) {
+        return;
+    }
+
+    // The isMaster reply also tells us which wire protocols the server speaks.
+    RemoteCommandRequest request(_hostAndPort, "admin", BSON("isMaster" << 1), timeout);
+
+    auto ownedOp = stdx::make_unique<NetworkInterfaceASIO::AsyncOp>(
+        TaskExecutor::CallbackHandle(),
+        request,
+        [this, cb](const TaskExecutor::ResponseStatus& response) {
+            _timer.cancelTimeout();
+            _op = nullptr;
+
+            Status status = response.getStatus();
+            if (status.isOK()) {
+                auto swProtocols = rpc::parseProtocolSetFromIsMasterReply(response.getValue().data);
+                status = swProtocols.getStatus();
+                if (status.isOK()) {
+                    _impl.setServerProtocols(swProtocols.getValue());
+                }
+            } else if (_timedOut) {
+                status = Status(ErrorCodes::ExceededTimeLimit,
+                                str::stream() << "Timed out connecting to " << _hostAndPort.toString());
+            }
+
+            _status = status;
+            _lastUsed = _global->now();
+
+            // NOTE: the pool may destroy this connection from within the callback.
+            cb(this, std::move(status));
+        },
+        net->now(),
+        net->_numOps.fetchAndAdd(1));
+
+    auto op = ownedOp.get();
+    op->setConnection(&_impl);
+    _op = op;
+
+    _timedOut = false;
+    _timer.setTimeout(timeout, [this]() {
+        if (!_op) {
+            return;
+        }
+
+        _timedOut = true;
+        _op->cancel();
+
+        // Wakes up whatever the operation is waiting on, so that it sees the cancellation.
+        std::error_code ec;
+        _impl.sock().cancel(ec);
+    });
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(net->_inProgressMutex);
+        net->_inProgress.emplace(op, std::move(ownedOp));
+    }
+
+    if (connect) {
+        asio::post(net->_io_service, [net, op]() { net->_connect(op); });
+    } else {
+        asio::post(net->_io_service, [net, op]() { net->_beginCommunication(op); });
+    }
+}
+
+ASIOImpl::ASIOImpl(NetworkInterfaceASIO* impl) : _impl(impl) {}
+
+std::unique_ptr<ConnectionPool::ConnectionInterface> ASIOImpl::makeConnection(
+    const HostAndPort& hostAndPort, size_t generation) {
+    return stdx::make_unique<ASIOConnection>(hostAndPort, generation, this);
+}
+
+std::unique_ptr<ConnectionPool::TimerInterface> ASIOImpl::makeTimer() {
+    return stdx::make_unique<ASIOTimer>(&_impl->_io_service);
+}
+
+Date_t ASIOImpl::now() {
+    return _impl->now();
+}
+
+}  // namespace connection_pool_asio
+}  // namespace executor
+}  // namespace mongo
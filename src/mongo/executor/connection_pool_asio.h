@@ -0,0 +1,135 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <asio.hpp>
+#include <memory>
+
+#include "mongo/executor/connection_pool.h"
+#include "mongo/executor/network_interface_asio.h"
+
+namespace mongo {
+namespace executor {
+namespace connection_pool_asio {
+
+/**
+ * Implements connection pool timers on top of asio.
+ */
+class ASIOTimer final : public ConnectionPool::TimerInterface {
+public:
+    explicit ASIOTimer(asio::io_service* service);
+    ~ASIOTimer() override;
+
+    void setTimeout(Milliseconds timeout, TimeoutCallback cb) override;
+    void cancelTimeout() override;
+
+private:
+    asio::steady_timer _timer;
+
+    // Bumped whenever the timeout is set or cancelled. A handler only runs its callback if the
+    // id it was armed with is still current, which covers handlers that were already queued
+    // when the timer was cancelled, reset or destroyed.
+    std::shared_ptr<uint64_t> _id;
+};
+
+class ASIOImpl;
+
+/**
+ * Implements connection pool connections on top of NetworkInterfaceASIO's AsyncConnection.
+ *
+ * setup() connects asynchronously and runs an isMaster to learn the wire protocols the server
+ * speaks, and refresh() runs another isMaster as a health check, both through the network
+ * interface's own operation state machine.
+ */
+class ASIOConnection final : public ConnectionPool::ConnectionInterface {
+public:
+    ASIOConnection(const HostAndPort& hostAndPort, size_t generation, ASIOImpl* global);
+    ~ASIOConnection() override;
+
+    void indicateUsed() override;
+    void indicateFailed(Status status) override;
+    const HostAndPort& getHostAndPort() const override;
+
+    Date_t getLastUsed() const override;
+    const Status& getStatus() const override;
+
+    void setTimeout(Milliseconds timeout, TimeoutCallback cb) override;
+    void cancelTimeout() override;
+
+    void setup(Milliseconds timeout, SetupCallback cb) override;
+    void refresh(Milliseconds timeout, RefreshCallback cb) override;
+
+    size_t getGeneration() const override;
+
+    NetworkInterfaceASIO::AsyncConnection* connection();
+
+private:
+    void _handshake(Milliseconds timeout, SetupCallback cb, bool connect);
+
+    const HostAndPort _hostAndPort;
+    const size_t _generation;
+    ASIOImpl* const _global;
+
+    Date_t _lastUsed;
+    Status _status = Status::OK();
+
+    // Used by the pool while the connection is idle, and for the setup and refresh timeouts
+    // while it is being processed. The two never overlap.
+    ASIOTimer _timer;
+
+    NetworkInterfaceASIO::AsyncConnection _impl;
+
+    // The setup or refresh operation in flight, if any
+    NetworkInterfaceASIO::AsyncOp* _op = nullptr;
+    bool _timedOut = false;
+};
+
+/**
+ * Makes ASIOConnections and ASIOTimers for NetworkInterfaceASIO's connection pool.
+ */
+class ASIOImpl final : public ConnectionPool::DependentTypeFactoryInterface {
+    friend class ASIOConnection;
+
+public:
+    explicit ASIOImpl(NetworkInterfaceASIO* impl);
+
+    std::unique_ptr<ConnectionPool::ConnectionInterface> makeConnection(
+        const HostAndPort& hostAndPort, size_t generation) override;
+
+    std::unique_ptr<ConnectionPool::TimerInterface> makeTimer() override;
+
+    Date_t now() override;
+
+private:
+    NetworkInterfaceASIO* const _impl;
+};
+
+}  // namespace connection_pool_asio
+}  // namespace executor
+}  // namespace mongo
@@ -0,0 +1,483 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/connection_pool_test_fixture.h"
+
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/executor/connection_pool.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace executor {
+namespace connection_pool_test_details {
+
+class ConnectionPoolTest : public unittest::Test {
+protected:
+    void setUp() override {
+        _now = Date_t::fromMillisSinceEpoch(1000 * 1000);
+        PoolImpl::setNow(_now);
+    }
+
+    void tearDown() override {
+        TimerImpl::clear();
+        ConnectionImpl::clear();
+    }
+
+    void advance(Milliseconds ms) {
+        _now += ms;
+        PoolImpl::setNow(_now);
+    }
+
+private:
+    Date_t _now;
+};
+
+using ConnectionHandle = ConnectionPool::ConnectionHandle;
+using StatusWithConn = StatusWith<ConnectionHandle>;
+
+const HostAndPort kHost("localhost", 30000);
+
+size_t connId(const ConnectionHandle& conn) {
+    return static_cast<ConnectionImpl*>(conn.get())->id();
+}
+
+/**
+ * Returns the stats for 'host', or an empty object if the pool has none.
+ */
+BSONObj hostStats(const ConnectionPool& pool, const HostAndPort& host) {
+    BSONObjBuilder b;
+    pool.appendConnectionStats(&b);
+    BSONObj all = b.obj();
+    BSONElement stats = all["hosts"].Obj()[host.toString()];
+    return stats.eoo() ? BSONObj() : stats.Obj().getOwned();
+}
+
+/**
+ * Verify that we get the same connection if we grab one, return it and grab another.
+ */
+TEST_F(ConnectionPoolTest, SameConn) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test");
+
+    size_t conn1Id = 0;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn1Id = connId(swConn.getValue());
+        swConn.getValue()->indicateUsed();
+    });
+
+    size_t conn2Id = 0;
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn2Id = connId(swConn.getValue());
+        swConn.getValue()->indicateUsed();
+    });
+
+    ASSERT_NOT_EQUALS(0U, conn1Id);
+    ASSERT_EQUALS(conn1Id, conn2Id);
+}
+
+/**
+ * Verify that connections to different hosts are not shared.
+ */
+TEST_F(ConnectionPoolTest, DifferentHostDifferentConn) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test");
+
+    size_t conn1Id = 0;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(HostAndPort("localhost", 30000), Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn1Id = connId(swConn.getValue());
+    });
+
+    size_t conn2Id = 0;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(HostAndPort("localhost", 30001), Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn2Id = connId(swConn.getValue());
+    });
+
+    ASSERT_NOT_EQUALS(0U, conn1Id);
+    ASSERT_NOT_EQUALS(0U, conn2Id);
+    ASSERT_NOT_EQUALS(conn1Id, conn2Id);
+}
+
+/**
+ * Verify that a connection which is still checked out is not handed out again.
+ */
+TEST_F(ConnectionPoolTest, DifferentConnWithoutReturn) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test");
+    ConnectionHandle conn1;
+    ConnectionHandle conn2;
+
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn1 = std::move(swConn.getValue());
+    });
+
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn2 = std::move(swConn.getValue());
+    });
+
+    ASSERT(conn1);
+    ASSERT(conn2);
+    ASSERT_NOT_EQUALS(connId(conn1), connId(conn2));
+    ASSERT_EQUALS(2, hostStats(pool, kHost)["inUse"].numberLong());
+}
+
+/**
+ * Verify that a connection returned after indicateFailed() is closed rather than reused.
+ */
+TEST_F(ConnectionPoolTest, FailedConnDifferentConn) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test");
+
+    size_t conn1Id = 0;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn1Id = connId(swConn.getValue());
+        swConn.getValue()->indicateFailed(Status(ErrorCodes::HostUnreachable, "error"));
+    });
+
+    size_t conn2Id = 0;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn2Id = connId(swConn.getValue());
+    });
+
+    ASSERT_NOT_EQUALS(0U, conn1Id);
+    ASSERT_NOT_EQUALS(0U, conn2Id);
+    ASSERT_NOT_EQUALS(conn1Id, conn2Id);
+}
+
+/**
+ * Verify that a request times out if no connection becomes available in time.
+ */
+TEST_F(ConnectionPoolTest, TimeoutOnSetup) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test");
+
+    bool notOk = false;
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_EQUALS(ErrorCodes::ExceededTimeLimit, swConn.getStatus());
+        notOk = true;
+    });
+
+    advance(Milliseconds(4999));
+    ASSERT(!notOk);
+
+    advance(Milliseconds(1));
+    ASSERT(notOk);
+    ASSERT_EQUALS(0, hostStats(pool, kHost)["pendingRequests"].numberLong());
+}
+
+/**
+ * Verify that a failed setup fails every request waiting on the host.
+ */
+TEST_F(ConnectionPoolTest, FailedSetupFailsWaitingRequests) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test");
+
+    size_t failed = 0;
+    for (int i = 0; i < 3; i++) {
+        pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+            ASSERT_EQUALS(ErrorCodes::HostUnreachable, swConn.getStatus());
+            failed++;
+        });
+    }
+    ASSERT_EQUALS(3U, ConnectionImpl::setupQueueDepth());
+
+    ConnectionImpl::pushSetup(Status(ErrorCodes::HostUnreachable, "unreachable"));
+    ASSERT_EQUALS(3U, failed);
+
+    // The remaining connections still join the pool if their setup succeeds.
+    ConnectionImpl::pushSetup(Status::OK());
+    ConnectionImpl::pushSetup(Status::OK());
+    ASSERT_EQUALS(2, hostStats(pool, kHost)["available"].numberLong());
+}
+
+/**
+ * Verify that no more than maxConnections are opened, and that waiting requests get returned
+ * connections in order of their deadlines.
+ */
+TEST_F(ConnectionPoolTest, MaxConnectionsQueuesRequests) {
+    ConnectionPool::Options options;
+    options.maxConnections = 1;
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test", options);
+
+    ConnectionHandle conn1;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn1 = std::move(swConn.getValue());
+    });
+    ASSERT(conn1);
+    const auto conn1Id = connId(conn1);
+
+    std::vector<int> order;
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        ASSERT_EQUALS(conn1Id, connId(swConn.getValue()));
+        order.push_back(2);
+    });
+    pool.get(kHost, Milliseconds(1000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        ASSERT_EQUALS(conn1Id, connId(swConn.getValue()));
+        order.push_back(1);
+    });
+
+    ASSERT_EQUALS(0U, ConnectionImpl::setupQueueDepth());
+    ASSERT_EQUALS(2, hostStats(pool, kHost)["pendingRequests"].numberLong());
+    ASSERT(order.empty());
+
+    conn1.reset();
+
+    ASSERT_EQUALS(2U, order.size());
+    ASSERT_EQUALS(1, order[0]);
+    ASSERT_EQUALS(2, order[1]);
+}
+
+/**
+ * Verify that the pool opens minConnections as soon as a host is used.
+ */
+TEST_F(ConnectionPoolTest, MinConnections) {
+    ConnectionPool::Options options;
+    options.minConnections = 3;
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test", options);
+
+    ConnectionHandle conn;
+    for (int i = 0; i < 3; i++) {
+        ConnectionImpl::pushSetup(Status::OK());
+    }
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn = std::move(swConn.getValue());
+    });
+    ASSERT(conn);
+
+    auto stats = hostStats(pool, kHost);
+    ASSERT_EQUALS(3, stats["created"].numberLong());
+    ASSERT_EQUALS(2, stats["available"].numberLong());
+    ASSERT_EQUALS(1, stats["inUse"].numberLong());
+}
+
+/**
+ * Verify that an idle connection is refreshed, and closed if the refresh fails.
+ */
+TEST_F(ConnectionPoolTest, RefreshIdleConnection) {
+    ConnectionPool::Options options;
+    options.refreshRequirement = Milliseconds(1000);
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test", options);
+
+    size_t conn1Id = 0;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn1Id = connId(swConn.getValue());
+        swConn.getValue()->indicateUsed();
+    });
+
+    advance(Milliseconds(999));
+    ASSERT_EQUALS(0U, ConnectionImpl::refreshQueueDepth());
+    advance(Milliseconds(1));
+    ASSERT_EQUALS(1U, ConnectionImpl::refreshQueueDepth());
+    ASSERT_EQUALS(1, hostStats(pool, kHost)["refreshing"].numberLong());
+
+    ConnectionImpl::pushRefresh(Status::OK());
+
+    size_t conn2Id = 0;
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn2Id = connId(swConn.getValue());
+    });
+    ASSERT_EQUALS(conn1Id, conn2Id);
+
+    advance(Milliseconds(1000));
+    ASSERT_EQUALS(1U, ConnectionImpl::refreshQueueDepth());
+    ConnectionImpl::pushRefresh(Status(ErrorCodes::HostUnreachable, "unreachable"));
+    ASSERT_EQUALS(0, hostStats(pool, kHost)["available"].numberLong());
+
+    size_t conn3Id = 0;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn3Id = connId(swConn.getValue());
+    });
+    ASSERT_NOT_EQUALS(0U, conn3Id);
+    ASSERT_NOT_EQUALS(conn1Id, conn3Id);
+}
+
+/**
+ * Verify that idle connections beyond minConnections are closed instead of refreshed.
+ */
+TEST_F(ConnectionPoolTest, IdleConnectionsAboveMinimumAreClosed) {
+    ConnectionPool::Options options;
+    options.refreshRequirement = Milliseconds(1000);
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test", options);
+
+    {
+        ConnectionHandle conn1;
+        ConnectionHandle conn2;
+        for (auto conn : {&conn1, &conn2}) {
+            ConnectionImpl::pushSetup(Status::OK());
+            pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+                ASSERT_OK(swConn.getStatus());
+                *conn = std::move(swConn.getValue());
+            });
+        }
+    }
+    ASSERT_EQUALS(2, hostStats(pool, kHost)["available"].numberLong());
+
+    advance(Milliseconds(1000));
+
+    auto stats = hostStats(pool, kHost);
+    ASSERT_EQUALS(0, stats["available"].numberLong());
+    ASSERT_EQUALS(1, stats["refreshing"].numberLong());
+    ASSERT_EQUALS(1U, ConnectionImpl::refreshQueueDepth());
+}
+
+/**
+ * Verify that a connection which was checked out for longer than refreshRequirement is
+ * refreshed before it is handed out again.
+ */
+TEST_F(ConnectionPoolTest, RefreshOnReturnAfterRefreshRequirement) {
+    ConnectionPool::Options options;
+    options.refreshRequirement = Milliseconds(1000);
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test", options);
+
+    ConnectionHandle conn;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn = std::move(swConn.getValue());
+    });
+
+    advance(Milliseconds(2000));
+    conn.reset();
+    ASSERT_EQUALS(1U, ConnectionImpl::refreshQueueDepth());
+
+    bool gotConn = false;
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        gotConn = true;
+    });
+    ASSERT(!gotConn);
+
+    ConnectionImpl::pushRefresh(Status::OK());
+    ASSERT(gotConn);
+}
+
+/**
+ * Verify that all connections to a host are closed once it has been idle for hostTimeout.
+ */
+TEST_F(ConnectionPoolTest, HostTimeoutClosesConnections) {
+    ConnectionPool::Options options;
+    options.hostTimeout = Milliseconds(5000);
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test", options);
+
+    size_t conn1Id = 0;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn1Id = connId(swConn.getValue());
+        swConn.getValue()->indicateUsed();
+    });
+
+    advance(Milliseconds(4999));
+    ASSERT_EQUALS(1, hostStats(pool, kHost)["available"].numberLong());
+
+    advance(Milliseconds(1));
+    ASSERT(hostStats(pool, kHost).isEmpty());
+
+    size_t conn2Id = 0;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn2Id = connId(swConn.getValue());
+    });
+    ASSERT_NOT_EQUALS(conn1Id, conn2Id);
+}
+
+/**
+ * Verify that dropConnections() closes connections that are in use once they are returned.
+ */
+TEST_F(ConnectionPoolTest, DropConnections) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test");
+
+    ConnectionHandle conn;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn = std::move(swConn.getValue());
+    });
+    const auto conn1Id = connId(conn);
+
+    pool.dropConnections(kHost);
+    conn.reset();
+    ASSERT_EQUALS(0, hostStats(pool, kHost)["available"].numberLong());
+
+    size_t conn2Id = 0;
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+        conn2Id = connId(swConn.getValue());
+    });
+    ASSERT_NOT_EQUALS(0U, conn2Id);
+    ASSERT_NOT_EQUALS(conn1Id, conn2Id);
+}
+
+/**
+ * Verify that appendAllConnectionStats reports every live pool by name.
+ */
+TEST_F(ConnectionPoolTest, AllConnectionStats) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "connectionPoolTestStats");
+
+    ConnectionImpl::pushSetup(Status::OK());
+    pool.get(kHost, Milliseconds(5000), [&](StatusWithConn swConn) {
+        ASSERT_OK(swConn.getStatus());
+    });
+
+    BSONObjBuilder b;
+    ConnectionPool::appendAllConnectionStats(&b);
+    BSONObj all = b.obj();
+    BSONObj stats = all["connectionPoolTestStats"].Obj();
+    ASSERT_EQUALS(1, stats["totalAvailable"].numberLong());
+    ASSERT_EQUALS(0, stats["totalInUse"].numberLong());
+    ASSERT_EQUALS(1, stats["totalCreated"].numberLong());
+}
+
+}  // namespace connection_pool_test_details
+}  // namespace executor
+}  // namespace mongo
@@ -0,0 +1,248 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/connection_pool_test_fixture.h"
+
+#include <vector>
+
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace executor {
+namespace connection_pool_test_details {
+
+std::set<TimerImpl*> TimerImpl::_timers;
+
+TimerImpl::TimerImpl(PoolImpl* global) : _global(global) {}
+
+TimerImpl::~TimerImpl() {
+    cancelTimeout();
+}
+
+void TimerImpl::setTimeout(Milliseconds timeout, TimeoutCallback cb) {
+    _cb = std::move(cb);
+    _expiration = _global->now() + timeout;
+
+    _timers.emplace(this);
+}
+
+void TimerImpl::cancelTimeout() {
+    TimeoutCallback cb;
+    _cb.swap(cb);
+
+    _timers.erase(this);
+}
+
+void TimerImpl::clear() {
+    while (!_timers.empty()) {
+        auto* timer = *_timers.begin();
+        timer->cancelTimeout();
+    }
+}
+
+void TimerImpl::fireIfNecessary() {
+    // Callbacks may set, cancel or destroy timers, so work from a copy and skip any timer which
+    // has gone away in the meantime.
+    const std::vector<TimerImpl*> timers(_timers.begin(), _timers.end());
+
+    for (auto timer : timers) {
+        if (!_timers.count(timer) || timer->_expiration > timer->_global->now()) {
+            continue;
+        }
+
+        TimeoutCallback cb;
+        timer->_cb.swap(cb);
+        _timers.erase(timer);
+        cb();
+    }
+}
+
+std::deque<ConnectionImpl*> ConnectionImpl::_setupQueue;
+std::deque<ConnectionImpl*> ConnectionImpl::_refreshQueue;
+std::deque<Status> ConnectionImpl::_pushSetupQueue;
+std::deque<Status> ConnectionImpl::_pushRefreshQueue;
+size_t ConnectionImpl::_idCounter = 1;
+
+ConnectionImpl::ConnectionImpl(const HostAndPort& hostAndPort, size_t generation, PoolImpl* global)
+    : _hostAndPort(hostAndPort),
+      _generation(generation),
+      _id(_idCounter++),
+      _global(global),
+      _timer(global) {}
+
+ConnectionImpl::~ConnectionImpl() {
+    for (auto queue : {&_setupQueue, &_refreshQueue}) {
+        for (auto iter = queue->begin(); iter != queue->end();) {
+            if (*iter == this) {
+                iter = queue->erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+}
+
+size_t ConnectionImpl::id() const {
+    return _id;
+}
+
+void ConnectionImpl::indicateUsed() {
+    _lastUsed = _global->now();
+}
+
+void ConnectionImpl::indicateFailed(Status status) {
+    _status = std::move(status);
+}
+
+const HostAndPort& ConnectionImpl::getHostAndPort() const {
+    return _hostAndPort;
+}
+
+Date_t ConnectionImpl::getLastUsed() const {
+    return _lastUsed;
+}
+
+const Status& ConnectionImpl::getStatus() const {
+    return _status;
+}
+
+void ConnectionImpl::setTimeout(Milliseconds timeout, TimeoutCallback cb) {
+    _timer.setTimeout(timeout, std::move(cb));
+}
+
+void ConnectionImpl::cancelTimeout() {
+    _timer.cancelTimeout();
+}
+
+void ConnectionImpl::setup(Milliseconds timeout, SetupCallback cb) {
+    _setupCallback = std::move(cb);
+    _setupQueue.push_back(this);
+
+    if (!_pushSetupQueue.empty()) {
+        processSetup();
+    }
+}
+
+void ConnectionImpl::refresh(Milliseconds timeout, RefreshCallback cb) {
+    _refreshCallback = std::move(cb);
+    _refreshQueue.push_back(this);
+
+    if (!_pushRefreshQueue.empty()) {
+        processRefresh();
+    }
+}
+
+size_t ConnectionImpl::getGeneration() const {
+    return _generation;
+}
+
+void ConnectionImpl::pushSetup(Status status) {
+    _pushSetupQueue.push_back(std::move(status));
+
+    if (!_setupQueue.empty()) {
+        processSetup();
+    }
+}
+
+void ConnectionImpl::pushRefresh(Status status) {
+    _pushRefreshQueue.push_back(std::move(status));
+
+    if (!_refreshQueue.empty()) {
+        processRefresh();
+    }
+}
+
+size_t ConnectionImpl::setupQueueDepth() {
+    return _setupQueue.size();
+}
+
+size_t ConnectionImpl::refreshQueueDepth() {
+    return _refreshQueue.size();
+}
+
+void ConnectionImpl::clear() {
+    _setupQueue.clear();
+    _refreshQueue.clear();
+    _pushSetupQueue.clear();
+    _pushRefreshQueue.clear();
+}
+
+void ConnectionImpl::processSetup() {
+    auto connPtr = _setupQueue.front();
+    auto status = std::move(_pushSetupQueue.front());
+    _setupQueue.pop_front();
+    _pushSetupQueue.pop_front();
+
+    connPtr->_status = status;
+    connPtr->_lastUsed = connPtr->_global->now();
+
+    SetupCallback cb;
+    connPtr->_setupCallback.swap(cb);
+    cb(connPtr, std::move(status));
+}
+
+void ConnectionImpl::processRefresh() {
+    auto connPtr = _refreshQueue.front();
+    auto status = std::move(_pushRefreshQueue.front());
+    _refreshQueue.pop_front();
+    _pushRefreshQueue.pop_front();
+
+    connPtr->_status = status;
+    connPtr->_lastUsed = connPtr->_global->now();
+
+    RefreshCallback cb;
+    connPtr->_refreshCallback.swap(cb);
+    cb(connPtr, std::move(status));
+}
+
+Date_t PoolImpl::_now;
+
+std::unique_ptr<ConnectionPool::ConnectionInterface> PoolImpl::makeConnection(
+    const HostAndPort& hostAndPort, size_t generation) {
+    return stdx::make_unique<ConnectionImpl>(hostAndPort, generation, this);
+}
+
+std::unique_ptr<ConnectionPool::TimerInterface> PoolImpl::makeTimer() {
+    return stdx::make_unique<TimerImpl>(this);
+}
+
+Date_t PoolImpl::now() {
+    return _now;
+}
+
+void PoolImpl::setNow(Date_t now) {
+    _now = now;
+    TimerImpl::fireIfNecessary();
+}
+
+}  // namespace connection_pool_test_details
+}  // namespace executor
+}  // namespace mongo
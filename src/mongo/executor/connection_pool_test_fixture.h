@@ -0,0 +1,161 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <set>
+
+#include "mongo/executor/connection_pool.h"
+
+namespace mongo {
+namespace executor {
+namespace connection_pool_test_details {
+
+class PoolImpl;
+
+/**
+ * Mock interface for the timer. Timers fire when the mock clock is moved forward with
+ * PoolImpl::setNow().
+ */
+class TimerImpl final : public ConnectionPool::TimerInterface {
+public:
+    explicit TimerImpl(PoolImpl* global);
+    ~TimerImpl() override;
+
+    void setTimeout(Milliseconds timeout, TimeoutCallback cb) override;
+
+    void cancelTimeout() override;
+
+    // Fires every timer whose expiration is at or before now
+    static void fireIfNecessary();
+
+    // Drops all timers
+    static void clear();
+
+private:
+    static std::set<TimerImpl*> _timers;
+
+    TimeoutCallback _cb;
+    PoolImpl* _global;
+    Date_t _expiration;
+};
+
+/**
+ * Mock interface for the connections. The results of setup() and refresh() are queued with
+ * pushSetup() and pushRefresh(), either before or after the pool asks for them, and handed out
+ * in order.
+ */
+class ConnectionImpl final : public ConnectionPool::ConnectionInterface {
+public:
+    ConnectionImpl(const HostAndPort& hostAndPort, size_t generation, PoolImpl* global);
+    ~ConnectionImpl() override;
+
+    size_t id() const;
+
+    void indicateUsed() override;
+
+    void indicateFailed(Status status) override;
+
+    const HostAndPort& getHostAndPort() const override;
+
+    Date_t getLastUsed() const override;
+
+    const Status& getStatus() const override;
+
+    void setTimeout(Milliseconds timeout, TimeoutCallback cb) override;
+
+    void cancelTimeout() override;
+
+    void setup(Milliseconds timeout, SetupCallback cb) override;
+
+    void refresh(Milliseconds timeout, RefreshCallback cb) override;
+
+    size_t getGeneration() const override;
+
+    // Gives the next connection being set up, now or in the future, this status
+    static void pushSetup(Status status);
+
+    // Gives the next connection being refreshed, now or in the future, this status
+    static void pushRefresh(Status status);
+
+    // The number of connections waiting for a setup or refresh result
+    static size_t setupQueueDepth();
+    static size_t refreshQueueDepth();
+
+    // Drops all pending setups and refreshes
+    static void clear();
+
+private:
+    static void processSetup();
+    static void processRefresh();
+
+    static std::deque<ConnectionImpl*> _setupQueue;
+    static std::deque<ConnectionImpl*> _refreshQueue;
+    static std::deque<Status> _pushSetupQueue;
+    static std::deque<Status> _pushRefreshQueue;
+    static size_t _idCounter;
+
+    const HostAndPort _hostAndPort;
+    const size_t _generation;
+    const size_t _id;
+    PoolImpl* const _global;
+
+    Date_t _lastUsed;
+    Status _status = Status::OK();
+    TimerImpl _timer;
+
+    SetupCallback _setupCallback;
+    RefreshCallback _refreshCallback;
+};
+
+/**
+ * Mock for the pool implementation, with a manually advanced clock.
+ */
+class PoolImpl final : public ConnectionPool::DependentTypeFactoryInterface {
+public:
+    PoolImpl() = default;
+
+    std::unique_ptr<ConnectionPool::ConnectionInterface> makeConnection(
+        const HostAndPort& hostAndPort, size_t generation) override;
+
+    std::unique_ptr<ConnectionPool::TimerInterface> makeTimer() override;
+
+    Date_t now() override;
+
+    // Moves the clock to 'now' and fires any timers that are due
+    static void setNow(Date_t now);
+
+private:
+    static Date_t _now;
+};
+
+}  // namespace connection_pool_test_details
+}  // namespace executor
+}  // namespace mongo
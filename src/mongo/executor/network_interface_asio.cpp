@@ -34,6 +34,7 @@
 
 #include <utility>
 
+#include "mongo/executor/connection_pool_asio.h"
 #include "mongo/stdx/chrono.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
@@ -42,14 +43,41 @@
 namespace mongo {
 namespace executor {
 
-NetworkInterfaceASIO::NetworkInterfaceASIO()
+namespace {
+
+AtomicUInt32 poolCounter;
+
+// Bounds the number of connections being bootstrapped with a DBClientConnection at once.
+const size_t kMaxBootstrapThreads = 8;
+
+// Each interface's connection pool gets its own name in connPoolStats.
+std::string nextPoolName() {
+    return str::stream() << "NetworkInterfaceASIO-" << poolCounter.fetchAndAdd(1);
+}
+
+ThreadPool::Options makeBootstrapPoolOptions(const std::string& poolName) {
+    ThreadPool::Options options;
+    options.poolName = poolName + "-bootstrap";
+    options.minThreads = 0;
+    options.maxThreads = kMaxBootstrapThreads;
+    return options;
+}
+
+}  // namespace
+
+NetworkInterfaceASIO::NetworkInterfaceASIO(ConnectionPool::Options options)
+    : NetworkInterfaceASIO(nextPoolName(), std::move(options)) {}
+
+NetworkInterfaceASIO::NetworkInterfaceASIO(const std::string& poolName,
+                                           ConnectionPool::Options options)
     : _io_service(),
+      _bootstrapPool(makeBootstrapPoolOptions(poolName)),
       _resolver(_io_service),
       _state(State::kReady),
+      _connectionPool(
+          stdx::make_unique<connection_pool_asio::ASIOImpl>(this), poolName, std::move(options)),
       _isExecutorRunnable(false),
-      _numOps(0) {
-    _connPool = stdx::make_unique<ConnectionPool>(kMessagingPortKeepOpen);
-}
+      _numOps(0) {}
 
 std::string NetworkInterfaceASIO::getDiagnosticString() {
     str::stream output;
@@ -64,6 +92,7 @@ std::string NetworkInterfaceASIO::getHostName() {
 }
 
 void NetworkInterfaceASIO::startup() {
+    _bootstrapPool.startup();
     _serviceRunner = stdx::thread([this]() {
         asio::io_service::work work(_io_service);
         _io_service.run();
@@ -73,8 +102,10 @@ void NetworkInterfaceASIO::startup() {
 
 void NetworkInterfaceASIO::shutdown() {
     _state.store(State::kShutdown);
+    _bootstrapPool.shutdown();
     _io_service.stop();
     _serviceRunner.join();
+    _bootstrapPool.join();
 }
 
 void NetworkInterfaceASIO::waitForWork() {
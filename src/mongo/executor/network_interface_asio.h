@@ -36,26 +36,38 @@
 #include <unordered_map>
 
 #include "mongo/base/status.h"
-#include "mongo/client/connection_pool.h"
 #include "mongo/client/remote_command_runner.h"
+#include "mongo/executor/connection_pool.h"
 #include "mongo/executor/network_interface.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/rpc/protocol.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/net/message.h"
 
 namespace mongo {
+
+class DBClientConnection;
+
 namespace executor {
 
+namespace connection_pool_asio {
+class ASIOConnection;
+class ASIOImpl;
+}  // namespace connection_pool_asio
+
 /**
  * Implementation of the replication system's network interface using Christopher
  * Kohlhoff's ASIO library instead of existing MongoDB networking primitives.
  */
 class NetworkInterfaceASIO final : public NetworkInterface {
+    friend class connection_pool_asio::ASIOConnection;
+    friend class connection_pool_asio::ASIOImpl;
+
 public:
-    NetworkInterfaceASIO();
+    explicit NetworkInterfaceASIO(ConnectionPool::Options options = ConnectionPool::Options());
     std::string getDiagnosticString() override;
     std::string getHostName() override;
     void startup() override;
@@ -77,6 +89,8 @@ private:
 
     enum class State { kReady, kRunning, kShutdown };
 
+    NetworkInterfaceASIO(const std::string& poolName, ConnectionPool::Options options);
+
     /**
      * AsyncConnection encapsulates the per-connection state we maintain.
      */
@@ -86,13 +100,15 @@ private:
 
         AsyncConnection(asio::ip::tcp::socket&& sock,
                         rpc::ProtocolSet serverProtocols,
-                        boost::optional<ConnectionPool::ConnectionPtr>&& bootstrapConn);
+                        std::shared_ptr<DBClientConnection> bootstrapConn);
 
         asio::ip::tcp::socket& sock();
 
         rpc::ProtocolSet serverProtocols() const;
         rpc::ProtocolSet clientProtocols() const;
 
+        void setServerProtocols(rpc::ProtocolSet protocols);
+
 // Explicit move construction and assignment to support MSVC
 #if defined(_MSC_VER) && _MSC_VER < 1900
         AsyncConnection(AsyncConnection&&);
@@ -113,7 +129,7 @@ private:
          * implementing async auth, but for now we need to keep it alive so that the socket it
          * creates stays open.
          */
-        boost::optional<ConnectionPool::ConnectionPtr> _bootstrapConn;
+        std::shared_ptr<DBClientConnection> _bootstrapConn;
     };
 
     /**
@@ -136,9 +152,28 @@ private:
 
         AsyncConnection* connection();
 
-        void connect(ConnectionPool* const pool, asio::io_service* service, Date_t now);
-        void setConnection(AsyncConnection&& conn);
-        bool connected() const;
+        /**
+         * Runs the operation on a connection that it does not own. Used for the operations
+         * which set up and refresh the connection pool's connections.
+         */
+        void setConnection(AsyncConnection* conn);
+
+        /**
+         * Runs the operation on a connection checked out of the connection pool, which goes
+         * back to the pool when the operation is destroyed.
+         */
+        void setConnectionHandle(ConnectionPool::ConnectionHandle handle);
+
+        /**
+         * The pooled connection the operation runs on, or nullptr if it has none.
+         */
+        ConnectionPool::ConnectionInterface* pooledConnection() const;
+
+        /**
+         * Marks the point after which the connection may hold a partial request or reply.
+         */
+        void setCommunicating();
+        bool communicating() const;
 
         void finish(const TaskExecutor::ResponseStatus& status);
 
@@ -159,13 +194,7 @@ private:
         void setOperationProtocol(rpc::Protocol proto);
 
     private:
-        enum class OpState {
-            kReady,
-            kConnectionAcquired,
-            kConnectionVerified,
-            kConnected,
-            kCompleted
-        };
+        enum class OpState { kReady, kConnectionAcquired, kCommunicating, kCompleted };
 
         // Information describing an in-flight command.
         TaskExecutor::CallbackHandle _cbHandle;
@@ -173,10 +202,12 @@ private:
         RemoteCommandCompletionFn _onFinish;
 
         /**
-         * The connection state used to service this request. We wrap it in an optional
-         * as it is instantiated at some point after the AsyncOp is created.
+         * The connection used to service this request, which is set at some point after the
+         * AsyncOp is created. It belongs to _connectionHandle if the operation has one.
          */
-        boost::optional<AsyncConnection> _connection;
+        AsyncConnection* _connection = nullptr;
+
+        ConnectionPool::ConnectionHandle _connectionHandle;
 
         /**
          * The RPC protocol used for this operation. We wrap it in an optional as it
@@ -208,6 +239,7 @@ private:
     void _asyncSendSimpleMessage(AsyncOp* op, const asio::const_buffer& buf);
 
     // Connection
+    void _connect(AsyncOp* op);
     void _connectASIO(AsyncOp* op);
     void _connectWithDBClientConnection(AsyncOp* op);
     void _setupSocket(AsyncOp* op, const asio::ip::tcp::resolver::iterator& endpoints);
@@ -230,10 +262,17 @@ private:
     asio::io_service _io_service;
     stdx::thread _serviceRunner;
 
+    // Runs the blocking connect and authentication of new connections when auth is enabled, so
+    // that at most a bounded number of threads are ever tied up doing so.
+    ThreadPool _bootstrapPool;
+
     asio::ip::tcp::resolver _resolver;
 
     std::atomic<State> _state;
 
+    // Declared before _inProgress, so that it outlives the operations holding its connections
+    ConnectionPool _connectionPool;
+
     stdx::mutex _inProgressMutex;
     std::unordered_map<AsyncOp*, std::unique_ptr<AsyncOp>> _inProgress;
 
@@ -241,8 +280,6 @@ private:
     bool _isExecutorRunnable;
     stdx::condition_variable _isExecutorRunnableCondition;
 
-    std::unique_ptr<ConnectionPool> _connPool;
-
     AtomicUInt64 _numOps;
 };
 
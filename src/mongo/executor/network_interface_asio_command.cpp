@@ -37,6 +37,7 @@
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/rpc/factory.h"
+#include "mongo/rpc/reply_interface.h"
 #include "mongo/rpc/request_builder_interface.h"
 #include "mongo/util/log.h"
 #include "mongo/util/assert_util.h"
@@ -56,8 +57,26 @@ void NetworkInterfaceASIO::_asyncRunCommand(AsyncOp* op) {
         return;
     }
 
-    // _connect...() will continue the state machine.
-    _connectWithDBClientConnection(op);
+    const auto timeout = (op->request().timeout == RemoteCommandRequest::kNoTimeout)
+        ? Milliseconds::max()
+        : op->request().timeout;
+
+    // The pool either hands over an idle connection or sets up a new one asynchronously.
+    _connectionPool.get(op->request().target,
+                        timeout,
+                        [this, op](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                            if (!swConn.isOK()) {
+                                LOG(3) << "failed to get a connection to "
+                                       << op->request().target << ": " << swConn.getStatus();
+                                return _completeOperation(op, swConn.getStatus());
+                            }
+
+                            op->setConnectionHandle(std::move(swConn.getValue()));
+
+                            // Continue from a fresh handler rather than from within the pool,
+                            // which may be in the middle of completing another operation.
+                            asio::post(_io_service, [this, op]() { _beginCommunication(op); });
+                        });
 }
 
 std::unique_ptr<Message> NetworkInterfaceASIO::_messageFromRequest(
@@ -109,6 +128,7 @@ void NetworkInterfaceASIO::_beginCommunication(AsyncOp* op) {
     }
 
     op->setOperationProtocol(negotiatedProtocol.getValue());
+    op->setCommunicating();
 
     op->setToSend(std::move(*_messageFromRequest(op->request(), negotiatedProtocol.getValue())));
 
@@ -165,15 +185,32 @@ void NetworkInterfaceASIO::_networkErrorCallback(AsyncOp* op, const std::error_c
 // NOTE: This method may only be called by ASIO threads
 // (do not call from methods entered by ReplicationExecutor threads)
 void NetworkInterfaceASIO::_completeOperation(AsyncOp* op, const ResponseStatus& resp) {
+    if (auto conn = op->pooledConnection()) {
+        // A pooled connection can only be reused after a complete round trip, or if nothing was
+        // sent on it. Otherwise it may still hold part of a request or reply.
+        if (resp.isOK()) {
+            conn->indicateUsed();
+        } else if (op->communicating()) {
+            conn->indicateFailed(resp.getStatus());
+        }
+    }
+
     op->finish(resp);
 
+    std::unique_ptr<AsyncOp> ownedOp;
     {
-        // NOTE: op will be deleted in the call to erase() below.
-        // It is invalid to reference op after this point.
         stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
-        _inProgress.erase(op);
+        auto iter = _inProgress.find(op);
+        invariant(iter != _inProgress.end());
+        ownedOp = std::move(iter->second);
+        _inProgress.erase(iter);
     }
 
+    // NOTE: deleting the op returns its connection to the pool, which may hand it straight to
+    // another operation, so it must not happen under _inProgressMutex.
+    // It is invalid to reference op after this point.
+    ownedOp.reset();
+
     signalWorkAvailable();
 }
 
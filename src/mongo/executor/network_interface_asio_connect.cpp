@@ -34,7 +34,13 @@
 
 #include <utility>
 
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/db/auth/authorization_manager_global.h"
+#include "mongo/db/auth/authorization_manager.h"
+#include "mongo/db/auth/internal_user_auth.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/sock.h"
 
 namespace mongo {
@@ -48,12 +54,12 @@ const auto kCanceledStatus = Status(ErrorCodes::CallbackCanceled, "Callback canc
 
 NetworkInterfaceASIO::AsyncConnection::AsyncConnection(asio::ip::tcp::socket&& sock,
                                                        rpc::ProtocolSet protocols)
-    : AsyncConnection(std::move(sock), protocols, boost::none) {}
+    : AsyncConnection(std::move(sock), protocols, nullptr) {}
 
 NetworkInterfaceASIO::AsyncConnection::AsyncConnection(
     asio::ip::tcp::socket&& sock,
     rpc::ProtocolSet protocols,
-    boost::optional<ConnectionPool::ConnectionPtr>&& bootstrapConn)
+    std::shared_ptr<DBClientConnection> bootstrapConn)
     : _sock(std::move(sock)),
       _serverProtocols(protocols),
       _bootstrapConn(std::move(bootstrapConn)) {}
@@ -62,13 +68,15 @@ NetworkInterfaceASIO::AsyncConnection::AsyncConnection(
 NetworkInterfaceASIO::AsyncConnection::AsyncConnection(AsyncConnection&& other)
     : _sock(std::move(other._sock)),
       _serverProtocols(other._serverProtocols),
-      _clientProtocols(other._clientProtocols) {}
+      _clientProtocols(other._clientProtocols),
+      _bootstrapConn(std::move(other._bootstrapConn)) {}
 
 NetworkInterfaceASIO::AsyncConnection& NetworkInterfaceASIO::AsyncConnection::operator=(
     AsyncConnection&& other) {
     _sock = std::move(other._sock);
     _serverProtocols = other._serverProtocols;
     _clientProtocols = other._clientProtocols;
+    _bootstrapConn = std::move(other._bootstrapConn);
     return *this;
 }
 #endif
@@ -85,6 +93,20 @@ rpc::ProtocolSet NetworkInterfaceASIO::AsyncConnection::clientProtocols() const
     return _clientProtocols;
 }
 
+void NetworkInterfaceASIO::AsyncConnection::setServerProtocols(rpc::ProtocolSet protocols) {
+    _serverProtocols = protocols;
+}
+
+void NetworkInterfaceASIO::_connect(AsyncOp* op) {
+    // Asynchronous authentication is not implemented yet (see _authenticate()), so when auth is
+    // enabled new connections are still bootstrapped and authenticated by a DBClientConnection.
+    if (getGlobalAuthorizationManager()->isAuthEnabled()) {
+        return _connectWithDBClientConnection(op);
+    }
+
+    _connectASIO(op);
+}
+
 void NetworkInterfaceASIO::_connectASIO(AsyncOp* op) {
     tcp::resolver::query query(op->request().target.host(),
                                std::to_string(op->request().target.port()));
@@ -106,14 +128,33 @@ void NetworkInterfaceASIO::_connectASIO(AsyncOp* op) {
 }
 
 void NetworkInterfaceASIO::_connectWithDBClientConnection(AsyncOp* op) {
-    // connect in a separate thread to avoid blocking the rest of the system
-    stdx::thread t([this, op]() {
+    // Connect on the bootstrap pool to avoid blocking the rest of the system. Connections wait
+    // their turn there once all of its threads are busy.
+    auto scheduleStatus = _bootstrapPool.schedule([this, op]() {
+        if (inShutdown()) {
+            return;
+        }
+
+        std::shared_ptr<DBClientConnection> conn;
         try {
-            // The call to connect() will throw if:
-            // - we cannot get a new connection from the pool
-            // - we get a connection from the pool, but cannot use it
-            // - we fail to transfer the connection's socket to an ASIO wrapper
-            op->connect(_connPool.get(), &_io_service, now());
+            const auto& target = op->request().target;
+
+            conn = std::make_shared<DBClientConnection>();
+            std::string errmsg;
+            uassert(ErrorCodes::HostUnreachable,
+                    str::stream() << "Failed attempt to connect to " << target.toString() << "; "
+                                  << errmsg,
+                    conn->connect(target, errmsg));
+
+            uassert(ErrorCodes::AuthenticationFailed,
+                    "Missing credentials for authenticating as internal user",
+                    isInternalAuthSet());
+            conn->auth(getInternalUserAuthParamsWithFallback());
+
+            int protocol = conn->port().localAddr().getType();
+            if (protocol != AF_INET && protocol != AF_INET6) {
+                throw SocketException(SocketException::CONNECT_ERROR, "Unsupported family");
+            }
         } catch (...) {
             LOG(3) << "failed to connect, posting mock completion";
 
@@ -135,20 +176,31 @@ void NetworkInterfaceASIO::_connectWithDBClientConnection(AsyncOp* op) {
             return;
         }
 
-        // send control back to main thread(pool)
-        asio::post(_io_service, [this, op]() { _beginCommunication(op); });
+        // send control back to the io_service thread, which adopts the connection's socket
+        asio::post(_io_service,
+                   [this, op, conn]() {
+                       if (op->canceled()) {
+                           return _completeOperation(op, kCanceledStatus);
+                       }
+
+                       int protocol = conn->port().localAddr().getType();
+                       tcp::socket sock{_io_service,
+                                        protocol == AF_INET ? tcp::v4() : tcp::v6(),
+                                        conn->port().psock->rawFD()};
+
+                       *op->connection() = AsyncConnection(
+                           std::move(sock), conn->getServerRPCProtocols(), std::move(conn));
+
+                       _beginCommunication(op);
+                   });
     });
 
-    t.detach();
+    if (!scheduleStatus.isOK()) {
+        LOG(3) << "failed to schedule connection bootstrap: " << scheduleStatus;
+    }
 }
 
 void NetworkInterfaceASIO::_setupSocket(AsyncOp* op, const tcp::resolver::iterator& endpoints) {
-    tcp::socket sock(_io_service);
-    AsyncConnection conn(std::move(sock), rpc::supports::kOpQueryOnly);
-
-    // TODO: Consider moving this call to post-auth so we only assign completed connections.
-    op->setConnection(std::move(conn));
-
     asio::async_connect(op->connection()->sock(),
                         std::move(endpoints),
                         [this, op](std::error_code ec, tcp::resolver::iterator iter) {
@@ -32,11 +32,11 @@
 
 #include "mongo/executor/network_interface_asio.h"
 
+#include "mongo/executor/connection_pool_asio.h"
+
 namespace mongo {
 namespace executor {
 
-using asio::ip::tcp;
-
 NetworkInterfaceASIO::AsyncOp::AsyncOp(const TaskExecutor::CallbackHandle& cbHandle,
                                        const RemoteCommandRequest& request,
                                        const RemoteCommandCompletionFn& onFinish,
@@ -59,10 +59,8 @@ std::string NetworkInterfaceASIO::AsyncOp::toString() const {
         output << "kReady";
     } else if (_state == OpState::kConnectionAcquired) {
         output << "kConnectionAcquired";
-    } else if (_state == OpState::kConnectionVerified) {
-        output << "kConnectionVerified";
-    } else if (_state == OpState::kConnected) {
-        output << "kConnected";
+    } else if (_state == OpState::kCommunicating) {
+        output << "kCommunicating";
     } else if (_state == OpState::kCompleted) {
         output << "kCompleted";
     } else {
@@ -87,46 +85,33 @@ const TaskExecutor::CallbackHandle& NetworkInterfaceASIO::AsyncOp::cbHandle() co
     return _cbHandle;
 }
 
-void NetworkInterfaceASIO::AsyncOp::connect(ConnectionPool* const pool,
-                                            asio::io_service* service,
-                                            Date_t now) {
-    // TODO(amidvidy): why is this hardcoded to 1 second? That seems too low.
-    ConnectionPool::ConnectionPtr conn(pool, _request.target, now, Milliseconds(1000));
+NetworkInterfaceASIO::AsyncConnection* NetworkInterfaceASIO::AsyncOp::connection() {
+    invariant(_connection);
+    return _connection;
+}
 
+void NetworkInterfaceASIO::AsyncOp::setConnection(AsyncConnection* conn) {
+    invariant(!_connection);
+    _connection = conn;
     _state = OpState::kConnectionAcquired;
+}
 
-    // TODO: Add a case here for unix domain sockets.
-    int protocol = conn.get()->port().localAddr().getType();
-    if (protocol != AF_INET && protocol != AF_INET6) {
-        throw SocketException(SocketException::CONNECT_ERROR, "Unsupported family");
-    }
-
-    _state = OpState::kConnectionVerified;
-
-    tcp::socket sock{
-        *service, protocol == AF_INET ? tcp::v4() : tcp::v6(), conn.get()->port().psock->rawFD()};
-
-    _connection.emplace(std::move(sock), conn.get()->getServerRPCProtocols(), std::move(conn));
-
-    _state = OpState::kConnected;
+void NetworkInterfaceASIO::AsyncOp::setConnectionHandle(ConnectionPool::ConnectionHandle handle) {
+    invariant(!_connectionHandle);
+    setConnection(static_cast<connection_pool_asio::ASIOConnection*>(handle.get())->connection());
+    _connectionHandle = std::move(handle);
 }
 
-NetworkInterfaceASIO::AsyncConnection* NetworkInterfaceASIO::AsyncOp::connection() {
-    invariant(_connection.is_initialized());
-    return _connection.get_ptr();
+ConnectionPool::ConnectionInterface* NetworkInterfaceASIO::AsyncOp::pooledConnection() const {
+    return _connectionHandle.get();
 }
 
-void NetworkInterfaceASIO::AsyncOp::setConnection(AsyncConnection&& conn) {
-    invariant(!_connection.is_initialized());
-    _connection = std::move(conn);
-    _state = OpState::kConnected;
+void NetworkInterfaceASIO::AsyncOp::setCommunicating() {
+    _state = OpState::kCommunicating;
 }
 
-bool NetworkInterfaceASIO::AsyncOp::connected() const {
-    return (_state == OpState::kConnected ||
-            // NOTE: if we fail at kConnectionVerified,
-            // ASIO will have closed the socket, don't disconnect
-            _state == OpState::kConnectionAcquired);
+bool NetworkInterfaceASIO::AsyncOp::communicating() const {
+    return _state == OpState::kCommunicating;
 }
 
 void NetworkInterfaceASIO::AsyncOp::finish(const ResponseStatus& status) {
@@ -46,17 +46,41 @@ const char kNetworkImplThreadPool[] = "threadPool";
 }  // namespace
 
 MONGO_EXPORT_STARTUP_SERVER_PARAMETER(outboundNetworkImpl, std::string, kNetworkImplThreadPool);
+
+// Connection pool sizing for the ASIO implementation, per remote host. A max size of 0 means no
+// limit.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(outboundConnectionPoolMinSize, int, 1);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(outboundConnectionPoolMaxSize, int, 0);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(outboundConnectionPoolHostTimeoutSecs, int, 300);
+
 MONGO_INITIALIZER(outboundNetworkImpl)(InitializerContext*) {
     if (outboundNetworkImpl != kNetworkImplThreadPool && outboundNetworkImpl != kNetworkImplASIO) {
         return Status(ErrorCodes::BadValue,
                       "unsupported networking option: " + outboundNetworkImpl);
     }
+    if (outboundConnectionPoolMinSize < 0 || outboundConnectionPoolMaxSize < 0 ||
+        outboundConnectionPoolHostTimeoutSecs <= 0) {
+        return Status(ErrorCodes::BadValue,
+                      "outbound connection pool sizes must not be negative, and the host "
+                      "timeout must be positive");
+    }
+    if (outboundConnectionPoolMaxSize &&
+        outboundConnectionPoolMinSize > outboundConnectionPoolMaxSize) {
+        return Status(ErrorCodes::BadValue,
+                      "outboundConnectionPoolMinSize must not exceed outboundConnectionPoolMaxSize");
+    }
     return Status::OK();
 }
 
 std::unique_ptr<NetworkInterface> makeNetworkInterface() {
     if (outboundNetworkImpl == kNetworkImplASIO) {
-        return stdx::make_unique<NetworkInterfaceASIO>();
+        ConnectionPool::Options options;
+        options.minConnections = outboundConnectionPoolMinSize;
+        if (outboundConnectionPoolMaxSize) {
+            options.maxConnections = outboundConnectionPoolMaxSize;
+        }
+        options.hostTimeout = Seconds(outboundConnectionPoolHostTimeoutSecs);
+        return stdx::make_unique<NetworkInterfaceASIO>(std::move(options));
     } else {
         return stdx::make_unique<NetworkInterfaceImpl>();
     }
@@ -40,6 +40,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/s/balancer_policy.h"
@@ -57,6 +58,7 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/s/client/shard_registry.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -74,6 +76,235 @@ using std::vector;
 
 MONGO_FP_DECLARE(skipBalanceRound);
 
+namespace {
+
+// Upper bound on the number of chunk migrations a balancing round issues at the same time. The
+// migrations running together never share a donor or recipient shard, nor a collection.
+int balancerMaxConcurrentMigrations = 1;
+
+class ExportedMaxConcurrentMigrationsParameter : public ExportedServerParameter<int> {
+public:
+    ExportedMaxConcurrentMigrationsParameter()
+        : ExportedServerParameter<int>(ServerParameterSet::getGlobal(),
+                                       "balancerMaxConcurrentMigrations",
+                                       &balancerMaxConcurrentMigrations,
+                                       true,
+                                       true) {}
+
+    virtual Status validate(const int& potentialNewValue) {
+        if (potentialNewValue < 1) {
+            return Status(ErrorCodes::BadValue,
+                          "balancerMaxConcurrentMigrations must be at least 1");
+        }
+        return Status::OK();
+    }
+} exportedMaxConcurrentMigrationsParam;
+
+/**
+ * What happened to a single migration issued by the balancer.
+ */
+struct MigrationOutcome {
+    // Whether a moveChunk command was sent to the donor shard.
+    bool attempted = false;
+
+    // Whether the donor reported that the chunk was moved.
+    bool succeeded = false;
+
+    // Whether the migration counts toward the chunks moved in the round. This includes chunks
+    // which were marked as jumbo, so that another round starts right away.
+    bool counted = false;
+
+    // Wall clock time of the moveChunk command, as seen by the balancer.
+    long long millis = 0;
+
+    // Per-step timings reported by the donor shard, if any.
+    BSONObj stepTimes;
+};
+
+/**
+ * Rolls the outcome of every migration issued in a balancing round into the statistics which
+ * are recorded with the round in the action log.
+ */
+class MigrationRoundStats {
+public:
+    explicit MigrationRoundStats(size_t maxConcurrent) : _maxConcurrent(maxConcurrent) {}
+
+    void add(const MigrationOutcome& outcome) {
+        if (!outcome.attempted) {
+            return;
+        }
+
+        _attempted++;
+        if (outcome.succeeded) {
+            _succeeded++;
+        }
+
+        _totalMillis += outcome.millis;
+        _maxMillis = std::max(_maxMillis, outcome.millis);
+
+        for (const auto& elem : outcome.stepTimes) {
+            if (!elem.isNumber()) {
+                continue;
+            }
+
+            auto it = std::find_if(_stepMillis.begin(),
+                                   _stepMillis.end(),
+                                   [&elem](const std::pair<string, long long>& step) {
+                                       return step.first == elem.fieldNameStringData();
+                                   });
+            if (it == _stepMillis.end()) {
+                _stepMillis.emplace_back(elem.fieldName(), elem.numberLong());
+            } else {
+                it->second += elem.numberLong();
+            }
+        }
+    }
+
+    void endWave() {
+        _waves++;
+    }
+
+    void appendTo(BSONObjBuilder* builder) const {
+        if (!_attempted) {
+            return;
+        }
+
+        builder->append("maxConcurrent", static_cast<long long>(_maxConcurrent));
+        builder->append("waves", _waves);
+        builder->append("attempted", _attempted);
+        builder->append("succeeded", _succeeded);
+        builder->append("failed", _attempted - _succeeded);
+        builder->append("totalTimeMillis", _totalMillis);
+        builder->append("maxTimeMillis", _maxMillis);
+
+        BSONObjBuilder stepTimes(builder->subobjStart("donorStepTimeMillis"));
+        for (const auto& step : _stepMillis) {
+            stepTimes.append(step.first, step.second);
+        }
+        stepTimes.done();
+    }
+
+private:
+    const size_t _maxConcurrent;
+
+    int _waves = 0;
+    int _attempted = 0;
+    int _succeeded = 0;
+    long long _totalMillis = 0;
+    long long _maxMillis = 0;
+
+    // Sum of the donor step timings, in the order the donor reports the steps.
+    std::vector<std::pair<string, long long>> _stepMillis;
+};
+
+/**
+ * Issues a single chunk migration on behalf of the balancer. Safe to call concurrently for
+ * migrations of different collections.
+ */
+MigrationOutcome issueMigration(const MigrateInfo& migrateInfo,
+                                const WriteConcernOptions* writeConcern,
+                                bool waitForDelete) {
+    MigrationOutcome outcome;
+
+    // Changes to metadata, borked metadata, and connectivity problems between shards
+    // should cause us to abort this chunk move, but shouldn't cause us to abort the entire
+    // round of chunks.
+    //
+    // TODO(spencer): We probably *should* abort the whole round on issues communicating
+    // with the config servers, but its impossible to distinguish those types of failures
+    // at the moment.
+    //
+    // TODO: Handle all these things more cleanly, since they're expected problems
+
+    const NamespaceString nss(migrateInfo.ns);
+
+    try {
+        auto status = grid.catalogCache()->getDatabase(nss.db().toString());
+        fassert(28628, status.getStatus());
+
+        shared_ptr<DBConfig> cfg = status.getValue();
+
+        // NOTE: We purposely do not reload metadata here, since _doBalanceRound already
+        // tried to do so once.
+        shared_ptr<ChunkManager> cm = cfg->getChunkManager(migrateInfo.ns);
+        invariant(cm);
+
+        ChunkPtr c = cm->findIntersectingChunk(migrateInfo.chunk.min);
+
+        if (c->getMin().woCompare(migrateInfo.chunk.min) ||
+            c->getMax().woCompare(migrateInfo.chunk.max)) {
+            // Likely a split happened somewhere, so force reload the chunk manager
+            cm = cfg->getChunkManager(migrateInfo.ns, true);
+            invariant(cm);
+
+            c = cm->findIntersectingChunk(migrateInfo.chunk.min);
+
+            if (c->getMin().woCompare(migrateInfo.chunk.min) ||
+                c->getMax().woCompare(migrateInfo.chunk.max)) {
+                log() << "chunk mismatch after reload, ignoring will retry issue "
+                      << migrateInfo.chunk.toString();
+
+                return outcome;
+            }
+        }
+
+        BSONObj res;
+        Timer moveTimer;
+        outcome.attempted = true;
+
+        const bool moved = c->moveAndCommit(migrateInfo.to,
+                                            Chunk::MaxChunkSize,
+                                            writeConcern,
+                                            waitForDelete,
+                                            0, /* maxTimeMS */
+                                            res);
+
+        outcome.millis = moveTimer.millis();
+        if (res["stepTimes"].type() == Object) {
+            outcome.stepTimes = res["stepTimes"].Obj().getOwned();
+        }
+
+        if (moved) {
+            outcome.succeeded = true;
+            outcome.counted = true;
+            return outcome;
+        }
+
+        // The move requires acquiring the collection metadata's lock, which can fail.
+        log() << "balancer move failed: " << res << " from: " << migrateInfo.from
+              << " to: " << migrateInfo.to << " chunk: " << migrateInfo.chunk;
+
+        if (res["chunkTooBig"].trueValue()) {
+            // Reload just to be safe
+            cm = cfg->getChunkManager(migrateInfo.ns);
+            invariant(cm);
+
+            c = cm->findIntersectingChunk(migrateInfo.chunk.min);
+
+            log() << "performing a split because migrate failed for size reasons";
+
+            Status status = c->split(Chunk::normal, NULL, NULL);
+            log() << "split results: " << status;
+
+            if (!status.isOK()) {
+                log() << "marking chunk as jumbo: " << c->toString();
+
+                c->markAsJumbo();
+
+                // We increment moveCount so we do another round right away
+                outcome.counted = true;
+            }
+        }
+    } catch (const DBException& ex) {
+        warning() << "could not move chunk " << migrateInfo.chunk.toString()
+                  << ", continuing balancing round" << causedBy(ex);
+    }
+
+    return outcome;
+}
+
+}  // namespace
+
 Balancer balancer;
 
 Balancer::Balancer() : _balancedLastTime(0), _policy(new BalancerPolicy()) {}
@@ -82,10 +313,15 @@ Balancer::~Balancer() = default;
 
 int Balancer::_moveChunks(const vector<shared_ptr<MigrateInfo>>& candidateChunks,
                           const WriteConcernOptions* writeConcern,
-                          bool waitForDelete) {
+                          bool waitForDelete,
+                          BSONObjBuilder* migrationStats) {
+    const size_t maxConcurrent = static_cast<size_t>(balancerMaxConcurrentMigrations);
+    const auto waves = BalancerPolicy::groupIntoConcurrentWaves(candidateChunks, maxConcurrent);
+
+    MigrationRoundStats roundStats(maxConcurrent);
     int movedCount = 0;
 
-    for (const auto& migrateInfo : candidateChunks) {
+    for (const auto& wave : waves) {
         // If the balancer was disabled since we started this round, don't start new chunks
         // moves.
         const auto balSettingsResult =
@@ -96,7 +332,7 @@ int Balancer::_moveChunks(const vector<shared_ptr<MigrateInfo>>& candidateChunks
 
         if (!balSettingsResult.isOK() && !isBalSettingsAbsent) {
             warning() << balSettingsResult.getStatus();
-            return movedCount;
+            break;
         }
 
         const SettingsType& balancerConfig =
@@ -105,93 +341,51 @@ int Balancer::_moveChunks(const vector<shared_ptr<MigrateInfo>>& candidateChunks
         if ((!isBalSettingsAbsent && !grid.shouldBalance(balancerConfig)) ||
             MONGO_FAIL_POINT(skipBalanceRound)) {
             LOG(1) << "Stopping balancing round early as balancing was disabled";
-            return movedCount;
+            break;
         }
 
-        // Changes to metadata, borked metadata, and connectivity problems between shards
-        // should cause us to abort this chunk move, but shouldn't cause us to abort the entire
-        // round of chunks.
-        //
-        // TODO(spencer): We probably *should* abort the whole round on issues communicating
-        // with the config servers, but its impossible to distinguish those types of failures
-        // at the moment.
-        //
-        // TODO: Handle all these things more cleanly, since they're expected problems
-
-        const NamespaceString nss(migrateInfo->ns);
+        vector<MigrationOutcome> outcomes(wave.size());
 
-        try {
-            auto status = grid.catalogCache()->getDatabase(nss.db().toString());
-            fassert(28628, status.getStatus());
-
-            shared_ptr<DBConfig> cfg = status.getValue();
-
-            // NOTE: We purposely do not reload metadata here, since _doBalanceRound already
-            // tried to do so once.
-            shared_ptr<ChunkManager> cm = cfg->getChunkManager(migrateInfo->ns);
-            invariant(cm);
-
-            ChunkPtr c = cm->findIntersectingChunk(migrateInfo->chunk.min);
-
-            if (c->getMin().woCompare(migrateInfo->chunk.min) ||
-                c->getMax().woCompare(migrateInfo->chunk.max)) {
-                // Likely a split happened somewhere, so force reload the chunk manager
-                cm = cfg->getChunkManager(migrateInfo->ns, true);
-                invariant(cm);
-
-                c = cm->findIntersectingChunk(migrateInfo->chunk.min);
-
-                if (c->getMin().woCompare(migrateInfo->chunk.min) ||
-                    c->getMax().woCompare(migrateInfo->chunk.max)) {
-                    log() << "chunk mismatch after reload, ignoring will retry issue "
-                          << migrateInfo->chunk.toString();
-
-                    continue;
-                }
+        if (wave.size() == 1) {
+            outcomes[0] = issueMigration(*wave[0], writeConcern, waitForDelete);
+        } else {
+            LOG(1) << "issuing " << wave.size() << " concurrent chunk migrations";
+
+            // Every shard takes part in at most one migration of the wave, so the migrations
+            // don't contend with each other on the donors or the recipients.
+            vector<stdx::thread> threads;
+            threads.reserve(wave.size());
+
+            for (size_t i = 0; i < wave.size(); i++) {
+                threads.emplace_back([&, i] {
+                    const string threadName = str::stream() << "BalancerMigration-" << i;
+                    Client::initThread(threadName.c_str());
+
+                    try {
+                        outcomes[i] = issueMigration(*wave[i], writeConcern, waitForDelete);
+                    } catch (const std::exception& ex) {
+                        warning() << "could not move chunk " << wave[i]->chunk.toString()
+                                  << ", continuing balancing round" << causedBy(ex);
+                    }
+                });
             }
 
-            BSONObj res;
-            if (c->moveAndCommit(migrateInfo->to,
-                                 Chunk::MaxChunkSize,
-                                 writeConcern,
-                                 waitForDelete,
-                                 0, /* maxTimeMS */
-                                 res)) {
-                movedCount++;
-                continue;
+            for (auto& thread : threads) {
+                thread.join();
             }
+        }
 
-            // The move requires acquiring the collection metadata's lock, which can fail.
-            log() << "balancer move failed: " << res << " from: " << migrateInfo->from
-                  << " to: " << migrateInfo->to << " chunk: " << migrateInfo->chunk;
-
-            if (res["chunkTooBig"].trueValue()) {
-                // Reload just to be safe
-                cm = cfg->getChunkManager(migrateInfo->ns);
-                invariant(cm);
-
-                c = cm->findIntersectingChunk(migrateInfo->chunk.min);
-
-                log() << "performing a split because migrate failed for size reasons";
-
-                Status status = c->split(Chunk::normal, NULL, NULL);
-                log() << "split results: " << status;
-
-                if (!status.isOK()) {
-                    log() << "marking chunk as jumbo: " << c->toString();
-
-                    c->markAsJumbo();
-
-                    // We increment moveCount so we do another round right away
-                    movedCount++;
-                }
+        for (const auto& outcome : outcomes) {
+            if (outcome.counted) {
+                movedCount++;
             }
-        } catch (const DBException& ex) {
-            warning() << "could not move chunk " << migrateInfo->chunk.toString()
-                      << ", continuing balancing round" << causedBy(ex);
+            roundStats.add(outcome);
         }
+
+        roundStats.endWave();
     }
 
+    roundStats.appendTo(migrationStats);
     return movedCount;
 }
 
@@ -552,18 +746,21 @@ void Balancer::run() {
                 vector<shared_ptr<MigrateInfo>> candidateChunks;
                 _doBalanceRound(&candidateChunks);
 
+                BSONObjBuilder migrationStats;
+
                 if (candidateChunks.size() == 0) {
                     LOG(1) << "no need to move any chunk";
                     _balancedLastTime = 0;
                 } else {
-                    _balancedLastTime =
-                        _moveChunks(candidateChunks, writeConcern.get(), waitForDelete);
+                    _balancedLastTime = _moveChunks(
+                        candidateChunks, writeConcern.get(), waitForDelete, &migrationStats);
                 }
 
                 actionLog.setDetails(boost::none,
                                      balanceRoundTimer.millis(),
                                      static_cast<int>(candidateChunks.size()),
-                                     _balancedLastTime);
+                                     _balancedLastTime,
+                                     migrationStats.obj());
                 actionLog.setTime(jsTime());
 
                 grid.catalogManager()->logAction(actionLog);
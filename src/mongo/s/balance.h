@@ -35,6 +35,7 @@
 
 namespace mongo {
 
+class BSONObjBuilder;
 class BalancerPolicy;
 struct MigrateInfo;
 struct WriteConcernOptions;
@@ -47,7 +48,9 @@ struct WriteConcernOptions;
  *
  * The balancer does act continuously but in "rounds". At a given round, it would decide if
  * there is an imbalance by checking the difference in chunks between the most and least
- * loaded shards. It would issue a request for a chunk migration per round, if it found so.
+ * loaded shards. It would issue a request for a chunk migration per collection, if it found so.
+ * Migrations between disjoint pairs of shards may run concurrently, up to the limit set by the
+ * balancerMaxConcurrentMigrations server parameter.
  */
 class Balancer : public BackgroundJob {
 public:
@@ -95,16 +98,19 @@ private:
     void _doBalanceRound(std::vector<std::shared_ptr<MigrateInfo>>* candidateChunks);
 
     /**
-     * Issues chunk migration request, one at a time.
+     * Issues chunk migration requests in waves. The migrations of a wave run concurrently and
+     * never share a donor or recipient shard.
      *
      * @param candidateChunks possible chunks to move
      * @param writeConcern detailed write concern. NULL means the default write concern.
      * @param waitForDelete wait for deletes to complete after each chunk move
+     * @param migrationStats (OUT) filled with round-level statistics of the migrations issued
      * @return number of chunks effectively moved
      */
     int _moveChunks(const std::vector<std::shared_ptr<MigrateInfo>>& candidateChunks,
                     const WriteConcernOptions* writeConcern,
-                    bool waitForDelete);
+                    bool waitForDelete,
+                    BSONObjBuilder* migrationStats);
 
     /**
      * Marks this balancer as being live on the config server(s).
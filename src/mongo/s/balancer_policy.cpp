@@ -53,6 +53,7 @@ namespace mongo {
 using std::map;
 using std::numeric_limits;
 using std::set;
+using std::shared_ptr;
 using std::string;
 using std::vector;
 
@@ -554,4 +555,36 @@ string ChunkInfo::toString() const {
     return buf.str();
 }
 
+vector<vector<shared_ptr<MigrateInfo>>> BalancerPolicy::groupIntoConcurrentWaves(
+    const vector<shared_ptr<MigrateInfo>>& candidates, size_t maxConcurrent) {
+    invariant(maxConcurrent > 0);
+
+    vector<vector<shared_ptr<MigrateInfo>>> waves;
+    vector<shared_ptr<MigrateInfo>> remaining(candidates);
+
+    while (!remaining.empty()) {
+        vector<shared_ptr<MigrateInfo>> wave;
+        vector<shared_ptr<MigrateInfo>> deferred;
+        set<ShardId> busyShards;
+        set<string> busyCollections;
+
+        for (const auto& migrateInfo : remaining) {
+            if (wave.size() < maxConcurrent && !busyShards.count(migrateInfo->from) &&
+                !busyShards.count(migrateInfo->to) && !busyCollections.count(migrateInfo->ns)) {
+                busyShards.insert(migrateInfo->from);
+                busyShards.insert(migrateInfo->to);
+                busyCollections.insert(migrateInfo->ns);
+                wave.push_back(migrateInfo);
+            } else {
+                deferred.push_back(migrateInfo);
+            }
+        }
+
+        waves.push_back(std::move(wave));
+        remaining.swap(deferred);
+    }
+
+    return waves;
+}
+
 }  // namespace mongo
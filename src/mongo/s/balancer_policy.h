@@ -233,6 +233,16 @@ public:
     static MigrateInfo* balance(const std::string& ns,
                                 const DistributionStatus& distribution,
                                 int balancedLastTime);
+
+    /**
+     * Splits the candidate migrations of a balancing round into waves whose migrations can run
+     * concurrently. Within a wave every shard takes part in at most one migration, either as
+     * donor or as recipient, no two migrations are for the same collection, and there are never
+     * more than 'maxConcurrent' migrations. Candidates keep their relative order, so a limit of
+     * one yields one wave per candidate.
+     */
+    static std::vector<std::vector<std::shared_ptr<MigrateInfo>>> groupIntoConcurrentWaves(
+        const std::vector<std::shared_ptr<MigrateInfo>>& candidates, size_t maxConcurrent);
 };
 
 }  // namespace mongo
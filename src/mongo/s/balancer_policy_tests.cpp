@@ -620,4 +620,64 @@ TEST(BalancerPolicyTests, Simulation) {
     }
 }
 
+std::shared_ptr<MigrateInfo> makeMigrateInfo(const string& ns,
+                                             const string& from,
+                                             const string& to) {
+    return std::make_shared<MigrateInfo>(
+        ns, to, from, BSON(ChunkType::min(BSON("x" << 0)) << ChunkType::max(BSON("x" << 1))));
+}
+
+TEST(BalancerPolicyTests, ConcurrentWavesUseDisjointShards) {
+    vector<std::shared_ptr<MigrateInfo>> candidates;
+    candidates.push_back(makeMigrateInfo("db.a", "shard0", "shard1"));
+    candidates.push_back(makeMigrateInfo("db.b", "shard1", "shard2"));
+    candidates.push_back(makeMigrateInfo("db.c", "shard2", "shard3"));
+    candidates.push_back(makeMigrateInfo("db.d", "shard4", "shard5"));
+
+    auto waves = BalancerPolicy::groupIntoConcurrentWaves(candidates, 10);
+    ASSERT_EQUALS(2U, waves.size());
+
+    ASSERT_EQUALS(3U, waves[0].size());
+    ASSERT_EQUALS("db.a", waves[0][0]->ns);
+    ASSERT_EQUALS("db.c", waves[0][1]->ns);
+    ASSERT_EQUALS("db.d", waves[0][2]->ns);
+
+    ASSERT_EQUALS(1U, waves[1].size());
+    ASSERT_EQUALS("db.b", waves[1][0]->ns);
+}
+
+TEST(BalancerPolicyTests, ConcurrentWavesRespectLimit) {
+    vector<std::shared_ptr<MigrateInfo>> candidates;
+    for (int i = 0; i < 5; i++) {
+        candidates.push_back(makeMigrateInfo(str::stream() << "db.c" << i,
+                                             str::stream() << "from" << i,
+                                             str::stream() << "to" << i));
+    }
+
+    auto waves = BalancerPolicy::groupIntoConcurrentWaves(candidates, 2);
+    ASSERT_EQUALS(3U, waves.size());
+    ASSERT_EQUALS(2U, waves[0].size());
+    ASSERT_EQUALS(2U, waves[1].size());
+    ASSERT_EQUALS(1U, waves[2].size());
+
+    // A limit of one keeps the sequential order of the candidates.
+    waves = BalancerPolicy::groupIntoConcurrentWaves(candidates, 1);
+    ASSERT_EQUALS(candidates.size(), waves.size());
+    for (size_t i = 0; i < waves.size(); i++) {
+        ASSERT_EQUALS(1U, waves[i].size());
+        ASSERT_EQUALS(candidates[i]->ns, waves[i][0]->ns);
+    }
+}
+
+TEST(BalancerPolicyTests, ConcurrentWavesSerializeSameCollection) {
+    vector<std::shared_ptr<MigrateInfo>> candidates;
+    candidates.push_back(makeMigrateInfo("db.a", "shard0", "shard1"));
+    candidates.push_back(makeMigrateInfo("db.a", "shard2", "shard3"));
+
+    auto waves = BalancerPolicy::groupIntoConcurrentWaves(candidates, 4);
+    ASSERT_EQUALS(2U, waves.size());
+    ASSERT_EQUALS(1U, waves[0].size());
+    ASSERT_EQUALS(1U, waves[1].size());
+}
+
 }  // namespace
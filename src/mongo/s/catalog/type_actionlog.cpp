@@ -141,7 +141,8 @@ void ActionLogType::setTime(const Date_t& time) {
 void ActionLogType::setDetails(const boost::optional<std::string>& errMsg,
                                int executionTime,
                                int candidateChunks,
-                               int chunksMoved) {
+                               int chunksMoved,
+                               const BSONObj& migrationStats) {
     BSONObjBuilder builder;
     builder.append("executionTimeMillis", executionTime);
     builder.append("errorOccured", errMsg.is_initialized());
@@ -151,6 +152,10 @@ void ActionLogType::setDetails(const boost::optional<std::string>& errMsg,
     } else {
         builder.append("candidateChunks", candidateChunks);
         builder.append("chunksMoved", chunksMoved);
+
+        if (!migrationStats.isEmpty()) {
+            builder.append("migrations", migrationStats);
+        }
     }
 
     _details = builder.obj();
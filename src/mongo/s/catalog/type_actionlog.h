@@ -103,7 +103,8 @@ public:
      *           "candidateChunks" : ,
      *           "chunksMoved" : ,
      *           "executionTimeMillis" : ,
-     *           "errorOccured" : false
+     *           "errorOccured" : false,
+     *           "migrations" : { ... }  // only if any migration was attempted
      *          }
      * Failure: {
      *           "executionTimeMillis" : ,
@@ -114,11 +115,13 @@ public:
      * @param executionTime: the time this round took to run
      * @param candidateChunks: the number of chunks identified to be moved
      * @param chunksMoved: the number of chunks moved
+     * @param migrationStats: round-level statistics of the migrations issued, may be empty
      */
     void setDetails(const boost::optional<std::string>& errMsg,
                     int executionTime,
                     int candidateChunks,
-                    int chunksMoved);
+                    int chunksMoved,
+                    const BSONObj& migrationStats = BSONObj());
 
 private:
     // Convention: (M)andatory, (O)ptional, (S)pecial rule.
@@ -263,6 +263,18 @@ public:
                     return false;
                 }
 
+                // Chunk ranges and shard-side key extraction always hash with MD5, so the
+                // hashed index must use the default hash version as well.
+                if (isHashedShardKey && !idx["hashVersion"].eoo() &&
+                    idx["hashVersion"].numberInt() != BSONElementHasher::MD5_HASH_VERSION) {
+                    errmsg = str::stream() << "can't shard collection " << ns
+                                           << " with hashed shard key " << proposedKey
+                                           << " because the hashed index uses a non-default"
+                                           << " hashVersion of " << idx["hashVersion"].numberInt();
+                    conn.done();
+                    return false;
+                }
+
                 hasUsefulIndexForKey = true;
             }
         }
@@ -36,6 +36,7 @@
 #include <vector>
 
 #include "mongo/client/connpool.h"
+#include "mongo/client/dbclientcursor.h"
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_manager.h"
@@ -48,6 +49,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/concurrency/lock_state.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/field_parser.h"
@@ -62,8 +64,11 @@
 #include "mongo/db/range_deleter_service.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/sharded_connection_info.h"
 #include "mongo/db/s/sharding_state.h"
@@ -91,6 +96,7 @@
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/startup_test.h"
 
 // Pause while a fail point is enabled.
@@ -113,6 +119,54 @@ namespace {
 const int kDefaultWTimeoutMs = 60 * 1000;
 const WriteConcernOptions DefaultWriteConcern(2, WriteConcernOptions::NONE, kDefaultWTimeoutMs);
 
+// Temporary collection where the donor spills the ids of documents modified during a migration
+// when they take too much memory. It is local to the donor and dropped at startup.
+const char kModsSpillNs[] = "local.migrationMods";
+
+// Maximum number of spilled mods read back at a time by _transferMods.
+const int kSpilledModsBatchSize = 10000;
+
+// Number of record ids read at a time from the shard key index scan over the chunk being
+// migrated. Each batch is fetched in record id order.
+MONGO_EXPORT_SERVER_PARAMETER(internalMigrationCloneBatchSize, int, 10000);
+
+// Bytes of document ids of modified documents the donor keeps in memory before spilling them to
+// kModsSpillNs.
+MONGO_EXPORT_SERVER_PARAMETER(internalMigrationModsMaxMemoryBytes, int, 32 * 1024 * 1024);
+
+/**
+ * Gives 'txn' the RecoveryUnit stashed in '*stash' for the lifetime of this object, and stashes
+ * it again afterwards. Storage engine cursors may only be restored on the RecoveryUnit they were
+ * saved on, so this is how an executor outlives the operation which created it, the same way
+ * ScopedRecoveryUnitSwapper does it for getMore.
+ */
+class ScopedStashedRecoveryUnit {
+    MONGO_DISALLOW_COPYING(ScopedStashedRecoveryUnit);
+
+public:
+    ScopedStashedRecoveryUnit(OperationContext* txn, unique_ptr<RecoveryUnit>* stash)
+        : _txn(txn), _stash(stash) {
+        invariant(_stash->get());
+        _txn->recoveryUnit()->abandonSnapshot();
+        _txnRecoveryUnit.reset(_txn->releaseRecoveryUnit());
+        _txnRecoveryUnitState =
+            _txn->setRecoveryUnit(_stash->release(), OperationContext::kNotInUnitOfWork);
+    }
+
+    ~ScopedStashedRecoveryUnit() {
+        _txn->recoveryUnit()->abandonSnapshot();
+        _stash->reset(_txn->releaseRecoveryUnit());
+        _txn->setRecoveryUnit(_txnRecoveryUnit.release(), _txnRecoveryUnitState);
+    }
+
+private:
+    OperationContext* const _txn;
+    unique_ptr<RecoveryUnit>* const _stash;
+
+    unique_ptr<RecoveryUnit> _txnRecoveryUnit;
+    OperationContext::RecoveryUnitState _txnRecoveryUnitState;
+};
+
 /**
  * Returns the default write concern for migration cleanup (at donor shard) and
  * cloning documents (at recipient shard).
@@ -179,6 +233,14 @@ public:
                 _b.append("errmsg", *_cmdErrmsg);
             }
 
+            if (_result) {
+                BSONObjBuilder stepTimes(_result->subobjStart("stepTimes"));
+                for (const auto& step : _stepMillis) {
+                    stepTimes.appendNumber(step.first, step.second);
+                }
+                stepTimes.done();
+            }
+
             grid.catalogManager()->logChange(_txn->getClient()->clientAddress(true),
                                              (string) "moveChunk." + _where,
                                              _ns,
@@ -189,6 +251,14 @@ public:
         }
     }
 
+    /**
+     * Also reports the time taken by each step in the command response, so that the caller
+     * (typically the balancer) can aggregate them.
+     */
+    void reportStepTimesTo(BSONObjBuilder* result) {
+        _result = result;
+    }
+
     void done(int step) {
         invariant(step == ++_next);
         invariant(step <= _total);
@@ -201,7 +271,9 @@ public:
             op->setMessage_inlock(s.c_str());
         }
 
-        _b.appendNumber(s, _t.millis());
+        const long long millis = _t.millis();
+        _b.appendNumber(s, millis);
+        _stepMillis.emplace_back(s, millis);
         _t.reset();
     }
 
@@ -220,6 +292,9 @@ private:
     const string* _cmdErrmsg;
 
     BSONObjBuilder _b;
+
+    std::vector<std::pair<string, long long>> _stepMillis;
+    BSONObjBuilder* _result = nullptr;
 };
 
 class ChunkCommandHelper : public Command {
@@ -288,6 +363,7 @@ public:
 
         stdx::lock_guard<stdx::mutex> tLock(_cloneLocsMutex);
         verify(_cloneLocs.size() == 0);
+        verify(!_cloneExec);
 
         return true;
     }
@@ -296,22 +372,28 @@ public:
         log() << "MigrateFromStatus::done About to acquire global lock to exit critical "
                  "section";
 
-        // Get global shared to synchronize with logOp. Also see comments in the class
-        // members declaration for more details.
-        Lock::GlobalRead globalShared(txn->lockState());
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        {
+            // Get global shared to synchronize with logOp. Also see comments in the class
+            // members declaration for more details.
+            Lock::GlobalRead globalShared(txn->lockState());
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
 
-        _active = false;
-        _deleteNotifyExec.reset(NULL);
-        _inCriticalSection = false;
-        _inCriticalSectionCV.notify_all();
+            _active = false;
+            _deleteNotifyExec.reset(NULL);
+            _inCriticalSection = false;
+            _inCriticalSectionCV.notify_all();
 
-        _deleted.clear();
-        _reload.clear();
-        _memoryUsed = 0;
+            _deleted.clear();
+            _reload.clear();
+            _memoryUsed = 0;
 
-        stdx::lock_guard<stdx::mutex> cloneLock(_cloneLocsMutex);
-        _cloneLocs.clear();
+            stdx::lock_guard<stdx::mutex> cloneLock(_cloneLocsMutex);
+            _cloneExec.reset();
+            _cloneRecoveryUnit.reset();
+            _cloneLocs.clear();
+        }
+
+        _dropModsSpill(txn);
     }
 
     void logOp(OperationContext* txn,
@@ -434,6 +516,24 @@ public:
     bool transferMods(OperationContext* txn, string& errmsg, BSONObjBuilder& b) {
         long long size = 0;
 
+        // Mods which were spilled are older than the ones still in memory, so they go first.
+        stdx::lock_guard<stdx::mutex> spillLock(_modsSpillMutex);
+        while (_spilledMods > 0) {
+            BSONObjBuilder spilledBuilder;
+            if (!_transferSpilledMods(txn, errmsg, &spilledBuilder, &size)) {
+                return false;
+            }
+
+            if (size > 0) {
+                b.appendElements(spilledBuilder.obj());
+                b.append("size", size);
+                return true;
+            }
+
+            // Either the last spilled mods were moved back in memory, or they were all reloads
+            // of documents which no longer exist.
+        }
+
         {
             AutoGetCollectionForRead ctx(txn, getNS());
 
@@ -454,18 +554,99 @@ public:
     }
 
     /**
-     * Get the disklocs that belong to the chunk migrated and sort them in _cloneLocs
-     * (to avoid seeking disk later).
+     * Moves the ids of the modified documents to the spill collection if they take more than
+     * internalMigrationModsMaxMemoryBytes of memory. Must not be holding any locks.
+     */
+    Status spillModsIfNeeded(OperationContext* txn) {
+        stdx::lock_guard<stdx::mutex> spillLock(_modsSpillMutex);
+
+        list<BSONObj> deleted;
+        list<BSONObj> reload;
+
+        {
+            stdx::lock_guard<stdx::mutex> sl(_mutex);
+            if (!_active || _memoryUsed <= internalMigrationModsMaxMemoryBytes) {
+                return Status::OK();
+            }
+
+            deleted.swap(_deleted);
+            reload.swap(_reload);
+            _memoryUsed = 0;
+        }
+
+        // The relative order of deletes and reloads which are in memory is not known, so they
+        // are spilled the way _transferMods would send them: deletes first. This is safe since
+        // reloads always send the current version of the document.
+        vector<BSONObj> entries;
+        entries.reserve(deleted.size() + reload.size());
+        for (const auto& idObj : deleted) {
+            entries.push_back(BSON("_id" << _nextSpillSeq++ << "op"
+                                         << "d"
+                                         << "doc" << idObj));
+        }
+        for (const auto& idObj : reload) {
+            entries.push_back(BSON("_id" << _nextSpillSeq++ << "op"
+                                         << "r"
+                                         << "doc" << idObj));
+        }
+
+        try {
+            DBDirectClient client(txn);
+
+            if (!_modsSpillCreated) {
+                // Left over if it couldn't be dropped at the end of the previous migration.
+                client.dropCollection(kModsSpillNs);
+
+                BSONObj info;
+                const NamespaceString spillNss(kModsSpillNs);
+                if (!client.runCommand(spillNss.db().toString(),
+                                       BSON("create" << spillNss.coll() << "temp" << true),
+                                       info)) {
+                    return Status(ErrorCodes::OperationFailed,
+                                  str::stream() << "could not create " << kModsSpillNs << ": "
+                                                << info);
+                }
+                _modsSpillCreated = true;
+            }
+
+            client.insert(kModsSpillNs, entries);
+
+            const string err = client.getLastError();
+            if (!err.empty()) {
+                return Status(ErrorCodes::OperationFailed,
+                              str::stream() << "could not write to " << kModsSpillNs << ": "
+                                            << err);
+            }
+        } catch (const DBException& ex) {
+            return ex.toStatus();
+        }
+
+        _spilledMods += entries.size();
+
+        LOG(1) << "moveChunk spilled " << entries.size() << " modified document ids, "
+               << _spilledMods << " spilled in total" << migrateLog;
+        return Status::OK();
+    }
+
+    long long modsSpilled() const {
+        stdx::lock_guard<stdx::mutex> spillLock(_modsSpillMutex);
+        return _spilledMods;
+    }
+
+    /**
+     * Checks that the chunk is not too big to move, and opens the scan of the shard key index
+     * over the chunk range which feeds clone(). Record ids are read from it in batches, so the
+     * donor's memory use doesn't depend on the size of the chunk.
      *
      * @param maxChunkSize number of bytes beyond which a chunk's base data (no indices)
      *                     is considered too large to move.
      * @param errmsg filled with textual description of error if this call return false.
      * @return false if approximate chunk size is too big to move or true otherwise.
      */
-    bool storeCurrentLocs(OperationContext* txn,
-                          long long maxChunkSize,
-                          string& errmsg,
-                          BSONObjBuilder& result) {
+    bool initCloneScan(OperationContext* txn,
+                       long long maxChunkSize,
+                       string& errmsg,
+                       BSONObjBuilder& result) {
         AutoGetCollectionForRead ctx(txn, getNS());
         Collection* collection = ctx.getCollection();
         if (!collection) {
@@ -483,7 +664,7 @@ public:
 
         if (idx == NULL) {
             errmsg = str::stream() << "can't find index with prefix " << _shardKeyPattern
-                                   << " in storeCurrentLocs for " << _ns;
+                                   << " in initCloneScan for " << _ns;
             return false;
         }
 
@@ -512,10 +693,31 @@ public:
             max = Helpers::toKeyFormat(kp.extendRangeBound(_max, false));
         }
 
+        {
+            // The scan is saved between batches, and is notified of the writes which happen
+            // in between like any yielding executor. Any change to the base data that it
+            // might miss is already being queued and will migrate in the 'transferMods' stage.
+            stdx::lock_guard<stdx::mutex> lk(_cloneLocsMutex);
+            invariant(!_cloneExec);
+            _cloneExec = InternalPlanner::indexScan(txn, collection, idx, min, max, false);
+            _cloneExec->registerExec();
+            _cloneExec->saveState();
+
+            // The scan is restored by _migrateClone commands, each with an OperationContext of
+            // its own. Keep its RecoveryUnit with it and give this operation a fresh one, like
+            // find does for the cursors it hands to getMore.
+            txn->recoveryUnit()->abandonSnapshot();
+            _cloneRecoveryUnit.reset(txn->releaseRecoveryUnit());
+            invariant(txn->setRecoveryUnit(
+                          getGlobalServiceContext()->getGlobalStorageEngine()->newRecoveryUnit(),
+                          OperationContext::kNotInUnitOfWork) ==
+                      OperationContext::kNotInUnitOfWork);
+        }
+
+        // Only count the index keys in the range here. The documents are fetched when they
+        // are cloned.
         unique_ptr<PlanExecutor> exec(
             InternalPlanner::indexScan(txn, collection, idx, min, max, false));
-        // We can afford to yield here because any change to the base data that we might
-        // miss is already being queued and will migrate in the 'transferMods' stage.
         exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
 
         // use the average object size to estimate how many objects a full chunk would carry
@@ -539,14 +741,8 @@ public:
         // we want the number of records to better report, in that case
         bool isLargeChunk = false;
         unsigned long long recCount = 0;
-        ;
-        RecordId dl;
-        while (PlanExecutor::ADVANCED == exec->getNext(NULL, &dl)) {
-            if (!isLargeChunk) {
-                stdx::lock_guard<stdx::mutex> lk(_cloneLocsMutex);
-                _cloneLocs.insert(dl);
-            }
-
+        PlanExecutor::ExecState state;
+        while (PlanExecutor::ADVANCED == (state = exec->getNext(NULL, NULL))) {
             if (++recCount > maxRecsWhenFull) {
                 isLargeChunk = true;
                 // continue on despite knowing that it will fail,
@@ -555,6 +751,12 @@ public:
         }
         exec.reset();
 
+        if (PlanExecutor::IS_EOF != state) {
+            errmsg = str::stream() << "scan of the chunk range failed with state "
+                                   << PlanExecutor::statestr(state) << " for " << _ns;
+            return false;
+        }
+
         if (isLargeChunk) {
             stdx::lock_guard<stdx::mutex> sl(_mutex);
             warning() << "cannot move chunk: the maximum number of documents for a chunk is "
@@ -569,7 +771,7 @@ public:
             return false;
         }
 
-        log() << "moveChunk number of documents: " << cloneLocsRemaining() << migrateLog;
+        log() << "moveChunk number of documents: " << recCount << migrateLog;
 
         txn->recoveryUnit()->abandonSnapshot();
         return true;
@@ -594,9 +796,10 @@ public:
                 return false;
             }
 
-            allocSize = std::min(
-                BSONObjMaxUserSize,
-                static_cast<int>((12 + collection->averageObjectSize(txn)) * cloneLocsRemaining()));
+            allocSize =
+                std::min(static_cast<long long>(BSONObjMaxUserSize),
+                         (12 + collection->averageObjectSize(txn)) *
+                             static_cast<long long>(internalMigrationCloneBatchSize));
         }
 
         bool isBufferFilled = false;
@@ -620,6 +823,12 @@ public:
             }
 
             stdx::lock_guard<stdx::mutex> lk(_cloneLocsMutex);
+            if (_cloneLocs.empty() && !_fillCloneLocs_inlock(txn, errmsg)) {
+                return false;
+            }
+
+            // _cloneLocs is ordered by record id, so the documents of a batch are fetched in
+            // storage order rather than in shard key order.
             set<RecordId>::iterator cloneLocsIter = _cloneLocs.begin();
             for (; cloneLocsIter != _cloneLocs.end(); ++cloneLocsIter) {
                 if (tracker.intervalHasElapsed())  // should I yield?
@@ -648,7 +857,7 @@ public:
             _cloneLocs.erase(_cloneLocs.begin(), cloneLocsIter);
 
             // Note: must be holding _cloneLocsMutex, don't move this inside while condition!
-            if (_cloneLocs.empty()) {
+            if (_cloneLocs.empty() && !_cloneExec) {
                 break;
             }
         }
@@ -666,9 +875,12 @@ public:
         _cloneLocs.erase(dl);
     }
 
-    std::size_t cloneLocsRemaining() {
+    /**
+     * @return true if every document of the chunk was handed out by clone().
+     */
+    bool isCloneDone() {
         stdx::lock_guard<stdx::mutex> lk(_cloneLocsMutex);
-        return _cloneLocs.size();
+        return _cloneLocs.empty() && !_cloneExec;
     }
 
     long long mbUsed() const {
@@ -711,6 +923,175 @@ public:
     }
 
 private:
+    /**
+     * Reads the next batch of record ids from the index scan over the chunk range into
+     * _cloneLocs. The scan is released once it reaches the end of the range.
+     *
+     * Must be holding the collection lock, _mutex and _cloneLocsMutex.
+     */
+    bool _fillCloneLocs_inlock(OperationContext* txn, string& errmsg) {
+        if (!_cloneExec) {
+            return true;
+        }
+
+        // Only the scan runs on its own RecoveryUnit. The documents are fetched on the caller's.
+        ON_BLOCK_EXIT([this] {
+            if (!_cloneExec)
+                _cloneRecoveryUnit.reset();
+        });
+        ScopedStashedRecoveryUnit stashedRecoveryUnit(txn, &_cloneRecoveryUnit);
+
+        if (!_cloneExec->restoreState(txn)) {
+            errmsg = str::stream() << "scan of the chunk range was killed for " << _ns;
+            return false;
+        }
+
+        PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+        while (_cloneLocs.size() < static_cast<size_t>(internalMigrationCloneBatchSize)) {
+            RecordId dl;
+            state = _cloneExec->getNext(NULL, &dl);
+            if (PlanExecutor::ADVANCED != state) {
+                break;
+            }
+
+            _cloneLocs.insert(dl);
+        }
+
+        if (PlanExecutor::IS_EOF == state) {
+            _cloneExec.reset();
+            return true;
+        }
+
+        if (PlanExecutor::ADVANCED != state) {
+            errmsg = str::stream() << "scan of the chunk range failed with state "
+                                   << PlanExecutor::statestr(state) << " for " << _ns;
+            return false;
+        }
+
+        _cloneExec->saveState();
+        return true;
+    }
+
+    /**
+     * Sends the oldest spilled mods to the recipient, and forgets about those which were sent.
+     * If these are all the mods left in the spill collection, they are instead put back in
+     * memory ahead of the newer mods, and nothing is sent.
+     *
+     * Must be holding _modsSpillMutex and no locks.
+     */
+    bool _transferSpilledMods(OperationContext* txn,
+                              string& errmsg,
+                              BSONObjBuilder* b,
+                              long long* size) {
+        list<BSONObj> deleted;
+        list<BSONObj> reload;
+        vector<long long> deletedSeqs;
+        vector<long long> reloadSeqs;
+        long long memoryUsed = 0;
+
+        DBDirectClient client(txn);
+
+        unique_ptr<DBClientCursor> cursor(
+            client.query(kModsSpillNs, Query().sort(BSON("_id" << 1)), kSpilledModsBatchSize));
+        if (!cursor) {
+            errmsg = str::stream() << "could not read spilled mods from " << kModsSpillNs;
+            return false;
+        }
+
+        while (cursor->more()) {
+            BSONObj entry = cursor->nextSafe();
+            BSONObj idObj = entry["doc"].Obj().getOwned();
+            memoryUsed += idObj.firstElement().size() + 5;
+
+            if (entry["op"].String() == "d") {
+                deleted.push_back(idObj);
+                deletedSeqs.push_back(entry["_id"].numberLong());
+            } else {
+                reload.push_back(idObj);
+                reloadSeqs.push_back(entry["_id"].numberLong());
+            }
+        }
+
+        const long long numRead = deletedSeqs.size() + reloadSeqs.size();
+
+        if (numRead >= _spilledMods || numRead < kSpilledModsBatchSize) {
+            stdx::lock_guard<stdx::mutex> sl(_mutex);
+            if (!_active) {
+                errmsg = "no active migration!";
+                return false;
+            }
+
+            _deleted.splice(_deleted.begin(), deleted);
+            _reload.splice(_reload.begin(), reload);
+            _memoryUsed += memoryUsed;
+            _spilledMods = 0;
+
+            // Nothing left to read back, the collection is recreated by the next spill.
+            client.dropCollection(kModsSpillNs);
+            _modsSpillCreated = false;
+            return true;
+        }
+
+        {
+            AutoGetCollectionForRead ctx(txn, getNS());
+
+            stdx::lock_guard<stdx::mutex> sl(_mutex);
+            if (!_active) {
+                errmsg = "no active migration!";
+                return false;
+            }
+
+            xfer(txn, _ns, ctx.getDb(), &deleted, *b, "deleted", *size, false);
+            xfer(txn, _ns, ctx.getDb(), &reload, *b, "reload", *size, true);
+        }
+
+        // xfer consumes the lists from the front, so what was sent is a prefix of each.
+        BSONArrayBuilder sentSeqs;
+        const size_t deletedSent = deletedSeqs.size() - deleted.size();
+        const size_t reloadSent = reloadSeqs.size() - reload.size();
+        for (size_t i = 0; i < deletedSent; i++) {
+            sentSeqs.append(deletedSeqs[i]);
+        }
+        for (size_t i = 0; i < reloadSent; i++) {
+            sentSeqs.append(reloadSeqs[i]);
+        }
+
+        client.remove(kModsSpillNs, BSON("_id" << BSON("$in" << sentSeqs.arr())));
+
+        const string err = client.getLastError();
+        if (!err.empty()) {
+            errmsg = str::stream() << "could not remove transferred mods from " << kModsSpillNs
+                                   << ": " << err;
+            return false;
+        }
+
+        _spilledMods -= deletedSent + reloadSent;
+        return true;
+    }
+
+    /**
+     * Drops the spill collection, if this migration created it.
+     */
+    void _dropModsSpill(OperationContext* txn) {
+        stdx::lock_guard<stdx::mutex> spillLock(_modsSpillMutex);
+
+        _spilledMods = 0;
+        _nextSpillSeq = 0;
+
+        if (!_modsSpillCreated) {
+            return;
+        }
+
+        _modsSpillCreated = false;
+
+        try {
+            DBDirectClient client(txn);
+            client.dropCollection(kModsSpillNs);
+        } catch (const DBException& ex) {
+            warning() << "could not drop " << kModsSpillNs << causedBy(ex) << migrateLog;
+        }
+    }
+
     bool _getActive() const {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
         return _active;
@@ -817,10 +1198,11 @@ private:
     // (MG) For reads, _mutex *OR* Global IX Lock must be held.
     //      For writes, the _mutex *AND* (Global Shared or Exclusive Lock) must be held.
     // (C)  Must hold _cloneLocsMutex for access.
+    // (S)  Must hold _modsSpillMutex for access.
     //
     // Locking order:
     //
-    // Global Lock -> _mutex -> _cloneLocsMutex
+    // _modsSpillMutex -> Global Lock -> _mutex -> _cloneLocsMutex
 
     mutable stdx::mutex _mutex;
 
@@ -850,9 +1232,31 @@ private:
 
     mutable stdx::mutex _cloneLocsMutex;
 
-    // List of record id that needs to be transferred from here to the other side.
+    // RecoveryUnit which _cloneExec was saved on, and must be restored on. Must outlive
+    // _cloneExec.
+    unique_ptr<RecoveryUnit> _cloneRecoveryUnit;  // (C)
+
+    // Scan of the shard key index over the chunk range, saved between batches. Reset once it
+    // reaches the end of the range.
+    unique_ptr<PlanExecutor> _cloneExec;  // (C)
+
+    // Batch of record ids read from _cloneExec which still need to be transferred from here
+    // to the other side.
     set<RecordId> _cloneLocs;  // (C)
 
+    // Serializes spilling mods with transferring them, so that the recipient gets them in the
+    // order they were logged. Taken before any lock.
+    mutable stdx::mutex _modsSpillMutex;
+
+    // Number of mods currently in the spill collection.
+    long long _spilledMods = 0;  // (S)
+
+    // Sequence number given to the next spilled mod, which orders the spill collection.
+    long long _nextSpillSeq = 0;  // (S)
+
+    // Whether this migration created the spill collection.
+    bool _modsSpillCreated = false;  // (S)
+
 } migrateFromStatus;
 
 void MigrateFromStatus::DeleteNotificationStage::invalidate(OperationContext* txn,
@@ -1150,6 +1554,7 @@ public:
 
         MoveTimingHelper timing(
             txn, "from", ns, min, max, 6 /* steps */, &errmsg, toShardName, fromShardName);
+        timing.reportStepTimesTo(&result);
 
         log() << "received moveChunk request: " << cmdObj << migrateLog;
 
@@ -1293,7 +1698,7 @@ public:
         {
             // See comment at the top of the function for more information on what
             // synchronization is used here.
-            if (!migrateFromStatus.storeCurrentLocs(txn, maxChunkSize, errmsg, result)) {
+            if (!migrateFromStatus.initCloneScan(txn, maxChunkSize, errmsg, result)) {
                 warning() << errmsg;
                 return false;
             }
@@ -1384,7 +1789,8 @@ public:
             }
 
             LOG(0) << "moveChunk data transfer progress: " << res
-                   << " my mem used: " << migrateFromStatus.mbUsed() << migrateLog;
+                   << " my mem used: " << migrateFromStatus.mbUsed()
+                   << " mods spilled: " << migrateFromStatus.modsSpilled() << migrateLog;
 
             if (!ok || res["state"].String() == "fail") {
                 warning() << "moveChunk error transferring data caused migration abort: " << res
@@ -1397,6 +1803,24 @@ public:
             if (res["state"].String() == "steady")
                 break;
 
+            Status spillStatus = migrateFromStatus.spillModsIfNeeded(txn);
+            if (!spillStatus.isOK()) {
+                // The mods which could not be spilled are lost, so the migration can't go on.
+                ScopedDbConnection conn(toShardCS);
+
+                BSONObj res;
+                if (!conn->runCommand("admin", BSON("_recvChunkAbort" << 1), res)) {
+                    warning() << "Error encountered while trying to abort migration on "
+                              << "destination shard" << toShardCS;
+                }
+
+                conn.done();
+                errmsg = str::stream() << "aborting migrate because modified documents could "
+                                       << "not be spilled" << causedBy(spillStatus);
+                error() << errmsg << migrateLog;
+                return false;
+            }
+
             if (migrateFromStatus.mbUsed() > (500 * 1024 * 1024)) {
                 // This is too much memory for us to use for this so we're going to abort
                 // the migrate
@@ -1431,11 +1855,9 @@ public:
         log() << "About to check if it is safe to enter critical section";
 
         // Ensure all cloned docs have actually been transferred
-        std::size_t locsRemaining = migrateFromStatus.cloneLocsRemaining();
-        if (locsRemaining != 0) {
+        if (!migrateFromStatus.isCloneDone()) {
             errmsg = str::stream() << "moveChunk cannot enter critical section before all data is"
-                                   << " cloned, " << locsRemaining << " locs were not transferred"
-                                   << " but to-shard reported " << res;
+                                   << " cloned, but to-shard reported " << res;
 
             // Should never happen, but safe to abort before critical section
             error() << errmsg << migrateLog;
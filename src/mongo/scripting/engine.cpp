@@ -403,6 +403,9 @@ public:
     bool isKillPending() const {
         return _real->isKillPending();
     }
+    void kill() {
+        _real->kill();
+    }
     int type(const char* field) {
         return _real->type(field);
     }
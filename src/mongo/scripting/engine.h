@@ -100,6 +100,12 @@ public:
 
     virtual bool isKillPending() const = 0;
 
+    /**
+     * Terminates the code running in this scope, and any run later. May be called from another
+     * thread.
+     */
+    virtual void kill() = 0;
+
     virtual void gc() = 0;
 
     virtual ScriptingFunction createFunction(const char* code);
@@ -179,60 +179,13 @@ bool MessagingPort::recv(Message& m) {
         MSGHEADER::Value header;
         int headerLen = sizeof(MSGHEADER::Value);
         psock->recv((char*)&header, headerLen);
-        int len = header.constView().getMessageLength();
-
-        if (len == 542393671) {
-            // an http GET
-            string msg =
-                "It looks like you are trying to access MongoDB over HTTP on the native driver "
-                "port.\n";
-            LOG(psock->getLogLevel()) << msg;
-            std::stringstream ss;
-            ss << "HTTP/1.0 200 OK\r\nConnection: close\r\nContent-Type: "
-                  "text/plain\r\nContent-Length: " << msg.size() << "\r\n\r\n" << msg;
-            string s = ss.str();
-            send(s.c_str(), s.size(), "http");
+        int len = checkHeader(header);
+        if (len < 0) {
             return false;
-        } else if (len == -1) {
-            // Endian check from the client, after connecting, to see what mode
-            // server is running in.
-            unsigned foo = 0x10203040;
-            send((char*)&foo, 4, "endian");
-            psock->setHandshakeReceived();
+        } else if (len == 0) {
             goto again;
         }
-        // If responseTo is not 0 or -1 for first packet assume SSL
-        else if (psock->isAwaitingHandshake()) {
-#ifndef MONGO_CONFIG_SSL
-            if (header.constView().getResponseTo() != 0 &&
-                header.constView().getResponseTo() != -1) {
-                uasserted(17133,
-                          "SSL handshake requested, SSL feature not available in this build");
-            }
-#else
-            if (header.constView().getResponseTo() != 0 &&
-                header.constView().getResponseTo() != -1) {
-                uassert(17132,
-                        "SSL handshake received but server is started without SSL support",
-                        sslGlobalParams.sslMode.load() != SSLParams::SSLMode_disabled);
-                setX509SubjectName(
-                    psock->doSSLHandshake(reinterpret_cast<const char*>(&header), sizeof(header)));
-                psock->setHandshakeReceived();
-                goto again;
-            }
-            uassert(17189,
-                    "The server is configured to only allow SSL connections",
-                    sslGlobalParams.sslMode.load() != SSLParams::SSLMode_requireSSL);
-#endif  // MONGO_CONFIG_SSL
-        }
-        if (static_cast<size_t>(len) < sizeof(MSGHEADER::Value) ||
-            static_cast<size_t>(len) > MaxMessageSizeBytes) {
-            LOG(0) << "recv(): message len " << len << " is invalid. "
-                   << "Min " << sizeof(MSGHEADER::Value) << " Max: " << MaxMessageSizeBytes;
-            return false;
-        }
 
-        psock->setHandshakeReceived();
         int z = (len + 1023) & 0xfffffc00;
         verify(z >= len);
         MsgData::View md = reinterpret_cast<char*>(mongoMalloc(z));
@@ -258,6 +211,63 @@ bool MessagingPort::recv(Message& m) {
     }
 }
 
+int MessagingPort::checkHeader(const MSGHEADER::Value& header) {
+    int len = header.constView().getMessageLength();
+
+    if (len == 542393671) {
+        // an http GET
+        string msg =
+            "It looks like you are trying to access MongoDB over HTTP on the native driver "
+            "port.\n";
+        LOG(psock->getLogLevel()) << msg;
+        std::stringstream ss;
+        ss << "HTTP/1.0 200 OK\r\nConnection: close\r\nContent-Type: "
+              "text/plain\r\nContent-Length: " << msg.size() << "\r\n\r\n" << msg;
+        string s = ss.str();
+        send(s.c_str(), s.size(), "http");
+        return -1;
+    } else if (len == -1) {
+        // Endian check from the client, after connecting, to see what mode
+        // server is running in.
+        unsigned foo = 0x10203040;
+        send((char*)&foo, 4, "endian");
+        psock->setHandshakeReceived();
+        return 0;
+    }
+    // If responseTo is not 0 or -1 for first packet assume SSL
+    else if (psock->isAwaitingHandshake()) {
+#ifndef MONGO_CONFIG_SSL
+        if (header.constView().getResponseTo() != 0 &&
+            header.constView().getResponseTo() != -1) {
+            uasserted(17133, "SSL handshake requested, SSL feature not available in this build");
+        }
+#else
+        if (header.constView().getResponseTo() != 0 &&
+            header.constView().getResponseTo() != -1) {
+            uassert(17132,
+                    "SSL handshake received but server is started without SSL support",
+                    sslGlobalParams.sslMode.load() != SSLParams::SSLMode_disabled);
+            setX509SubjectName(
+                psock->doSSLHandshake(reinterpret_cast<const char*>(&header), sizeof(header)));
+            psock->setHandshakeReceived();
+            return 0;
+        }
+        uassert(17189,
+                "The server is configured to only allow SSL connections",
+                sslGlobalParams.sslMode.load() != SSLParams::SSLMode_requireSSL);
+#endif  // MONGO_CONFIG_SSL
+    }
+    if (static_cast<size_t>(len) < sizeof(MSGHEADER::Value) ||
+        static_cast<size_t>(len) > MaxMessageSizeBytes) {
+        LOG(0) << "recv(): message len " << len << " is invalid. "
+               << "Min " << sizeof(MSGHEADER::Value) << " Max: " << MaxMessageSizeBytes;
+        return -1;
+    }
+
+    psock->setHandshakeReceived();
+    return len;
+}
+
 void MessagingPort::reply(Message& received, Message& response) {
     say(/*received.from, */ response, received.header().getId());
 }
@@ -62,6 +62,17 @@ public:
        also, the Message data will go out of scope on the subsequent recv call.
     */
     bool recv(Message& m);
+
+    /**
+     * Handles the header of an incoming message the way recv() does, for servers which read
+     * messages off the socket themselves. Answers the endian check and plain HTTP requests.
+     *
+     * Returns the length of the message, header included, 0 if the header was part of the
+     * handshake and the next header is to be read instead, or -1 if the connection must be
+     * closed. Throws on SSL handshake errors.
+     */
+    int checkHeader(const MSGHEADER::Value& header);
+
     void reply(Message& received, Message& response, MSGID responseTo);
     void reply(Message& received, Message& response);
     bool call(Message& toSend, Message& response);
@@ -36,10 +36,20 @@
 
 #include "mongo/platform/basic.h"
 
+#include <memory>
+
 namespace mongo {
 
 class MessageHandler {
 public:
+    /**
+     * Opaque per-connection state which a handler otherwise keeps in thread-local storage.
+     */
+    class ConnectionState {
+    public:
+        virtual ~ConnectionState() {}
+    };
+
     virtual ~MessageHandler() {}
 
     /**
@@ -52,6 +62,23 @@ public:
      * handler is responsible for responding to client
      */
     virtual void process(Message& m, AbstractMessagingPort* p) = 0;
+
+    /**
+     * Servers which multiplex connections over a pool of threads call detachConnection() on the
+     * thread which just processed a message from "p", and attachConnection() with the returned
+     * state on the thread which processes the next one. Handlers that do not override these
+     * can only be served with one thread per connection.
+     */
+    virtual bool supportsDetachedConnections() const {
+        return false;
+    }
+
+    virtual std::unique_ptr<ConnectionState> detachConnection(AbstractMessagingPort* p) {
+        return std::unique_ptr<ConnectionState>();
+    }
+
+    virtual void attachConnection(AbstractMessagingPort* p,
+                                  std::unique_ptr<ConnectionState> state) {}
 };
 
 class MessageServer {
@@ -35,11 +35,14 @@
 #include <system_error>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/base/init.h"
 #include "mongo/config.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/stdx/functional.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/concurrency/synchronization.h"
 #include "mongo/util/concurrency/thread_name.h"
@@ -52,7 +55,9 @@
 #include "mongo/util/net/message.h"
 #include "mongo/util/net/message_port.h"
 #include "mongo/util/net/message_server.h"
+#include "mongo/util/net/message_server_reactor.h"
 #include "mongo/util/net/ssl_manager.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
 
 #ifdef __linux__  // TODO: consider making this ifndef _WIN32
@@ -70,6 +75,53 @@ using std::endl;
 
 namespace {
 
+const char kServiceModelThreadPerConnection[] = "threadPerConnection";
+const char kServiceModelReactor[] = "reactor";
+
+}  // namespace
+
+// How accepted connections are serviced: "threadPerConnection" runs a dedicated thread for each
+// connection, "reactor" multiplexes all connections over a few epoll I/O threads and a pool of
+// worker threads (see MessageServerReactor). mongos always uses a thread per connection.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(serviceModel, std::string, kServiceModelThreadPerConnection);
+MONGO_INITIALIZER(serviceModel)(InitializerContext*) {
+    if (serviceModel != kServiceModelThreadPerConnection && serviceModel != kServiceModelReactor) {
+        return Status(ErrorCodes::BadValue, "unsupported service model: " + serviceModel);
+    }
+    return Status::OK();
+}
+
+// Number of the reactor's I/O threads, and of worker threads it keeps even while idle. 0 picks a
+// size based on the number of cores.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(serviceReactorIOThreads, int, 0);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(serviceReactorWorkerThreads, int, 0);
+
+namespace {
+
+std::unique_ptr<MessageServerReactor> makeReactor(MessageHandler* handler) {
+    if (serviceModel != kServiceModelReactor)
+        return std::unique_ptr<MessageServerReactor>();
+
+    if (!MessageServerReactor::isSupported(handler)) {
+        warning() << "serviceModel " << kServiceModelReactor
+                  << " is not supported on this platform or with this configuration, using "
+                  << kServiceModelThreadPerConnection;
+        return std::unique_ptr<MessageServerReactor>();
+    }
+
+    const size_t numCores = std::max(ProcessInfo().getNumCores(), 1U);
+    const size_t numIOThreads = serviceReactorIOThreads > 0
+        ? serviceReactorIOThreads
+        : std::max(numCores / 4, static_cast<size_t>(1));
+    const size_t minWorkerThreads = serviceReactorWorkerThreads > 0
+        ? serviceReactorWorkerThreads
+        : std::max(numCores * 16, static_cast<size_t>(64));
+
+    log() << "servicing connections with " << numIOThreads << " I/O threads and at least "
+          << minWorkerThreads << " worker threads";
+    return stdx::make_unique<MessageServerReactor>(handler, numIOThreads, minWorkerThreads);
+}
+
 class MessagingPortWithHandler : public MessagingPort {
     MONGO_DISALLOW_COPYING(MessagingPortWithHandler);
 
@@ -102,7 +154,7 @@ public:
      *     and should make sure that it lives longer than this server.
      */
     PortMessageServer(const MessageServer::Options& opts, MessageHandler* handler)
-        : Listener("", opts.ipList, opts.port), _handler(handler) {}
+        : Listener("", opts.ipList, opts.port), _handler(handler), _reactor(makeReactor(handler)) {}
 
     virtual void accepted(std::shared_ptr<Socket> psocket, long long connectionId) {
         ScopeGuard sleepAfterClosingPort = MakeGuard(sleepmillis, 2);
@@ -115,6 +167,12 @@ public:
             return;
         }
 
+        if (_reactor) {
+            _reactor->addConnection(std::move(portWithHandler));
+            sleepAfterClosingPort.Dismiss();
+            return;
+        }
+
         try {
 #ifndef __linux__  // TODO: consider making this ifdef _WIN32
             {
@@ -173,6 +231,9 @@ public:
     }
 
     void run() {
+        if (_reactor) {
+            _reactor->startup();
+        }
         initAndListen();
     }
 
@@ -183,6 +244,9 @@ public:
 private:
     MessageHandler* _handler;
 
+    // Set if connections are serviced by a reactor rather than a thread per connection.
+    std::unique_ptr<MessageServerReactor> _reactor;
+
     /**
      * Handles incoming messages from a given socket.
      *
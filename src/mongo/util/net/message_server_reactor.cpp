@@ -0,0 +1,456 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_server_reactor.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#endif
+
+#include <limits>
+
+#include "mongo/base/status.h"
+#include "mongo/config.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/allocator.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/listen.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_port.h"
+#include "mongo/util/net/message_server.h"
+#include "mongo/util/net/ssl_options.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+namespace {
+
+ThreadPool::Options makeWorkerPoolOptions(size_t minWorkerThreads) {
+    ThreadPool::Options options;
+    options.poolName = "ServiceReactorWorkers";
+    options.threadNamePrefix = "reactorWorker";
+    options.minThreads = minWorkerThreads;
+    // Each connection has at most one message queued or being processed, so the pool never needs
+    // more threads than there are connections, and never runs out of them while some of its
+    // threads block in long operations, such as awaitData getMores or waits for write concern.
+    options.maxThreads = std::numeric_limits<size_t>::max();
+    return options;
+}
+
+void logEndConnection(MessagingPort* port) {
+    if (!serverGlobalParams.quiet) {
+        int conns = Listener::globalTicketHolder.used() - 1;
+        const char* word = (conns == 1 ? " connection" : " connections");
+        log() << "end connection " << port->psock->remoteString() << " (" << conns << word
+              << " now open)";
+    }
+}
+
+}  // namespace
+
+struct MessageServerReactor::Connection {
+    Connection(std::unique_ptr<MessagingPort> port, IOThread* ioThread)
+        : ticketReleaser(&Listener::globalTicketHolder),
+          port(std::move(port)),
+          ioThread(ioThread) {}
+
+    ~Connection() {
+        free(data);
+        serviceReactorCounter.gotDisconnection();
+    }
+
+    TicketHolderReleaser ticketReleaser;
+    std::unique_ptr<MessagingPort> port;
+
+    // The I/O thread which watches this connection.
+    IOThread* const ioThread;
+
+    // State of the connection kept by the handler while no thread processes one of its messages.
+    // Empty until the handler's connected() has run on a worker thread.
+    std::unique_ptr<MessageHandler::ConnectionState> handlerState;
+    bool connected = false;
+
+    // The message being read off the socket, which may take several wakeups of the I/O thread.
+    // The header is read into 'header' first, then the whole message into 'data', which is
+    // allocated with mongoMalloc once the header has been checked.
+    MSGHEADER::Value header;
+    size_t headerBytesRead = 0;
+    char* data = nullptr;
+    size_t dataBytesRead = 0;
+    size_t messageLength = 0;
+
+    // The last message received on this connection, and when it was handed to the workers.
+    Message message;
+    Timer queuedTimer;
+};
+
+#ifdef __linux__
+
+/**
+ * Waits on an epoll set for any of its connections to become readable, and reads from each
+ * readable connection without blocking. Once a whole message has been read from a connection, its
+ * processing is scheduled on the worker pool. A connection which has only sent part of a message
+ * is rearmed right away, and the I/O thread moves on to other connections.
+ *
+ * Connections are registered with EPOLLONESHOT, so that once a message has been received from a
+ * connection, it is not watched again until the worker which processed that message rearms it.
+ * Whoever holds the Connection pointer while it is not armed in the epoll set owns it.
+ */
+class MessageServerReactor::IOThread {
+    MONGO_DISALLOW_COPYING(IOThread);
+
+public:
+    IOThread(MessageServerReactor* reactor, int id)
+        : _reactor(reactor), _id(id), _shutdown(false) {
+        _epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (_epollFd < 0) {
+            const int err = errno;
+            severe() << "epoll_create1 failed: " << errnoWithDescription(err);
+            fassertFailed(28722);
+        }
+    }
+
+    ~IOThread() {
+        _shutdown.store(true);
+        if (_thread.joinable())
+            _thread.join();
+        ::close(_epollFd);
+    }
+
+    void startup() {
+        _thread = stdx::thread(stdx::bind(&IOThread::_run, this));
+    }
+
+    /**
+     * Arms "conn" in this thread's epoll set. New connections are added, connections whose
+     * message has been processed are rearmed. Ownership is transferred to the epoll set.
+     */
+    void watch(std::unique_ptr<Connection> conn, bool isNew) {
+        const int fd = conn->port->psock->rawFD();
+
+        epoll_event event;
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        event.data.ptr = conn.get();
+
+        // The connection may be received and even destroyed by _run() as soon as it is armed.
+        Connection* const rawConn = conn.release();
+        if (epoll_ctl(_epollFd, isNew ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event) != 0) {
+            const int err = errno;
+            std::unique_ptr<Connection> owned(rawConn);
+            log() << "closing connection " << owned->port->psock->remoteString()
+                  << ", epoll_ctl failed: " << errnoWithDescription(err);
+            owned->port->shutdown();
+        }
+    }
+
+private:
+    void _run() {
+        setThreadName(std::string(str::stream() << "reactorIO" << _id));
+
+        const int kMaxEvents = 64;
+        const int kTimeoutMillis = 100;
+        epoll_event events[kMaxEvents];
+
+        while (!_shutdown.load() && !inShutdown()) {
+            const int numEvents = epoll_wait(_epollFd, events, kMaxEvents, kTimeoutMillis);
+            if (numEvents < 0) {
+                const int err = errno;
+                if (err == EINTR)
+                    continue;
+                severe() << "epoll_wait failed: " << errnoWithDescription(err);
+                fassertFailed(28723);
+            }
+
+            for (int i = 0; i < numEvents; ++i) {
+                _receive(std::unique_ptr<Connection>(static_cast<Connection*>(events[i].data.ptr)));
+            }
+        }
+    }
+
+    enum class ReadResult { kComplete, kWouldBlock, kClosed };
+
+    /**
+     * Reads from "conn" into "buf" until "*bytesRead" reaches "len", or until reading would block.
+     */
+    ReadResult _read(Connection* conn, char* buf, size_t len, size_t* bytesRead) {
+        const int fd = conn->port->psock->rawFD();
+        while (*bytesRead < len) {
+            const ssize_t ret = ::recv(fd, buf + *bytesRead, len - *bytesRead, MSG_DONTWAIT);
+            if (ret > 0) {
+                *bytesRead += ret;
+                continue;
+            }
+            if (ret == 0) {
+                return ReadResult::kClosed;
+            }
+
+            const int err = errno;
+            if (err == EINTR)
+                continue;
+            if (err == EAGAIN || err == EWOULDBLOCK)
+                return ReadResult::kWouldBlock;
+
+            LOG(1) << "error receiving from " << conn->port->psock->remoteString() << ": "
+                   << errnoWithDescription(err);
+            return ReadResult::kClosed;
+        }
+        return ReadResult::kComplete;
+    }
+
+    /**
+     * Reads what is available of the next message of "conn". Returns true if the whole message
+     * has been read into conn->message, otherwise "conn" has been rearmed or closed.
+     */
+    bool _readMessage(std::unique_ptr<Connection>& conn) {
+        MessagingPort* const port = conn->port.get();
+        ReadResult result = ReadResult::kComplete;
+
+        while (!conn->data) {
+            result = _read(conn.get(),
+                           reinterpret_cast<char*>(&conn->header),
+                           sizeof(conn->header),
+                           &conn->headerBytesRead);
+            if (result != ReadResult::kComplete)
+                break;
+
+            conn->headerBytesRead = 0;
+            const int len = port->checkHeader(conn->header);
+            if (len < 0) {
+                result = ReadResult::kClosed;
+                break;
+            }
+            if (len == 0)
+                continue;
+
+            // Same allocation as MessagingPort::recv().
+            const size_t size = (len + 1023) & 0xfffffc00;
+            conn->data = static_cast<char*>(mongoMalloc(size));
+            memcpy(conn->data, &conn->header, sizeof(conn->header));
+            conn->dataBytesRead = sizeof(conn->header);
+            conn->messageLength = len;
+        }
+
+        if (result == ReadResult::kComplete) {
+            result = _read(conn.get(), conn->data, conn->messageLength, &conn->dataBytesRead);
+        }
+
+        switch (result) {
+            case ReadResult::kComplete:
+                break;
+            case ReadResult::kWouldBlock:
+                watch(std::move(conn), false);
+                return false;
+            case ReadResult::kClosed:
+                logEndConnection(port);
+                _close(std::move(conn));
+                return false;
+        }
+
+        conn->message.reset();
+        conn->message.setData(conn->data, true);
+        conn->data = nullptr;
+        return true;
+    }
+
+    void _receive(std::unique_ptr<Connection> conn) {
+        try {
+            if (!_readMessage(conn))
+                return;
+        } catch (const DBException& e) {
+            log() << "exception receiving request, closing client connection: " << e;
+            _close(std::move(conn));
+            return;
+        }
+
+        // The message is read around the socket, so the worker counts it on top of whatever the
+        // socket reads and sends while processing it.
+        conn->port->psock->clearCounters();
+        conn->queuedTimer.reset();
+        serviceReactorCounter.gotQueued();
+
+        Connection* const rawConn = conn.release();
+        Status status =
+            _reactor->_workers.schedule(stdx::bind(&MessageServerReactor::_processMessage,
+                                                   _reactor,
+                                                   rawConn));
+        if (!status.isOK()) {
+            // Only fails on shutdown.
+            serviceReactorCounter.gotDequeued(0);
+            _close(std::unique_ptr<Connection>(rawConn));
+        }
+    }
+
+    void _close(std::unique_ptr<Connection> conn) {
+        epoll_ctl(_epollFd, EPOLL_CTL_DEL, conn->port->psock->rawFD(), NULL);
+        conn->port->shutdown();
+    }
+
+    MessageServerReactor* const _reactor;
+    const int _id;
+    int _epollFd;
+    AtomicWord<bool> _shutdown;
+    stdx::thread _thread;
+};
+
+bool MessageServerReactor::isSupported(const MessageHandler* handler) {
+    if (!handler->supportsDetachedConnections())
+        return false;
+
+#ifdef MONGO_CONFIG_SSL
+    // Data buffered inside the SSL layer does not make the socket readable, so SSL connections
+    // could wait forever for a message which has already been received.
+    if (sslGlobalParams.sslMode.load() != SSLParams::SSLMode_disabled)
+        return false;
+#endif
+
+    return true;
+}
+
+#else  // __linux__
+
+class MessageServerReactor::IOThread {
+public:
+    IOThread(MessageServerReactor* reactor, int id) {}
+
+    void startup() {}
+
+    void watch(std::unique_ptr<Connection> conn, bool isNew) {
+        MONGO_UNREACHABLE;
+    }
+};
+
+bool MessageServerReactor::isSupported(const MessageHandler* handler) {
+    return false;
+}
+
+#endif  // __linux__
+
+MessageServerReactor::MessageServerReactor(MessageHandler* handler,
+                                           size_t numIOThreads,
+                                           size_t minWorkerThreads)
+    : _handler(handler), _workers(makeWorkerPoolOptions(minWorkerThreads)) {
+    invariant(isSupported(handler));
+    invariant(numIOThreads > 0);
+    for (size_t i = 0; i < numIOThreads; ++i) {
+        _ioThreads.push_back(stdx::make_unique<IOThread>(this, i));
+    }
+    serviceReactorCounter.enable(numIOThreads, minWorkerThreads);
+}
+
+MessageServerReactor::~MessageServerReactor() {
+    _ioThreads.clear();
+    _workers.shutdown();
+    _workers.join();
+}
+
+void MessageServerReactor::startup() {
+    _workers.startup();
+    for (auto&& ioThread : _ioThreads) {
+        ioThread->startup();
+    }
+}
+
+void MessageServerReactor::addConnection(std::unique_ptr<MessagingPort> port) {
+    // Only called by the listener thread, so _nextIOThread needs no synchronization.
+    IOThread* const ioThread = _ioThreads[_nextIOThread].get();
+    _nextIOThread = (_nextIOThread + 1) % _ioThreads.size();
+
+    port->psock->setLogLevel(logger::LogSeverity::Debug(1));
+    serviceReactorCounter.gotConnection();
+    ioThread->watch(stdx::make_unique<Connection>(std::move(port), ioThread), true);
+}
+
+void MessageServerReactor::_processMessage(Connection* rawConn) {
+    std::unique_ptr<Connection> conn(rawConn);
+    serviceReactorCounter.gotDequeued(conn->queuedTimer.micros());
+
+    MessagingPort* const port = conn->port.get();
+    bool attached = false;
+    bool succeeded = false;
+    try {
+        if (!conn->connected) {
+            _handler->connected(port);
+            conn->connected = true;
+        } else {
+            _handler->attachConnection(port, std::move(conn->handlerState));
+        }
+        attached = true;
+
+        _handler->process(conn->message, port);
+        networkCounter.hit(conn->messageLength + port->psock->getBytesIn(),
+                           port->psock->getBytesOut());
+
+        conn->handlerState = _handler->detachConnection(port);
+        attached = false;
+        succeeded = true;
+    } catch (const AssertionException& e) {
+        log() << "AssertionException handling request, closing client connection: " << e;
+    } catch (const SocketException& e) {
+        log() << "SocketException handling request, closing client connection: " << e;
+    } catch (const DBException& e) {  // must be right above std::exception to avoid catching
+                                      // subclasses
+        log() << "DBException handling request, closing client connection: " << e;
+    } catch (const std::exception& e) {
+        error() << "Uncaught std::exception: " << e.what() << ", terminating";
+        dbexit(EXIT_UNCAUGHT);
+    }
+
+    if (!succeeded) {
+        // Take the connection's state off this thread before closing it, so that the worker can
+        // service other connections.
+        if (attached)
+            conn->handlerState = _handler->detachConnection(port);
+        port->shutdown();
+        return;
+    }
+
+    if (inShutdown()) {
+        port->shutdown();
+        return;
+    }
+
+    IOThread* const ioThread = conn->ioThread;
+    ioThread->watch(std::move(conn), false);
+}
+
+}  // namespace mongo
@@ -0,0 +1,99 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+
+class MessageHandler;
+class MessagingPort;
+
+/**
+ * Services connections with an epoll based reactor instead of one thread per connection.
+ *
+ * A small number of I/O threads wait for their connections to become readable and read messages
+ * from them without blocking. Each received message is handed to a pool of worker threads, which
+ * runs MessageHandler::process() for it. The pool keeps a minimum number of threads and grows
+ * whenever all of them are busy, up to one thread per connection. A connection is only watched by
+ * its I/O thread while none of its messages is being processed, so the messages of a connection
+ * are still processed one at a time and in order.
+ *
+ * Since the worker which processes a message is not the one which processed the previous message
+ * of the same connection, the handler must support detached connections, which means that it
+ * keeps no per-connection state in thread-local storage other than the Client. Only available on
+ * Linux.
+ */
+class MessageServerReactor {
+    MONGO_DISALLOW_COPYING(MessageServerReactor);
+
+public:
+    /**
+     * Returns true if connections can be serviced by a reactor on this platform and with the
+     * current server configuration.
+     */
+    static bool isSupported(const MessageHandler* handler);
+
+    MessageServerReactor(MessageHandler* handler, size_t numIOThreads, size_t minWorkerThreads);
+    ~MessageServerReactor();
+
+    /**
+     * Starts the I/O and worker threads. Must be called once, before addConnection().
+     */
+    void startup();
+
+    /**
+     * Takes ownership of the newly accepted connection "port", for which the caller has acquired
+     * a ticket of Listener::globalTicketHolder. The ticket is released when the connection ends.
+     */
+    void addConnection(std::unique_ptr<MessagingPort> port);
+
+private:
+    class IOThread;
+    struct Connection;
+
+    /**
+     * Runs in a worker thread, processing the message just received on "conn".
+     */
+    void _processMessage(Connection* conn);
+
+    MessageHandler* const _handler;
+
+    std::vector<std::unique_ptr<IOThread>> _ioThreads;
+    ThreadPool _workers;
+
+    // Index into _ioThreads of the thread which gets the next new connection.
+    size_t _nextIOThread = 0;
+};
+
+}  // namespace mongo